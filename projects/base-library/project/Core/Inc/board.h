@@ -13,6 +13,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "stdio.h"
+#include "i2c_recovery_hal.h"
 
 /* Variables ------------------------------------------------------------------*/
 /* Protocols */
@@ -38,6 +39,7 @@ extern DMA_NodeTypeDef Node_GPDMA1_Channel1;
 extern DMA_QListTypeDef List_GPDMA1_Channel1;
 extern DMA_HandleTypeDef handle_GPDMA1_Channel1;
 extern uint8_t UART1_rxBuffer[1];
+extern I2C_RECOVERY i2c1_recovery;
 
 /* Function prototypes ------------------------------------------------------------------*/
 void delay(uint16_t time);
@@ -56,6 +58,7 @@ void pwm3_set_ch1(uint16_t dutycycle);
 
 extern HAL_StatusTypeDef i2c_wr(I2C_HandleTypeDef handle, uint8_t device_address, uint8_t register_address, uint16_t value);
 extern HAL_StatusTypeDef i2c_rd(I2C_HandleTypeDef handle, uint8_t device_address, uint8_t register_address, uint16_t* value);
+void i2c1_recovery_init(void);
 
 void uart_rd(UART_HandleTypeDef handle, uint8_t* buffer, int size);
 
@@ -7,8 +7,18 @@
  *  Author: Peter, Jordan, Katherine
  */
 
+#ifndef INC_CAN_H_
+#define INC_CAN_H_
+
 /* Includes ------------------------------------------------------------------*/
+#include "board.h"
 
 /* Variables ------------------------------------------------------------------*/
 
 /* Functions ------------------------------------------------------------------*/
+HAL_StatusTypeDef can_init(void); // Starts FDCAN1, MX_FDCAN1_Init() only configures it
+uint32_t can_tx_free(void); // Frames that can be queued without waiting
+uint8_t can_tx_pending(void); // 1 while queued frames are still waiting for the bus
+HAL_StatusTypeDef can_tx(uint16_t id, const uint8_t* data, uint8_t length); // Queues a classic frame (standard ID, up to 8 bytes), never waits
+
+#endif /* INC_CAN_H_ */
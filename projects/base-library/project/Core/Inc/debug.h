@@ -12,11 +12,20 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "board.h"
+#include "profiling.h"
+#include "profiling_irq.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define DEBUG_PROFILE_CAN_ID 0x7E3 // see profiling_packCan(), profiling_irqPackCan() and profiling_irqPackNesting()
+#define DEBUG_PROFILE_TIMEOUT_MS 20 // per UART line, and for each CAN frame
 
 /* Variables ------------------------------------------------------------------*/
 extern uint8_t UART1_rxBuffer[1];
 
 /* Function prototypes ------------------------------------------------------------------*/
 int debug_key(void);
+#ifdef PROFILING_ENABLE
+void debug_profile_dump(void); // Sends the profiling table over UART1 and CAN, blocks until it is sent
+#endif
 
 #endif /* INC_OPRT_H_ */
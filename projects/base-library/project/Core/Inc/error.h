@@ -3,21 +3,36 @@
  *
  *  Description: Provides declarations for variables and function prototypes related to error handling.
  *
+ *  Errors are reported with REPORT_ERR() from anywhere, interrupts included. The report is only counted and queued
+ *  in the shared error log (errlog.h), the main loop then sends the queued entries in batches with error_flush():
+ *  one CAN frame per entry as long as the CAN transmit FIFO has room, and the same entries as text lines over UART1
+ *  in a single interrupt driven transfer. A burst of the same error is rate limited by the log, the extra reports
+ *  only show up in the counters and in the summary frame.
+ *
  *  Created on: Mar 30, 2024
  *  Author: Moiz
  */
-#include <cstdint>
 
 #ifndef INC_ERROR_H_
 #define INC_ERROR_H_
 
-#define ERROR_LOG_SIZE 10
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include <stdint.h>
+#include "errlog.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define ERROR_CAN_ID 0x7E0 // one frame per entry, see errlog_pack_can()
+#define ERROR_CAN_SUMMARY_ID 0x7E1 // totals, see errlog_pack_summary()
+#define ERROR_FLUSH_PERIOD_MS 100
+#define ERROR_UART_LINES 8 // lines per UART transfer
 
 typedef enum
 {
-	ERR_LOW,
-	ERR_MID,
-	ERR_HIGH
+	ERR_LOW = ERRLOG_LOW,
+	ERR_MID = ERRLOG_MID,
+	ERR_HIGH = ERRLOG_HIGH,
+	ERR_FATAL = ERRLOG_FATAL
 }errlevel;
 
 typedef enum
@@ -26,27 +41,27 @@ typedef enum
 	FAST_BLINK,
 }ledpattern;
 
-typedef enum
-{
-	OK,
-	ERROR
-} errcode;
-
-// TODO: Move both of these definitions to source code later otherwise the compiler will complain (multiple definitions)
-errcode errlog[ERROR_LOG_SIZE];
-uint8_t index;
-
+typedef uint16_t errcode;
 
+/* Error codes of the base library, the driver modules define theirs next to their code */
+#define ERR_NONE ERRLOG_NONE
+#define ERR_CAN_TX_FULL ERRLOG_CODE(ERRLOG_MODULE_CAN, 1, ERR_LOW)
+#define ERR_CAN_START ERRLOG_CODE(ERRLOG_MODULE_CAN, 2, ERR_FATAL)
+#define ERR_VEML3328_READ ERRLOG_CODE(ERRLOG_MODULE_VEML3328, 1, ERR_MID)
+#define ERR_VEML3328_ID ERRLOG_CODE(ERRLOG_MODULE_VEML3328, 2, ERR_HIGH)
+#define ERR_VEML3328_WRITE ERRLOG_CODE(ERRLOG_MODULE_VEML3328, 3, ERR_MID)
+#define ERR_WATCHDOG_RESET ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 1, ERR_HIGH) // detail: task that missed its deadline, 0xFF if none did
+#define ERR_WATCHDOG_LATE ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 2, ERR_HIGH) // detail: ms since its last check-in
+#define ERR_CRASH ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 3, ERR_HIGH) // detail: crashes since power-on, the record is in fault.h
+#define ERR_HEAP_RUNTIME ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 4, ERR_MID) // detail: allocator calls after initialisation, see sysmem.h
 
-//-- Internal functions
-static void reportError(errcode err_code, errlevel err_level); // Sending all accumulated error codes through UART and/or through CAN
-static void logError(errcode err_code); // Add error to error logs. Can be stored in memory
-static void ledIndicationError(ledpattern pattern);
-static void I2C_ErrorResetCycle(I2C_HandleTypeDef handle, uint16_t device_address, uint8_t register_address, int read_regs);
+/* Function prototypes ------------------------------------------------------------------*/
+#define REPORT_ERR(err_code, detail) (errlog_report((err_code), (detail)))
 
-//-- Public Functions
-#define REPORT_ERR(err_code, err_level) (reportError(err_code, err_level))
+void error_init(void); // Clears the log, timestamps come from HAL_GetTick()
+void error_flush(void); // Sends the queued errors over CAN and UART, call it from the main loop
 errcode getLatestError(void);
 void clearAllErrors(void);
+ledpattern error_led_pattern(void); // FAST_BLINK once a high or fatal error was reported
 
 #endif /* INC_ERROR_H_ */
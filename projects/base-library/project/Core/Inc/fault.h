@@ -0,0 +1,34 @@
+/*
+ *  fault.h
+ *
+ *  Description: Provides the fault handlers and the report of the last crash.
+ *
+ *  A HardFault, MemManage, BusFault or UsageFault saves the stacked registers, the fault status registers and the
+ *  top of the stack in a no-init RAM section (crashlog.h) and resets the board. fault_init() then sends the record
+ *  as "CRASH" lines over UART1 and one CAN frame per word, decode them with projects/shared/crashlog/crash_decode.py
+ *  and the ELF of the build that crashed.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+#ifndef INC_FAULT_H_
+#define INC_FAULT_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "crashlog.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define FAULT_CAN_ID 0x7E2 // one word of the record per frame, see crashlog_packCan()
+#define FAULT_UART_TIMEOUT_MS 20 // per line
+#define FAULT_CAN_TIMEOUT_MS 50 // for all the frames
+
+/* Function prototypes ------------------------------------------------------------------*/
+void fault_init(void); // Reports the crash of the previous run if there was one, call after can_init()
+void HardFault_Handler(void);
+void MemManage_Handler(void);
+void BusFault_Handler(void);
+void UsageFault_Handler(void);
+
+#endif /* INC_FAULT_H_ */
@@ -0,0 +1,39 @@
+/*
+ *  idle.h
+ *
+ *  Description: Provides the idle wait of the main loop, the CPU load and the low power states.
+ *
+ *  idle_wait() replaces the busy wait of HAL_Delay(): the core sleeps until the next interrupt and the time it spent
+ *  asleep is counted as idle (cpuload.h), so the load of each second and the residency of each power state can be
+ *  reported on CAN. When the wait is long enough and no peripheral needs its clock (no UART or I2C transfer, no
+ *  frame waiting for the bus, no PWM or ADC running), the board goes to Stop2 instead: SysTick stops, LPTIM1 on
+ *  the LSI wakes the core at the end of the wait and the HAL tick is advanced by the time spent in Stop2, so
+ *  HAL_GetTick() stays on time. The part of a tick left over is carried to the next Stop2 instead of rounded off.
+ *
+ *  The stack and heap use of sysmem.h go out with the load, once per second.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+#ifndef INC_IDLE_H_
+#define INC_IDLE_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "cpuload.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define IDLE_CAN_ID 0x7E4 // once per second, see cpuload_packCan()
+#define IDLE_WINDOW_US 1000000
+#define IDLE_LPTIM_HZ 32000 // LSI, no prescaler
+#define IDLE_STOP2_MIN_MS 2 // shorter waits use Sleep, leaving Stop2 restarts the PLL
+#define IDLE_STOP2_MAX_MS 100 // SysTick refreshes the watchdog, stay well below WATCHDOG_TIMEOUT_MS
+
+/* Function prototypes ------------------------------------------------------------------*/
+void idle_init(void); // Starts LPTIM1 and the load measurement
+void idle_wait(uint32_t ms); // Sleeps until ms have passed, then sends the report of a second that ended
+uint16_t idle_load(void); // Load of the last second, in CPULOAD_SCALE
+void idle_irq(void); // Call from LPTIM1_IRQHandler()
+
+#endif /* INC_IDLE_H_ */
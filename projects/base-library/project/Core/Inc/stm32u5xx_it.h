@@ -47,10 +47,6 @@
 
 /* Exported functions prototypes ---------------------------------------------*/
 void NMI_Handler(void);
-void HardFault_Handler(void);
-void MemManage_Handler(void);
-void BusFault_Handler(void);
-void UsageFault_Handler(void);
 void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
@@ -58,9 +54,11 @@ void SysTick_Handler(void);
 void GPDMA1_Channel1_IRQHandler(void);
 void GPDMA1_Channel4_IRQHandler(void);
 void ADC1_IRQHandler(void);
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
 void USART1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
-
+void LPTIM1_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
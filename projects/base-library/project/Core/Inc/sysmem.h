@@ -0,0 +1,41 @@
+/*
+ *  sysmem.h
+ *
+ *  Description: Provides the stack and heap usage of the board and the check that nothing allocates after
+ *  initialisation.
+ *
+ *  sysmem_paint_stack() paints the SYSMEM_PAINT_BYTES at the top of RAM (memstats.h), the stack high-water mark is
+ *  then found by looking for the lowest word that lost the pattern. _sbrk() keeps the highest heap break and the
+ *  allocator lock hooks of newlib count every malloc(), free() and realloc() made after sysmem_heap_lock(): in
+ *  SYSMEM_HEAP_REPORT mode each of them is reported to the error log, in SYSMEM_HEAP_FAULT mode the first one stops
+ *  on a fault so that the crash record (fault.h) gives the code that allocated.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+#ifndef INC_SYSMEM_H_
+#define INC_SYSMEM_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "memstats.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define SYSMEM_CAN_ID 0x7E5 // MEMSTATS_CAN_FRAMES frames, see memstats_packCan()
+#define SYSMEM_PAINT_BYTES 0x4000 // 16 times _Min_Stack_Size, the high-water mark saturates there
+#define SYSMEM_PAINT_MARGIN 64 // left below the frame of sysmem_paint_stack()
+
+typedef enum
+{
+	SYSMEM_HEAP_OPEN, // allocations allowed, during initialisation
+	SYSMEM_HEAP_REPORT, // allocations counted and reported with ERR_HEAP_RUNTIME
+	SYSMEM_HEAP_FAULT // the first allocation faults
+}sysmem_heap_mode;
+
+/* Function prototypes ------------------------------------------------------------------*/
+void sysmem_paint_stack(void); // Call first in main(), before any interrupt is enabled
+void sysmem_heap_lock(sysmem_heap_mode mode); // Call at the end of initialisation
+void sysmem_stats(MEMSTATS* stats); // Scans the painted stack and reads the allocator, from the main loop only
+
+#endif /* INC_SYSMEM_H_ */
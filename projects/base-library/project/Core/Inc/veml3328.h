@@ -10,11 +10,28 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "board.h"
+#include "regmap_i2c.h"
 
 /* Variables ------------------------------------------------------------------*/
-/*Data variables*/
-extern HAL_StatusTypeDef r,g,b;
-extern uint16_t conf, r_data, g_data, b_data;
+/* Driver state, the counts are written by the I2C interrupt */
+typedef struct {
+  REGMAP_I2C bus;
+  uint16_t c, r, g, b, ir;  // counts of the last reading
+  uint32_t lux;             // green channel in millilux, normalized by the range of the reading
+  uint32_t baseline;        // running ambient green channel in millilux, exponential average
+  uint32_t samples;         // completed readings
+  uint32_t errors;          // failed transfers
+  uint32_t next_read;       // HAL tick of the next integration time boundary
+  uint16_t it_ms;           // integration time of the current range
+  uint8_t range;            // range of the configuration in the sensor, 0 is the least sensitive
+  uint8_t target_range;     // range to write at the next poll
+  uint8_t auto_range;       // adjust the range from the headroom of each reading
+  uint8_t present;          // device ID checked
+  volatile uint8_t fresh;   // a reading completed since veml3328_new_sample()
+  volatile uint8_t failed;  // a transfer failed, the bus is checked before the next reading
+} veml3328_state;
+
+extern veml3328_state veml3328;
 
 /* Registers */
 #define veml3328_addr           0x10
@@ -26,7 +43,49 @@ extern uint16_t conf, r_data, g_data, b_data;
 #define B_                      0x07
 #define IR_                     0x08
 
-/* Sensor resolutions */
+/* Register map indices (veml3328_regmap) */
+typedef enum {
+  veml3328_reg_conf,
+  veml3328_reg_c,
+  veml3328_reg_r,
+  veml3328_reg_g,
+  veml3328_reg_b,
+  veml3328_reg_ir,
+  veml3328_reg_id,
+  veml3328_reg_count
+} veml3328_reg;
+
+/* Command code registers are 16 bit little endian and do not auto-increment, so each is its own transaction */
+extern const REGMAP_DEVICE veml3328_regmap;
+
+/* Ambient baseline: exponential average over 2^shift readings (32 readings = 1.6 s at 50 ms) */
+#define veml3328_baseline_shift 5
+#define veml3328_baseline_band  1920 // mlx above/below the baseline that count as a change (5 counts at the default range)
+#define veml3328_recovery_ms    1000 // wait before checking the bus again when the I2C recovery failed
+
+/* Configuration register fields */
+#define veml3328_conf_sd1_pos   15
+#define veml3328_conf_sd_als_pos 14
+#define veml3328_conf_dg_pos    12
+#define veml3328_conf_gain_pos  10
+#define veml3328_conf_sens_pos  6
+#define veml3328_conf_it_pos    4
+#define veml3328_conf_af_pos    3
+#define veml3328_conf_trig_pos  2
+#define veml3328_conf_sd0_pos   0
+
+/* Auto-ranging: 9 ranges one resolution step (res9 to res1) apart. A reading whose largest channel is at or above
+ * the high threshold moves to a less sensitive range, one below the low threshold to a more sensitive range. The
+ * low threshold is under half of the high one, so a reading moved by one range cannot cross back. */
+#define veml3328_range_count    9
+#define veml3328_range_default  1     // IT 50 ms, gain x1, DG x1 (configuration 0000)
+#define veml3328_range_high     52428 // 80% of full scale
+#define veml3328_range_low      16384 // 25% of full scale
+
+/* Converts a resolution in lux per count to micro-lux per count at compile time */
+#define veml3328_ulx(res) ((uint32_t)((res) * 1000000 + 0.5))
+
+/* Sensor resolutions, lux per count of the green channel (res8 is IT 50 ms, gain x1, DG x1) */
 #define res1 0.003
 #define res2 0.006
 #define res3 0.012
@@ -34,7 +93,7 @@ extern uint16_t conf, r_data, g_data, b_data;
 #define res5 0.048
 #define res6 0.096
 #define res7 0.192
-#define res8 0.328
+#define res8 0.384
 #define res9 0.768
 
 /* Command codes for registers */
@@ -90,9 +149,17 @@ typedef enum {
 
 /* Function prototypes ------------------------------------------------------------------*/
 HAL_StatusTypeDef veml3328_init(void);
-void veml3328_rd_rgb(void);
-uint16_t veml3328_avg_amb(void);
-int veml3328_run(uint16_t amb);
+void veml3328_poll(void);
+uint8_t veml3328_new_sample(void);
+uint32_t veml3328_lux(void);
+uint32_t veml3328_ambient(void);
+int veml3328_run(void);
+void veml3328_set_auto_range(uint8_t enable);
+void veml3328_set_range(uint8_t range);
+uint8_t veml3328_next_range(uint8_t range, uint16_t peak);
+uint16_t veml3328_range_conf(uint8_t range);
+uint16_t veml3328_range_it_ms(uint8_t range);
+uint32_t veml3328_range_res_ulx(uint8_t range);
 
 #endif /* INC_VEML3328_H_ */
 
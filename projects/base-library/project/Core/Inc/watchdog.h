@@ -0,0 +1,32 @@
+/*
+ *  watchdog.h
+ *
+ *  Description: Provides the independent watchdog and the supervision of the tasks that keep it refreshed.
+ *
+ *  The watchdog is only refreshed from the SysTick interrupt while every registered task checked in within its
+ *  deadline (supervisor.h), so a main loop stuck in a blocking HAL call resets the board instead of freezing the
+ *  actuators. The task that missed its deadline is kept in a no-init RAM section and reported to the error log at
+ *  the next boot.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+#ifndef INC_WATCHDOG_H_
+#define INC_WATCHDOG_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "supervisor.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define WATCHDOG_TIMEOUT_MS 500 // LSI (32 kHz) / 32, at most 4096
+#define WATCHDOG_POLL_MS 10
+
+/* Function prototypes ------------------------------------------------------------------*/
+void watchdog_init(void); // Reports the previous watchdog reset and starts the watchdog, call after error_init()
+uint8_t watchdog_add_task(uint32_t deadline_ms); // Returns the task number to check in with
+void watchdog_check_in(uint8_t task); // Safe from interrupts
+void watchdog_tick(void); // Call from SysTick_Handler()
+
+#endif /* INC_WATCHDOG_H_ */
@@ -9,6 +9,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "board.h"
+#include "veml3328.h"
 
 /* Variables ------------------------------------------------------------------*/
 ADC_HandleTypeDef hadc1;
@@ -30,6 +31,10 @@ UART_HandleTypeDef huart1;
 UART_HandleTypeDef huart2;
 HAL_StatusTypeDef status;
 
+/* Recovery ladder of I2C1 (PB8 SCL, PB9 SDA) */
+static I2C_RECOVERY_HAL i2c1_bus = {&hi2c1, GPIOB, GPIO_PIN_8, GPIOB, GPIO_PIN_9, 10};
+I2C_RECOVERY i2c1_recovery;
+
 /* Functions ------------------------------------------------------------------*/
 /* Print */
 int _write(int file, char *ptr, int len)
@@ -104,6 +109,26 @@ HAL_StatusTypeDef i2c_wr(I2C_HandleTypeDef handle, uint8_t device_address, uint8
 	return status;
 }
 
+void i2c1_recovery_init(void) {
+	i2c_recovery_hal_init(&i2c1_recovery, &i2c1_bus, NULL);
+}
+
+/* I2C callbacks, forwarded to the asynchronous drivers */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	regmap_i2c_handleRxCplt(&veml3328.bus, hi2c);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	regmap_i2c_handleTxCplt(&veml3328.bus, hi2c);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	regmap_i2c_handleError(&veml3328.bus, hi2c);
+}
+
 /* USART */
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
@@ -8,7 +8,43 @@
  */
 
 /* Includes ------------------------------------------------------------------*/
+#include "can.h"
+#include "error.h"
 
 /* Variables ------------------------------------------------------------------*/
 
 /* Functions ------------------------------------------------------------------*/
+HAL_StatusTypeDef can_init(void){
+	HAL_StatusTypeDef result = HAL_FDCAN_Start(&hfdcan1);
+	if (result != HAL_OK) REPORT_ERR(ERR_CAN_START, result);
+	return result;
+}
+
+uint32_t can_tx_free(void){
+	return HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan1);
+}
+
+uint8_t can_tx_pending(void){
+	return hfdcan1.Instance->TXBRP != 0;
+}
+
+HAL_StatusTypeDef can_tx(uint16_t id, const uint8_t* data, uint8_t length){
+	if (length > 8) return HAL_ERROR;
+	if (can_tx_free() == 0) {
+		REPORT_ERR(ERR_CAN_TX_FULL, id);
+		return HAL_BUSY;
+	}
+
+	FDCAN_TxHeaderTypeDef header = {
+		.Identifier = id,
+		.IdType = FDCAN_STANDARD_ID,
+		.TxFrameType = FDCAN_DATA_FRAME,
+		.DataLength = (uint32_t)length << 16, // FDCAN_DLC_BYTES_0 to FDCAN_DLC_BYTES_8
+		.ErrorStateIndicator = FDCAN_ESI_ACTIVE,
+		.BitRateSwitch = FDCAN_BRS_OFF,
+		.FDFormat = FDCAN_CLASSIC_CAN,
+		.TxEventFifoControl = FDCAN_NO_TX_EVENTS,
+		.MessageMarker = 0
+	};
+	return HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan1, &header, (uint8_t*)data);
+}
@@ -9,6 +9,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "debug.h"
+#include "can.h"
 
 /* Variables ------------------------------------------------------------------*/
 uint8_t UART1_rxBuffer[1] = {0};
@@ -26,3 +27,50 @@ int debug_key(void){
 
 	return *UART1_rxBuffer;
 }
+
+#ifdef PROFILING_ENABLE
+// Waits for a free CAN transmit slot, then sends one profiling frame
+static HAL_StatusTypeDef debug_profile_send(uint8_t* data){
+	uint32_t start = HAL_GetTick();
+	while (can_tx_free() == 0 && HAL_GetTick() - start < DEBUG_PROFILE_TIMEOUT_MS);
+	return can_tx(DEBUG_PROFILE_CAN_ID, data, PROFILING_CAN_PAYLOAD_SIZE);
+}
+
+// Waits for the UART1 transfer in progress (a batch of error reports from error_flush()) to end, then sends one line
+static HAL_StatusTypeDef debug_profile_print(char* line, uint16_t length){
+	uint32_t start = HAL_GetTick();
+	while (huart1.gState != HAL_UART_STATE_READY && HAL_GetTick() - start < DEBUG_PROFILE_TIMEOUT_MS);
+	return HAL_UART_Transmit(&huart1, (uint8_t*)line, length, DEBUG_PROFILE_TIMEOUT_MS);
+}
+
+/* Profiling dump:
+ * Text lines on UART1 (see profiling_formatLine() and profiling_irqFormatLine()), then the statistics of each probe,
+ * of each interrupt and the deepest nesting on DEBUG_PROFILE_CAN_ID.
+ */
+void debug_profile_dump(void){
+	char line[PROFILING_LINE_SIZE];
+	uint16_t length;
+	for (uint16_t i = 0; (length = profiling_formatLine(i, line)) > 0; i++) {
+		debug_profile_print(line, length);
+	}
+	for (uint16_t i = 0; (length = profiling_irqFormatLine(i, line)) > 0; i++) {
+		debug_profile_print(line, length);
+	}
+
+	uint8_t data[PROFILING_CAN_PAYLOAD_SIZE];
+	for (uint8_t probe = 0; probe < PROFILING_PROBE_COUNT; probe++) {
+		for (uint8_t frame = 0; frame < PROFILING_CAN_FRAMES; frame++) {
+			profiling_packCan(probe, frame, data);
+			if (debug_profile_send(data) != HAL_OK) return;
+		}
+	}
+	for (uint8_t irq = 0; irq < PROFILING_IRQ_COUNT; irq++) {
+		for (uint8_t frame = 0; frame < PROFILING_IRQ_CAN_FRAMES; frame++) {
+			profiling_irqPackCan(irq, frame, data);
+			if (debug_profile_send(data) != HAL_OK) return;
+		}
+	}
+	profiling_irqPackNesting(data);
+	debug_profile_send(data);
+}
+#endif
@@ -1,7 +1,8 @@
 /*
- *  error.h
+ *  error.c
  *
- *  Description: Provides declarations for variables and function prototypes related to error handling.
+ *  Description: Provides the board side of error handling: timestamps for the error log and the batched reporting
+ *  of its entries over CAN and UART.
  *
  *  Created on: Mar 30, 2024
  *  Author: Moiz
@@ -10,19 +11,72 @@
 /* Includes ------------------------------------------------------------------*/
 #include "error.h"
 #include "board.h"
+#include "can.h"
 
 /* Variables ------------------------------------------------------------------*/
+static uint32_t error_last_flush;
+static uint32_t error_sent_suppressed;
+static uint32_t error_sent_dropped;
+static char error_uart_buffer[ERROR_UART_LINES * ERRLOG_LINE_SIZE]; // in use until the UART transfer completes
 
 /* Functions ------------------------------------------------------------------*/
-static void I2C_ErrorResetCycle (I2C_HandleTypeDef handle, uint16_t device_address, uint8_t register_address, int read_regs)  {
-    uint8_t buffer;
-    buffer[0] = register_address;
-	if (HAL_I2C_Master_Transmit(&handle, (device_address << 1), buffer, 1, HAL_MAX_DELAY) != HAL_OK) {
-		NVIC_SystemReset();
-	} else {
-        if (HAL_I2C_Master_Receive(&handle, (device_address << 1), buffer, read_regs, HAL_MAX_DELAY) != HAL_OK) {
-            NVIC_SystemReset();
-        }
-    }
-    HAL_Delay(250);
+static uint32_t error_clock(void){
+	return HAL_GetTick();
+}
+
+void error_init(void){
+	errlog_init(error_clock);
+	error_last_flush = HAL_GetTick();
+	error_sent_suppressed = 0;
+	error_sent_dropped = 0;
+}
+
+/* Sends at most ERROR_UART_LINES entries per ERROR_FLUSH_PERIOD_MS: each one in its own CAN frame while the CAN
+ * transmit FIFO has room, and all of them in one UART transfer if the previous one is done. An entry is only taken
+ * from the log when one of the two can send it, so nothing is lost while the bus is busy. */
+void error_flush(void){
+	uint32_t now = HAL_GetTick();
+	if (now - error_last_flush < ERROR_FLUSH_PERIOD_MS) return;
+	error_last_flush = now;
+
+	uint8_t data[ERRLOG_CAN_PAYLOAD_SIZE];
+	uint32_t suppressed = errlog_suppressed();
+	uint32_t dropped = errlog_dropped();
+	if ((suppressed != error_sent_suppressed || dropped != error_sent_dropped) && can_tx_free() > 0) {
+		errlog_pack_summary(data);
+		if (can_tx(ERROR_CAN_SUMMARY_ID, data, sizeof(data)) == HAL_OK) {
+			error_sent_suppressed = suppressed;
+			error_sent_dropped = dropped;
+		}
+	}
+
+	uint8_t uart_ready = huart1.gState == HAL_UART_STATE_READY;
+	uint16_t length = 0;
+	errlog_entry entry;
+	for (uint8_t lines = 0; lines < ERROR_UART_LINES; lines++) {
+		uint8_t can_ready = can_tx_free() > 0;
+		if (!(can_ready || uart_ready) || !errlog_pop(&entry)) break;
+		if (can_ready) {
+			errlog_pack_can(&entry, data);
+			can_tx(ERROR_CAN_ID, data, sizeof(data));
+		}
+		if (uart_ready) length += errlog_format(&entry, &error_uart_buffer[length]);
+	}
+	if (length > 0) HAL_UART_Transmit_IT(&huart1, (uint8_t*)error_uart_buffer, length);
+}
+
+errcode getLatestError(void){
+	return errlog_latest();
+}
+
+void clearAllErrors(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	error_init();
+	__set_PRIMASK(primask);
+}
+
+ledpattern error_led_pattern(void){
+	if (errlog_severity_count(ERRLOG_HIGH) + errlog_severity_count(ERRLOG_FATAL) > 0) return FAST_BLINK;
+	return SLOW_BLINK;
 }
@@ -0,0 +1,66 @@
+/*
+ *  fault.c
+ *
+ *  Description: Provides the fault handlers and the report of the last crash.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "fault.h"
+#include "board.h"
+#include "can.h"
+#include "error.h"
+
+/* Variables ------------------------------------------------------------------*/
+extern uint32_t _estack; // top of the stack, from the linker script
+static CRASHLOG_RECORD fault_record __attribute__((section(".noinit"))); // survives the reset
+
+/* Functions ------------------------------------------------------------------*/
+/* Called by the handlers with the stack pointer the core stacked the registers on */
+static void __attribute__((used, noreturn)) fault_capture(const uint32_t* frame, uint32_t exc_return){
+	__disable_irq();
+	CRASHLOG_FAULT fault = {.cfsr = SCB->CFSR, .hfsr = SCB->HFSR, .mmfar = SCB->MMFAR, .bfar = SCB->BFAR};
+	crashlog_capture(&fault_record, frame, exc_return, &fault, HAL_GetTick(), SRAM1_BASE, (uintptr_t)&_estack);
+	NVIC_SystemReset();
+}
+
+/* Naked so that nothing is pushed before the stack pointer is read, bit 2 of EXC_RETURN tells which one was in use */
+#define FAULT_HANDLER(name) \
+	void __attribute__((naked)) name(void){ \
+		__asm volatile( \
+			"tst lr, #4\n" \
+			"ite eq\n" \
+			"mrseq r0, msp\n" \
+			"mrsne r0, psp\n" \
+			"mov r1, lr\n" \
+			"b fault_capture\n" \
+		); \
+	}
+
+FAULT_HANDLER(HardFault_Handler)
+FAULT_HANDLER(MemManage_Handler)
+FAULT_HANDLER(BusFault_Handler)
+FAULT_HANDLER(UsageFault_Handler)
+
+void fault_init(void){
+	if (!crashlog_boot(&fault_record)) return;
+	REPORT_ERR(ERR_CRASH, fault_record.crashes > 0xFFFF ? 0xFFFF : fault_record.crashes);
+
+	char line[CRASHLOG_LINE_SIZE];
+	uint8_t length;
+	for (uint8_t i = 0; (length = crashlog_formatLine(&fault_record, i, line)) > 0; i++) {
+		HAL_UART_Transmit(&huart1, (uint8_t*)line, length, FAULT_UART_TIMEOUT_MS);
+	}
+
+	/* Waits for room in the transmit FIFO, but not forever if nobody acknowledges on the bus */
+	uint8_t data[CRASHLOG_CAN_PAYLOAD_SIZE];
+	uint32_t start = HAL_GetTick();
+	for (uint8_t i = 0; i < crashlog_words(&fault_record); i++) {
+		while (can_tx_free() == 0 && HAL_GetTick() - start < FAULT_CAN_TIMEOUT_MS);
+		crashlog_packCan(&fault_record, i, data);
+		if (can_tx(FAULT_CAN_ID, data, sizeof(data)) != HAL_OK) break;
+	}
+	crashlog_reported(&fault_record);
+}
@@ -0,0 +1,177 @@
+/*
+ *  idle.c
+ *
+ *  Description: Provides the idle wait of the main loop, the CPU load and the low power states.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "idle.h"
+#include "board.h"
+#include "can.h"
+#include "sysmem.h"
+
+/* Definitions ------------------------------------------------------------------*/
+#define IDLE_SYNC_TIMEOUT_MS 10
+
+/* Variables ------------------------------------------------------------------*/
+static CPULOAD idle_cpuload;
+static uint8_t idle_lptim_ready;
+static int32_t idle_stop2_carry_ns; // time spent in Stop2 that is not a whole tick yet, counted at the next one
+
+/* Functions ------------------------------------------------------------------*/
+/* Nanoseconds into the current HAL tick */
+static uint32_t idle_tick_phase_ns(uint32_t val){
+	uint32_t load = SysTick->LOAD;
+	return (uint32_t)((uint64_t)(load - val) * 1000000 / (load + 1));
+}
+
+/* Microseconds into the current HAL tick */
+static uint32_t idle_tick_phase_us(uint32_t val){
+	return idle_tick_phase_ns(val) / 1000;
+}
+
+/* Microseconds from the HAL tick and SysTick, also right after a wakeup when the SysTick interrupt is still pending */
+static uint32_t idle_now_us(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t tick = uwTick;
+	uint32_t val = SysTick->VAL;
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		tick += uwTickFreq;
+		val = SysTick->VAL;
+	}
+	__set_PRIMASK(primask);
+	return tick * 1000 + idle_tick_phase_us(val);
+}
+
+/* The HAL LPTIM driver is not part of the project, the registers are written directly.
+ * ARR, CCR1 and DIER are written through the LPTIM clock domain, each write must be acknowledged. */
+static void idle_lptim_sync(uint32_t flag){
+	uint32_t start = HAL_GetTick();
+	while ((LPTIM1->ISR & flag) == 0 && HAL_GetTick() - start < IDLE_SYNC_TIMEOUT_MS);
+	LPTIM1->ICR = flag;
+}
+
+static uint16_t idle_lptim_count(void){
+	uint32_t count;
+	do {
+		count = LPTIM1->CNT; // asynchronous to the core, two equal reads in a row are valid
+	} while (count != LPTIM1->CNT);
+	return (uint16_t)count;
+}
+
+static void idle_lptim_init(void){
+	RCC_OscInitTypeDef osc = {
+		.OscillatorType = RCC_OSCILLATORTYPE_LSI,
+		.LSIState = RCC_LSI_ON,
+		.LSIDiv = RCC_LSI_DIV1,
+		.PLL.PLLState = RCC_PLL_NONE
+	};
+	if (HAL_RCC_OscConfig(&osc) != HAL_OK) return;
+
+	__HAL_RCC_LPTIM1_CONFIG(RCC_LPTIM1CLKSOURCE_LSI);
+	__HAL_RCC_LPTIM1_CLK_ENABLE();
+	__HAL_RCC_LPTIM1_CLKAM_ENABLE(); // kept running in Stop2
+	LPTIM1->CFGR = 0; // kernel clock, no prescaler, software start
+	LPTIM1->CR = LPTIM_CR_ENABLE;
+	LPTIM1->DIER = LPTIM_DIER_CC1IE;
+	idle_lptim_sync(LPTIM_ISR_DIEROK);
+	LPTIM1->ARR = 0xFFFF; // free running, 2 s per turn
+	idle_lptim_sync(LPTIM_ISR_ARROK);
+	LPTIM1->CR = LPTIM_CR_ENABLE | LPTIM_CR_CNTSTRT;
+
+	HAL_NVIC_SetPriority(LPTIM1_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+	idle_lptim_ready = 1;
+}
+
+/* Stop2 stops the clocks of everything below, only enter it when none of them is in use */
+static uint8_t idle_stop2_allowed(void){
+	return idle_lptim_ready
+		&& huart1.gState == HAL_UART_STATE_READY && huart1.RxState == HAL_UART_STATE_READY
+		&& HAL_I2C_GetState(&hi2c1) == HAL_I2C_STATE_READY
+		&& !can_tx_pending()
+		&& (htim1.Instance->CR1 & TIM_CR1_CEN) == 0 && (htim3.Instance->CR1 & TIM_CR1_CEN) == 0
+		&& (HAL_ADC_GetState(&hadc1) & HAL_ADC_STATE_REG_BUSY) == 0;
+}
+
+/* Called with the interrupts masked, the wakeup interrupt runs once the clocks are back */
+static void idle_stop2(uint32_t ms){
+	if (ms > IDLE_STOP2_MAX_MS) ms = IDLE_STOP2_MAX_MS;
+	uint16_t start = idle_lptim_count();
+	LPTIM1->CCR1 = (uint16_t)(start + ms * IDLE_LPTIM_HZ / 1000);
+	idle_lptim_sync(LPTIM_ISR_CMP1OK);
+	LPTIM1->ICR = LPTIM_ICR_CC1CF;
+	NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+
+	uint32_t before_ns = idle_tick_phase_ns(SysTick->VAL);
+	HAL_SuspendTick();
+	HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+	SystemClock_Config(); // the PLL is off after Stop2, this also restarts SysTick from the start of a tick
+
+	/* The ticks SysTick missed: from the start of the tick before Stop2 to now, less the part of a tick the restarted
+	 * SysTick already counts (a whole one more if its interrupt is pending). What is left over is not thrown away but
+	 * carried to the next Stop2, so HAL_GetTick() does not drift by a rounding at every entry. */
+	int32_t elapsed_ns = (int32_t)((uint32_t)(uint16_t)(idle_lptim_count() - start) * (1000000000 / IDLE_LPTIM_HZ));
+	int32_t after_ns = (int32_t)idle_tick_phase_ns(SysTick->VAL);
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		after_ns += 1000000;
+	}
+	int32_t missed_ns = idle_stop2_carry_ns + (int32_t)before_ns + elapsed_ns - after_ns;
+	if (missed_ns < 0) {
+		missed_ns = 0; // within the LPTIM resolution
+	}
+	uwTick += (uint32_t)missed_ns / 1000000 * uwTickFreq;
+	idle_stop2_carry_ns = missed_ns % 1000000;
+}
+
+void idle_init(void){
+	idle_stop2_carry_ns = 0;
+	idle_lptim_init();
+	cpuload_init(&idle_cpuload, IDLE_WINDOW_US, idle_now_us());
+}
+
+void idle_wait(uint32_t ms){
+	uint32_t start = HAL_GetTick();
+	uint32_t elapsed;
+	while ((elapsed = HAL_GetTick() - start) < ms) {
+		/* Interrupts stay masked until the end of the idle period is read, the handler that woke the core counts as load */
+		__disable_irq();
+		CPULOAD_STATE state = CPULOAD_SLEEP;
+		uint32_t sleep_start = idle_now_us();
+		if (ms - elapsed >= IDLE_STOP2_MIN_MS && idle_stop2_allowed()) {
+			state = CPULOAD_STOP2;
+			idle_stop2(ms - elapsed);
+		}
+		else {
+			HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+		}
+		cpuload_idle(&idle_cpuload, state, sleep_start, idle_now_us());
+		__enable_irq();
+	}
+
+	/* Health frames of the second that ended: load, then stack and heap use */
+	if (cpuload_update(&idle_cpuload, idle_now_us()) > 0) {
+		uint8_t data[CPULOAD_CAN_PAYLOAD_SIZE];
+		cpuload_packCan(&idle_cpuload, data);
+		can_tx(IDLE_CAN_ID, data, sizeof(data));
+
+		MEMSTATS memory;
+		sysmem_stats(&memory);
+		for (uint8_t frame = 0; frame < MEMSTATS_CAN_FRAMES; frame++) {
+			memstats_packCan(&memory, frame, data);
+			if (can_tx(SYSMEM_CAN_ID, data, MEMSTATS_CAN_PAYLOAD_SIZE) != HAL_OK) break;
+		}
+	}
+}
+
+uint16_t idle_load(void){
+	return cpuload_load(&idle_cpuload);
+}
+
+void idle_irq(void){
+	LPTIM1->ICR = LPTIM_ICR_CC1CF;
+}
@@ -20,6 +20,12 @@
 #include "board.h"
 #include "veml3328.h"
 #include "debug.h"
+#include "can.h"
+#include "error.h"
+#include "watchdog.h"
+#include "fault.h"
+#include "idle.h"
+#include "sysmem.h"
 #include "utest.h"
 
 
@@ -80,6 +86,7 @@ static void MX_I2C4_Init(void);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  sysmem_paint_stack();
 
   /* USER CODE END 1 */
 
@@ -121,14 +128,29 @@ int main(void)
   #endif
 
   int key = 0;
-  uint16_t amb;
 
+  error_init();
+  watchdog_init();
+  can_init();
+  fault_init();
+  #ifdef PROFILING_ENABLE
+  	  profiling_init();
+  #endif
+  idle_init();
+  i2c1_recovery_init();
   veml3328_init();
   pwm1_init_ch1(5);
   pwm3_init_ch1(5);
-  amb = veml3328_avg_amb();
+
+  /* Supervised tasks: the loop itself, and sensor acquisition (a reading or a failed transfer counts as progress) */
+  uint8_t loop_task = watchdog_add_task(250);
+  uint8_t sensor_task = watchdog_add_task(2500);
+  uint32_t sensor_progress = 0;
+  /* Everything is allocated, the control loop must not touch the heap */
+  sysmem_heap_lock(SYSMEM_HEAP_REPORT);
 
   while(1){
+	  watchdog_check_in(loop_task);
 
 	  /* GPIO */
 	  key = debug_key();
@@ -138,11 +160,25 @@ int main(void)
 	  /* Keyboard Mapping */
 	  if (key == 97) pwm3_set_ch1(100); // a = 97
 	  if (key == 98) pwm3_set_ch1(5); // b = 98
+  #ifdef PROFILING_ENABLE
+	  if (key == 112) { // p = 112, once per key press
+		  UART1_rxBuffer[0] = 0;
+		  debug_profile_dump();
+	  }
+  #endif
 
 	  /* I2C Sensor */
-	  pwm1_set_ch1(veml3328_run(amb));
+	  pwm1_set_ch1(veml3328_run());
+	  if (veml3328.samples + veml3328.errors != sensor_progress) {
+		  sensor_progress = veml3328.samples + veml3328.errors;
+		  watchdog_check_in(sensor_task);
+	  }
+
+	  /* Errors */
+	  error_flush();
 
-	  delay(5);
+	  /* Idle until the next pass, the load is sent once per second */
+	  idle_wait(5);
   }
 
   /* USER CODE END 3 */
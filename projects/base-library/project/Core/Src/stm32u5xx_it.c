@@ -22,6 +22,9 @@
 #include "stm32u5xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "watchdog.h"
+#include "profiling_irq.h"
+#include "idle.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -62,6 +65,7 @@ extern DMA_HandleTypeDef handle_GPDMA1_Channel4;
 extern DMA_NodeTypeDef Node_GPDMA1_Channel1;
 extern DMA_QListTypeDef List_GPDMA1_Channel1;
 extern DMA_HandleTypeDef handle_GPDMA1_Channel1;
+extern I2C_HandleTypeDef hi2c1;
 extern UART_HandleTypeDef huart1;
 /* USER CODE BEGIN EV */
 
@@ -85,66 +89,6 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Memory management fault.
-  */
-void MemManage_Handler(void)
-{
-  /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
-  /* USER CODE END MemoryManagement_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_MemoryManagement_IRQn 0 */
-    /* USER CODE END W1_MemoryManagement_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Prefetch fault, memory access fault.
-  */
-void BusFault_Handler(void)
-{
-  /* USER CODE BEGIN BusFault_IRQn 0 */
-
-  /* USER CODE END BusFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
-    /* USER CODE END W1_BusFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Undefined instruction or illegal state.
-  */
-void UsageFault_Handler(void)
-{
-  /* USER CODE BEGIN UsageFault_IRQn 0 */
-
-  /* USER CODE END UsageFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_UsageFault_IRQn 0 */
-    /* USER CODE END W1_UsageFault_IRQn 0 */
-  }
-}
-
 /**
   * @brief This function handles System service call via SWI instruction.
   */
@@ -190,11 +134,12 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  PROFILING_IRQ_ENTER(SYSTICK);
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-
+  watchdog_tick();
+  PROFILING_IRQ_EXIT(SYSTICK);
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -211,11 +156,11 @@ void SysTick_Handler(void)
 void GPDMA1_Channel1_IRQHandler(void)
 {
   /* USER CODE BEGIN GPDMA1_Channel1_IRQn 0 */
-
+  PROFILING_IRQ_ENTER(GPDMA1_CH1);
   /* USER CODE END GPDMA1_Channel1_IRQn 0 */
   HAL_DMA_IRQHandler(&handle_GPDMA1_Channel1);
   /* USER CODE BEGIN GPDMA1_Channel1_IRQn 1 */
-
+  PROFILING_IRQ_EXIT(GPDMA1_CH1);
   /* USER CODE END GPDMA1_Channel1_IRQn 1 */
 }
 
@@ -225,11 +170,11 @@ void GPDMA1_Channel1_IRQHandler(void)
 void GPDMA1_Channel4_IRQHandler(void)
 {
   /* USER CODE BEGIN GPDMA1_Channel4_IRQn 0 */
-
+  PROFILING_IRQ_ENTER(GPDMA1_CH4);
   /* USER CODE END GPDMA1_Channel4_IRQn 0 */
   HAL_DMA_IRQHandler(&handle_GPDMA1_Channel4);
   /* USER CODE BEGIN GPDMA1_Channel4_IRQn 1 */
-
+  PROFILING_IRQ_EXIT(GPDMA1_CH4);
   /* USER CODE END GPDMA1_Channel4_IRQn 1 */
 }
 
@@ -239,28 +184,64 @@ void GPDMA1_Channel4_IRQHandler(void)
 void ADC1_IRQHandler(void)
 {
   /* USER CODE BEGIN ADC1_IRQn 0 */
-
+  PROFILING_IRQ_ENTER(ADC1);
   /* USER CODE END ADC1_IRQn 0 */
   HAL_ADC_IRQHandler(&hadc1);
   /* USER CODE BEGIN ADC1_IRQn 1 */
-
+  PROFILING_IRQ_EXIT(ADC1);
   /* USER CODE END ADC1_IRQn 1 */
 }
 
+/**
+  * @brief This function handles I2C1 Event interrupt / I2C1 wake-up interrupt through EXTI line 23.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+  PROFILING_IRQ_ENTER(I2C1_EV);
+  /* USER CODE END I2C1_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_EV_IRQn 1 */
+  PROFILING_IRQ_EXIT(I2C1_EV);
+  /* USER CODE END I2C1_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C1 Error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_ER_IRQn 0 */
+  PROFILING_IRQ_ENTER(I2C1_ER);
+  /* USER CODE END I2C1_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_ER_IRQn 1 */
+  PROFILING_IRQ_EXIT(I2C1_ER);
+  /* USER CODE END I2C1_ER_IRQn 1 */
+}
+
 /**
   * @brief This function handles USART1 global interrupt.
   */
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
-
+  PROFILING_IRQ_ENTER(USART1);
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
-
+  PROFILING_IRQ_EXIT(USART1);
   /* USER CODE END USART1_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
-
+/**
+  * @brief This function handles LPTIM1 global interrupt, the wakeup from Stop2 (idle.c).
+  */
+void LPTIM1_IRQHandler(void)
+{
+  PROFILING_IRQ_ENTER(LPTIM1);
+  idle_irq();
+  PROFILING_IRQ_EXIT(LPTIM1);
+}
 /* USER CODE END 1 */
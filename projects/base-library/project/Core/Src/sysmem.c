@@ -23,12 +23,39 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include <malloc.h>
+#include "sysmem.h"
+#include "error.h"
+
+/* Symbols defined in the linker script */
+extern uint8_t _end;
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+extern uint32_t _Min_Heap_Size;
 
 /**
  * Pointer to the current high watermark of the heap usage
  */
 static uint8_t *__sbrk_heap_end = NULL;
 
+/**
+ * Highest heap end given by _sbrk(), freed memory is not given back
+ */
+static uint8_t *sysmem_heap_peak = NULL;
+
+/**
+ * Painted zone of the stack, NULL until sysmem_paint_stack()
+ */
+static uint32_t *sysmem_paint_low = NULL;
+static uint32_t *sysmem_paint_high = NULL;
+
+/**
+ * Allocator calls after sysmem_heap_lock(), not counted while sysmem_stats() reads the allocator
+ */
+static volatile sysmem_heap_mode sysmem_mode = SYSMEM_HEAP_OPEN;
+static volatile uint32_t sysmem_runtime_calls = 0;
+static volatile uint8_t sysmem_reading = 0;
+
 /**
  * @brief _sbrk() allocates memory to the newlib heap and is used by malloc
  *        and others from the C library
@@ -52,9 +79,6 @@ static uint8_t *__sbrk_heap_end = NULL;
  */
 void *_sbrk(ptrdiff_t incr)
 {
-  extern uint8_t _end; /* Symbol defined in the linker script */
-  extern uint8_t _estack; /* Symbol defined in the linker script */
-  extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
   const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
   const uint8_t *max_heap = (uint8_t *)stack_limit;
   uint8_t *prev_heap_end;
@@ -74,6 +98,98 @@ void *_sbrk(ptrdiff_t incr)
 
   prev_heap_end = __sbrk_heap_end;
   __sbrk_heap_end += incr;
+  if (__sbrk_heap_end > sysmem_heap_peak)
+  {
+    sysmem_heap_peak = __sbrk_heap_end;
+  }
 
   return (void *)prev_heap_end;
 }
+
+/**
+ * @brief Paints the top SYSMEM_PAINT_BYTES of RAM below the frame of the caller
+ *        with MEMSTATS_PAINT, for the high-water mark of sysmem_stats()
+ */
+void sysmem_paint_stack(void)
+{
+  uint32_t *high = (uint32_t *)((__get_MSP() - SYSMEM_PAINT_MARGIN) & ~3u);
+  uint32_t *low = (uint32_t *)(&_estack - SYSMEM_PAINT_BYTES);
+
+  if ((uint8_t *)low < &_end)
+  {
+    low = (uint32_t *)(((uint32_t)&_end + 3u) & ~3u);
+  }
+
+  __disable_irq();
+  memstats_paint(low, high);
+  sysmem_paint_low = low;
+  sysmem_paint_high = high;
+  __enable_irq();
+}
+
+/**
+ * @brief Ends the initialisation: from now on every allocator call is counted,
+ *        and reported or faulted depending on the mode
+ */
+void sysmem_heap_lock(sysmem_heap_mode mode)
+{
+  sysmem_mode = mode;
+}
+
+void sysmem_stats(MEMSTATS *stats)
+{
+  uint8_t *heap_end = (__sbrk_heap_end != NULL) ? __sbrk_heap_end : &_end;
+  uint8_t *heap_peak = (sysmem_heap_peak != NULL) ? sysmem_heap_peak : &_end;
+  uint8_t *deepest = &_estack;
+  *stats = (MEMSTATS){0};
+
+  if (sysmem_paint_low != NULL)
+  {
+    /* The heap may have grown into the bottom of the painted zone */
+    uint32_t *low = sysmem_paint_low;
+    if ((uint8_t *)low < heap_end)
+    {
+      low = (uint32_t *)(((uint32_t)heap_end + 3u) & ~3u);
+    }
+    deepest = (uint8_t *)(low + memstats_untouched(low, sysmem_paint_high));
+    stats->stackPainted = &_estack - (uint8_t *)sysmem_paint_low;
+  }
+  stats->stackPeak = &_estack - deepest;
+  stats->stackReserve = (uint32_t)&_Min_Stack_Size;
+  stats->gap = (deepest > heap_peak) ? deepest - heap_peak : 0;
+
+  /* mallinfo() takes the allocator lock, it must not count as an allocation */
+  sysmem_reading = 1;
+  struct mallinfo info = mallinfo();
+  sysmem_reading = 0;
+  stats->heapPeak = heap_peak - &_end;
+  stats->heapReserve = (uint32_t)&_Min_Heap_Size;
+  stats->heapArena = info.arena;
+  stats->heapInUse = info.uordblks;
+  stats->runtimeCalls = sysmem_runtime_calls;
+  stats->locked = sysmem_mode != SYSMEM_HEAP_OPEN;
+}
+
+/**
+ * @brief Taken by newlib around every malloc(), free() and realloc(), the
+ *        board has no threads to protect the heap from, it only counts them
+ */
+void __malloc_lock(struct _reent *r)
+{
+  (void)r;
+  if (sysmem_mode == SYSMEM_HEAP_OPEN || sysmem_reading)
+  {
+    return;
+  }
+  sysmem_runtime_calls++;
+  if (sysmem_mode == SYSMEM_HEAP_FAULT)
+  {
+    __builtin_trap(); /* UsageFault, the crash record holds the caller */
+  }
+  REPORT_ERR(ERR_HEAP_RUNTIME, sysmem_runtime_calls > 0xFFFF ? 0xFFFF : sysmem_runtime_calls);
+}
+
+void __malloc_unlock(struct _reent *r)
+{
+  (void)r;
+}
@@ -7,67 +7,239 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "veml3328.h"
+#include "error.h"
+#include "profiling.h"
+#include <string.h>
 
 /* Variables ------------------------------------------------------------------*/
-HAL_StatusTypeDef r,g,b;
-uint16_t conf, r_data, g_data, b_data;
+veml3328_state veml3328;
+
+/* Channels read every integration time, the device ID is added until it has been checked */
+static const uint8_t veml3328_channels[] = {
+  veml3328_reg_c, veml3328_reg_r, veml3328_reg_g, veml3328_reg_b, veml3328_reg_ir, veml3328_reg_id
+};
+
+/* Ranges from the least to the most sensitive. Strong light uses the shortest integration time for the highest
+ * sample rate, the integration time is only lengthened once the analog gain is at its maximum and the digital gain
+ * (which only scales the counts) is the last resort. */
+static const struct {
+  IT it;
+  GAIN gain;
+  DG dg;
+  uint32_t res_ulx;
+} veml3328_ranges[veml3328_range_count] = {
+  {IT_50, GAINx1_2, DGx1, veml3328_ulx(res9)},
+  {IT_50, GAINx1, DGx1, veml3328_ulx(res8)},
+  {IT_50, GAINx2, DGx1, veml3328_ulx(res7)},
+  {IT_50, GAINx4, DGx1, veml3328_ulx(res6)},
+  {IT_100, GAINx4, DGx1, veml3328_ulx(res5)},
+  {IT_200, GAINx4, DGx1, veml3328_ulx(res4)},
+  {IT_400, GAINx4, DGx1, veml3328_ulx(res3)},
+  {IT_400, GAINx4, DGx2, veml3328_ulx(res2)},
+  {IT_400, GAINx4, DGx4, veml3328_ulx(res1)}
+};
+
+/* Register map */
+static const REGMAP_REGISTER veml3328_registers[veml3328_reg_count] = {
+  [veml3328_reg_conf] = {veml3328__conf, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_c] = {C_, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_r] = {R_, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_g] = {G_, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_b] = {B_, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_ir] = {IR_, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+  [veml3328_reg_id] = {veml3328_reg_deviceID, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1}
+};
+
+const REGMAP_DEVICE veml3328_regmap = {
+  .address = veml3328_addr,
+  .autoIncrement = 0,
+  .maxGap = 0,
+  .maxBlock = 2,
+  .registers = veml3328_registers,
+  .count = veml3328_reg_count
+};
 
 
 /* Functions ------------------------------------------------------------------*/
-/* veml3328 initialization*/
-HAL_StatusTypeDef veml3328_init(void) {
-
-	HAL_StatusTypeDef stat1, deviceId;
-	uint16_t regVal;
+/* Read completion, runs in the I2C interrupt */
+static void veml3328_read_done(void* context, HAL_StatusTypeDef status) {
+	if (status != HAL_OK) {
+		veml3328.errors++;
+		veml3328.failed = 1;
+		REPORT_ERR(ERR_VEML3328_READ, status);
+		return;
+	}
 
 	// Check register device ID (should be 0x28)
-	stat1 = i2c_rd(hi2c1, veml3328_addr, veml3328_reg_deviceID, &regVal);
-	if (stat1 != HAL_OK) return 0;
-
-	deviceId = (uint8_t)(regVal & 0xFF);
-	if (deviceId != 0x28) return 0;
+	if (!veml3328.present) {
+		uint16_t id = regmap_i2c_raw(&veml3328.bus, veml3328_reg_id);
+		if ((id & 0xFF) != 0x28) {
+			veml3328.errors++;
+			REPORT_ERR(ERR_VEML3328_ID, id);
+			return;
+		}
+		veml3328.present = 1;
+	}
 
-	i2c_wr(hi2c1, veml3328_addr, veml3328__conf, 0000); // 0000 is the default configuration.
+	veml3328.c = regmap_i2c_raw(&veml3328.bus, veml3328_reg_c);
+	veml3328.r = regmap_i2c_raw(&veml3328.bus, veml3328_reg_r);
+	veml3328.g = regmap_i2c_raw(&veml3328.bus, veml3328_reg_g);
+	veml3328.b = regmap_i2c_raw(&veml3328.bus, veml3328_reg_b);
+	veml3328.ir = regmap_i2c_raw(&veml3328.bus, veml3328_reg_ir);
+	veml3328.lux = (uint32_t)(((uint64_t)veml3328.g * veml3328_ranges[veml3328.range].res_ulx + 500) / 1000);
+
+	// The first reading starts the baseline so it is usable immediately. Q4 millilux, up to 65535 * 768 * 16.
+	int32_t lux = veml3328.lux << 4;
+	if (veml3328.samples == 0) veml3328.baseline = lux;
+	else veml3328.baseline += (lux - (int32_t)veml3328.baseline) >> veml3328_baseline_shift;
+
+	if (veml3328.auto_range) {
+		uint16_t peak = veml3328.c;
+		if (veml3328.r > peak) peak = veml3328.r;
+		if (veml3328.g > peak) peak = veml3328.g;
+		if (veml3328.b > peak) peak = veml3328.b;
+		if (veml3328.ir > peak) peak = veml3328.ir;
+		veml3328.target_range = veml3328_next_range(veml3328.range, peak);
+	}
 
-	return 1;
+	veml3328.samples++;
+	veml3328.fresh = 1;
 }
 
-/* veml3328 read R,G,B */
-void veml3328_rd_rgb(void){
-    r = i2c_rd(hi2c1, veml3328_addr, R_, &r_data);
-    g = i2c_rd(hi2c1, veml3328_addr, G_, &g_data);
-    b = i2c_rd(hi2c1, veml3328_addr, B_, &b_data);
+/* veml3328 initialization, does not wait for the bus */
+HAL_StatusTypeDef veml3328_init(void) {
+	memset(&veml3328, 0, sizeof(veml3328));
+	regmap_i2c_init(&veml3328.bus, &hi2c1, &veml3328_regmap);
+	veml3328.range = veml3328_range_default;
+	veml3328.target_range = veml3328_range_default;
+	veml3328.auto_range = 1;
+	veml3328.it_ms = veml3328_range_it_ms(veml3328.range);
+
+	// The first reading is ready after a full integration time following the configuration write
+	veml3328.next_read = HAL_GetTick() + 2 * veml3328.it_ms;
+
+	return regmap_i2c_write(&veml3328.bus, veml3328_reg_conf, veml3328_range_conf(veml3328.range), NULL, NULL); // 0000 is the default configuration.
 }
 
-uint16_t veml3328_avg_amb(void){
-	int n = 0;
-	int avg = 0;
+/* Starts reading C, R, G, B and IR at each integration time boundary, call from the main loop */
+void veml3328_poll(void) {
+	PROFILING_SCOPE(VEML3328_POLL);
+	uint32_t now = HAL_GetTick();
+
+	if (regmap_i2c_isBusy(&veml3328.bus)) return;
+
+	// Change range between readings. The reading in progress mixes both configurations, so it is skipped.
+	uint8_t target = veml3328.target_range;
+	if (target != veml3328.range) {
+		if (regmap_i2c_write(&veml3328.bus, veml3328_reg_conf, veml3328_range_conf(target), NULL, NULL) != HAL_OK) {
+			veml3328.errors++;
+			veml3328.failed = 1;
+			REPORT_ERR(ERR_VEML3328_WRITE, target);
+			return;
+		}
+		veml3328.range = target;
+		veml3328.it_ms = veml3328_range_it_ms(target);
+		veml3328.next_read = now + 2 * veml3328.it_ms;
+		return;
+	}
 
-	for (n = 0; n < 50; n++){
-		veml3328_rd_rgb();
-		avg += g_data;
+	if ((int32_t)(now - veml3328.next_read) < 0) return;
+
+	// The bus is idle: after a failure, read the device ID through the I2C recovery ladder before going on
+	if (veml3328.failed) {
+		uint8_t id[2];
+		if (i2c_recovery_read(&i2c1_recovery, veml3328_addr, veml3328_reg_deviceID, id, sizeof(id)) != I2C_RECOVERY_OK) {
+			veml3328.errors++;
+			veml3328.next_read = now + veml3328_recovery_ms;
+			return;
+		}
+		veml3328.failed = 0;
 	}
 
-	return avg/50;
-}
+	veml3328.next_read += veml3328.it_ms;
+	if ((int32_t)(now - veml3328.next_read) >= 0) veml3328.next_read = now + veml3328.it_ms; // fell behind
 
-int veml3328_run(uint16_t amb){
-	veml3328_rd_rgb();
-	printf("ambient is: %u  data is: %u\r\n", amb, g_data);
+	uint8_t count = veml3328.present ? sizeof(veml3328_channels) - 1 : sizeof(veml3328_channels);
+	if (regmap_i2c_read(&veml3328.bus, veml3328_channels, count, veml3328_read_done, NULL) != HAL_OK) {
+		veml3328.errors++;
+		REPORT_ERR(ERR_VEML3328_READ, HAL_BUSY);
+	}
+}
 
-	if (g_data > amb+5) return 90;
-	if (g_data < amb-5) return 10;
+/* Returns 1 once per completed reading */
+uint8_t veml3328_new_sample(void) {
+	if (!veml3328.fresh) return 0;
+	veml3328.fresh = 0;
+	return 1;
+}
 
-	return 5;
+/* Green channel of the last reading in millilux */
+uint32_t veml3328_lux(void) {
+	return veml3328.lux;
 }
 
+/* Running ambient green channel in millilux */
+uint32_t veml3328_ambient(void) {
+	return (veml3328.baseline + 8) >> 4;
+}
 
+/* PWM duty cycle from the last reading compared to the ambient baseline */
+int veml3328_run(void) {
+	veml3328_poll();
+	if (veml3328.samples == 0) return 5;
 
+	uint32_t amb = veml3328_ambient();
+	if (veml3328.lux > amb + veml3328_baseline_band) return 90;
+	if (veml3328.lux + veml3328_baseline_band < amb) return 10;
 
+	return 5;
+}
 
+/* Enables or disables auto-ranging, the current range is kept when disabled */
+void veml3328_set_auto_range(uint8_t enable) {
+	veml3328.auto_range = enable;
+}
 
+/* Selects a fixed range (disables auto-ranging), written at the next poll */
+void veml3328_set_range(uint8_t range) {
+	if (range >= veml3328_range_count) return;
+	veml3328.auto_range = 0;
+	veml3328.target_range = range;
+}
 
+/* Range for the next reading from the largest channel of the last one */
+uint8_t veml3328_next_range(uint8_t range, uint16_t peak) {
+	// A saturated reading is at least twice the full scale as far as we know
+	uint32_t counts = peak == 0xFFFF ? 2 * 0xFFFF : peak;
 
+	while (counts >= veml3328_range_high && range > 0) {
+		counts >>= 1;
+		range--;
+	}
+	while (counts < veml3328_range_low && range < veml3328_range_count - 1) {
+		counts <<= 1;
+		range++;
+	}
+	return range;
+}
 
+/* Configuration register of a range: both channel groups on, auto mode, high sensitivity */
+uint16_t veml3328_range_conf(uint8_t range) {
+	return (veml3328_ranges[range].dg << veml3328_conf_dg_pos)
+		| (veml3328_ranges[range].gain << veml3328_conf_gain_pos)
+		| (SENS_hi << veml3328_conf_sens_pos)
+		| (veml3328_ranges[range].it << veml3328_conf_it_pos)
+		| (AF_auto << veml3328_conf_af_pos)
+		| (SD1_on << veml3328_conf_sd1_pos)
+		| (SD0_on << veml3328_conf_sd0_pos);
+}
 
+/* Integration time of a range in ms */
+uint16_t veml3328_range_it_ms(uint8_t range) {
+	return 50 << veml3328_ranges[range].it;
+}
 
+/* Resolution of a range in micro-lux per count */
+uint32_t veml3328_range_res_ulx(uint8_t range) {
+	return veml3328_ranges[range].res_ulx;
+}
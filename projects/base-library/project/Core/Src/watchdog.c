@@ -0,0 +1,67 @@
+/*
+ *  watchdog.c
+ *
+ *  Description: Provides the independent watchdog and the supervision of the tasks that keep it refreshed.
+ *
+ *  Created on: Oct 19, 2026
+ *  Author: Sailbot
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "watchdog.h"
+#include "error.h"
+
+/* Variables ------------------------------------------------------------------*/
+static SUPERVISOR watchdog_supervisor;
+static SUPERVISOR_RECORD watchdog_record __attribute__((section(".noinit"))); // survives the reset
+static volatile uint8_t watchdog_started;
+static uint32_t watchdog_last_poll;
+
+/* Functions ------------------------------------------------------------------*/
+static void watchdog_refresh(void){
+	IWDG->KR = 0xAAAA;
+}
+
+/* The HAL IWDG driver is not part of the project, the registers are written directly */
+static void watchdog_start(void){
+	__HAL_DBGMCU_FREEZE_IWDG(); // stopped while the debugger halts the core
+	IWDG->KR = 0xCCCC; // start, also starts the LSI
+	IWDG->KR = 0x5555; // unlock PR and RLR
+	IWDG->PR = 3; // divide by 32, 1 ms per count
+	IWDG->RLR = WATCHDOG_TIMEOUT_MS - 1;
+	uint32_t start = HAL_GetTick();
+	while (IWDG->SR != 0 && HAL_GetTick() - start < 100);
+	watchdog_refresh();
+}
+
+void watchdog_init(void){
+	SUPERVISOR_BOOT boot;
+	uint8_t watchdog_reset = __HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) != 0;
+	__HAL_RCC_CLEAR_RESET_FLAGS();
+
+	supervisor_init(&watchdog_supervisor, &watchdog_record, watchdog_reset, &boot);
+	if (boot.watchdogReset) {
+		REPORT_ERR(ERR_WATCHDOG_RESET, boot.task);
+		REPORT_ERR(ERR_WATCHDOG_LATE, boot.lateMs > 0xFFFF ? 0xFFFF : boot.lateMs);
+	}
+
+	watchdog_last_poll = HAL_GetTick();
+	watchdog_start();
+	watchdog_started = 1;
+}
+
+uint8_t watchdog_add_task(uint32_t deadline_ms){
+	return supervisor_addTask(&watchdog_supervisor, deadline_ms, HAL_GetTick());
+}
+
+void watchdog_check_in(uint8_t task){
+	supervisor_checkIn(&watchdog_supervisor, task, HAL_GetTick());
+}
+
+void watchdog_tick(void){
+	if (!watchdog_started) return;
+	uint32_t now = HAL_GetTick();
+	if (now - watchdog_last_poll < WATCHDOG_POLL_MS) return;
+	watchdog_last_poll = now;
+	if (supervisor_poll(&watchdog_supervisor, now)) watchdog_refresh();
+}
@@ -10,7 +10,8 @@
 
 typedef enum {
 	ALL,
-	TEMP
+	TEMP,
+	VEML
 } testgroup;
 
 #define TEST_GROUP_SEL ALL
@@ -6,6 +6,7 @@
  */
 #include "utest.h"
 #include "uconfig.h"
+#include "veml3328.h"
 
 
 //-- Add tests to runner and custom test macros/definitions
@@ -15,7 +16,9 @@
 const t_test test_runner[] = {
 //		{"Name of test", "function definition", "testgroup id"
 		{.testname="Temporary test 1", .func=temp_test1, .group=TEMP},
-		{.testname="Iteration test", .func=iteration_test}
+		{.testname="Iteration test", .func=iteration_test},
+		{.testname="VEML3328 auto-range hysteresis", .func=veml3328_range_test, .group=VEML},
+		{.testname="VEML3328 range configurations", .func=veml3328_conf_test, .group=VEML}
 };
 
 
@@ -35,6 +38,58 @@ testresult iteration_test(void) {
 	return res;
 }
 
+testresult veml3328_range_test(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	for (uint8_t range = 0; range < veml3328_range_count; ++range) {
+		for (uint32_t peak = 0; peak <= 0xFFFF; peak += 97) {
+			uint8_t next = veml3328_next_range(range, peak);
+			uint32_t counts = peak == 0xFFFF ? 2 * 0xFFFF : peak; // saturated
+			if (next > range) counts <<= next - range;
+			if (next < range) counts >>= range - next;
+
+			// The reading scaled to the new range is inside the thresholds unless the ladder ends
+			if ((counts >= veml3328_range_high && next > 0) || (counts < veml3328_range_low && next < veml3328_range_count - 1)) {
+				res.stat = TERROR;
+				res.error.seg[0] = range;
+				res.error.seg[1] = peak;
+				return res;
+			}
+
+			// Hysteresis: the same light seen in the new range does not move again
+			if (peak != 0 && veml3328_next_range(next, counts > 0xFFFE ? 0xFFFE : counts) != next) {
+				res.stat = TERROR;
+				res.error.seg[0] = range;
+				res.error.seg[1] = peak;
+				return res;
+			}
+		}
+	}
+
+	// Saturation drops two ranges at once
+	if (veml3328_next_range(4, 0xFFFF) != 2) res.stat = TERROR;
+	return res;
+}
+
+testresult veml3328_conf_test(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	// The default range is the power on configuration
+	if (veml3328_range_conf(veml3328_range_default) != 0x0000) res.stat = TERROR;
+	if (veml3328_range_it_ms(veml3328_range_default) != 50) res.stat = TERROR;
+	if (veml3328_range_res_ulx(veml3328_range_default) != 384000) res.stat = TERROR;
+
+	// Most sensitive: DG x4, gain x4, IT 400 ms
+	if (veml3328_range_conf(veml3328_range_count - 1) != 0x2830) res.stat = TERROR;
+	if (veml3328_range_it_ms(veml3328_range_count - 1) != 400) res.stat = TERROR;
+
+	// Each range is exactly twice as sensitive as the previous one
+	for (uint8_t range = 1; range < veml3328_range_count; ++range) {
+		if (veml3328_range_res_ulx(range) * 2 != veml3328_range_res_ulx(range - 1)) res.stat = TERROR;
+	}
+	return res;
+}
+
 void run_tests(void) {
 	test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
 }
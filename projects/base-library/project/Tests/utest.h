@@ -16,6 +16,8 @@ void run_tests(void);
 // Test functions
 testresult temp_test1(void);
 testresult iteration_test(void);
+testresult veml3328_range_test(void);
+testresult veml3328_conf_test(void);
 
 
 #endif /* UTEST_H_ */
@@ -0,0 +1,18 @@
+/*
+ * uconfig.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef UCONFIG_H_
+#define UCONFIG_H_
+
+typedef enum {
+	ALL,
+	VEML
+} testgroup;
+
+#define TEST_GROUP_SEL ALL
+
+#endif /* UCONFIG_H_ */
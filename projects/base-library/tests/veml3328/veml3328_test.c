@@ -0,0 +1,279 @@
+/*
+ * veml3328_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "board.h"
+#include "can.h"
+#include "error.h"
+#include "veml3328.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define LOOP_PERIOD_MS 5 //idle_wait() of the main loop
+#define BENCHMARK_MINUTES 10
+
+testresult veml3328_first_readings(void);
+testresult veml3328_auto_ranging(void);
+testresult veml3328_wrong_id_reported(void);
+testresult veml3328_nack_recovery(void);
+testresult veml3328_held_bus_recovery(void);
+testresult veml3328_loop_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Configuration and first readings", .func=veml3328_first_readings, .group=VEML},
+		{.testname="Auto-ranging follows the light", .func=veml3328_auto_ranging, .group=VEML},
+		{.testname="Wrong device ID reported over CAN and UART", .func=veml3328_wrong_id_reported, .group=VEML},
+		{.testname="Missing sensor retried through the recovery", .func=veml3328_nack_recovery, .group=VEML},
+		{.testname="Held bus cleared by the recovery", .func=veml3328_held_bus_recovery, .group=VEML},
+		{.testname="Main loop benchmark", .func=veml3328_loop_benchmark, .group=VEML}
+};
+
+// -- Helpers --
+//Defined in main.c on the board
+uint8_t UART1_rxBuffer[1];
+
+//VEML3328 model: 16 bit command code registers, the channels follow the light of the scene and the range set in
+//the configuration register when they are read
+static uint8_t registers[2 * 0x10];
+static HAL_HOST_I2C_REGS veml;
+static uint32_t sceneLux;
+
+static uint16_t reg16(uint8_t reg) {
+	return registers[2 * reg] | (registers[2 * reg + 1] << 8);
+}
+
+static void put16(uint8_t reg, uint32_t value) {
+	if (value > 0xFFFF) value = 0xFFFF;
+	registers[2 * reg] = (uint8_t)value;
+	registers[2 * reg + 1] = (uint8_t)(value >> 8);
+}
+
+static void measure(void* context, uint8_t reg, uint16_t length) {
+	//res8 (IT 50 ms, gain x1, DG x1) is 0.384 lx, each doubling of the integration time or gain halves it
+	uint16_t conf = reg16(veml3328__conf);
+	uint32_t it = (conf >> veml3328_conf_it_pos) & 0x3;
+	uint32_t gain = (conf >> veml3328_conf_gain_pos) & 0x3;
+	uint32_t dg = (conf >> veml3328_conf_dg_pos) & 0x3;
+	uint64_t halves = (gain == GAINx1_2 ? 1 : 2u << gain) << it << dg; //sensitivity in halves of res8
+	uint64_t green = (uint64_t)sceneLux * 1000 * halves / (2 * 384);
+	put16(G_, green);
+	put16(C_, green + green / 4);
+	put16(R_, green / 2);
+	put16(B_, green / 3);
+	put16(IR_, green / 8);
+}
+
+//SDA held low by the sensor until it got the clock pulses that finish its byte
+static uint8_t holding;
+static uint8_t pulsesToRelease;
+static uint32_t pulses;
+
+static void sclWritten(void* context, GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+	if (holding && pin == GPIO_PIN_8 && state == GPIO_PIN_RESET && ++pulses == pulsesToRelease) {
+		holding = 0;
+		veml.response = HAL_HOST_I2C_ACK;
+	}
+}
+
+static GPIO_PinState sdaRead(void* context, GPIO_TypeDef* port, uint16_t pin, GPIO_PinState level) {
+	return (holding && pin == GPIO_PIN_9) ? GPIO_PIN_RESET : level;
+}
+
+static const HAL_HOST_GPIO_MODEL i2cPins = {.write = sclWritten, .read = sdaRead};
+
+//The peripherals as MX_*_Init() configure them, then the start of main()
+static void setup(uint32_t lux) {
+	hal_host_reset();
+	memset(registers, 0, sizeof(registers));
+	put16(veml3328__conf, 0x8001); //shut down
+	put16(veml3328_reg_deviceID, 0x0128);
+	sceneLux = lux;
+	veml = (HAL_HOST_I2C_REGS){.registers = registers, .size = sizeof(registers), .width = 2, .onRead = measure};
+	hal_host_i2cAttachRegs(I2C1, veml3328_addr, &veml);
+	holding = 0;
+	pulses = 0;
+	hal_host_gpioAttach(GPIOB, &i2cPins);
+
+	hi2c1 = (I2C_HandleTypeDef){.Instance = I2C1, .Init = {.Timing = 0x10707DBC}};
+	HAL_I2C_Init(&hi2c1);
+	hfdcan1 = (FDCAN_HandleTypeDef){.Instance = FDCAN1, .Init = {.ClockDivider = FDCAN_CLOCK_DIV1,
+			.Mode = FDCAN_MODE_NORMAL, .NominalPrescaler = 16, .NominalTimeSeg1 = 2, .NominalTimeSeg2 = 2}};
+	HAL_FDCAN_Init(&hfdcan1);
+	huart1 = (UART_HandleTypeDef){.Instance = USART1, .Init = {.BaudRate = 115200}};
+	HAL_UART_Init(&huart1);
+
+	error_init();
+	can_init();
+	i2c1_recovery_init();
+	veml3328_init();
+}
+
+//Passes of the main loop over ms: the sensor, then the error reports
+static void run(uint32_t ms) {
+	for (uint32_t t = 0; t < ms; t += LOOP_PERIOD_MS) {
+		veml3328_run();
+		error_flush();
+		hal_host_advance(HAL_HOST_MS(LOOP_PERIOD_MS));
+	}
+}
+
+static uint8_t within(uint32_t value, uint32_t expected, uint32_t tolerance) {
+	return value + tolerance >= expected && value <= expected + tolerance;
+}
+
+// -- Unit tests --
+testresult veml3328_first_readings(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+	veml3328_set_auto_range(0);
+	hal_host_runNext();
+	TEST_CHECK(reg16(veml3328__conf) == veml3328_range_conf(veml3328_range_default));
+
+	//The first reading after two integration times, then one every 50 ms, the ID only read with the first one
+	run(95);
+	TEST_CHECK(veml3328.samples == 0);
+	run(210);
+	TEST_CHECK(veml3328.samples == 5 && veml3328.present && veml3328.errors == 0);
+	HAL_HOST_I2C_STATS stats;
+	hal_host_i2cStats(I2C1, &stats);
+	TEST_CHECK(stats.transfers == 1 + 6 + 4 * 5);
+
+	//500 lx at 0.384 lx a count
+	TEST_CHECK(veml3328.g == 1302 && veml3328.c == 1302 + 1302 / 4);
+	TEST_CHECK(within(veml3328_lux(), 500000, 384));
+	TEST_CHECK(within(veml3328_ambient(), 500000, 384));
+	TEST_CHECK(veml3328_new_sample() && !veml3328_new_sample());
+	return res;
+}
+
+testresult veml3328_auto_ranging(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+
+	//Dim light moves up to IT 200 ms with gain x4, where 500 lx is between the thresholds
+	run(2000);
+	TEST_CHECK(veml3328.range == 5 && reg16(veml3328__conf) == veml3328_range_conf(5));
+	TEST_CHECK(within(veml3328_lux(), 500000, 24));
+	uint32_t samples = veml3328.samples;
+	run(1000);
+	TEST_CHECK(veml3328.samples == samples + 5 && veml3328.range == 5);
+
+	//Sunlight saturates the channels, the range steps down until the largest one is under 80 % of full scale
+	sceneLux = 20000;
+	run(1000);
+	TEST_CHECK(veml3328.range == 0 && reg16(veml3328__conf) == veml3328_range_conf(0));
+	TEST_CHECK(veml3328.c < veml3328_range_high && veml3328.c >= veml3328_range_low);
+	TEST_CHECK(within(veml3328_lux(), 20000000, 768));
+	//A flash brighter than the baseline
+	TEST_CHECK(veml3328_run() == 90);
+	TEST_CHECK(veml3328.errors == 0);
+	return res;
+}
+
+testresult veml3328_wrong_id_reported(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+	put16(veml3328_reg_deviceID, 0x0155);
+
+	//Readings with the wrong ID are dropped and reported
+	run(500);
+	TEST_CHECK(veml3328.samples == 0 && veml3328.errors > 0 && !veml3328.present);
+	TEST_CHECK(getLatestError() == ERR_VEML3328_ID && error_led_pattern() == FAST_BLINK);
+
+	//The first report left in a frame per entry on CAN and as a text line on UART1
+	HAL_HOST_CAN_FRAME frame;
+	uint8_t found = 0;
+	while (hal_host_canTake(&frame)) {
+		if (frame.id == ERROR_CAN_ID && (frame.data[4] | frame.data[5] << 8) == ERR_VEML3328_ID) {
+			found = (frame.data[6] | frame.data[7] << 8) == 0x0155;
+		}
+	}
+	TEST_CHECK(found);
+	char line[ERROR_UART_LINES * ERRLOG_LINE_SIZE + 1];
+	uint16_t length = hal_host_uartSent(USART1, (uint8_t*)line, sizeof(line) - 1);
+	line[length] = 0;
+	TEST_CHECK(length > 0 && line[0] == 'E' && strstr(line, "\r\n") != NULL);
+
+	//Fixed, the readings go on
+	put16(veml3328_reg_deviceID, 0x0128);
+	run(200);
+	TEST_CHECK(veml3328.samples > 0 && veml3328.present);
+	return res;
+}
+
+testresult veml3328_nack_recovery(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+	veml3328_set_auto_range(0);
+	run(300);
+	uint32_t samples = veml3328.samples;
+	TEST_CHECK(samples > 0);
+
+	//The sensor stops answering: the reading fails, and the check through the recovery ladder ends with a NACK
+	//on a free bus, without a reset. It is checked again a second later.
+	veml.response = HAL_HOST_I2C_NACK;
+	run(300);
+	TEST_CHECK(veml3328.failed && veml3328.samples == samples);
+	TEST_CHECK(i2c1_recovery.stats.unrecovered == 1 && hal_host_resets() == 0);
+	TEST_CHECK(errlog_count(ERR_VEML3328_READ) == 1);
+	veml.response = HAL_HOST_I2C_ACK;
+	run(1000);
+	TEST_CHECK(!veml3328.failed && veml3328.samples > samples);
+	TEST_CHECK(i2c1_recovery.stats.unrecovered == 1 && hal_host_resets() == 0);
+	return res;
+}
+
+testresult veml3328_held_bus_recovery(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+	veml3328_set_auto_range(0);
+	run(300);
+	uint32_t samples = veml3328.samples;
+
+	//The sensor holds SDA in the middle of a byte: the reading times out, the recovery clocks SCL as GPIO until
+	//the sensor lets go (4 pulses), sends a STOP and the bus is back
+	holding = 1;
+	pulsesToRelease = 4;
+	veml.response = HAL_HOST_I2C_HOLD;
+	run(200);
+	TEST_CHECK(!holding && pulses == 4);
+	TEST_CHECK(i2c1_recovery.stats.busClears == 1 && i2c1_recovery.stats.clockPulses == 4);
+	TEST_CHECK(i2c1_recovery.stats.recovered == 1 && hal_host_resets() == 0);
+	run(200);
+	TEST_CHECK(!veml3328.failed && veml3328.samples > samples);
+	HAL_HOST_I2C_STATS stats;
+	hal_host_i2cStats(I2C1, &stats);
+	TEST_CHECK(stats.timeouts >= 2);
+	return res;
+}
+
+testresult veml3328_loop_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(500);
+
+	//Minutes of the main loop with a changing scene, timing the drivers and the models on the host clock
+	clock_t start = clock();
+	for (uint32_t second = 0; second < BENCHMARK_MINUTES * 60; ++second) {
+		sceneLux = 50 + (second * 37) % 5000;
+		run(1000);
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	TEST_CHECK(veml3328.errors == 0 && veml3328.samples > BENCHMARK_MINUTES * 60 * 4);
+	uint32_t passes = BENCHMARK_MINUTES * 60000 / LOOP_PERIOD_MS;
+	printf("%lu passes and %lu readings (%d min) in %.3f s on the host, %.2f us a pass\n", (unsigned long)passes,
+			(unsigned long)veml3328.samples, BENCHMARK_MINUTES, seconds, seconds * 1e6 / passes);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
@@ -136,23 +136,7 @@ int main(void)
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
 
-  //initialize heading registers
-  volatile uint32_t headingData = 0;
-  volatile uint32_t rollData = 0;
-  volatile uint32_t pitchData = 0;
-
-  //initialize offset registers
-  volatile uint32_t accX_Offset = 0;
-  volatile uint32_t accY_Offset = 0;
-  volatile uint32_t accZ_Offset = 0;
-  volatile uint32_t magX_Offset = 0;
-  volatile uint32_t magY_Offset = 0;
-  volatile uint32_t magZ_Offset = 0;
-  volatile uint32_t gyrX_Offset = 0;
-  volatile uint32_t gyrY_Offset = 0;
-  volatile uint32_t gyrZ_Offset = 0;
-
-  imu = IMU__create(&hi2c2, &htim2 ,5, &headingData, &rollData, &pitchData, &accX_Offset, &accY_Offset, &accZ_Offset, &magX_Offset, &magY_Offset, &magZ_Offset, &gyrX_Offset, &gyrY_Offset, &gyrZ_Offset); //setup IMU object
+  imu = IMU__create(&hi2c2, &htim2 ,5); //setup IMU object
   HAL_TIM_Base_Start_IT(&htim2); //start timer controlling data collection
 
 
@@ -167,7 +151,9 @@ int main(void)
 	 HAL_Delay (1000);
 
 //	 IMU_getOffset(imu);
-//	 printf(" ACC- X:%u , Y: %u , Z: %u\x0D\x0A MAG- X:%u , Y: %u , Z: %u\x0D\x0A GYR- X:%u , Y: %u , Z: %u\x0D\x0A", (signed int) accX_Offset, (signed int) accY_Offset, (signed int) accZ_Offset, (signed int) magX_Offset, (signed int) magY_Offset, (signed int) magZ_Offset, (signed int) gyrX_Offset, (signed int) gyrY_Offset, (signed int) gyrZ_Offset);
+//	 BNO055_OFFSETS offsets;
+//	 IMU__getOffsets(imu, &offsets);
+//	 printf(" ACC- X:%d , Y: %d , Z: %d\x0D\x0A MAG- X:%d , Y: %d , Z: %d\x0D\x0A GYR- X:%d , Y: %d , Z: %d\x0D\x0A", (int) offsets.acc[0], (int) offsets.acc[1], (int) offsets.acc[2], (int) offsets.mag[0], (int) offsets.mag[1], (int) offsets.mag[2], (int) offsets.gyr[0], (int) offsets.gyr[1], (int) offsets.gyr[2]);
 //
 	 CALIBSTAT* calibStat = BNO055_ReadCalibStat(imu);
 	 //printf("lol");
@@ -175,7 +161,9 @@ int main(void)
 
 //	 if(calibStat->sysStat == 3 && calibStat->gyrStat == 3 && calibStat->accStat == 3 && calibStat->magStat == 3){
 //		  HAL_Delay (10);
-//		  printf("Heading: %u , Roll: %u , Pitch: %u\x0D\x0A", (unsigned int) headingData, (unsigned int) rollData, (signed int) pitchData);
+//		  IMU_SAMPLE sample;
+//		  IMU__getLatest(imu, &sample);
+//		  printf("Heading: %d , Roll: %d , Pitch: %d\x0D\x0A", (int) sample.heading, (int) sample.roll, (int) sample.pitch);
 //	 }
 
     /* USER CODE END WHILE */
@@ -0,0 +1,201 @@
+/*
+ * BNO055.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "BNO055.h"
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- PRIVATE MACROS ------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Scale factors that are not a ratio of small integers, in Q32 (value * 2^32) so that every 16 bit register
+//value still rounds to the nearest output unit
+//(pi / 180 / 16) * 1e6 microradians per LSB
+#define MICRORADIANS_PER_LSB_Q32 4685082536292LL
+//(pi / 180 / 16) * 1e3 milliradians per second per LSB
+#define MILLIRADIANS_PER_LSB_Q32 4685082536LL
+//(10 / 9.80665) mg per LSB
+#define MILLI_G_PER_LSB_Q32 4379647786LL
+
+//Offsets of the fields of a calibration profile record
+#define RECORD_MAGIC 0
+#define RECORD_VERSION 4
+#define RECORD_LENGTH 6
+#define RECORD_PROFILE 8
+#define RECORD_CRC (RECORD_PROFILE + BNO055_PROFILE_LENGTH + 2)
+
+//Register map macros: address, signed 16 bit little endian, scale
+#define REG_INT16(address, numerator, denominator) {address, 2, REGMAP_LITTLE_ENDIAN, 1, numerator, denominator}
+#define REG_UINT8(address) {address, 1, REGMAP_LITTLE_ENDIAN, 0, 1, 1}
+
+//A block read costs 9 bits per unused byte, a new transaction about 40 bits (start, addresses, repeated start) plus
+//an interrupt and a DMA restart, so reading through the gravity and temperature registers is still cheaper
+#define BLOCK_MAX_GAP 8
+#define BLOCK_MAX_LENGTH 64
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- REGISTER MAP --------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Scales are the same as the default units of the conversion functions below
+static const REGMAP_REGISTER registers[BNO055_REG_COUNT] = {
+	[BNO055_REG_CHIP_ID] = REG_UINT8(0x00),
+	[BNO055_REG_ACC_X] = REG_INT16(0x08, 10, 1),
+	[BNO055_REG_ACC_Y] = REG_INT16(0x0A, 10, 1),
+	[BNO055_REG_ACC_Z] = REG_INT16(0x0C, 10, 1),
+	[BNO055_REG_MAG_X] = REG_INT16(0x0E, 125, 2),
+	[BNO055_REG_MAG_Y] = REG_INT16(0x10, 125, 2),
+	[BNO055_REG_MAG_Z] = REG_INT16(0x12, 125, 2),
+	[BNO055_REG_GYR_X] = REG_INT16(0x14, 125, 2),
+	[BNO055_REG_GYR_Y] = REG_INT16(0x16, 125, 2),
+	[BNO055_REG_GYR_Z] = REG_INT16(0x18, 125, 2),
+	[BNO055_REG_HEADING] = {0x1A, 2, REGMAP_LITTLE_ENDIAN, 0, 125, 2},
+	[BNO055_REG_ROLL] = REG_INT16(0x1C, 125, 2),
+	[BNO055_REG_PITCH] = REG_INT16(0x1E, 125, 2),
+	[BNO055_REG_QUA_W] = REG_INT16(0x20, 1, 1),
+	[BNO055_REG_QUA_X] = REG_INT16(0x22, 1, 1),
+	[BNO055_REG_QUA_Y] = REG_INT16(0x24, 1, 1),
+	[BNO055_REG_QUA_Z] = REG_INT16(0x26, 1, 1),
+	[BNO055_REG_LIA_X] = REG_INT16(0x28, 10, 1),
+	[BNO055_REG_LIA_Y] = REG_INT16(0x2A, 10, 1),
+	[BNO055_REG_LIA_Z] = REG_INT16(0x2C, 10, 1),
+	[BNO055_REG_GRV_X] = REG_INT16(0x2E, 10, 1),
+	[BNO055_REG_GRV_Y] = REG_INT16(0x30, 10, 1),
+	[BNO055_REG_GRV_Z] = REG_INT16(0x32, 10, 1),
+	[BNO055_REG_TEMP] = {0x34, 1, REGMAP_LITTLE_ENDIAN, 1, 10, 1},
+	[BNO055_REG_CALIB_STAT] = REG_UINT8(0x35),
+	[BNO055_REG_OPR_MODE] = REG_UINT8(0x3D)
+};
+
+const REGMAP_DEVICE BNO055_REGMAP = {
+	.address = 0x28,
+	.autoIncrement = 1,
+	.maxGap = BLOCK_MAX_GAP,
+	.maxBlock = BLOCK_MAX_LENGTH,
+	.registers = registers,
+	.count = BNO055_REG_COUNT
+};
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//raw * 125 / 2, the scale from 16 LSB per unit to thousandths of a unit
+static int32_t sixteenthsToThousandths(int32_t raw){
+	return (raw * 125 + 1) >> 1;
+}
+
+//raw * scale / 2^32, rounded
+static int32_t scaleQ32(int32_t raw, int64_t scale){
+	return (int32_t)((raw * scale + (1LL << 31)) >> 32);
+}
+
+static void writeUint32(uint8_t* buffer, uint32_t value){
+	buffer[0] = value & 0xFF;
+	buffer[1] = (value >> 8) & 0xFF;
+	buffer[2] = (value >> 16) & 0xFF;
+	buffer[3] = value >> 24;
+}
+
+static uint32_t readUint32(const uint8_t* buffer){
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- BNO055 METHODS ------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+int16_t BNO055__readInt16(const uint8_t* registers, uint8_t index){
+	return (int16_t)(registers[index + 1] << 8 | registers[index]);
+}
+
+int32_t BNO055__angle(int16_t raw, BNO055_ANGLE_UNIT unit){
+	switch(unit){
+	case BNO055_ANGLE_DECIDEGREES:
+		return (raw * 5 + 4) >> 3;
+	case BNO055_ANGLE_MICRORADIANS:
+		return scaleQ32(raw, MICRORADIANS_PER_LSB_Q32);
+	case BNO055_ANGLE_MILLIDEGREES:
+	default:
+		return sixteenthsToThousandths(raw);
+	}
+}
+
+int32_t BNO055__heading(uint16_t raw, BNO055_ANGLE_UNIT unit){
+	switch(unit){
+	case BNO055_ANGLE_DECIDEGREES:
+		return ((int32_t)raw * 5 + 4) >> 3;
+	case BNO055_ANGLE_MICRORADIANS:
+		return scaleQ32(raw, MICRORADIANS_PER_LSB_Q32);
+	case BNO055_ANGLE_MILLIDEGREES:
+	default:
+		return sixteenthsToThousandths(raw);
+	}
+}
+
+int32_t BNO055__accel(int16_t raw, BNO055_ACCEL_UNIT unit){
+	if(unit == BNO055_ACCEL_MILLI_G){
+		return scaleQ32(raw, MILLI_G_PER_LSB_Q32);
+	}
+	return raw * 10;
+}
+
+int32_t BNO055__rate(int16_t raw, BNO055_RATE_UNIT unit){
+	if(unit == BNO055_RATE_MILLIRADIANS_PER_S){
+		return scaleQ32(raw, MILLIRADIANS_PER_LSB_Q32);
+	}
+	return sixteenthsToThousandths(raw);
+}
+
+int32_t BNO055__magnetic(int16_t raw){
+	return sixteenthsToThousandths(raw);
+}
+
+int16_t BNO055__temperature(int8_t raw){
+	return raw * 10;
+}
+
+void BNO055__decodeOffsets(const uint8_t* registers, const BNO055_UNITS* units, BNO055_OFFSETS* offsets){
+	for(uint8_t i = 0; i < 3; i++){
+		offsets->acc[i] = BNO055__accel(BNO055__readInt16(registers, 2 * i), units->accel);
+		offsets->mag[i] = BNO055__magnetic(BNO055__readInt16(registers, 6 + 2 * i));
+		offsets->gyr[i] = BNO055__rate(BNO055__readInt16(registers, 12 + 2 * i), units->rate);
+	}
+}
+
+uint32_t BNO055__crc32(const uint8_t* data, uint32_t length){
+	uint32_t crc = 0xFFFFFFFF;
+	for(uint32_t i = 0; i < length; i++){
+		crc ^= data[i];
+		for(uint8_t bit = 0; bit < 8; bit++){
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+void BNO055__packProfile(const uint8_t* profile, uint8_t* record){
+	memset(record, 0xFF, BNO055_PROFILE_RECORD_SIZE);
+	writeUint32(&record[RECORD_MAGIC], BNO055_PROFILE_MAGIC);
+	record[RECORD_VERSION] = BNO055_PROFILE_VERSION & 0xFF;
+	record[RECORD_VERSION + 1] = BNO055_PROFILE_VERSION >> 8;
+	record[RECORD_LENGTH] = BNO055_PROFILE_LENGTH;
+	record[RECORD_LENGTH + 1] = 0;
+	memcpy(&record[RECORD_PROFILE], profile, BNO055_PROFILE_LENGTH);
+	writeUint32(&record[RECORD_CRC], BNO055__crc32(record, RECORD_CRC));
+}
+
+uint8_t BNO055__unpackProfile(const uint8_t* record, uint8_t* profile){
+	if(readUint32(&record[RECORD_MAGIC]) != BNO055_PROFILE_MAGIC
+			|| (record[RECORD_VERSION] | (record[RECORD_VERSION + 1] << 8)) != BNO055_PROFILE_VERSION
+			|| (record[RECORD_LENGTH] | (record[RECORD_LENGTH + 1] << 8)) != BNO055_PROFILE_LENGTH
+			|| readUint32(&record[RECORD_CRC]) != BNO055__crc32(record, RECORD_CRC)){
+		return 0;
+	}
+	memcpy(profile, &record[RECORD_PROFILE], BNO055_PROFILE_LENGTH);
+	return 1;
+}
@@ -0,0 +1,217 @@
+/*
+ * This library converts the raw output registers of a BNO055 to fixed point values with integer arithmetic only,
+ * so it is cheap enough to run inside the I2C interrupt. It does not depend on the HAL so it can be tested on a
+ * host machine. It assumes the sensor's default unit selection (UNIT_SEL = 0x80), which gives the following
+ * register scales (datasheet section 3.6.4):
+ *		-Euler angles: 16 LSB = 1 degree
+ *		-Angular rate and gyroscope offsets: 16 LSB = 1 dps
+ *		-Acceleration, linear acceleration, gravity and accelerometer offsets: 100 LSB = 1 m/s^2
+ *		-Magnetic field and magnetometer offsets: 16 LSB = 1 uT
+ *		-Quaternion: 2^14 LSB = 1 (left as is, it is already an exact fixed point value)
+ *		-Temperature: 1 LSB = 1 degree Celsius
+ *
+ * Results are rounded to the nearest output unit (halves are rounded up).
+ *
+ * It also packs the calibration profile (offset and radius registers 0x55-0x6A) into a versioned record with a
+ * CRC32, so it can be stored in flash and written back at the next power up.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef BNO055_H
+#define BNO055_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "regmap.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Register scales with the default unit selection
+#define BNO055_LSB_PER_DEGREE 16
+#define BNO055_LSB_PER_DPS 16
+#define BNO055_LSB_PER_MS2 100
+#define BNO055_LSB_PER_UT 16
+#define BNO055_QUATERNION_ONE (1 << 14)
+
+//Number of bytes of the offset registers (0x55-0x66) decoded by BNO055__decodeOffsets()
+#define BNO055_OFFSET_REGISTERS 18
+
+//The calibration profile: accelerometer, magnetometer and gyroscope offsets then accelerometer and magnetometer radii
+#define BNO055_PROFILE_REGISTER 0x55
+#define BNO055_PROFILE_LENGTH 22
+
+//Calibration profile record: magic (4 bytes), version (2), profile length (2), profile (22), padding (2), CRC32 of
+//everything before it (4), padded with 0xFF to a multiple of the 16 byte flash programming unit
+#define BNO055_PROFILE_MAGIC 0x314F4E42 //"BNO1"
+#define BNO055_PROFILE_VERSION 1
+#define BNO055_PROFILE_RECORD_SIZE 48
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Registers of BNO055_REGMAP, in the default output units (millidegrees, mm/s^2, millidegrees per second, nT)
+typedef enum {
+	BNO055_REG_CHIP_ID,
+	BNO055_REG_ACC_X, BNO055_REG_ACC_Y, BNO055_REG_ACC_Z,
+	BNO055_REG_MAG_X, BNO055_REG_MAG_Y, BNO055_REG_MAG_Z,
+	BNO055_REG_GYR_X, BNO055_REG_GYR_Y, BNO055_REG_GYR_Z,
+	BNO055_REG_HEADING, BNO055_REG_ROLL, BNO055_REG_PITCH,
+	BNO055_REG_QUA_W, BNO055_REG_QUA_X, BNO055_REG_QUA_Y, BNO055_REG_QUA_Z,
+	BNO055_REG_LIA_X, BNO055_REG_LIA_Y, BNO055_REG_LIA_Z,
+	BNO055_REG_GRV_X, BNO055_REG_GRV_Y, BNO055_REG_GRV_Z,
+	BNO055_REG_TEMP,
+	BNO055_REG_CALIB_STAT,
+	BNO055_REG_OPR_MODE,
+	BNO055_REG_COUNT
+} BNO055_REGISTER;
+
+//Output unit of angles (Euler angles)
+typedef enum {
+	BNO055_ANGLE_MILLIDEGREES,
+	BNO055_ANGLE_DECIDEGREES, //0.1 degrees, as used by the wind sensor libraries
+	BNO055_ANGLE_MICRORADIANS
+} BNO055_ANGLE_UNIT;
+
+//Output unit of accelerations
+typedef enum {
+	BNO055_ACCEL_MM_PER_S2, //mm/s^2
+	BNO055_ACCEL_MILLI_G //mg with g = 9.80665 m/s^2
+} BNO055_ACCEL_UNIT;
+
+//Output unit of angular rates
+typedef enum {
+	BNO055_RATE_MILLIDEGREES_PER_S,
+	BNO055_RATE_MILLIRADIANS_PER_S
+} BNO055_RATE_UNIT;
+
+//The output units used for a conversion
+typedef struct {
+	BNO055_ANGLE_UNIT angle;
+	BNO055_ACCEL_UNIT accel;
+	BNO055_RATE_UNIT rate;
+} BNO055_UNITS;
+
+//The offset registers converted to the output units
+typedef struct {
+	int32_t acc[3]; //x, y, z in the acceleration unit
+	int32_t mag[3]; //x, y, z in nT
+	int32_t gyr[3]; //x, y, z in the angular rate unit
+} BNO055_OFFSETS;
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- REGISTER MAP -------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Page 0 output registers of the BNO055 (datasheet table 4-2). The register pointer auto-increments, so reads of
+//neighbouring registers are merged into block reads, e.g. the heading to the calibration status is one 28 byte read.
+extern const REGMAP_DEVICE BNO055_REGMAP;
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- BNO055 METHODS -----------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Reads a signed little endian register pair.
+ *
+ * @param registers The register bytes
+ * @param index Index of the LSB register in registers
+ * @return The register value
+ */
+int16_t BNO055__readInt16(const uint8_t* registers, uint8_t index);
+
+/*
+ * Converts an Euler angle register.
+ *
+ * @param raw The register value (16 LSB = 1 degree)
+ * @param unit The output unit
+ * @return The angle in the output unit
+ */
+int32_t BNO055__angle(int16_t raw, BNO055_ANGLE_UNIT unit);
+
+/*
+ * Converts a heading register. The heading register holds 0 to 5760 so it is read unsigned.
+ *
+ * @param raw The register value (16 LSB = 1 degree)
+ * @param unit The output unit
+ * @return The heading in the output unit
+ */
+int32_t BNO055__heading(uint16_t raw, BNO055_ANGLE_UNIT unit);
+
+/*
+ * Converts an acceleration, linear acceleration, gravity or accelerometer offset register.
+ *
+ * @param raw The register value (100 LSB = 1 m/s^2)
+ * @param unit The output unit
+ * @return The acceleration in the output unit
+ */
+int32_t BNO055__accel(int16_t raw, BNO055_ACCEL_UNIT unit);
+
+/*
+ * Converts an angular rate or gyroscope offset register.
+ *
+ * @param raw The register value (16 LSB = 1 dps)
+ * @param unit The output unit
+ * @return The angular rate in the output unit
+ */
+int32_t BNO055__rate(int16_t raw, BNO055_RATE_UNIT unit);
+
+/*
+ * Converts a magnetic field or magnetometer offset register.
+ *
+ * @param raw The register value (16 LSB = 1 uT)
+ * @return The magnetic field in nT
+ */
+int32_t BNO055__magnetic(int16_t raw);
+
+/*
+ * Converts the temperature register.
+ *
+ * @param raw The register value (1 LSB = 1 degree Celsius)
+ * @return The temperature in 0.1 degrees Celsius
+ */
+int16_t BNO055__temperature(int8_t raw);
+
+/*
+ * Decodes the accelerometer, magnetometer and gyroscope offset registers, each with its own unit.
+ *
+ * @param registers The BNO055_OFFSET_REGISTERS bytes read from register 0x55
+ * @param units The output units
+ * @param offsets Receives the converted offsets
+ */
+void BNO055__decodeOffsets(const uint8_t* registers, const BNO055_UNITS* units, BNO055_OFFSETS* offsets);
+
+/*
+ * Computes the CRC32 (IEEE 802.3, as used by zlib) of a block of data.
+ *
+ * @param data The data
+ * @param length The number of bytes
+ * @return The CRC32
+ */
+uint32_t BNO055__crc32(const uint8_t* data, uint32_t length);
+
+/*
+ * Packs a calibration profile into a record that can be stored in flash.
+ *
+ * @param profile The BNO055_PROFILE_LENGTH bytes read from register 0x55
+ * @param record Receives the BNO055_PROFILE_RECORD_SIZE bytes of the record
+ */
+void BNO055__packProfile(const uint8_t* profile, uint8_t* record);
+
+/*
+ * Checks a stored record and extracts the calibration profile from it.
+ *
+ * @param record The BNO055_PROFILE_RECORD_SIZE bytes of the record
+ * @param profile Receives the BNO055_PROFILE_LENGTH bytes to write to register 0x55
+ * @return 1 if the record is valid (magic, version, length and CRC match), 0 otherwise (e.g. erased flash)
+ */
+uint8_t BNO055__unpackProfile(const uint8_t* record, uint8_t* profile);
+
+#endif /* BNO055_H */
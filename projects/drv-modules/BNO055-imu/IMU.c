@@ -6,8 +6,10 @@
  */
 
 #include "IMU.h"
-#include <stdlib.h>
+#include "profiling.h"
+#include "pool.h"
 #include <stdio.h>
+#include <string.h>
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------- PRIVATE MACROS ------------------------------------------------------------------------------
@@ -16,21 +18,51 @@
 //The address used for the IMU (0x28 is default) left shift by one
 #define BNO055_ADDR 0x28 << 1
 
-//The maximum number of sequential register bytes that can be read:
-#define MAX_INPUT_BUFFER 18
+//The maximum number of sequential register bytes read by the Euler and offset reads:
+#define MAX_INPUT_BUFFER 28
 
-//The timer prescalar value
-#define PRESCALAR 1599
+//Bytes read by a burst, the registers from the Euler angles to the calibration status with the gravity vector and
+//temperature the regmap plan reads through
+#define BURST_LENGTH IMU_BURST_LENGTH
 
-//The APB1 frequency in kHz
-#define APB1_FREQUENCY 160000
+//Values of data_flag, the read in progress outside of the burst acquisition
+#define DATA_IDLE 0
+#define DATA_EULER 1
+#define DATA_OFFSET 2
+#define DATA_BLOCKING 3 //a blocking transfer is using the bus, timer ticks are skipped
 
-//The constants to convert from BNO055 euler outputs to our standard degrees
-#define EULER_CONSTANT 62.5
+//Bits on the bus (including start, restart, stop and acknowledge bits) of the transactions made on each timer tick
+//Burst: S + address + register + Sr + address + 28 data bytes + P
+#define BURST_BUS_BITS (1 + 9 + 9 + 1 + 9 + BURST_LENGTH * 9 + 1)
+//Euler: S + address + register + P, then S + address + 6 data bytes + P
+#define EULER_BUS_BITS ((1 + 9 + 9 + 1) + (1 + 9 + 6 * 9 + 1))
+
+//Frequency the timer counts at, so a 16 bit timer reaches periods of 6.5 s and a 32 bit timer (TIM2, TIM5) 65 s
+#define TIMER_TICK_FREQUENCY 10000
+
+//Period at which the BNO055 updates its fusion outputs in ms. The INT pin of the BNO055 only signals motion events,
+//not new fusion data, so fresh data is detected by comparing each read with the previous one.
+#define BNO055_OUTPUT_PERIOD 10
+
+//Reads with changing data in a row before a repeated one is taken as a read that came just before the sensor's
+//update (the polling drifting across the updates), rather than a sensor at rest giving the same values again
+#define PHASE_CHANGED_RUN 8
 
 //The address used to check the calibration status of the system, gyroscope, accelerometer and magnetometer consecutively
 #define BNO055_CalibStat 0x35
 
+//The operation mode register, CONFIG mode and the times needed to switch from (19 ms) and to (7 ms) CONFIG mode
+#define BNO055_OPR_MODE 0x3D
+#define BNO055_CONFIG_MODE 0x00
+#define CONFIG_ENTER_DELAY 19
+#define CONFIG_EXIT_DELAY 7
+
+//Timeout of the blocking transfers in ms
+#define I2C_TIMEOUT 100
+
+//Address of the flash page holding the calibration profile
+#define CALIB_FLASH_ADDRESS (FLASH_BASE + (IMU_CALIB_FLASH_BANK == FLASH_BANK_2 ? FLASH_BANK_SIZE : 0) + IMU_CALIB_FLASH_PAGE * FLASH_PAGE_SIZE)
+
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------- CONSTANTS -----------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -38,6 +70,15 @@
 //The register address of the heading data for the BNO055 (following 6 registers contain data for heading, roll and pitch consecutively)
 const uint8_t headingRegisterAddress = 0x1A;
 
+//The registers published from a burst: Euler angles (0x1A-0x1F), quaternion (0x20-0x27), linear acceleration
+//(0x28-0x2D) and calibration status (0x35). They are planned into the single 28 byte read of BURST_LENGTH.
+static const uint8_t burstRegisters[] = {
+	BNO055_REG_HEADING, BNO055_REG_ROLL, BNO055_REG_PITCH,
+	BNO055_REG_QUA_W, BNO055_REG_QUA_X, BNO055_REG_QUA_Y, BNO055_REG_QUA_Z,
+	BNO055_REG_LIA_X, BNO055_REG_LIA_Y, BNO055_REG_LIA_Z,
+	BNO055_REG_CALIB_STAT
+};
+
 //The register address of the offset data for the BNO055 accelerometer X-axis LSB (following 18 registers contain data for accelerometer, magnetometer and gyroscope consecutively)
 const uint8_t accX_LSB_RegisterAddress = 0x55;
 
@@ -48,31 +89,61 @@ const uint8_t imuModeData[] = { 0x3D, 0x08 };
 //--------------------------------------------------------------------------- OBJECT MANAGEMENT ---------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+//Clock of the timers on APB1, which run at twice the bus clock when the bus is divided
+static uint32_t timerClock(void){
+	uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+	return ((RCC->CFGR2 & RCC_CFGR2_PPRE1) == RCC_HCLK_DIV1) ? pclk : 2 * pclk;
+}
+
+//Switches the operation mode with a blocking write and waits for the switch to complete
+static HAL_StatusTypeDef setOperationMode(IMU* self, uint8_t mode){
+	HAL_StatusTypeDef status = HAL_I2C_Mem_Write(self->I2cHandle, BNO055_ADDR, BNO055_OPR_MODE, I2C_MEMADD_SIZE_8BIT, &mode, 1, I2C_TIMEOUT);
+	HAL_Delay((mode == BNO055_CONFIG_MODE) ? CONFIG_ENTER_DELAY : CONFIG_EXIT_DELAY);
+	return status;
+}
+
+//Writes the calibration profile stored in flash to the sensor, which must be in CONFIG mode
+static uint8_t restoreCalibration(IMU* self){
+	uint8_t profile[BNO055_PROFILE_LENGTH];
+	if(!BNO055__unpackProfile((const uint8_t*)CALIB_FLASH_ADDRESS, profile)){
+		return 0;
+	}
+	return HAL_I2C_Mem_Write(self->I2cHandle, BNO055_ADDR, BNO055_PROFILE_REGISTER, I2C_MEMADD_SIZE_8BIT, profile, BNO055_PROFILE_LENGTH, I2C_TIMEOUT) == HAL_OK;
+}
+
 
 //Initializes the IMU object
-void IMU__init(IMU* self, I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint8_t timeBetweenSamples, volatile uint32_t* headingOutput, volatile uint32_t* rollOutput, volatile uint32_t* pitchOutput, volatile uint32_t* accX_Offset, volatile uint32_t* accY_Offset, volatile uint32_t* accZ_Offset, volatile uint32_t* magX_Offset, volatile uint32_t* magY_Offset, volatile uint32_t* magZ_Offset, volatile uint32_t* gyrX_Offset, volatile uint32_t* gyrY_Offset, volatile uint32_t* gyrZ_Offset) {
+void IMU__init(IMU* self, I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint16_t timeBetweenSamples) {
 
 	//Copy the required data to the IMU object
 	self->I2cHandle = i2cChannel;
 	self->timHandle = timChannel;
-	self->headingOutput = headingOutput;
-	self->rollOutput = rollOutput;
-	self->pitchOutput = pitchOutput;
-	self->data_flag = 0;
-	self->accX_Offset = accX_Offset;
-	self->accY_Offset = accY_Offset;
-	self->accZ_Offset = accZ_Offset;
-	self->magX_Offset = magX_Offset;
-	self->magY_Offset = magY_Offset;
-	self->magZ_Offset = magZ_Offset;
-	self->gyrX_Offset = gyrX_Offset;
-	self->gyrY_Offset = gyrY_Offset;
-	self->gyrZ_Offset = gyrZ_Offset;
+	self->data_flag = DATA_IDLE;
+	self->acquisition = IMU_ACQUISITION_BURST;
+	regmap_i2c_init(&self->bus, i2cChannel, &BNO055_REGMAP);
+	IMU__resetStats(self);
+	self->sampleLock = 0;
+	memset(&self->sample, 0, sizeof(IMU_SAMPLE));
+	self->offsetsLock = 0;
+	memset(&self->offsets, 0, sizeof(BNO055_OFFSETS));
+	self->units.angle = BNO055_ANGLE_MILLIDEGREES;
+	self->units.accel = BNO055_ACCEL_MM_PER_S2;
+	self->units.rate = BNO055_RATE_MILLIDEGREES_PER_S;
 
 	//Adjust the timer so that we get interrupts on the specified frequency
-	__HAL_TIM_SET_PRESCALER(timChannel, PRESCALAR);
-	__HAL_TIM_SET_AUTORELOAD(timChannel, APB1_FREQUENCY/(PRESCALAR+1)*timeBetweenSamples);
+	self->timerPeriod = (uint32_t)timeBetweenSamples * (TIMER_TICK_FREQUENCY / 1000);
+	self->phaseTracking = timeBetweenSamples >= BNO055_OUTPUT_PERIOD;
+	__HAL_TIM_SET_PRESCALER(timChannel, timerClock() / TIMER_TICK_FREQUENCY - 1);
+	__HAL_TIM_SET_AUTORELOAD(timChannel, self->timerPeriod - 1);
 	__HAL_TIM_SET_COUNTER(timChannel, 0);
+	memset(self->previousData, 0, sizeof(self->previousData));
+	self->changedRun = 0;
+	self->readsSinceNew = 0;
+
+	//The calibration profile can only be written in CONFIG mode, the sensor then starts fusing with it instead of
+	//calibrating from scratch
+	setOperationMode(self, BNO055_CONFIG_MODE);
+	self->calibrationRestored = restoreCalibration(self);
 
 	//Transmit the instruction to get into IMU mode
 	HAL_I2C_Master_Transmit(self->I2cHandle, BNO055_ADDR, (uint8_t *) imuModeData, 2, HAL_MAX_DELAY);
@@ -85,13 +156,21 @@ void IMU__init(IMU* self, I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timC
 	//HAL_Delay(timeBetweenSamples);
 }
 
-IMU* IMU__create(I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint8_t timeBetweenSamples, volatile uint32_t* headingOutput,  volatile uint32_t* rollOutput, volatile uint32_t* pitchOutput, volatile uint32_t* accX_Offset, volatile uint32_t* accY_Offset, volatile uint32_t* accZ_Offset, volatile uint32_t* magX_Offset, volatile uint32_t* magY_Offset, volatile uint32_t* magZ_Offset, volatile uint32_t* gyrX_Offset, volatile uint32_t* gyrY_Offset, volatile uint32_t* gyrZ_Offset) {
-	//Allocate memory for the IMU object and initialize it
-	IMU* result = (IMU*)malloc(sizeof(IMU));
-	result->inputBuffer = (uint8_t *) malloc(MAX_INPUT_BUFFER);
-	result->calibStat = (uint8_t *) malloc(1);
-	result->calibObject = (CALIBSTAT*) malloc(sizeof(CALIBSTAT));
-	IMU__init(result, i2cChannel, timChannel, timeBetweenSamples, headingOutput, rollOutput, pitchOutput, accX_Offset, accY_Offset, accZ_Offset, magX_Offset, magY_Offset, magZ_Offset, gyrX_Offset, gyrY_Offset, gyrZ_Offset);
+IMU* IMU__create(I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint16_t timeBetweenSamples) {
+	//Take the IMU object and its buffers from the pool and initialize it
+	IMU* result = (IMU*)pool_alloc(sizeof(IMU));
+	if (result == NULL) return NULL;
+	result->inputBuffer = (uint8_t *) pool_alloc(MAX_INPUT_BUFFER);
+	result->calibStat = (uint8_t *) pool_alloc(1);
+	result->calibObject = (CALIBSTAT*) pool_alloc(sizeof(CALIBSTAT));
+	if (result->inputBuffer == NULL || result->calibStat == NULL || result->calibObject == NULL) {
+		pool_free(result->inputBuffer);
+		pool_free(result->calibStat);
+		pool_free(result->calibObject);
+		pool_free(result);
+		return NULL;
+	}
+	IMU__init(result, i2cChannel, timChannel, timeBetweenSamples);
 	return result;
 }
 
@@ -99,7 +178,24 @@ IMU* IMU__create(I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, u
 //--------------------------------------------------------------------------- Calibration MANAGEMENT ----------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+//Splits the calibration status register into the calibration object
+static void decodeCalibStat(IMU* self, uint8_t calibVal){
+	self->calibObject->sysStat = (calibVal >> 6) & 0x03;
+	self->calibObject->gyrStat = (calibVal >> 4) & 0x03;
+	self->calibObject->accStat = (calibVal >> 2) & 0x03;
+	self->calibObject->magStat = (calibVal) & 0x03;
+}
+
 CALIBSTAT* BNO055_ReadCalibStat(IMU* self){
+	//The status is already read with every burst, decode the one of the latest published sample so it comes from a
+	//single read
+	if(self->acquisition == IMU_ACQUISITION_BURST){
+		IMU_SAMPLE sample;
+		IMU__getLatest(self, &sample);
+		decodeCalibStat(self, sample.calibStat);
+		return self->calibObject;
+	}
+
 	//make this have an if statement for HAL status
 //	if (self->calibStat == NULL) {
 //	    printf("Error: calibStat is NULL, allocating memory...\r\n");
@@ -117,11 +213,7 @@ CALIBSTAT* BNO055_ReadCalibStat(IMU* self){
 		//CALIBSTAT* calibObject;
 		//returnVal = (CALIBSTAT*) malloc(sizeof(CALIBSTAT));
 
-		uint8_t calibVal = *(self->calibStat);
-		self->calibObject->sysStat = (calibVal >> 6) & 0x03;
-		self->calibObject->gyrStat = (calibVal >> 4) & 0x03;
-		self->calibObject->accStat = (calibVal >> 2) & 0x03;
-		self->calibObject->magStat = (calibVal) & 0x03;
+		decodeCalibStat(self, *(self->calibStat));
 
 		/*self->calibObject->sysStat = ((uint8_t) self->calibStat >> 6) & 0x03;
 		self->calibObject->gyrStat = ((uint8_t) self->calibStat >> 4) & 0x03;
@@ -142,23 +234,156 @@ CALIBSTAT* BNO055_ReadCalibStat(IMU* self){
 		//self->calibObject->gyrStat = (calibStat >> 4) & 0x03;
 		//self->calibObject->accStat = (calibStat >> 2) & 0x03;
 		//self->calibObject->magStat = (calibStat) & 0x03;
-		return self->calibObject;
 	}
+	return self->calibObject;
 }
 
 
+HAL_StatusTypeDef IMU__saveCalibration(IMU* self){
+	uint8_t profile[BNO055_PROFILE_LENGTH];
+	//Static so its address fits the 32 bit DataAddress of HAL_FLASH_Program() on a host build too
+	static uint32_t record[BNO055_PROFILE_RECORD_SIZE / sizeof(uint32_t)];
+
+	if(self->data_flag != DATA_IDLE || regmap_i2c_isBusy(&self->bus)){
+		return HAL_BUSY;
+	}
+	self->data_flag = DATA_BLOCKING;
+
+	//The profile registers are only valid in CONFIG mode
+	HAL_StatusTypeDef status = setOperationMode(self, BNO055_CONFIG_MODE);
+	if(status == HAL_OK){
+		status = HAL_I2C_Mem_Read(self->I2cHandle, BNO055_ADDR, BNO055_PROFILE_REGISTER, I2C_MEMADD_SIZE_8BIT, profile, BNO055_PROFILE_LENGTH, I2C_TIMEOUT);
+	}
+	HAL_I2C_Master_Transmit(self->I2cHandle, BNO055_ADDR, (uint8_t *) imuModeData, 2, I2C_TIMEOUT);
+	HAL_Delay(CONFIG_EXIT_DELAY);
+	self->data_flag = DATA_IDLE;
+	if(status != HAL_OK){
+		return status;
+	}
+
+	BNO055__packProfile(profile, (uint8_t*)record);
+
+	FLASH_EraseInitTypeDef erase = {
+		.TypeErase = FLASH_TYPEERASE_PAGES,
+		.Banks = IMU_CALIB_FLASH_BANK,
+		.Page = IMU_CALIB_FLASH_PAGE,
+		.NbPages = 1
+	};
+	uint32_t pageError;
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&erase, &pageError);
+	for(uint32_t offset = 0; status == HAL_OK && offset < BNO055_PROFILE_RECORD_SIZE; offset += 16){
+		status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, CALIB_FLASH_ADDRESS + offset, (uint32_t)(uintptr_t)&record[offset / sizeof(uint32_t)]);
+	}
+	HAL_FLASH_Lock();
+	//The instruction cache also caches data read from flash and is not updated by the erase and programming, drop the
+	//record it may hold since power up
+	HAL_ICACHE_Invalidate();
+	if(status != HAL_OK){
+		return status;
+	}
+
+	//Read the record back the same way it is read at power up
+	return BNO055__unpackProfile((const uint8_t*)CALIB_FLASH_ADDRESS, profile) ? HAL_OK : HAL_ERROR;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------- DATA PARSING FUNCTIONS ---------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+//The sequence lock count is odd while a writer is updating the protected data
+static void beginWrite(volatile uint32_t* lock){
+	(*lock)++;
+	__DMB();
+}
+
+static void endWrite(volatile uint32_t* lock){
+	__DMB();
+	(*lock)++;
+}
+
+//Copies data protected by a sequence lock, retrying if the writer interrupted the copy
+static void readLocked(volatile uint32_t* lock, void* destination, const void* source, size_t size){
+	uint32_t before;
+	uint32_t after;
+	do{
+		before = *lock;
+		__DMB();
+		memcpy(destination, source, size);
+		__DMB();
+		after = *lock;
+	} while((before & 1) || before != after);
+}
+
+//Writes the Euler angles (heading, roll, pitch registers in that order) to the sample being published
+static void decodeEuler(IMU* self, const uint8_t* euler){
+	self->sample.heading = BNO055__heading(BNO055__readInt16(euler, 0), self->units.angle);
+	self->sample.roll = BNO055__angle(BNO055__readInt16(euler, 2), self->units.angle);
+	self->sample.pitch = BNO055__angle(BNO055__readInt16(euler, 4), self->units.angle);
+}
+
+//Counts a read that holds a new update of the sensor
+static uint8_t newReading(IMU* self){
+	self->readsSinceNew = 0;
+	self->freshSamples++;
+	return 1;
+}
+
+//Checks whether a read holds a new update of the sensor. Changed output registers always do, the same registers as
+//the previous read are a new update of a sensor at rest unless the read came too early to find one.
+static uint8_t isFresh(IMU* self, const uint8_t* data, uint8_t length){
+	if(memcmp(self->previousData, data, length) != 0){
+		memcpy(self->previousData, data, length);
+		if(self->changedRun < PHASE_CHANGED_RUN){
+			self->changedRun++;
+		}
+		return newReading(self);
+	}
+
+	//Polling faster than the sensor: no update within one output period of the last one
+	uint8_t early = (self->readsSinceNew + 1) * self->timerPeriod < BNO055_OUTPUT_PERIOD * (TIMER_TICK_FREQUENCY / 1000);
+	//A single repeat in a steady run of changing data: the read came before the sensor's update, so delay the
+	//following ticks by a quarter period. This settles the polling just after the sensor's updates instead of racing
+	//them. Repeats after that are a sensor at rest and leave the timer alone.
+	uint8_t missed = !early && self->changedRun >= PHASE_CHANGED_RUN;
+	self->changedRun = 0;
+	if(!early && !missed){
+		return newReading(self);
+	}
+	self->duplicates++;
+	self->readsSinceNew++;
+	if(missed && self->phaseTracking){
+		uint32_t counter = __HAL_TIM_GET_COUNTER(self->timHandle);
+		uint32_t shift = self->timerPeriod / 4;
+		__HAL_TIM_SET_COUNTER(self->timHandle, (counter > shift) ? counter - shift : 0);
+	}
+	return 0;
+}
+
+void IMU__getLatest(IMU* self, IMU_SAMPLE* sample){
+	readLocked(&self->sampleLock, sample, &self->sample, sizeof(IMU_SAMPLE));
+}
+
+void IMU__getOffsets(IMU* self, BNO055_OFFSETS* offsets){
+	readLocked(&self->offsetsLock, offsets, &self->offsets, sizeof(BNO055_OFFSETS));
+}
+
+void IMU__setUnits(IMU* self, const BNO055_UNITS* units){
+	self->units = *units;
+}
+
+void IMU__setAcquisition(IMU* self, IMU_ACQUISITION acquisition){
+	self->acquisition = acquisition;
+}
+
 void IMU__handleTxDMA(IMU* self, I2C_HandleTypeDef *I2cHandle){
 	if(self->I2cHandle->Instance == I2cHandle->Instance){
-		if(self->data_flag == 1){
+		if(self->data_flag == DATA_EULER){
 			if(HAL_I2C_Master_Receive_DMA(I2cHandle, BNO055_ADDR, self->inputBuffer, 6) != HAL_OK){
 				printf("Error: failed to receive euler data \r\n");
 			}
 		}
-		else if (self->data_flag == 2){
+		else if (self->data_flag == DATA_OFFSET){
 			if (HAL_I2C_Master_Receive_DMA(I2cHandle, BNO055_ADDR, self->inputBuffer, 18) != HAL_OK){
 				printf("Error: failed to receive offset data \r\n");
 			}
@@ -167,47 +392,137 @@ void IMU__handleTxDMA(IMU* self, I2C_HandleTypeDef *I2cHandle){
 }
 
 void IMU__handleRxDMA(IMU* self, I2C_HandleTypeDef *I2cHandle){
+	PROFILING_SCOPE(IMU_HANDLE_RX_DMA);
 	if(self->I2cHandle->Instance == I2cHandle->Instance){
-		if(self->data_flag == 1){
-			self->headingOutput[0] = (self->inputBuffer[1] << 8 | self->inputBuffer[0]) * EULER_CONSTANT;
-			self->rollOutput[0] = (self->inputBuffer[2] << 8 | self->inputBuffer[3]);
-			self->pitchOutput[0] = (self->inputBuffer[4] << 8 | self->inputBuffer[5]);
+		if(self->data_flag == DATA_EULER){
+			self->samples++;
+			if(isFresh(self, self->inputBuffer, 6)){
+				beginWrite(&self->sampleLock);
+				decodeEuler(self, self->inputBuffer);
+				self->sample.timestamp = HAL_GetTick();
+				self->sample.sequence++;
+				endWrite(&self->sampleLock);
+			}
 		}
-		else if(self->data_flag == 2){
-			self->accX_Offset[0] = (self->inputBuffer[1] << 8 | self->inputBuffer[0]) * EULER_CONSTANT;
-			self->accY_Offset[0] = (self->inputBuffer[2] << 8 | self->inputBuffer[3]) * EULER_CONSTANT;
-			self->accZ_Offset[0] = (self->inputBuffer[4] << 8 | self->inputBuffer[5]) * EULER_CONSTANT;
-			self->magX_Offset[0] = (self->inputBuffer[6] << 8 | self->inputBuffer[7]) * EULER_CONSTANT;
-			self->magY_Offset[0] = (self->inputBuffer[8] << 8 | self->inputBuffer[9]) * EULER_CONSTANT;
-			self->magZ_Offset[0] = (self->inputBuffer[10] << 8 | self->inputBuffer[11]) * EULER_CONSTANT;
-			self->gyrX_Offset[0] = (self->inputBuffer[12] << 8 | self->inputBuffer[13]) * EULER_CONSTANT;
-			self->gyrY_Offset[0] = (self->inputBuffer[14] << 8 | self->inputBuffer[15]) * EULER_CONSTANT;
-			self->gyrZ_Offset[0] = (self->inputBuffer[16] << 8 | self->inputBuffer[17]) * EULER_CONSTANT;
+		else if(self->data_flag == DATA_OFFSET){
+			beginWrite(&self->offsetsLock);
+			BNO055__decodeOffsets(self->inputBuffer, &self->units, &self->offsets);
+			endWrite(&self->offsetsLock);
 		}
-		self->data_flag = 0;
+		self->data_flag = DATA_IDLE;
+	}
+}
+
+//Completion of a burst read, called by regmap_i2c from the I2C interrupt while the plan buffer still holds the read
+static void burstComplete(void* context, HAL_StatusTypeDef status){
+	IMU* self = (IMU*)context;
+	if(status != HAL_OK){
+		self->errors++;
+		return;
+	}
+	self->samples++;
+	//The whole block read, the gravity vector and temperature included, so any new update of the sensor is seen
+	if(!isFresh(self, &self->bus.buffer[self->bus.plan.offsets[BNO055_REG_HEADING]], BURST_LENGTH)){
+		return;
+	}
+
+	beginWrite(&self->sampleLock);
+	self->sample.heading = BNO055__heading(regmap_i2c_raw(&self->bus, BNO055_REG_HEADING), self->units.angle);
+	self->sample.roll = BNO055__angle(regmap_i2c_raw(&self->bus, BNO055_REG_ROLL), self->units.angle);
+	self->sample.pitch = BNO055__angle(regmap_i2c_raw(&self->bus, BNO055_REG_PITCH), self->units.angle);
+	for(uint8_t i = 0; i < 4; i++){
+		self->sample.quaternion[i] = regmap_i2c_raw(&self->bus, BNO055_REG_QUA_W + i);
+	}
+	for(uint8_t i = 0; i < 3; i++){
+		self->sample.linearAccel[i] = BNO055__accel(regmap_i2c_raw(&self->bus, BNO055_REG_LIA_X + i), self->units.accel);
+	}
+	self->sample.calibStat = regmap_i2c_raw(&self->bus, BNO055_REG_CALIB_STAT);
+	self->sample.timestamp = HAL_GetTick();
+	self->sample.sequence++;
+	endWrite(&self->sampleLock);
+}
+
+void IMU__handleMemRxDMA(IMU* self, I2C_HandleTypeDef *I2cHandle){
+	PROFILING_SCOPE(IMU_HANDLE_MEM_RX_DMA);
+	regmap_i2c_handleRxCplt(&self->bus, I2cHandle);
+}
+
+void IMU__handleError(IMU* self, I2C_HandleTypeDef *I2cHandle){
+	//A burst read is dropped (and counted) by burstComplete()
+	if(regmap_i2c_handleError(&self->bus, I2cHandle)){
+		return;
+	}
+	if(self->I2cHandle->Instance == I2cHandle->Instance && self->data_flag != DATA_IDLE){
+		self->errors++;
+		self->data_flag = DATA_IDLE;
 	}
 }
 
 void IMU__updateBuffer(IMU* self, TIM_HandleTypeDef* timChannel){
 	if(self->timHandle->Instance == timChannel->Instance){
-		if(self->data_flag == 0){
+		if(self->data_flag != DATA_IDLE || regmap_i2c_isBusy(&self->bus)){
+			self->skippedTicks++;
+		}
+		else if(self->acquisition == IMU_ACQUISITION_BURST){
+			//The registers are planned into a single transaction, completed in HAL_I2C_MemRxCpltCallback()
+			if(regmap_i2c_read(&self->bus, burstRegisters, sizeof(burstRegisters), burstComplete, self) != HAL_OK){
+				self->errors++;
+			}
+		}
+		else{
 			if(HAL_I2C_Master_Transmit_DMA(self->I2cHandle, BNO055_ADDR, (uint8_t *) &headingRegisterAddress, 1) != HAL_OK){
 				printf("Error: failed to transmit signal for euler data \r\n");
+				self->errors++;
 			}
 			else{
-				self->data_flag = 1;
+				self->data_flag = DATA_EULER;
 			}
 		}
 	}
 }
 
+void IMU__resetStats(IMU* self){
+	self->samples = 0;
+	self->freshSamples = 0;
+	self->duplicates = 0;
+	self->skippedTicks = 0;
+	self->errors = 0;
+	self->statsStartTick = HAL_GetTick();
+}
+
+void IMU__getStats(IMU* self, IMU_STATS* stats){
+	uint32_t elapsed = HAL_GetTick() - self->statsStartTick;
+	stats->samples = self->samples;
+	stats->duplicates = self->duplicates;
+	stats->skippedTicks = self->skippedTicks;
+	stats->errors = self->errors;
+	stats->sampleRate = 0;
+	stats->effectiveRate = 0;
+	stats->busOccupancy = 0;
+	if(elapsed == 0){
+		return;
+	}
+	stats->sampleRate = (uint64_t)stats->samples * 100000 / elapsed;
+	stats->effectiveRate = (uint64_t)self->freshSamples * 100000 / elapsed;
+
+	//SCL period from the prescaler and the low and high periods of the timing register, in ns
+	uint32_t timing = self->I2cHandle->Init.Timing;
+	uint32_t prescaler = ((timing >> 28) & 0x0F) + 1;
+	uint32_t sclCycles = ((timing & 0xFF) + 1) + (((timing >> 8) & 0xFF) + 1);
+	uint64_t sclPeriod = (uint64_t)prescaler * sclCycles * 1000000000 / HAL_RCC_GetPCLK1Freq();
+
+	uint32_t bits = (self->acquisition == IMU_ACQUISITION_BURST) ? BURST_BUS_BITS : EULER_BUS_BITS;
+	uint64_t busyNs = (uint64_t)stats->samples * bits * sclPeriod;
+	stats->busOccupancy = busyNs / ((uint64_t)elapsed * 1000);
+}
+
 void IMU_getOffset(IMU* self){
-	if(self->data_flag == 0){
+	if(self->data_flag == DATA_IDLE && !regmap_i2c_isBusy(&self->bus)){
 		if(HAL_I2C_Master_Transmit_DMA(self->I2cHandle, BNO055_ADDR, (uint8_t *) &accX_LSB_RegisterAddress, 1) != HAL_OK){
 			printf("Error: failed to transmit signal for offset data \r\n");
 		}
 		else{
-			self->data_flag = 2;
+			self->data_flag = DATA_OFFSET;
 		}
 	}
 }
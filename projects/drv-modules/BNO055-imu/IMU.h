@@ -2,11 +2,19 @@
  * This library provides an interface to communicate between the microcontroller and a BNO055 IMU.
  * It currently has the following functionality:
  *		-Initialize the IMU for use
- *		-Read the heading
+ *		-Read the heading, roll and pitch as signed fixed point values
+ *		-Publish every read as one consistent sample that can be copied at any time without masking interrupts
+ *		-Read the Euler angles, quaternion, linear acceleration and calibration status in one I2C transaction per sample
+ *		-Report the achieved sample rate, the duplicate reads and the I2C bus occupancy
+ *		-Only publish reads that contain a new update of the sensor (unchanged data at rest included), and keep the
+ *		polling just after the sensor's updates
+ *		-Save the calibration profile to flash and restore it at power up
  *
  * For this library to work as intended:
- * 		"IMU__handleTxDMA()" must be called inside "HAL_I2C_MasterTxCpltCallback()"
- * 		"IMU__handleRxDMA()" must be called inside "HAL_I2C_MasterRxCpltCallback()"
+ * 		"IMU__handleMemRxDMA()" must be called inside "HAL_I2C_MemRxCpltCallback()"
+ * 		"IMU__handleError()" must be called inside "HAL_I2C_ErrorCallback()"
+ * 		"IMU__handleTxDMA()" must be called inside "HAL_I2C_MasterTxCpltCallback()" (IMU_ACQUISITION_EULER and IMU_getOffset())
+ * 		"IMU__handleRxDMA()" must be called inside "HAL_I2C_MasterRxCpltCallback()" (IMU_ACQUISITION_EULER and IMU_getOffset())
  * 		"IMU__updateBuffer()" must be called inside "HAL_TIM_PeriodElapsedCallback()"
  * 		"HAL_TIM_Base_Start_IT()" must be called immediately after creating the IMU object with the
  * 		timer channel handle pointer used in the creation of the IMU object as a parameter.
@@ -27,11 +35,49 @@
  //----------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 #include "stm32u5xx_hal.h"
+#include "BNO055.h"
+#include "regmap_i2c.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Number of registers read by a burst, from the Euler angles (0x1A) to the calibration status (0x35)
+#define IMU_BURST_LENGTH 28
+
+//Flash page holding the calibration profile, the last page of bank 2 by default. The FLASH linker scripts of the
+//controller projects keep it out of the FLASH region (IMU_CALIB region), move that region with these.
+#ifndef IMU_CALIB_FLASH_BANK
+#define IMU_CALIB_FLASH_BANK FLASH_BANK_2
+#endif
+#ifndef IMU_CALIB_FLASH_PAGE
+#define IMU_CALIB_FLASH_PAGE (FLASH_PAGE_NB - 1)
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+//How the data is read on every timer tick
+typedef enum {
+	//One memory read of the whole block from the Euler angles (0x1A) to the calibration status (0x35), planned by
+	//regmap_i2c from BNO055_REGMAP
+	IMU_ACQUISITION_BURST,
+	//A register address write followed by a separate read of the Euler angles only
+	IMU_ACQUISITION_EULER
+} IMU_ACQUISITION;
+
+//Acquisition statistics since the last call to IMU__resetStats()
+typedef struct {
+	uint32_t samples; //completed reads
+	uint32_t duplicates; //reads that came before the sensor's next update and returned the previous data again
+	uint32_t skippedTicks; //timer ticks where the previous read had not completed yet
+	uint32_t errors; //reads that failed to start or were aborted by an I2C error
+	uint32_t sampleRate; //completed reads per second in 0.01 Hz
+	uint32_t effectiveRate; //reads holding a new update of the sensor per second in 0.01 Hz, the rate of the published samples
+	uint32_t busOccupancy; //fraction of the time the I2C bus was used by the reads in 0.1 %
+} IMU_STATS;
+
 //The CALIBSTAT data type
 typedef struct {
 	volatile uint8_t sysStat;
@@ -40,29 +86,62 @@ typedef struct {
 	volatile uint8_t magStat;
 } CALIBSTAT;
 
+//A consistent snapshot of one read of the sensor, copied with IMU__getLatest()
+typedef struct {
+	int32_t heading; //in the angle unit (millidegrees by default), 0 is north and increasing clockwise
+	int32_t roll; //in the angle unit
+	int32_t pitch; //in the angle unit
+	int16_t quaternion[4]; //w, x, y, z with BNO055_QUATERNION_ONE = 1 (burst acquisition only)
+	int32_t linearAccel[3]; //x, y, z in the acceleration unit (burst acquisition only)
+	uint8_t calibStat; //raw calibration status register (burst acquisition only), decode it with the IMU_CALIB_* macros
+	uint32_t timestamp; //HAL_GetTick() when the read completed
+	uint32_t sequence; //incremented on every sample, used to detect new samples
+} IMU_SAMPLE;
+
+//Calibration levels (0 to 3) of the system and the three sensors in IMU_SAMPLE.calibStat
+#define IMU_CALIB_SYS(calibStat) (((calibStat) >> 6) & 0x03)
+#define IMU_CALIB_GYR(calibStat) (((calibStat) >> 4) & 0x03)
+#define IMU_CALIB_ACC(calibStat) (((calibStat) >> 2) & 0x03)
+#define IMU_CALIB_MAG(calibStat) ((calibStat) & 0x03)
+
 //The IMU data type
 typedef struct {
 	I2C_HandleTypeDef* I2cHandle;
 	TIM_HandleTypeDef* timHandle;
-	//allocated memory to store euler angle data output
-	volatile uint32_t * headingOutput;
-	volatile uint32_t * rollOutput;
-	volatile uint32_t * pitchOutput;
 	uint8_t * inputBuffer;
 	uint8_t * calibStat;
 	CALIBSTAT* calibObject;
-	//flag determining whether reading euler data or offset data
+	//flag determining whether reading euler data or offset data, the burst reads are tracked by bus
 	uint8_t data_flag;
-	//allocated memory to store offset data output
-	volatile uint32_t * accX_Offset;
-	volatile uint32_t * accY_Offset;
-	volatile uint32_t * accZ_Offset;
-	volatile uint32_t * magX_Offset;
-	volatile uint32_t * magY_Offset;
-	volatile uint32_t * magZ_Offset;
-	volatile uint32_t * gyrX_Offset;
-	volatile uint32_t * gyrY_Offset;
-	volatile uint32_t * gyrZ_Offset;
+	//register map reads of the burst acquisition
+	REGMAP_I2C bus;
+	IMU_ACQUISITION acquisition;
+	//timer period in timer ticks, and whether duplicate reads shift the polling phase
+	uint32_t timerPeriod;
+	uint8_t phaseTracking;
+	//output registers of the previous read, used to detect duplicates, the reads with changed data in a row (up to
+	//the run that makes a repeat a missed update) and the reads since the last new update
+	uint8_t previousData[IMU_BURST_LENGTH];
+	uint8_t changedRun;
+	uint8_t readsSinceNew;
+	//1 if a calibration profile was restored from flash at power up
+	uint8_t calibrationRestored;
+	//units of the published samples and offsets
+	BNO055_UNITS units;
+	//latest sample, written from the I2C interrupt and published with a sequence lock: the count is odd while the
+	//sample is being written. Read it with IMU__getLatest().
+	volatile uint32_t sampleLock;
+	IMU_SAMPLE sample;
+	//latest offsets, published the same way, read them with IMU__getOffsets()
+	volatile uint32_t offsetsLock;
+	BNO055_OFFSETS offsets;
+	//acquisition statistics
+	volatile uint32_t samples;
+	volatile uint32_t freshSamples;
+	volatile uint32_t duplicates;
+	volatile uint32_t skippedTicks;
+	volatile uint32_t errors;
+	uint32_t statsStartTick;
 } IMU;
 
 
@@ -71,28 +150,68 @@ typedef struct {
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 /*
- * Creates a new IMU object.
+ * Creates a new IMU object. If a calibration profile was saved with IMU__saveCalibration(), it is written to the
+ * sensor in CONFIG mode before switching to the fusion mode (see calibrationRestored).
  *
  * @param i2cChannel The I2C Handle of the I2C peripheral to be used. Must be set up to be compatible with the BNO055.
  * @param timChannel The timer channel to be used with this peripheral. This is used to create an interrupt
  * 			for the periodic calling for data from the sensor.
- * @param timeBetweenSamples The time in ms between sample collection from the sensor.
- * @param headingOutput Points to a location in memory where the heading is automatically updated. It is in the format
- * 			of heading * 1000 in degrees where 0 is north and increasing in the CW direction. It will be modified
- * 			whenever new sensor data is received at any point in time.
+ * @param timeBetweenSamples The time in ms between sample collection from the sensor, up to 6553 ms with a 16 bit timer.
+ * 			The BNO055 updates its outputs every 10 ms, reads that come before its next update are counted as
+ * 			duplicates and not published. Identical data from a sensor at rest is still published. With a period of
+ * 			10 ms or more the polling phase is adjusted after a duplicate that interrupts changing data.
  */
-IMU* IMU__create(I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint8_t timeBetweenSamples, volatile uint32_t* headingOutput, volatile uint32_t* rollOutput, volatile uint32_t* pitchOutput, volatile uint32_t* accX_Offset, volatile uint32_t* accY_Offset, volatile uint32_t* accZ_Offset, volatile uint32_t* magX_Offset, volatile uint32_t* magY_Offset, volatile uint32_t* magZ_Offset, volatile uint32_t* gyrX_Offset, volatile uint32_t* gyrY_Offset, volatile uint32_t* gyrZ_Offset);
+IMU* IMU__create(I2C_HandleTypeDef* i2cChannel, TIM_HandleTypeDef* timChannel, uint16_t timeBetweenSamples);
+
+/*
+ * Copies the latest sample. The copy is always from a single read of the sensor, even if a new sample is
+ * written by the I2C interrupt during the copy, and interrupts are never masked. This must not be called from an
+ * interrupt that can preempt the I2C interrupt.
+ *
+ * @param self The IMU object
+ * @param sample Receives the sample, its sequence is 0 until the first read completes
+ */
+void IMU__getLatest(IMU* self, IMU_SAMPLE* sample);
+
+/*
+ * Copies the offsets read by the last IMU_getOffset() request.
+ *
+ * @param self The IMU object
+ * @param offsets Receives the offsets, each converted with the unit of its sensor
+ */
+void IMU__getOffsets(IMU* self, BNO055_OFFSETS* offsets);
+
+/*
+ * Selects the units of the samples and offsets published from now on. The default is millidegrees, mm/s^2 and
+ * millidegrees per second. The conversions are done with integer arithmetic in the I2C interrupt.
+ *
+ * @param self The IMU object
+ * @param units The output units
+ */
+void IMU__setUnits(IMU* self, const BNO055_UNITS* units);
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------- IMU CALIBRATION -----------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-/* This function should be called when reading the calibration status for the system and three internal sensors
- *  @param reg is the calibration register 0x35
+/* This function should be called when reading the calibration status for the system and three internal sensors.
+ * In IMU_ACQUISITION_BURST mode the status is read with every sample, so this decodes the one of the latest sample
+ * (see IMU__getLatest()) without accessing the bus. Otherwise it does a blocking read of the calibration register 0x35.
+ * Like IMU__getLatest(), this must not be called from an interrupt that can preempt the I2C interrupt.
  */
 CALIBSTAT* BNO055_ReadCalibStat(IMU* self);
 
 
+/*
+ * Saves the sensor's current calibration profile (offsets and radii) to flash, so it is written back to the sensor
+ * by IMU__create() at the next power up. This should be called once the calibration status shows the sensors are
+ * fully calibrated. It blocks for about 30 ms plus the page erase time and pauses the acquisition meanwhile.
+ *
+ * @param self The IMU object
+ * @return HAL_OK if the profile was read and stored, HAL_BUSY if a read was in progress (try again later)
+ */
+HAL_StatusTypeDef IMU__saveCalibration(IMU* self);
+
 /* This function should be called to manually write to the offset registers
  *
  */
@@ -104,6 +223,50 @@ CALIBSTAT* BNO055_ReadCalibStat(IMU* self);
 //----------------------------------------------------------------------------- IMU METHODS -------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+/*
+ * Selects how the data is read on every timer tick. IMU_ACQUISITION_BURST is the default.
+ *
+ * @param self The IMU object
+ * @param acquisition The acquisition mode
+ */
+void IMU__setAcquisition(IMU* self, IMU_ACQUISITION acquisition);
+
+/*
+ * This function should be called when there is a I2C DMA memory read callback associated with this IMU sensor.
+ * It will check that the I2C handle of the interrupt matches that of the IMU and then update the outputs
+ * from the burst read.
+ *
+ * @param self The IMU object being read
+ * @param I2cHandle is the I2C handle of the interrupt
+ */
+void IMU__handleMemRxDMA(IMU* self, I2C_HandleTypeDef *I2cHandle);
+
+/*
+ * This function should be called when there is an I2C error callback. It drops the read in progress so the next
+ * timer tick starts a new one.
+ *
+ * @param self The IMU object
+ * @param I2cHandle is the I2C handle of the interrupt
+ */
+void IMU__handleError(IMU* self, I2C_HandleTypeDef *I2cHandle);
+
+/*
+ * Computes the achieved sample rate and I2C bus occupancy since the last call to IMU__resetStats(). The bus
+ * occupancy is estimated from the number of bits of each transaction and the SCL period set in the I2C timing
+ * register, assuming the I2C kernel clock is PCLK1.
+ *
+ * @param self The IMU object
+ * @param stats Receives the statistics
+ */
+void IMU__getStats(IMU* self, IMU_STATS* stats);
+
+/*
+ * Clears the acquisition statistics.
+ *
+ * @param self The IMU object
+ */
+void IMU__resetStats(IMU* self);
+
 /*
  * This function should be called when there is a I2C DMA transmit callback associated with this IMU sensor.
  * It will check that the I2C handle of the interrupt matches that of the IMU and then respond accordingly.
@@ -136,7 +299,7 @@ void IMU__updateBuffer(IMU* self, TIM_HandleTypeDef* timChannel);
 
 /*
  * This function should be called when there is an interrupt pushed manually to request for offset data
- * It will read and save the offset values for recalibration after power off
+ * It will read and save the offset values for recalibration after power off, get them with IMU__getOffsets()
  *
  * @param self The IMU object that should be updated
  */
@@ -0,0 +1,280 @@
+/*
+ * NMEA.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "NMEA.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- PRIVATE MACROS ------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Parser states
+#define NMEA_WAIT_START 0	//waiting for '$'
+#define NMEA_BODY 1			//collecting characters until '*'
+#define NMEA_CHECKSUM_HI 2	//waiting for the first checksum digit
+#define NMEA_CHECKSUM_LO 3	//waiting for the second checksum digit
+
+//Fields of the MWV sentence: $--MWV,<angle>,<R|T>,<speed>,<unit>,<status>*hh
+#define MWV_ANGLE_FIELD 1
+#define MWV_REFERENCE_FIELD 2
+#define MWV_SPEED_FIELD 3
+#define MWV_UNIT_FIELD 4
+#define MWV_STATUS_FIELD 5
+
+//Fields of the XDR sentence: $--XDR,<type>,<value>,<unit>,<name>,...*hh
+#define XDR_TYPE_FIELD 1
+#define XDR_VALUE_FIELD 2
+#define XDR_UNIT_FIELD 3
+
+//Speed unit conversions to knots, as a ratio over SPEED_SCALE
+#define SPEED_SCALE 10000
+#define METERS_PER_SECOND_TO_KNOTS 19438	//1.943844
+#define KILOMETERS_PER_HOUR_TO_KNOTS 5400	//0.539957
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Converts a hexadecimal digit to its value, returns 0xFF if it is not a hexadecimal digit
+static uint8_t hexValue(uint8_t c){
+	if(c >= '0' && c <= '9'){
+		return c - '0';
+	}
+	if(c >= 'A' && c <= 'F'){
+		return c - 'A' + 10;
+	}
+	if(c >= 'a' && c <= 'f'){
+		return c - 'a' + 10;
+	}
+	return 0xFF;
+}
+
+//Drops the sentence in progress and waits for the next '$'
+static void abortSentence(NMEA_PARSER* self){
+	self->framingErrors++;
+	self->state = NMEA_WAIT_START;
+	self->fieldCount = 0;
+}
+
+//Starts a new sentence, invalidating the fields of the previous one
+static void startSentence(NMEA_PARSER* self){
+	self->state = NMEA_BODY;
+	self->checksum = 0;
+	self->length = 0;
+	self->fieldCount = 0;
+	self->fieldStart[0] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------- NMEA METHODS --------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void NMEA__init(NMEA_PARSER* self){
+	self->state = NMEA_WAIT_START;
+	self->checksum = 0;
+	self->received = 0;
+	self->length = 0;
+	self->fieldCount = 0;
+	self->buffer[0] = '\0';
+	self->sentenceCount = 0;
+	self->checksumErrors = 0;
+	self->framingErrors = 0;
+}
+
+uint8_t NMEA__feed(NMEA_PARSER* self, uint8_t byte){
+	//A '$' always starts a new sentence, even in the middle of another one.
+	//Fields are only exposed while waiting for the next sentence, so starting one hides the previous fields.
+	if(byte == '$'){
+		if(self->state != NMEA_WAIT_START){
+			self->framingErrors++;
+		}
+		startSentence(self);
+		return 0;
+	}
+
+	switch(self->state){
+	case NMEA_BODY:
+		if(byte == '*'){
+			self->buffer[self->length] = '\0';
+			self->state = NMEA_CHECKSUM_HI;
+		}
+		else if(byte < 0x20 || byte > 0x7E || self->length >= NMEA_MAX_SENTENCE){
+			//Control characters (CR/LF before the checksum), binary noise or an overlong sentence
+			abortSentence(self);
+		}
+		else if(byte == ','){
+			if(self->fieldCount + 1 >= NMEA_MAX_FIELDS){
+				abortSentence(self);
+				break;
+			}
+			self->checksum ^= byte;
+			self->buffer[self->length++] = '\0';
+			self->fieldStart[++self->fieldCount] = self->length;
+		}
+		else{
+			self->checksum ^= byte;
+			self->buffer[self->length++] = byte;
+		}
+		break;
+
+	case NMEA_CHECKSUM_HI:
+		if(hexValue(byte) == 0xFF){
+			abortSentence(self);
+			break;
+		}
+		self->received = hexValue(byte) << 4;
+		self->state = NMEA_CHECKSUM_LO;
+		break;
+
+	case NMEA_CHECKSUM_LO:
+		if(hexValue(byte) == 0xFF){
+			abortSentence(self);
+			break;
+		}
+		self->state = NMEA_WAIT_START;
+		self->received |= hexValue(byte);
+		if(self->received != self->checksum){
+			self->checksumErrors++;
+			self->fieldCount = 0;
+			break;
+		}
+		//The field count was tracking the index of the last field
+		self->fieldCount++;
+		self->sentenceCount++;
+		return 1;
+
+	default:
+		//Anything between sentences (CR, LF, noise) is ignored
+		break;
+	}
+
+	return 0;
+}
+
+const char* NMEA__field(const NMEA_PARSER* self, uint8_t index){
+	if(self->state != NMEA_WAIT_START || index >= self->fieldCount){
+		return "";
+	}
+	return &self->buffer[self->fieldStart[index]];
+}
+
+uint8_t NMEA__fieldLength(const NMEA_PARSER* self, uint8_t index){
+	if(self->state != NMEA_WAIT_START || index >= self->fieldCount){
+		return 0;
+	}
+	if(index + 1 < self->fieldCount){
+		return self->fieldStart[index + 1] - self->fieldStart[index] - 1;
+	}
+	return self->length - self->fieldStart[index];
+}
+
+uint8_t NMEA__isSentence(const NMEA_PARSER* self, const char* formatter){
+	//The address field is a two character talker identifier followed by the three character formatter
+	if(NMEA__fieldLength(self, 0) != 5){
+		return 0;
+	}
+	const char* address = NMEA__field(self, 0);
+	return address[2] == formatter[0] && address[3] == formatter[1] && address[4] == formatter[2];
+}
+
+uint8_t NMEA__parseFixed(const char* field, uint8_t decimals, int32_t* value){
+	uint8_t negative = 0;
+	uint8_t digits = 0;
+	int8_t fraction = -1;	//number of decimal digits consumed, -1 before the decimal point
+	uint32_t result = 0;
+
+	if(*field == '-' || *field == '+'){
+		negative = (*field == '-');
+		field++;
+	}
+
+	for(; *field != '\0'; field++){
+		if(*field == '.' && fraction < 0){
+			fraction = 0;
+		}
+		else if(*field >= '0' && *field <= '9'){
+			if(fraction >= decimals){
+				//Truncate the digits beyond the requested resolution
+				continue;
+			}
+			if(result > (INT32_MAX - 9) / 10){
+				return 0;
+			}
+			result = result * 10 + (*field - '0');
+			digits++;
+			if(fraction >= 0){
+				fraction++;
+			}
+		}
+		else{
+			return 0;
+		}
+	}
+	if(digits == 0){
+		return 0;
+	}
+
+	//Pad the missing decimal places
+	for(fraction = (fraction < 0) ? 0 : fraction; fraction < decimals; fraction++){
+		if(result > INT32_MAX / 10){
+			return 0;
+		}
+		result *= 10;
+	}
+
+	*value = negative ? -(int32_t)result : (int32_t)result;
+	return 1;
+}
+
+uint8_t NMEA__decodeMWV(const NMEA_PARSER* self, NMEA_MWV* mwv){
+	int32_t angle, speed;
+
+	if(!NMEA__isSentence(self, "MWV")){
+		return 0;
+	}
+	if(!NMEA__parseFixed(NMEA__field(self, MWV_ANGLE_FIELD), 1, &angle) || angle < 0 || angle > 3600){
+		return 0;
+	}
+	if(!NMEA__parseFixed(NMEA__field(self, MWV_SPEED_FIELD), 2, &speed) || speed < 0){
+		return 0;
+	}
+
+	switch(NMEA__field(self, MWV_UNIT_FIELD)[0]){
+	case 'N':
+		break;
+	case 'M':
+		speed = ((int64_t)speed * METERS_PER_SECOND_TO_KNOTS + SPEED_SCALE / 2) / SPEED_SCALE;
+		break;
+	case 'K':
+		speed = ((int64_t)speed * KILOMETERS_PER_HOUR_TO_KNOTS + SPEED_SCALE / 2) / SPEED_SCALE;
+		break;
+	default:
+		return 0;
+	}
+	if(speed > UINT16_MAX){
+		return 0;
+	}
+
+	mwv->angle = (angle == 3600) ? 0 : angle;
+	mwv->reference = NMEA__field(self, MWV_REFERENCE_FIELD)[0];
+	mwv->speed = speed;
+	mwv->valid = (NMEA__field(self, MWV_STATUS_FIELD)[0] == 'A');
+	return 1;
+}
+
+uint8_t NMEA__decodeXDRTemperature(const NMEA_PARSER* self, int16_t* temperature){
+	int32_t value;
+
+	if(!NMEA__isSentence(self, "XDR") || NMEA__field(self, XDR_TYPE_FIELD)[0] != 'C' || NMEA__field(self, XDR_UNIT_FIELD)[0] != 'C'){
+		return 0;
+	}
+	if(!NMEA__parseFixed(NMEA__field(self, XDR_VALUE_FIELD), 1, &value) || value < INT16_MIN || value > INT16_MAX){
+		return 0;
+	}
+
+	*temperature = value;
+	return 1;
+}
@@ -0,0 +1,148 @@
+/*
+ * This library provides a streaming NMEA 0183 sentence parser. It does not depend on the HAL so it can be
+ * used by any UART driver and tested on a host machine.
+ * It currently has the following functionality:
+ *		-Byte-driven framing of "$...*hh" sentences in any order, with resynchronization on a new '$'
+ *		-Validation of the "*hh" checksum
+ *		-In place tokenization of the sentence into comma separated fields
+ *		-Fixed point decoding of numeric fields and of the MWV (wind) and XDR (transducer) sentences
+ *
+ * Bytes are fed one at a time with "NMEA__feed()". When it returns 1, a complete sentence with a valid
+ * checksum is available and its fields can be accessed with "NMEA__field()" until the next '$' is fed.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef NMEA_H
+#define NMEA_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Maximum number of characters between '$' and '*' (the NMEA 0183 limit is 82 characters including "$", "*hh" and CRLF)
+#define NMEA_MAX_SENTENCE 80
+
+//Maximum number of comma separated fields in a sentence (including the address field)
+#define NMEA_MAX_FIELDS 24
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//The NMEA parser data type
+typedef struct {
+	uint8_t state;
+	//running XOR of the characters between '$' and '*'
+	uint8_t checksum;
+	//checksum received after '*'
+	uint8_t received;
+	uint8_t length;
+	uint8_t fieldCount;
+	//offset of the first character of each field in buffer
+	uint8_t fieldStart[NMEA_MAX_FIELDS];
+	//sentence body, with every ',' replaced by '\0' so that each field is a string
+	char buffer[NMEA_MAX_SENTENCE + 1];
+	//statistics
+	uint32_t sentenceCount;
+	uint32_t checksumErrors;
+	uint32_t framingErrors;
+} NMEA_PARSER;
+
+//Decoded wind speed and angle ($--MWV)
+typedef struct {
+	//wind angle in 0.1 degrees, 0 to 3599
+	uint16_t angle;
+	//'R' for relative to the bow, 'T' for theoretical (true)
+	char reference;
+	//wind speed in 0.01 knots, converted from the unit of the sentence
+	uint16_t speed;
+	//1 if the sensor flagged the data as valid ('A')
+	uint8_t valid;
+} NMEA_MWV;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------- NMEA METHODS --------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Resets the parser and clears its statistics.
+ *
+ * @param self The parser to initialize
+ */
+void NMEA__init(NMEA_PARSER* self);
+
+/*
+ * Feeds a single received byte into the parser.
+ *
+ * @param self The parser
+ * @param byte The received byte
+ * @return 1 if this byte completed a sentence with a valid checksum, 0 otherwise
+ */
+uint8_t NMEA__feed(NMEA_PARSER* self, uint8_t byte);
+
+/*
+ * Returns a field of the last completed sentence. Field 0 is the address field (e.g. "IIMWV").
+ *
+ * @param self The parser
+ * @param index The index of the field
+ * @return The field as a null terminated string, or an empty string if the field does not exist
+ */
+const char* NMEA__field(const NMEA_PARSER* self, uint8_t index);
+
+/*
+ * Returns the number of characters in a field of the last completed sentence.
+ *
+ * @param self The parser
+ * @param index The index of the field
+ * @return The length of the field, 0 if the field is empty or does not exist
+ */
+uint8_t NMEA__fieldLength(const NMEA_PARSER* self, uint8_t index);
+
+/*
+ * Checks the sentence formatter of the last completed sentence, ignoring the talker identifier.
+ *
+ * @param self The parser
+ * @param formatter The three character sentence formatter (e.g. "MWV")
+ * @return 1 if the sentence matches, 0 otherwise
+ */
+uint8_t NMEA__isSentence(const NMEA_PARSER* self, const char* formatter);
+
+/*
+ * Parses a decimal field (e.g. "-012.34") directly into a fixed point integer. Extra decimal digits are
+ * truncated and missing ones are taken as zero, so "2.4" with 2 decimals gives 240.
+ *
+ * @param field The field to parse
+ * @param decimals The number of decimal places of the result
+ * @param value Receives the field value multiplied by 10^decimals
+ * @return 1 if the field is a valid number that fits in 32 bits, 0 otherwise
+ */
+uint8_t NMEA__parseFixed(const char* field, uint8_t decimals, int32_t* value);
+
+/*
+ * Decodes the last completed sentence as a wind speed and angle sentence ($--MWV).
+ *
+ * @param self The parser
+ * @param mwv Receives the decoded sentence
+ * @return 1 if the sentence is an MWV sentence with a valid angle, speed and unit, 0 otherwise
+ */
+uint8_t NMEA__decodeMWV(const NMEA_PARSER* self, NMEA_MWV* mwv);
+
+/*
+ * Decodes the last completed sentence as a temperature transducer measurement ($--XDR,C,<value>,C,...).
+ * Only the first measurement of the sentence is decoded.
+ *
+ * @param self The parser
+ * @param temperature Receives the temperature in 0.1 degrees Celsius
+ * @return 1 if the sentence is an XDR temperature measurement, 0 otherwise
+ */
+uint8_t NMEA__decodeXDRTemperature(const NMEA_PARSER* self, int16_t* temperature);
+
+#endif /* NMEA_H */
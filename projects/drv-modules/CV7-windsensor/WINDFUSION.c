@@ -0,0 +1,168 @@
+/*
+ * WINDFUSION.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "WINDFUSION.h"
+#include "fixed_trig.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- PRIVATE MACROS ------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Extra fractional bits kept on the wind vector components so that light winds keep their angle resolution
+#define VECTOR_SHIFT 8
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Ring position of the n-th oldest attitude
+static const WINDFUSION_ATTITUDE* attitudeAt(const WINDFUSION* self, uint8_t n){
+	return &self->history[(self->head + n) % WINDFUSION_HISTORY];
+}
+
+static int32_t interpolate(int32_t from, int32_t to, uint32_t elapsed, uint32_t span){
+	return from + (int32_t)(((int64_t)(to - from) * elapsed + span / 2) / span);
+}
+
+//Finds the attitude at the given time, interpolating between the attitudes on either side of it
+static uint8_t attitudeAtTime(const WINDFUSION* self, uint32_t time, WINDFUSION_ATTITUDE* attitude){
+	if(self->count == 0){
+		return 0;
+	}
+
+	//Times are compared relative to the newest attitude so the tick counter may wrap
+	const WINDFUSION_ATTITUDE* newest = attitudeAt(self, self->count - 1);
+	int32_t age = (int32_t)(newest->timestamp - time);
+	if(age <= 0){
+		*attitude = *newest;
+		return (uint32_t)-age <= self->attitudeTimeoutMs;
+	}
+
+	for(int8_t n = self->count - 2; n >= 0; n--){
+		const WINDFUSION_ATTITUDE* before = attitudeAt(self, n);
+		uint32_t elapsed = time - before->timestamp;
+		if((int32_t)elapsed < 0){
+			continue;
+		}
+		const WINDFUSION_ATTITUDE* after = attitudeAt(self, n + 1);
+		uint32_t span = after->timestamp - before->timestamp;
+		if(span == 0){
+			*attitude = *after;
+			return 1;
+		}
+		attitude->timestamp = time;
+		attitude->heading = fixed_wrap(interpolate(0, fixed_wrapSigned(after->heading - before->heading), elapsed, span) + before->heading);
+		attitude->roll = interpolate(before->roll, after->roll, elapsed, span);
+		attitude->pitch = interpolate(before->pitch, after->pitch, elapsed, span);
+		return 1;
+	}
+
+	//Older than the whole history, so the oldest attitude is the closest one
+	*attitude = *attitudeAt(self, 0);
+	return (uint32_t)(attitude->timestamp - time) <= self->attitudeTimeoutMs;
+}
+
+//Cosine of a tilt angle used to undo its projection, limited to WINDFUSION_MAX_TILT
+static int32_t tiltCos(int16_t tilt){
+	int32_t magnitude = (tilt < 0) ? -tilt : tilt;
+	return fixed_cos((magnitude > WINDFUSION_MAX_TILT) ? WINDFUSION_MAX_TILT : magnitude);
+}
+
+static uint16_t vectorSpeed(int32_t x, int32_t y){
+	uint32_t speed = (fixed_sqrt((int64_t)x * x + (int64_t)y * y) + (1 << (VECTOR_SHIFT - 1))) >> VECTOR_SHIFT;
+	return (speed > UINT16_MAX) ? UINT16_MAX : speed;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------- WINDFUSION METHODS ---------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void WINDFUSION__init(WINDFUSION* self, uint32_t latencyMs, uint32_t attitudeTimeoutMs, uint32_t boatSpeedTimeoutMs){
+	self->latencyMs = latencyMs;
+	self->attitudeTimeoutMs = attitudeTimeoutMs;
+	self->boatSpeedTimeoutMs = boatSpeedTimeoutMs;
+	self->head = 0;
+	self->count = 0;
+	self->boatSpeed = 0;
+	self->boatSpeedTimestamp = 0;
+	self->hasBoatSpeed = 0;
+}
+
+void WINDFUSION__addAttitude(WINDFUSION* self, uint16_t heading, int16_t roll, int16_t pitch, uint32_t timestamp){
+	WINDFUSION_ATTITUDE* attitude;
+	if(self->count == WINDFUSION_HISTORY){
+		attitude = &self->history[self->head];
+		self->head = (self->head + 1) % WINDFUSION_HISTORY;
+	}
+	else{
+		attitude = &self->history[(self->head + self->count) % WINDFUSION_HISTORY];
+		self->count++;
+	}
+	attitude->timestamp = timestamp;
+	attitude->heading = heading;
+	attitude->roll = roll;
+	attitude->pitch = pitch;
+}
+
+void WINDFUSION__setBoatSpeed(WINDFUSION* self, uint16_t speed, uint32_t timestamp){
+	self->boatSpeed = speed;
+	self->boatSpeedTimestamp = timestamp;
+	self->hasBoatSpeed = 1;
+}
+
+void WINDFUSION__setBoatSpeedCAN(WINDFUSION* self, const uint8_t* data, uint32_t timestamp){
+	WINDFUSION__setBoatSpeed(self, data[0] | (data[1] << 8), timestamp);
+}
+
+void WINDFUSION__process(WINDFUSION* self, uint16_t direction, uint16_t speed, uint32_t timestamp, WINDFUSION_SAMPLE* output){
+	uint32_t measured = timestamp - self->latencyMs;
+	WINDFUSION_ATTITUDE attitude = {measured, 0, 0, 0};
+	uint8_t flags = WINDFUSION_VALID_APPARENT;
+
+	if(attitudeAtTime(self, measured, &attitude)){
+		flags |= WINDFUSION_VALID_ATTITUDE;
+	}
+
+	//Wind vector in the frame of the sensor: x towards the bow, y towards starboard. When the mast is tilted the
+	//sensor only sees the projection of the horizontal wind on its plane, so the components are scaled back up.
+	int64_t scaled = (int64_t)speed << VECTOR_SHIFT;
+	int32_t x = scaled * fixed_cos(direction) / tiltCos(attitude.pitch);
+	int32_t y = scaled * fixed_sin(direction) / tiltCos(attitude.roll);
+
+	output->apparentAngle = fixed_atan2(y, x);
+	output->apparentSpeed = vectorSpeed(x, y);
+	output->apparentDirection = fixed_wrap(output->apparentAngle + attitude.heading);
+
+	//The boat's own motion adds a wind from straight ahead, remove it to get the true wind
+	if(self->hasBoatSpeed && timestamp - self->boatSpeedTimestamp <= self->boatSpeedTimeoutMs){
+		int32_t trueX = x - ((int32_t)self->boatSpeed << VECTOR_SHIFT);
+		output->trueAngle = fixed_atan2(y, trueX);
+		output->trueSpeed = vectorSpeed(trueX, y);
+		flags |= WINDFUSION_VALID_TRUE;
+	}
+	else{
+		output->trueAngle = output->apparentAngle;
+		output->trueSpeed = output->apparentSpeed;
+	}
+	output->trueDirection = fixed_wrap(output->trueAngle + attitude.heading);
+
+	output->attitude = attitude;
+	output->flags = flags;
+}
+
+void WINDFUSION__packCAN(const WINDFUSION_SAMPLE* sample, uint8_t* data){
+	int16_t heel = sample->attitude.roll / 10;
+
+	data[0] = sample->apparentDirection & 0xFF;
+	data[1] = sample->apparentDirection >> 8;
+	data[2] = sample->trueDirection & 0xFF;
+	data[3] = sample->trueDirection >> 8;
+	data[4] = sample->trueSpeed & 0xFF;
+	data[5] = sample->trueSpeed >> 8;
+	data[6] = (uint8_t)(int8_t)((heel > 127) ? 127 : (heel < -128) ? -128 : heel);
+	data[7] = sample->flags;
+}
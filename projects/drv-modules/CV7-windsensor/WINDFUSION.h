@@ -0,0 +1,157 @@
+/*
+ * This library combines the samples of the WINDSENSOR library with the attitude from the IMU library, so the
+ * wind leaves the COM module already referenced to north instead of to the sensor.
+ * It does not depend on the HAL so it can be tested on a host machine.
+ * It currently has the following functionality:
+ *		-Keep a short history of IMU attitudes and interpolate it at the time each wind sample was measured
+ *		-Correct the apparent wind for the heel (roll) and pitch of the mast
+ *		-Compute the apparent wind direction relative to north
+ *		-Compute the true wind angle, speed and direction when a recent boat speed has been received over CAN
+ *
+ * Only integer arithmetic is used (see shared/fixed_math), so it can run on every wind sample inside the UART
+ * interrupt. WINDFUSION__addAttitude() and WINDFUSION__process() must not preempt each other, e.g. call both from
+ * interrupts of the same priority or both from the main loop.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef WINDFUSION_H
+#define WINDFUSION_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Number of attitudes kept for the time alignment. It must cover the sensor latency at the IMU sample rate.
+#ifndef WINDFUSION_HISTORY
+#define WINDFUSION_HISTORY 16
+#endif
+
+//Heel and pitch beyond which the correction is no longer increased (in 0.1 degrees). The CV7 cannot measure the
+//wind properly past this point and dividing by a small cosine would only amplify the noise.
+#define WINDFUSION_MAX_TILT 600
+
+//Validity flags of a fused sample
+#define WINDFUSION_VALID_APPARENT 0x01 //the apparent wind angle and speed are valid
+#define WINDFUSION_VALID_ATTITUDE 0x02 //an attitude was available at the time of the sample, the north referenced values are valid
+#define WINDFUSION_VALID_TRUE 0x04 //a recent boat speed was available, the true wind values are valid
+
+//Size of the CAN payload produced by WINDFUSION__packCAN()
+#define WINDFUSION_CAN_PAYLOAD_SIZE 8
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//An attitude of the boat from the IMU
+typedef struct {
+	uint32_t timestamp; //in ms
+	uint16_t heading; //in 0.1 degrees, 0 is north and increasing clockwise
+	int16_t roll; //in 0.1 degrees, positive is heeled to starboard
+	int16_t pitch; //in 0.1 degrees, positive is bow up
+} WINDFUSION_ATTITUDE;
+
+//The WINDFUSION data type
+typedef struct {
+	//time between the wind being measured and the sentence being received, in ms
+	uint32_t latencyMs;
+	//longest time an attitude or boat speed is used for, in ms
+	uint32_t attitudeTimeoutMs;
+	uint32_t boatSpeedTimeoutMs;
+	//ring buffer of the latest attitudes, oldest first
+	WINDFUSION_ATTITUDE history[WINDFUSION_HISTORY];
+	uint8_t head;
+	uint8_t count;
+	uint16_t boatSpeed; //in 0.01 knots
+	uint32_t boatSpeedTimestamp;
+	uint8_t hasBoatSpeed;
+} WINDFUSION;
+
+//A wind sample combined with the attitude of the boat
+typedef struct {
+	uint16_t apparentAngle; //heel corrected, in 0.1 degrees from the bow, increasing clockwise
+	uint16_t apparentSpeed; //heel corrected, in 0.01 knots
+	uint16_t apparentDirection; //direction the apparent wind comes from, in 0.1 degrees from north
+	uint16_t trueAngle; //in 0.1 degrees from the bow, increasing clockwise
+	uint16_t trueSpeed; //in 0.01 knots
+	uint16_t trueDirection; //direction the true wind comes from, in 0.1 degrees from north
+	WINDFUSION_ATTITUDE attitude; //attitude interpolated at the time the wind was measured
+	uint8_t flags; //WINDFUSION_VALID_* bits
+} WINDFUSION_SAMPLE;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------- WINDFUSION METHODS ---------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Initializes a fusion stage without any attitude or boat speed.
+ *
+ * @param self The fusion stage to initialize
+ * @param latencyMs Time subtracted from the wind sample timestamps to get the time the wind was measured, in ms
+ * @param attitudeTimeoutMs Longest time past the newest attitude that it is still used for, in ms
+ * @param boatSpeedTimeoutMs Longest time a received boat speed is used for, in ms
+ */
+void WINDFUSION__init(WINDFUSION* self, uint32_t latencyMs, uint32_t attitudeTimeoutMs, uint32_t boatSpeedTimeoutMs);
+
+/*
+ * Adds an attitude to the history. Attitudes must be added in time order, every time the IMU is read.
+ *
+ * @param self The fusion stage
+ * @param heading The heading in 0.1 degrees
+ * @param roll The roll in 0.1 degrees
+ * @param pitch The pitch in 0.1 degrees
+ * @param timestamp The time the attitude was read in ms
+ */
+void WINDFUSION__addAttitude(WINDFUSION* self, uint16_t heading, int16_t roll, int16_t pitch, uint32_t timestamp);
+
+/*
+ * Sets the boat speed through the water used for the true wind.
+ *
+ * @param self The fusion stage
+ * @param speed The boat speed in 0.01 knots
+ * @param timestamp The time the speed was received in ms
+ */
+void WINDFUSION__setBoatSpeed(WINDFUSION* self, uint16_t speed, uint32_t timestamp);
+
+/*
+ * Sets the boat speed from a received CAN payload, whose bytes 0-1 hold the speed in 0.01 knots (little endian).
+ *
+ * @param self The fusion stage
+ * @param data The CAN payload, at least 2 bytes long
+ * @param timestamp The time the frame was received in ms
+ */
+void WINDFUSION__setBoatSpeedCAN(WINDFUSION* self, const uint8_t* data, uint32_t timestamp);
+
+/*
+ * Combines a wind sample with the attitude at the time it was measured. This should be called for every new
+ * wind sample so the output has the sensor's native rate.
+ *
+ * @param self The fusion stage
+ * @param direction The apparent wind direction from the sensor in 0.1 degrees from the bow
+ * @param speed The apparent wind speed from the sensor in 0.01 knots
+ * @param timestamp The time the wind sample was received in ms
+ * @param output Receives the fused sample
+ */
+void WINDFUSION__process(WINDFUSION* self, uint16_t direction, uint16_t speed, uint32_t timestamp, WINDFUSION_SAMPLE* output);
+
+/*
+ * Packs a fused sample into a CAN payload:
+ * 		Bytes 0-1: apparent wind direction from north (0.1 degrees, little endian)
+ * 		Bytes 2-3: true wind direction from north (0.1 degrees, little endian)
+ * 		Bytes 4-5: true wind speed (0.01 knots, little endian)
+ * 		Byte 6: heel (signed, whole degrees)
+ * 		Byte 7: WINDFUSION_VALID_* flags
+ *
+ * @param sample The sample to pack
+ * @param data Receives the WINDFUSION_CAN_PAYLOAD_SIZE bytes of the payload
+ */
+void WINDFUSION__packCAN(const WINDFUSION_SAMPLE* sample, uint8_t* data);
+
+#endif /* WINDFUSION_H */
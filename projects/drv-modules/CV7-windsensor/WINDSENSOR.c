@@ -7,138 +7,152 @@
  *
  */
 
-#include "wind_sensor.h"
-
-//Variables for processing wind sentence data
-uint16_t rx_buffer[1] = {0};
-uint16_t wind_sentence[WIND_BUFFER_SIZE]; //max sentence identifier length is 10 "PLCJEA870" + \0
-int wind_sentence_index = 0;
-uint16_t wind_speed[5]; //in knots
-uint16_t wind_direction[4]; //in degrees
-uint16_t wind_temperature[5]; //in Degrees Celsius
-uint16_t wind_data_can_output[32]; //OUTPUT TO CANBUS
-
-void processWindSensorData(uint16_t *input_data)
+#include "WINDSENSOR.h"
+#include "profiling.h"
+#include "pool.h"
+#include <string.h>
+
+//The temperature stays valid until no temperature sentence has been received for WIND_TEMPERATURE_TIMEOUT_MS
+static uint8_t temperatureValid(const WINDSENSOR* self, uint32_t now)
 {
-	if(input_data[0] == '$')
+	return (self->sample.flags & WIND_VALID_TEMPERATURE) && now - self->temperatureTimestamp <= WIND_TEMPERATURE_TIMEOUT_MS;
+}
+
+//Processes a sentence that has been fully received and passed its checksum
+static void processWindSentence(WINDSENSOR* self)
+{
+	NMEA_MWV mwv;
+	int16_t temperature;
+
+	if(NMEA__decodeMWV(&self->parser, &mwv))
 	{
-		//First sentence, or finished sentence.
-		if(wind_sentence_index != 0)
+		//Process <<Wind Sentence>>
+		uint32_t now = HAL_GetTick();
+		uint8_t flags = temperatureValid(self, now) ? WIND_VALID_TEMPERATURE : 0;
+		if(mwv.valid)
 		{
-			//completed wind sentence message, now process data
-			if(wind_sentence[1] == 'I')
-			{
-				//Process <<Wind Sentence>>
-
-				//Wind Direction (Degrees) - Resolution: 1 degree
-				int k = 0;
-				for(int i = 7; wind_sentence[i] != ','; i++)
-				{
-					wind_direction[k] = wind_sentence[i];
-					k++;
-					if(k >= 5)
-					{
-						//Wind Direction is always 5 indexes long
-						return;
-					}
-				}
-				for(int i = 0; i < 3; i++)
-				{
-					//We can ignore the decimal place since resolution = 1 degree
-					wind_data_can_output[i] = ASCIItoINT(wind_direction[i]);
-				}
-
-				//Wind Speed (Knots) - Resolution 0.1 knots (Therefore, multiply by 10 in order to send as int and then SOFTWARE will divide by 10 on their side)
-				k = 0;
-				for(int i = 15; wind_sentence[i] != ','; i++)
-				{
-					wind_speed[k] = wind_sentence[i];
-					k++;
-					if(k >= 5)
-					{
-						//Wind Speed is always 5 indexes long
-						return;
-					}
-				}
-				for(int i = 0; i < 4; i++)
-				{
-					if(wind_speed[i] == '.')
-					{
-						//Skip the decimal point and the next bit is the decimal
-						wind_data_can_output[i] = ASCIItoINT(wind_speed[i+1]);
-					}
-					else
-					{
-						wind_data_can_output[i] = ASCIItoINT(wind_speed[i]);
-					}
-				}
-			}
-			else if(wind_sentence[1] == 'W')
-			{
-				//Process <<Wind Temperature>>
-
-				int k = 0;
-				for(int i = 9; wind_sentence[i] != ','; i++)
-				{
-					wind_temperature[k] = wind_sentence[i];
-					k++;
-					if(k >= 5)
-					{
-						//Wind Temperature is always 5 indexes long
-						return;
-					}
-				}
-				//NO NEED TO ADD Wind Temperature TO CANBUS as of now.
-				//If adding, it can be negative and the ASCIItoInt function must be changed.
-
-				//UNCOMMENT THESE TO PRINT WIND DIRECTION, WIND SPEED, AND WIND TEMPERATURE TO PUTTY THROUGH USART1
-//				printf("Wind Direction:%s\x0D\x0A", wind_direction);
-//				printf("Wind Speed:%s\x0D\x0A", wind_speed);
-//				printf("Wind Temperature:%s\x0D\x0A", wind_temperature);
-			}
-			else
-			{
-				//Either we received an invalid message or the 2 technical messages that are not required
-				return;
-			}
-			wind_sentence_index = 0; //reset index for new message
-			wind_sentence[wind_sentence_index] = input_data[0];
-			wind_sentence_index++;
+			flags |= WIND_VALID_DIRECTION | WIND_VALID_SPEED;
 		}
-		else
+		if(mwv.reference == 'T')
 		{
-			//For first sentence received
-			wind_sentence[wind_sentence_index] = input_data[0];
-			wind_sentence_index++;
+			flags |= WIND_TRUE_REFERENCE;
 		}
+		self->sample.direction = mwv.angle;
+		self->sample.speed = mwv.speed;
+		self->sample.flags = flags;
+		self->sample.timestamp = now;
+		self->sample.sequence++;
 	}
-	else
+	else if(NMEA__decodeXDRTemperature(&self->parser, &temperature))
+	{
+		//Process <<Wind Temperature>>
+		self->sample.temperature = temperature;
+		self->sample.flags |= WIND_VALID_TEMPERATURE;
+		self->temperatureTimestamp = HAL_GetTick();
+	}
+	//Any other sentence (e.g. the technical messages that are not required) is ignored
+}
+
+void processWindSensorData(WINDSENSOR* self, uint8_t input_data)
+{
+	PROFILING_SCOPE(WIND_SENSOR_DATA);
+	if(NMEA__feed(&self->parser, input_data))
 	{
-		//gathering wind sentence data
-		if(wind_sentence_index >= WIND_BUFFER_SIZE)
+		processWindSentence(self);
+	}
+}
+
+//Initializes the WINDSENSOR object
+void WINDSENSOR__init(WINDSENSOR* self, UART_HandleTypeDef * huartChannel)
+{
+	self->huart = huartChannel;
+	self->rxTail = 0;
+	NMEA__init(&self->parser);
+	memset((void*)&self->sample, 0, sizeof(WIND_SAMPLE));
+	self->temperatureTimestamp = 0;
+
+	//Clear any flags then trigger a continuous DMA reception
+	__HAL_UART_CLEAR_FLAG(huartChannel, UART_FLAG_IDLE);
+	__HAL_UART_CLEAR_FLAG(huartChannel, UART_FLAG_ORE);
+	HAL_UARTEx_ReceiveToIdle_DMA(self->huart, self->rxBuffer, WIND_DMA_BUFFER_SIZE);
+}
+
+WINDSENSOR* WINDSENSOR__create(UART_HandleTypeDef * huartChannel)
+{
+	WINDSENSOR* result = (WINDSENSOR*)pool_alloc(sizeof(WINDSENSOR));
+	if (result == NULL) return NULL; // Prevent null pointer issues
+
+	WINDSENSOR__init(result, huartChannel);
+	return result;
+}
+
+void WINDSENSOR__handleRxEvent(WINDSENSOR* self, UART_HandleTypeDef *huart, uint16_t size)
+{
+	if(huart->Instance != self->huart->Instance)
+	{
+		return;
+	}
+
+	//The DMA position only moves forward until it wraps at the end of the buffer
+	if(size < self->rxTail)
+	{
+		for(uint16_t i = self->rxTail; i < WIND_DMA_BUFFER_SIZE; i++)
 		{
-			//Wind Sentence Should Not Be More Than Around 32 Characters Long (Usually it is around 26-29)
-			return;
+			processWindSensorData(self, self->rxBuffer[i]);
 		}
-		wind_sentence[wind_sentence_index] = input_data[0];
-		wind_sentence_index++;
+		self->rxTail = 0;
+	}
+	for(uint16_t i = self->rxTail; i < size; i++)
+	{
+		processWindSensorData(self, self->rxBuffer[i]);
+	}
+	self->rxTail = (size >= WIND_DMA_BUFFER_SIZE) ? 0 : size;
+
+	//In normal (non circular) DMA mode the reception stops at the end of the buffer, so restart it
+	if(huart->RxState == HAL_UART_STATE_READY)
+	{
+		self->rxTail = 0;
+		HAL_UARTEx_ReceiveToIdle_DMA(self->huart, self->rxBuffer, WIND_DMA_BUFFER_SIZE);
 	}
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-    if (huart->Instance == USART2) {
-    	processWindSensorData(rx_buffer);
-    }
-    HAL_UART_Receive_DMA(&huart2, rx_buffer, 1);
+void WINDSENSOR__handleError(WINDSENSOR* self, UART_HandleTypeDef *huart)
+{
+	if(huart->Instance != self->huart->Instance)
+	{
+		return;
+	}
+
+	//The sentence in progress is lost, the parser resynchronizes on the next '$'
+	__HAL_UART_CLEAR_FLAG(huart, UART_FLAG_ORE);
+	__HAL_UART_CLEAR_FLAG(huart, UART_FLAG_NE);
+	__HAL_UART_CLEAR_FLAG(huart, UART_FLAG_FE);
+	HAL_UART_AbortReceive(huart);
+	self->rxTail = 0;
+	HAL_UARTEx_ReceiveToIdle_DMA(self->huart, self->rxBuffer, WIND_DMA_BUFFER_SIZE);
 }
 
-int ASCIItoINT(uint16_t *input)
+void WINDSENSOR__getSample(WINDSENSOR* self, WIND_SAMPLE* sample)
 {
-	//Assumes all inputs must be positive
-	//Since all wind direction, speed and temperature are 5 bytes long (3 numbers, then a decimal and then a number, ex: 125.2). We know it will be
-	if(input[0] >= '0' && input[0] <= '9')
+	//The copy is a few words long, so masking the interrupt is cheaper than detecting a torn copy
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*sample = *(WIND_SAMPLE*)&self->sample;
+	if(!temperatureValid(self, HAL_GetTick()))
 	{
-		return (input[0] - '0');
+		sample->flags &= ~WIND_VALID_TEMPERATURE;
 	}
+	__set_PRIMASK(primask);
 }
 
+void WINDSENSOR__packCAN(const WIND_SAMPLE* sample, uint8_t* data)
+{
+	data[0] = sample->direction & 0xFF;
+	data[1] = sample->direction >> 8;
+	data[2] = sample->speed & 0xFF;
+	data[3] = sample->speed >> 8;
+	data[4] = (uint16_t)sample->temperature & 0xFF;
+	data[5] = (uint16_t)sample->temperature >> 8;
+	data[6] = sample->flags;
+	data[7] = sample->sequence;
+}
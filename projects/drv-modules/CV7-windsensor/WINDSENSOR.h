@@ -1,5 +1,16 @@
 /*
- * WIND_SENSOR.h
+ * This library provides an interface to communicate between the microcontroller and a CV7 wind sensor.
+ * It currently has the following functionality:
+ *		-Continuous reception of the sensor's NMEA output with a circular DMA buffer
+ *		-Checksum validated parsing of the wind ($IIMWV) and temperature ($WIXDR) sentences, in any order
+ *		-Automatically update a fixed point wind sample (direction, speed, temperature, timestamp)
+ *		-Pack the latest sample into an 8 byte CAN payload
+ *
+ * For this library to work as intended:
+ * 		"WINDSENSOR__handleRxEvent()" must be called inside "HAL_UARTEx_RxEventCallback()"
+ * 		"WINDSENSOR__handleError()" must be called inside "HAL_UART_ErrorCallback()"
+ * 		The RX DMA channel of the UART must be in circular (linked-list) mode. More information on the
+ * 		intended use can be found in the associated readme file.
  *
  * Created: March 20, 2025
  * Author: Faaiq Majeed
@@ -11,27 +22,101 @@
 #define WIND_SENSOR_H
 
 #include "stm32u5xx_hal.h"  // Include HAL library for STM32U5 series
+#include "NMEA.h"
+
+//Size of the circular DMA buffer. Half of it must hold more than one sentence so that processing
+//on the half and full transfer events can never fall behind the DMA.
+#define WIND_DMA_BUFFER_SIZE 128
+
+//Validity flags of a wind sample
+#define WIND_VALID_DIRECTION 0x01
+#define WIND_VALID_SPEED 0x02
+#define WIND_VALID_TEMPERATURE 0x04
+#define WIND_TRUE_REFERENCE 0x08 //direction and speed are theoretical (true) rather than relative to the bow
+
+//Time after the last temperature sentence after which the temperature is no longer flagged valid, in ms
+#define WIND_TEMPERATURE_TIMEOUT_MS 5000
 
-//WIND SENTENCE BUFFER SIZE
-#define WIND_BUFFER_SIZE 32
+//Size of the CAN payload produced by WINDSENSOR__packCAN()
+#define WIND_CAN_PAYLOAD_SIZE 8
 
-//Global Variables for processing wind sentence data
-extern uint16_t rx_buffer[1] = {0};
-extern uint16_t wind_sentence[WIND_BUFFER_SIZE]; //max sentence identifier length is 10 "PLCJEA870" + \0
-extern int wind_sentence_index = 0;
-extern uint16_t wind_speed[5]; //in knots
-extern uint16_t wind_direction[4]; //in degrees
-extern uint16_t wind_temperature[5]; //in Degrees Celsius
-extern uint16_t wind_data_can_output[32]; //OUTPUT TO CANBUS
+//The latest data received from the wind sensor
+typedef struct {
+	uint16_t direction; //in 0.1 degrees, 0 to 3599, 0 is the bow and increasing clockwise
+	uint16_t speed; //in 0.01 knots
+	int16_t temperature; //in 0.1 degrees Celsius
+	uint8_t flags; //WIND_VALID_* bits
+	uint8_t sequence; //incremented on every wind sentence, used to detect new samples
+	uint32_t timestamp; //HAL_GetTick() when the wind sentence was received
+} WIND_SAMPLE;
+
+//The WINDSENSOR data type
+typedef struct {
+	UART_HandleTypeDef * huart;
+	//circular buffer written by the DMA
+	uint8_t rxBuffer[WIND_DMA_BUFFER_SIZE];
+	//position in rxBuffer up to which bytes have been parsed
+	uint16_t rxTail;
+	NMEA_PARSER parser;
+	//written from the UART interrupt, read it with WINDSENSOR__getSample()
+	volatile WIND_SAMPLE sample;
+	//HAL_GetTick() when the temperature sentence was received, the sample timestamp is the wind's
+	volatile uint32_t temperatureTimestamp;
+} WINDSENSOR;
 
 
 //Function Handles
 
-//Function for processing wind sentence data
-void processWindSensorData(uint8_t *input_data);
-//Function for handling DMA on USART2 for the wind sensor
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
-//Function for converting ASCII to INT
-int ASCIItoINT(uint8_t input);
-#endif
+/*
+ * Creates a new WINDSENSOR object and starts the continuous reception.
+ *
+ * @param huartChannel The UART handle of the peripheral connected to the sensor.
+ * @return Pointer to an initialized WINDSENSOR object.
+ */
+WINDSENSOR* WINDSENSOR__create(UART_HandleTypeDef * huartChannel);
+
+/*
+ * Parses the bytes written by the DMA since the last event. This function should be called inside
+ * HAL_UARTEx_RxEventCallback(), which is raised on an idle line and on the half and full buffer events.
+ *
+ * @param self Pointer to a WINDSENSOR object.
+ * @param huart UART handle passed by the callback function.
+ * @param size Position in the circular buffer up to which the DMA has written.
+ */
+void WINDSENSOR__handleRxEvent(WINDSENSOR* self, UART_HandleTypeDef *huart, uint16_t size);
 
+/*
+ * Restarts the reception after a UART error (noise, framing or overrun). This function should be called
+ * inside HAL_UART_ErrorCallback().
+ *
+ * @param self Pointer to a WINDSENSOR object.
+ * @param huart UART handle passed by the callback function.
+ */
+void WINDSENSOR__handleError(WINDSENSOR* self, UART_HandleTypeDef *huart);
+
+/*
+ * Copies the latest wind sample without it being modified part way through by the UART interrupt. The
+ * temperature is flagged valid for WIND_TEMPERATURE_TIMEOUT_MS after its sentence, so it is not reported forever
+ * once the temperature sentences stop.
+ *
+ * @param self Pointer to a WINDSENSOR object.
+ * @param sample Receives the latest sample.
+ */
+void WINDSENSOR__getSample(WINDSENSOR* self, WIND_SAMPLE* sample);
+
+/*
+ * Packs a wind sample into a CAN payload:
+ * 		Bytes 0-1: direction (0.1 degrees, little endian)
+ * 		Bytes 2-3: speed (0.01 knots, little endian)
+ * 		Bytes 4-5: temperature (0.1 degrees Celsius, signed, little endian)
+ * 		Byte 6: flags
+ * 		Byte 7: sequence
+ *
+ * @param sample The sample to pack.
+ * @param data Receives the WIND_CAN_PAYLOAD_SIZE bytes of the payload.
+ */
+void WINDSENSOR__packCAN(const WIND_SAMPLE* sample, uint8_t* data);
+
+//Function for processing a single byte of wind sentence data
+void processWindSensorData(WINDSENSOR* self, uint8_t input_data);
+#endif
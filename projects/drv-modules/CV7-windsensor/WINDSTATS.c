@@ -0,0 +1,150 @@
+/*
+ * WINDSTATS.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "WINDSTATS.h"
+#include "fixed_trig.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Ring position of the n-th oldest entry
+static uint16_t position(const WINDSTATS* self, uint16_t n){
+	return (self->head + n) % WINDSTATS_MAX_SAMPLES;
+}
+
+//Clamps a Q15 value so that 1.0 fits in an int16_t
+static int16_t toInt16(int32_t value){
+	return (value > INT16_MAX) ? INT16_MAX : value;
+}
+
+//Removes the oldest entry from the window and from the running sums
+static void dropOldest(WINDSTATS* self){
+	WINDSTATS_ENTRY* oldest = &self->entries[self->head];
+
+	self->sumSin -= oldest->sin;
+	self->sumCos -= oldest->cos;
+	self->sumSpeed -= oldest->speed;
+	self->sumSpeedSquared -= (uint32_t)oldest->speed * oldest->speed;
+
+	if(self->gustCount > 0 && self->gust[self->gustHead] == self->head){
+		self->gustHead = (self->gustHead + 1) % WINDSTATS_MAX_SAMPLES;
+		self->gustCount--;
+	}
+
+	self->head = (self->head + 1) % WINDSTATS_MAX_SAMPLES;
+	self->count--;
+}
+
+//Drops the entries that are older than the windows at the given time
+static void expire(WINDSTATS* self, uint32_t now){
+	while(self->count > 0 && now - self->entries[self->head].timestamp > self->windowMs){
+		dropOldest(self);
+	}
+	while(self->gustCount > 0 && now - self->entries[self->gust[self->gustHead]].timestamp > self->gustMs){
+		self->gustHead = (self->gustHead + 1) % WINDSTATS_MAX_SAMPLES;
+		self->gustCount--;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------- WINDSTATS METHODS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void WINDSTATS__init(WINDSTATS* self, uint32_t windowMs, uint32_t gustMs, uint32_t publishMs){
+	self->windowMs = windowMs;
+	self->gustMs = (gustMs < windowMs) ? gustMs : windowMs;
+	self->publishMs = publishMs;
+	self->lastPublish = 0;
+	self->head = 0;
+	self->count = 0;
+	self->sumSin = 0;
+	self->sumCos = 0;
+	self->sumSpeed = 0;
+	self->sumSpeedSquared = 0;
+	self->gustHead = 0;
+	self->gustCount = 0;
+}
+
+void WINDSTATS__add(WINDSTATS* self, uint16_t direction, uint16_t speed, uint32_t timestamp){
+	expire(self, timestamp);
+	if(self->count == WINDSTATS_MAX_SAMPLES){
+		dropOldest(self);
+	}
+
+	uint16_t index = position(self, self->count);
+	WINDSTATS_ENTRY* entry = &self->entries[index];
+	entry->timestamp = timestamp;
+	entry->speed = speed;
+	entry->sin = toInt16(fixed_sin(direction));
+	entry->cos = toInt16(fixed_cos(direction));
+	self->count++;
+
+	self->sumSin += entry->sin;
+	self->sumCos += entry->cos;
+	self->sumSpeed += speed;
+	self->sumSpeedSquared += (uint32_t)speed * speed;
+
+	//Candidates that are not faster than the new sample can never be the gust again
+	while(self->gustCount > 0){
+		uint16_t last = self->gust[(self->gustHead + self->gustCount - 1) % WINDSTATS_MAX_SAMPLES];
+		if(self->entries[last].speed > speed){
+			break;
+		}
+		self->gustCount--;
+	}
+	self->gust[(self->gustHead + self->gustCount) % WINDSTATS_MAX_SAMPLES] = index;
+	self->gustCount++;
+}
+
+void WINDSTATS__getSummary(WINDSTATS* self, uint32_t now, WINDSTATS_SUMMARY* summary){
+	expire(self, now);
+
+	summary->samples = self->count;
+	if(self->count == 0){
+		summary->meanDirection = 0;
+		summary->directionVariance = 0;
+		summary->meanSpeed = 0;
+		summary->gustSpeed = 0;
+		summary->speedVariance = 0;
+		return;
+	}
+
+	uint32_t n = self->count;
+
+	//The mean resultant length is 1 when all directions agree and 0 when they cancel out
+	uint32_t resultant = fixed_sqrt((int64_t)self->sumSin * self->sumSin + (int64_t)self->sumCos * self->sumCos);
+	uint32_t length = (uint64_t)resultant * 1000 / (n * INT16_MAX);
+	summary->meanDirection = fixed_atan2(self->sumSin, self->sumCos);
+	summary->directionVariance = (length >= 1000) ? 0 : 1000 - length;
+
+	summary->meanSpeed = (self->sumSpeed + n / 2) / n;
+	summary->speedVariance = (n * self->sumSpeedSquared - (uint64_t)self->sumSpeed * self->sumSpeed) / (n * n);
+	summary->gustSpeed = (self->gustCount > 0) ? self->entries[self->gust[self->gustHead]].speed : 0;
+}
+
+uint8_t WINDSTATS__isDue(WINDSTATS* self, uint32_t now){
+	if(now - self->lastPublish < self->publishMs){
+		return 0;
+	}
+	self->lastPublish = now;
+	return 1;
+}
+
+void WINDSTATS__packCAN(const WINDSTATS_SUMMARY* summary, uint8_t* data){
+	//Standard deviation in 0.1 knots from the variance in (0.01 knots)^2
+	uint32_t deviation = (fixed_sqrt(summary->speedVariance) + 5) / 10;
+
+	data[0] = summary->meanDirection & 0xFF;
+	data[1] = summary->meanDirection >> 8;
+	data[2] = summary->meanSpeed & 0xFF;
+	data[3] = summary->meanSpeed >> 8;
+	data[4] = summary->gustSpeed & 0xFF;
+	data[5] = summary->gustSpeed >> 8;
+	data[6] = (deviation > 255) ? 255 : deviation;
+	data[7] = (summary->directionVariance + 5) / 10;
+}
@@ -0,0 +1,147 @@
+/*
+ * This library computes wind statistics over a sliding time window from the samples of the WINDSENSOR library.
+ * It does not depend on the HAL so it can be tested on a host machine.
+ * It currently has the following functionality:
+ *		-Circular (unit vector) mean wind direction and circular variance, correct across the 0/360 degree wrap
+ *		-Mean wind speed and speed variance
+ *		-Gust speed (maximum speed over a shorter window inside the main window)
+ *		-A publishing period so summaries can be sent at a lower rate than the sensor's sample rate
+ *
+ * Every sample costs a constant amount of work: running sums are updated when a sample enters or leaves the window
+ * and the gust is tracked with a monotonic queue (amortized O(1)). Only integer arithmetic is used.
+ *
+ * Typical use, from the main loop:
+ * 		if(sample.sequence != lastSequence && (sample.flags & WIND_VALID_DIRECTION)) {
+ * 			WINDSTATS__add(&stats, sample.direction, sample.speed, sample.timestamp);
+ * 		}
+ * 		if(WINDSTATS__isDue(&stats, HAL_GetTick())) {
+ * 			WINDSTATS__getSummary(&stats, HAL_GetTick(), &summary);
+ * 			WINDSTATS__packCAN(&summary, data);
+ * 		}
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef WINDSTATS_H
+#define WINDSTATS_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Maximum number of samples held in a window. The CV7 outputs about 2 wind sentences per second, so 128 samples
+//covers a one minute window. If the window holds more samples than this, the oldest ones are dropped early.
+#ifndef WINDSTATS_MAX_SAMPLES
+#define WINDSTATS_MAX_SAMPLES 128
+#endif
+
+//Size of the CAN payload produced by WINDSTATS__packCAN()
+#define WINDSTATS_CAN_PAYLOAD_SIZE 8
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//A sample held in the window
+typedef struct {
+	uint32_t timestamp;
+	uint16_t speed;
+	//unit vector of the direction in Q15
+	int16_t sin;
+	int16_t cos;
+} WINDSTATS_ENTRY;
+
+//The WINDSTATS data type
+typedef struct {
+	uint32_t windowMs;
+	uint32_t gustMs;
+	uint32_t publishMs;
+	uint32_t lastPublish;
+	//ring buffer of the samples in the window, oldest first
+	WINDSTATS_ENTRY entries[WINDSTATS_MAX_SAMPLES];
+	uint16_t head;
+	uint16_t count;
+	//running sums over the entries in the window
+	int32_t sumSin;
+	int32_t sumCos;
+	uint32_t sumSpeed;
+	uint64_t sumSpeedSquared;
+	//ring positions of the gust candidates, in decreasing speed order
+	uint16_t gust[WINDSTATS_MAX_SAMPLES];
+	uint16_t gustHead;
+	uint16_t gustCount;
+} WINDSTATS;
+
+//Statistics over the current window
+typedef struct {
+	uint16_t meanDirection; //in 0.1 degrees, 0 to 3599
+	uint16_t directionVariance; //circular variance (1 - mean resultant length) in 0.001, 0 to 1000
+	uint16_t meanSpeed; //in 0.01 knots
+	uint16_t gustSpeed; //in 0.01 knots
+	uint32_t speedVariance; //in (0.01 knots)^2
+	uint16_t samples; //number of samples in the window, the other fields are 0 if there are none
+} WINDSTATS_SUMMARY;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------- WINDSTATS METHODS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Initializes an empty set of statistics.
+ *
+ * @param self The statistics to initialize
+ * @param windowMs Length of the window for the mean direction, mean speed and variances in ms
+ * @param gustMs Length of the window for the gust in ms (at most windowMs)
+ * @param publishMs Period at which WINDSTATS__isDue() reports that a summary should be published in ms
+ */
+void WINDSTATS__init(WINDSTATS* self, uint32_t windowMs, uint32_t gustMs, uint32_t publishMs);
+
+/*
+ * Adds a sample to the window and drops the samples that have left it. Samples must be added in time order.
+ *
+ * @param self The statistics
+ * @param direction The wind direction in 0.1 degrees
+ * @param speed The wind speed in 0.01 knots
+ * @param timestamp The time of the sample in ms
+ */
+void WINDSTATS__add(WINDSTATS* self, uint16_t direction, uint16_t speed, uint32_t timestamp);
+
+/*
+ * Computes the statistics over the window ending now.
+ *
+ * @param self The statistics
+ * @param now The current time in ms, samples older than the window are dropped
+ * @param summary Receives the statistics
+ */
+void WINDSTATS__getSummary(WINDSTATS* self, uint32_t now, WINDSTATS_SUMMARY* summary);
+
+/*
+ * Checks whether a publishing period has elapsed since the last time this function returned 1.
+ *
+ * @param self The statistics
+ * @param now The current time in ms
+ * @return 1 if a summary should be published, 0 otherwise
+ */
+uint8_t WINDSTATS__isDue(WINDSTATS* self, uint32_t now);
+
+/*
+ * Packs a summary into a CAN payload:
+ * 		Bytes 0-1: mean direction (0.1 degrees, little endian)
+ * 		Bytes 2-3: mean speed (0.01 knots, little endian)
+ * 		Bytes 4-5: gust speed (0.01 knots, little endian)
+ * 		Byte 6: speed standard deviation (0.1 knots, saturated at 255)
+ * 		Byte 7: direction circular variance (0.01, 0 to 100)
+ *
+ * @param summary The summary to pack
+ * @param data Receives the WINDSTATS_CAN_PAYLOAD_SIZE bytes of the payload
+ */
+void WINDSTATS__packCAN(const WINDSTATS_SUMMARY* summary, uint8_t* data);
+
+#endif /* WINDSTATS_H */
@@ -10,8 +10,9 @@
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
 #include "BRITER.h"
+#include "profiling.h"
+#include "pool.h"
 #include <string.h>
-#include <stdlib.h>
 #include <stdio.h>
 
 
@@ -104,9 +105,11 @@ void BRITER__init(BRITER* self, UART_HandleTypeDef * huartChannel, volatile uint
 	//Copy the relevant data to the object
 	self->encoderRaw = encoderRaw;
 	self->huart = huartChannel;
+	self->lastValidDataTime = HAL_GetTick(); //the silence check counts from the initialization
 
-	//Allocate and reset the inputBuffer
-	self->inputBuffer = (uint8_t *) malloc(MAX_SCENTENCE_LENGTH);
+	//Take the inputBuffer from the pool and reset it, without it no reception is started
+	self->inputBuffer = (uint8_t *) pool_alloc(MAX_SCENTENCE_LENGTH);
+	if (self->inputBuffer == NULL) return;
 	memset(self->inputBuffer, 0, MAX_SCENTENCE_LENGTH);
 
 	//Set the last two bytes of the zero command to the samplePeriod unless less than 20ms
@@ -130,11 +133,15 @@ void BRITER__init(BRITER* self, UART_HandleTypeDef * huartChannel, volatile uint
 }
 
 BRITER* BRITER__create(UART_HandleTypeDef * huartChannel, uint16_t samplePeriod) {
-    BRITER* result = (BRITER*)malloc(sizeof(BRITER));
+    BRITER* result = (BRITER*)pool_alloc(sizeof(BRITER));
     if (result == NULL) return NULL; // Prevent null pointer issues
 
     // Initialize using the internally managed encoderRaw
     BRITER__init(result, huartChannel, &encoderRaw, samplePeriod);
+    if (result->inputBuffer == NULL) {
+        pool_free(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -208,7 +215,8 @@ void BRITER__checkErrors(BRITER* self) {
 
     // Check for encoder timeout (100ms)
     if (currentTime - self->lastValidDataTime > 100) {
-        printf("BRITER ERROR: Encoder timeout! Attempting power cycle...\n");
+        uint32_t silence = currentTime - self->lastValidDataTime;
+        errlog_report(BRITER_ERROR_TIMEOUT, silence > 0xFFFF ? 0xFFFF : silence);
 
         // Power cycle the encoder once **Currently the power cycle function kills the entire program
        // BRITER__powerCycle(self);
@@ -221,6 +229,7 @@ void BRITER__checkErrors(BRITER* self) {
 
 // Update BRITER__handleDMA to include angle calculations, timeout tracking, and error detection
 void BRITER__handleDMA(BRITER* self, UART_HandleTypeDef *huart, uint16_t size) {
+    PROFILING_SCOPE(BRITER_HANDLE_DMA);
     if (huart->Instance == self->huart->Instance) {
 
         // If it is an incomplete message, ignore it
@@ -231,7 +240,7 @@ void BRITER__handleDMA(BRITER* self, UART_HandleTypeDef *huart, uint16_t size) {
 
         // Check message length
         if (size != 9) {
-            printf("BRITER ERROR: Received incorrect message length: %d\r\n", size);
+            errlog_report(BRITER_ERROR_LENGTH, size);
             memset(self->inputBuffer, 0, MAX_SCENTENCE_LENGTH);
             HAL_UARTEx_ReceiveToIdle_DMA(self->huart, self->inputBuffer, 16);
             return;
@@ -242,8 +251,7 @@ void BRITER__handleDMA(BRITER* self, UART_HandleTypeDef *huart, uint16_t size) {
         uint32_t crc = modbus_CRC(bufPoint, 7);
 
         if (bufPoint[7] != (crc & 0xFF) || bufPoint[8] != ((crc >> 8) & 0xFF)) {
-            printf("BRITER ERROR: CRC check failed. Received: 0x%02X 0x%02X, Expected: 0x%02lX 0x%02lX\r\n",
-                bufPoint[7], bufPoint[8], (unsigned long)(crc & 0xFF), (unsigned long)((crc >> 8) & 0xFF));
+            errlog_report(BRITER_ERROR_CRC, bufPoint[7] | bufPoint[8] << 8);
             memset(self->inputBuffer, 0, MAX_SCENTENCE_LENGTH);
             HAL_UARTEx_ReceiveToIdle_DMA(self->huart, self->inputBuffer, 16);
             return;
@@ -259,7 +267,7 @@ void BRITER__handleDMA(BRITER* self, UART_HandleTypeDef *huart, uint16_t size) {
             BRITER__computePassval(self);
             self->lastValidDataTime = HAL_GetTick(); // Update last valid timestamp
         } else {
-            printf("BRITER ERROR: Incorrect data format received.\r\n");
+            errlog_report(BRITER_ERROR_FORMAT, bufPoint[0] << 8 | bufPoint[1]);
         }
 
         // Clear flags and request a new reception
@@ -273,10 +281,10 @@ void BRITER__handleDMA(BRITER* self, UART_HandleTypeDef *huart, uint16_t size) {
 
 //sends a command to the encoder
 void sendScentence(BRITER* self, uint8_t *outputData, uint16_t outputLength) {
-    // Allocate memory for the output buffer
-    uint8_t *outputBuffer = (uint8_t *) malloc(MAX_SCENTENCE_LENGTH);
-    if (outputBuffer == NULL) {
-        printf("Error: Failed to allocate memory for outputBuffer\r\n");
+    // The frame is built on the stack, the address, function code and CRC take 4 bytes around the message
+    uint8_t outputBuffer[MAX_SCENTENCE_LENGTH];
+    if (outputLength > MAX_SCENTENCE_LENGTH - 4) {
+        errlog_report(BRITER_ERROR_TRANSMIT, outputLength);
         return;
     }
 
@@ -295,11 +303,8 @@ void sendScentence(BRITER* self, uint8_t *outputData, uint16_t outputLength) {
     // Transmit the message
     HAL_StatusTypeDef status = HAL_UART_Transmit(self->huart, outputBuffer, outputLength + 4, TRANSMISSION_MAX_TIME);
     if (status != HAL_OK) {
-        printf("Error: UART transmission failed with status %d\r\n", status);
+        errlog_report(BRITER_ERROR_TRANSMIT, status);
     }
-
-    // Free allocated memory
-    free(outputBuffer);
 }
 
 
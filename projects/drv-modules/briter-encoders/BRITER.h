@@ -24,6 +24,7 @@
  //----------------------------------------------------------------------------------------------------------------------------------------------------------------
  
  #include "stm32u5xx_hal.h"
+ #include "errlog.h"
  
  //------------------------------------------------------------------------------------------------------------------------------------------------------------------
  //--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
@@ -44,6 +45,14 @@
  // The address used for the encoder (0x01 is default)
  #define ENCODER_ADDRESS 0x01
  
+ // Errors reported to the error log. The reception errors come from the UART interrupt, once a burst is over the
+ // rate limit of the log they only cost a counter increment.
+ #define BRITER_ERROR_LENGTH ERRLOG_CODE(ERRLOG_MODULE_BRITER, 1, ERRLOG_LOW)   // detail: received length
+ #define BRITER_ERROR_CRC ERRLOG_CODE(ERRLOG_MODULE_BRITER, 2, ERRLOG_LOW)      // detail: received CRC
+ #define BRITER_ERROR_FORMAT ERRLOG_CODE(ERRLOG_MODULE_BRITER, 3, ERRLOG_LOW)   // detail: first two bytes
+ #define BRITER_ERROR_TIMEOUT ERRLOG_CODE(ERRLOG_MODULE_BRITER, 4, ERRLOG_HIGH) // detail: ms since the last valid message
+ #define BRITER_ERROR_TRANSMIT ERRLOG_CODE(ERRLOG_MODULE_BRITER, 5, ERRLOG_MID) // detail: HAL status, or the length of a message too long for a frame
+ 
  //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
  //--------------------------------------------------------------------------- OBJECT MANAGEMENT ---------------------------------------------------------------------------
  //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
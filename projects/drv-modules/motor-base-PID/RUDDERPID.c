@@ -1,14 +1,15 @@
 /*
- * Motor_PID.h
+ * RUDDERPID.c
  *
  *  Created on: Mar 18, 2025
  *      Author: Chukwudalu Joshua Obi
  */
 
- #include "Motor_PID.h"
+ #include "RUDDERPID.h"
  #include <stdint.h>
  #include <math.h>
  #include <stdio.h>
+ #include "profiling.h"
 
 void DAC_STEP(int step) {
 
@@ -21,16 +22,16 @@ void DAC_STEP(int step) {
 		 *
 		 */
 
-    uint32_t Motor_DAC = (uint32_t)(i * 4095.0f / 50); // Keep DAC value as 12-bit resolution
+    uint32_t Motor_DAC = (uint32_t)(step * 4095.0f / 50); // Keep DAC value as 12-bit resolution
     HAL_DAC_SetValue(&hdac1, DAC_CHANNEL_1, DAC_ALIGN_12B_R, Motor_DAC); // Set DAC output
-    float voltage = (i * 3.3f) /100; // Convert DAC value to voltage
+    float voltage = (Motor_DAC * 3.3f) / 4095; // Convert DAC value to voltage
 
-    printf("%u\r\n", Motor_DAC);
+    printf("%lu\r\n", (unsigned long)Motor_DAC);
     printf("V: %d.%03d V\r\n", (int)voltage, (int)(fabsf(voltage * 1000)) % 1000);
 }
 
 
-void Set_Motor(float_t Motor_Control)
+void Set_Motor(float Motor_Control)
 {
 
 	/*
@@ -67,6 +68,7 @@ void PI_Motor(int32_t desired_heading, int32_t current_heading,
               float* integral_error, uint32_t* last_time_stamp,
               int32_t* past_encoder_heading, int8_t* past_motor_direction)
 {
+	PROFILING_SCOPE(PI_MOTOR);
 
 	/*
 	 * Calculates the error in boat's heading and adjusts the rudder accordingly
@@ -99,7 +101,7 @@ void PI_Motor(int32_t desired_heading, int32_t current_heading,
 		}
 
 		int32_t error = desired_heading - current_heading;
-		printf("%li\r\n",error);
+		printf("%li\r\n", (long)error);
 		int8_t direction = (error > 0) - (error < 0); // Determine direction (-1, 0, or 1)
 		float Angular_Velocity = (current_heading-*past_encoder_heading)/del_time;
 
@@ -25,7 +25,10 @@
 #include <stdint.h>
 #include <math.h>
 #include <stdio.h>
-#include "stm32u5xx_hal.h  
+#include "stm32u5xx_hal.h"
+
+//DAC driving the motor controller, defined with the other handles of the board
+extern DAC_HandleTypeDef hdac1;
 
 // Constants
 #define PROPORTIONAL_GAIN 0.0017f
@@ -0,0 +1,110 @@
+/*
+ * SERVOCHANNEL.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "SERVOCHANNEL.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define US_PER_SECOND 1000000ULL
+
+//Timer ticks in a duration, rounded to the nearest tick
+static uint64_t usToTicks(const SERVOTIMER* self, uint64_t us){
+	uint64_t denominator = (uint64_t)(self->prescaler + 1) * US_PER_SECOND;
+	return (us * self->clockHz + denominator / 2) / denominator;
+}
+
+static int16_t clampAngle(const SERVOCHANNEL* channel, int16_t angle){
+	if(angle < 0){
+		return 0;
+	}
+	if(angle > channel->maxAngle){
+		return channel->maxAngle;
+	}
+	return angle;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- SERVOTIMER METHODS --------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+uint8_t SERVOTIMER__configure(SERVOTIMER* self, uint32_t clockHz, uint32_t periodUs, uint32_t maxReload){
+	self->clockHz = clockHz;
+	self->periodUs = periodUs;
+	self->channelCount = 0;
+
+	//Smallest prescaler that fits the frame in maxReload + 1 ticks
+	uint64_t frameTicks = ((uint64_t)clockHz * periodUs + US_PER_SECOND / 2) / US_PER_SECOND;
+	uint64_t maxTicks = (uint64_t)maxReload + 1;
+	uint64_t divider = (frameTicks + maxTicks - 1) / maxTicks;
+	if(divider == 0){
+		divider = 1;
+	}
+	if(frameTicks < 2 || divider - 1 > SERVOTIMER_MAX_PRESCALER){
+		self->prescaler = 0;
+		self->reload = 0;
+		self->tickHz = 0;
+		return 0;
+	}
+
+	self->prescaler = divider - 1;
+	self->reload = usToTicks(self, periodUs) - 1;
+	self->tickHz = clockHz / divider;
+	return 1;
+}
+
+uint8_t SERVOTIMER__addChannel(SERVOTIMER* self, uint32_t id, uint16_t minPulseUs, uint16_t maxPulseUs, int16_t maxAngle){
+	if(self->tickHz == 0 || self->channelCount >= SERVOTIMER_MAX_CHANNELS || maxAngle <= 0 || minPulseUs == maxPulseUs){
+		return SERVOTIMER_NO_CHANNEL;
+	}
+	uint16_t low = minPulseUs < maxPulseUs ? minPulseUs : maxPulseUs;
+	uint16_t high = minPulseUs < maxPulseUs ? maxPulseUs : minPulseUs;
+	if(high >= self->periodUs){
+		return SERVOTIMER_NO_CHANNEL;
+	}
+
+	//Exact span in ticks scaled to Q16 before dividing by the angle range
+	uint64_t denominator = (uint64_t)(self->prescaler + 1) * US_PER_SECOND * maxAngle;
+	uint64_t slope = (((uint64_t)(high - low) * self->clockHz << 16) + denominator / 2) / denominator;
+	if(slope == 0 || slope > UINT32_MAX){
+		return SERVOTIMER_NO_CHANNEL;
+	}
+
+	uint8_t index = self->channelCount++;
+	SERVOCHANNEL* channel = &self->channels[index];
+	channel->id = id;
+	channel->minPulseUs = minPulseUs;
+	channel->maxPulseUs = maxPulseUs;
+	channel->maxAngle = maxAngle;
+	channel->reversed = maxPulseUs < minPulseUs;
+	channel->baseTicks = usToTicks(self, low);
+	channel->slopeQ16 = slope;
+	SERVOTIMER__setAngle(self, index, 0);
+	return index;
+}
+
+uint32_t SERVOTIMER__compare(const SERVOTIMER* self, uint8_t index, int16_t angle){
+	const SERVOCHANNEL* channel = &self->channels[index];
+	uint32_t steps = clampAngle(channel, angle);
+	if(channel->reversed){
+		steps = channel->maxAngle - steps;
+	}
+	return channel->baseTicks + (uint32_t)(((uint64_t)steps * channel->slopeQ16 + 0x8000) >> 16);
+}
+
+uint32_t SERVOTIMER__setAngle(SERVOTIMER* self, uint8_t index, int16_t angle){
+	SERVOCHANNEL* channel = &self->channels[index];
+	channel->angle = clampAngle(channel, angle);
+	channel->compare = SERVOTIMER__compare(self, index, channel->angle);
+	return channel->compare;
+}
+
+uint32_t SERVOTIMER__resolution(const SERVOTIMER* self, uint8_t index){
+	const SERVOCHANNEL* channel = &self->channels[index];
+	return ((1000ULL << 16) + channel->slopeQ16 / 2) / channel->slopeQ16;
+}
@@ -0,0 +1,122 @@
+/*
+ * This library computes the PWM timer configuration and compare values for hobby servos. A SERVOTIMER is one timer
+ * with a fixed frame period (20 ms for a 50 Hz servo) shared by up to SERVOTIMER_MAX_CHANNELS servos, each with its
+ * own calibrated pulse range:
+ *
+ *		SERVOTIMER__configure(&timer, timerClockHz, 20000, 0xFFFFFFFF); //32-bit timer
+ *		uint8_t wingsail = SERVOTIMER__addChannel(&timer, TIM_CHANNEL_3, 560, 2560, 1800);
+ *		SERVOTIMER__setAngle(&timer, wingsail, 900); //90.0 degrees
+ *		//write timer.channels[wingsail].compare to the CCR of the channel
+ *
+ * The prescaler is the smallest that fits the frame in the auto-reload register, so the pulse resolution is as fine
+ * as the timer allows (6.25 ns on a 160 MHz 32-bit timer, 0.3 us on a 16-bit one). Angles are integers in a unit chosen
+ * per channel (0.1 degrees above) and the compare value is one multiply and shift from a precomputed Q16 slope.
+ *
+ * It does not depend on the HAL so it can be tested on a host machine (see SERVOSOLENOID.c for the TIM2 side).
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef SERVOCHANNEL_H
+#define SERVOCHANNEL_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define SERVOTIMER_MAX_CHANNELS 4 //capture/compare channels of a general purpose timer
+#define SERVOTIMER_MAX_PRESCALER 0xFFFF
+#define SERVOTIMER_NO_CHANNEL 0xFF //returned by SERVOTIMER__addChannel() on failure
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//One servo output of a SERVOTIMER
+typedef struct {
+	uint32_t id; //timer channel, not used by the library (e.g. TIM_CHANNEL_3)
+	uint16_t minPulseUs; //pulse at angle 0
+	uint16_t maxPulseUs; //pulse at maxAngle
+	int16_t maxAngle; //angle range in the unit of the channel
+	uint8_t reversed; //maxPulseUs is below minPulseUs
+	uint32_t baseTicks; //shortest pulse in timer ticks
+	uint32_t slopeQ16; //timer ticks per angle unit, Q16
+	int16_t angle; //last angle set, clamped
+	uint32_t compare; //compare value for angle
+} SERVOCHANNEL;
+
+//The SERVOTIMER data type
+typedef struct {
+	uint32_t clockHz; //timer input clock
+	uint32_t periodUs; //frame period
+	uint32_t prescaler; //value for the PSC register (clock divided by prescaler + 1)
+	uint32_t reload; //value for the ARR register (frame of reload + 1 ticks)
+	uint32_t tickHz; //counter frequency
+	SERVOCHANNEL channels[SERVOTIMER_MAX_CHANNELS];
+	uint8_t channelCount;
+} SERVOTIMER;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- SERVOTIMER METHODS --------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Computes the prescaler and auto-reload values for a frame period and removes all channels.
+ *
+ * @param self The timer to configure
+ * @param clockHz The timer input clock in Hz
+ * @param periodUs The frame period in us (20000 for 50 Hz)
+ * @param maxReload The largest auto-reload value (0xFFFF or 0xFFFFFFFF)
+ * @return 1 on success, 0 if the period does not fit even with the largest prescaler
+ */
+uint8_t SERVOTIMER__configure(SERVOTIMER* self, uint32_t clockHz, uint32_t periodUs, uint32_t maxReload);
+
+/*
+ * Adds a servo channel, parked at angle 0.
+ *
+ * @param self The configured timer
+ * @param id The timer channel, stored for the caller
+ * @param minPulseUs The pulse at angle 0 in us
+ * @param maxPulseUs The pulse at maxAngle in us (can be below minPulseUs to reverse the servo)
+ * @param maxAngle The angle range, e.g. 1800 for 180 degrees in 0.1 degrees
+ * @return The channel index, or SERVOTIMER_NO_CHANNEL if the timer is full or the range is invalid
+ */
+uint8_t SERVOTIMER__addChannel(SERVOTIMER* self, uint32_t id, uint16_t minPulseUs, uint16_t maxPulseUs, int16_t maxAngle);
+
+/*
+ * Returns the compare value for an angle without changing the channel.
+ *
+ * @param self The timer
+ * @param index The channel index
+ * @param angle The angle, clamped to 0..maxAngle
+ * @return The compare value
+ */
+uint32_t SERVOTIMER__compare(const SERVOTIMER* self, uint8_t index, int16_t angle);
+
+/*
+ * Sets the angle of a channel and updates its compare value.
+ *
+ * @param self The timer
+ * @param index The channel index
+ * @param angle The angle, clamped to 0..maxAngle
+ * @return The compare value to write to the channel
+ */
+uint32_t SERVOTIMER__setAngle(SERVOTIMER* self, uint8_t index, int16_t angle);
+
+/*
+ * Returns the angle step of one timer tick on a channel. Below 1000 the pulse is finer than the angle unit.
+ *
+ * @param self The timer
+ * @param index The channel index
+ * @return The angle per tick in 1/1000 of the angle unit
+ */
+uint32_t SERVOTIMER__resolution(const SERVOTIMER* self, uint8_t index);
+
+#endif /* SERVOCHANNEL_H */
@@ -0,0 +1,130 @@
+/*
+ * SERVORAMP.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "SERVORAMP.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define ONE (1L << SERVORAMP_FRACTION_BITS)
+
+//Distance covered while braking from a speed to a stop, one acceleration step per frame
+static int64_t brakingDistance(const SERVORAMP* self, int32_t speed){
+	if(speed <= 0){
+		return 0;
+	}
+	int64_t steps = speed / self->maxAcceleration;
+	return steps * speed - (int64_t)self->maxAcceleration * steps * (steps + 1) / 2;
+}
+
+//Per frame value of a per second quantity raised to a power of the frame period, Q8, at least 1
+static int32_t perFrame(uint64_t perSecond, uint32_t framePeriodUs, uint8_t power){
+	uint64_t value = perSecond << SERVORAMP_FRACTION_BITS;
+	for(uint8_t i = 0; i < power; i++){
+		value = value * framePeriodUs / 1000000;
+	}
+	if(value > INT32_MAX / 4){
+		value = INT32_MAX / 4;
+	}
+	return value == 0 ? 1 : value;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- SERVORAMP METHODS ---------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void SERVORAMP__init(SERVORAMP* self, uint32_t maxRate, uint32_t maxAcceleration, uint32_t framePeriodUs, int16_t position){
+	self->maxVelocity = perFrame(maxRate, framePeriodUs, 1);
+	self->maxAcceleration = perFrame(maxAcceleration, framePeriodUs, 2);
+	SERVORAMP__reset(self, position);
+}
+
+void SERVORAMP__reset(SERVORAMP* self, int16_t position){
+	self->position = (int32_t)position * ONE;
+	self->velocity = 0;
+	self->target = position;
+	self->fillPosition = self->position;
+	self->fillVelocity = 0;
+}
+
+void SERVORAMP__setTarget(SERVORAMP* self, int16_t target){
+	self->target = target;
+}
+
+uint8_t SERVORAMP__step(SERVORAMP* self){
+	if(SERVORAMP__done(self)){
+		return 0;
+	}
+
+	int32_t distance = (int32_t)self->target * ONE - self->position;
+	int32_t direction = distance < 0 ? -1 : 1;
+	int32_t remaining = distance * direction;
+	int32_t speed = self->velocity * direction; //negative when moving away from the target
+	int32_t a = self->maxAcceleration;
+
+	//Close enough to stop within one acceleration step
+	if(remaining <= a && speed <= a && speed >= -a){
+		self->position = (int32_t)self->target * ONE;
+		self->velocity = 0;
+		return 1;
+	}
+
+	//Fastest speed after which the ramp can still stop on the target, braking hard if none can
+	int32_t faster = speed + a > self->maxVelocity ? self->maxVelocity : speed + a;
+	int32_t next;
+	if(faster + brakingDistance(self, faster) <= remaining){
+		next = faster;
+	}
+	else if(speed <= self->maxVelocity && speed + brakingDistance(self, speed) <= remaining){
+		next = speed;
+	}
+	else{
+		next = speed - a;
+	}
+
+	self->velocity = next * direction;
+	self->position += self->velocity;
+	return 1;
+}
+
+uint8_t SERVORAMP__done(const SERVORAMP* self){
+	return self->velocity == 0 && self->position == (int32_t)self->target * ONE;
+}
+
+int16_t SERVORAMP__position(const SERVORAMP* self){
+	//Arithmetic shift rounds towards minus infinity, adding half rounds to nearest
+	return (self->position + ONE / 2) >> SERVORAMP_FRACTION_BITS;
+}
+
+uint32_t SERVORAMP__framesLeft(const SERVORAMP* self){
+	SERVORAMP copy = *self;
+	uint32_t frames = 0;
+	while(SERVORAMP__step(&copy)){
+		frames++;
+	}
+	return frames;
+}
+
+uint16_t SERVORAMP__fill(SERVORAMP* self, const SERVOTIMER* timer, uint8_t channel, uint32_t* buffer, uint16_t maxFrames){
+	self->fillPosition = self->position;
+	self->fillVelocity = self->velocity;
+
+	uint16_t frames = 0;
+	while(frames < maxFrames && SERVORAMP__step(self)){
+		buffer[frames++] = SERVOTIMER__compare(timer, channel, SERVORAMP__position(self));
+	}
+	return frames;
+}
+
+void SERVORAMP__rewind(SERVORAMP* self, uint16_t frames){
+	self->position = self->fillPosition;
+	self->velocity = self->fillVelocity;
+	for(uint16_t i = 0; i < frames; i++){
+		SERVORAMP__step(self);
+	}
+}
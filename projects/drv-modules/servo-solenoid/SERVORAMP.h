@@ -0,0 +1,136 @@
+/*
+ * This library generates slew-limited servo moves: the angle changes by at most the maximum rate per second and
+ * the rate by at most the maximum acceleration, so large wingsail trim moves start and stop smoothly instead of
+ * stepping the pulse. It runs one step per PWM frame and decelerates so that it stops on the target without
+ * overshooting.
+ *
+ * The steps of a move are computed ahead into a buffer of compare values (SERVORAMP__fill()) that the timer streams
+ * into its compare register by DMA on each update event, so the CPU is only involved once per buffer. When the
+ * target changes during a move, SERVORAMP__rewind() brings the ramp back to the last frame the timer used and the
+ * move continues from there with its current rate.
+ *
+ * Angles are in the unit of the servo channel (0.1 degrees for the wingsail). Internally the position and rate are
+ * kept in 1/256 of that unit. It does not depend on the HAL so the profiles can be checked on a host machine.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef SERVORAMP_H
+#define SERVORAMP_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "SERVOCHANNEL.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#define SERVORAMP_FRACTION_BITS 8
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//The SERVORAMP data type
+typedef struct {
+	int32_t maxVelocity; //per frame, Q8
+	int32_t maxAcceleration; //per frame squared, Q8
+	int32_t position; //Q8
+	int32_t velocity; //per frame, Q8
+	int16_t target;
+	//state at the start of the last SERVORAMP__fill()
+	int32_t fillPosition;
+	int32_t fillVelocity;
+} SERVORAMP;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- SERVORAMP METHODS ---------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Initializes a ramp at rest.
+ *
+ * @param self The ramp to initialize
+ * @param maxRate The maximum rate in angle units per second
+ * @param maxAcceleration The maximum acceleration in angle units per second squared
+ * @param framePeriodUs The time between steps (the PWM frame)
+ * @param position The starting angle
+ */
+void SERVORAMP__init(SERVORAMP* self, uint32_t maxRate, uint32_t maxAcceleration, uint32_t framePeriodUs, int16_t position);
+
+/*
+ * Stops the ramp at an angle, e.g. when the servo position is not known and it has to jump.
+ *
+ * @param self The ramp
+ * @param position The angle
+ */
+void SERVORAMP__reset(SERVORAMP* self, int16_t position);
+
+/*
+ * Sets the angle to move to. The move continues from the current position and rate.
+ *
+ * @param self The ramp
+ * @param target The target angle
+ */
+void SERVORAMP__setTarget(SERVORAMP* self, int16_t target);
+
+/*
+ * Advances the ramp by one frame.
+ *
+ * @param self The ramp
+ * @return 1 if the ramp moved
+ */
+uint8_t SERVORAMP__step(SERVORAMP* self);
+
+/*
+ * Returns whether the ramp is stopped on its target.
+ *
+ * @param self The ramp
+ * @return 1 once the move is complete
+ */
+uint8_t SERVORAMP__done(const SERVORAMP* self);
+
+/*
+ * Returns the current angle, rounded.
+ *
+ * @param self The ramp
+ * @return The angle
+ */
+int16_t SERVORAMP__position(const SERVORAMP* self);
+
+/*
+ * Returns the number of frames until the ramp stops on its target.
+ *
+ * @param self The ramp
+ * @return The number of frames, 0 if it is done
+ */
+uint32_t SERVORAMP__framesLeft(const SERVORAMP* self);
+
+/*
+ * Computes the compare values of the next frames of the move. The last value written is the target once the ramp
+ * is done.
+ *
+ * @param self The ramp
+ * @param timer The timer of the servo
+ * @param channel The channel index of the servo
+ * @param buffer Receives the compare values, one per frame
+ * @param maxFrames The size of the buffer
+ * @return The number of frames written, 0 if the ramp is done
+ */
+uint16_t SERVORAMP__fill(SERVORAMP* self, const SERVOTIMER* timer, uint8_t channel, uint32_t* buffer, uint16_t maxFrames);
+
+/*
+ * Sets the ramp back to where it was after a number of frames of the last SERVORAMP__fill(), e.g. the frames the
+ * DMA transferred before it was stopped. Call it before changing the target.
+ *
+ * @param self The ramp
+ * @param frames The number of frames used
+ */
+void SERVORAMP__rewind(SERVORAMP* self, uint16_t frames);
+
+#endif /* SERVORAMP_H */
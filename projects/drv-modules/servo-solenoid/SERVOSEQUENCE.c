@@ -0,0 +1,200 @@
+/*
+ * SERVOSEQUENCE.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "SERVOSEQUENCE.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- HELPER FUNCTIONS ----------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+static int16_t clampAngle(int16_t angle){
+	if(angle < SERVOSEQUENCE_MIN_ANGLE){
+		return SERVOSEQUENCE_MIN_ANGLE;
+	}
+	if(angle > SERVOSEQUENCE_MAX_ANGLE){
+		return SERVOSEQUENCE_MAX_ANGLE;
+	}
+	return angle;
+}
+
+static void setState(SERVOSEQUENCE* self, SERVOSEQUENCE_STATE state, uint32_t now, uint32_t duration){
+	self->state = state;
+	self->deadline = now + duration;
+	self->changed = 1;
+}
+
+//Time to reach the target from anywhere in the span
+static uint32_t moveTime(const SERVOSEQUENCE* self){
+	int32_t low = self->target - self->spanLow;
+	int32_t high = self->spanHigh - self->target;
+	int32_t distance = low > high ? low : high;
+	if(distance < 0){
+		distance = -distance;
+	}
+	return ((uint32_t)distance * self->timing.msPer10Degrees + 99) / 100;
+}
+
+static void startMove(SERVOSEQUENCE* self, uint32_t now){
+	self->pwm = 1;
+	if(self->spanLow > self->target){
+		self->spanLow = self->target;
+	}
+	if(self->spanHigh < self->target){
+		self->spanHigh = self->target;
+	}
+	setState(self, SERVOSEQUENCE_MOVE, now, moveTime(self));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- SERVOSEQUENCE METHODS -----------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+void SERVOSEQUENCE__init(SERVOSEQUENCE* self, const SERVOSEQUENCE_TIMING* timing){
+	self->timing = *timing;
+	self->state = SERVOSEQUENCE_IDLE;
+	self->deadline = 0;
+	self->solenoid = 0;
+	self->pwm = 0;
+	self->target = 0;
+	self->position = 0;
+	self->positionKnown = 0;
+	self->spanLow = SERVOSEQUENCE_MIN_ANGLE;
+	self->spanHigh = SERVOSEQUENCE_MAX_ANGLE;
+	self->commands = 0;
+	self->merged = 0;
+	self->completed = 0;
+	self->changed = 0;
+}
+
+void SERVOSEQUENCE__command(SERVOSEQUENCE* self, int16_t angle, uint32_t now){
+	angle = clampAngle(angle);
+	self->commands++;
+
+	switch(self->state){
+	case SERVOSEQUENCE_IDLE:
+		self->target = angle;
+		if(self->positionKnown && angle == self->position){
+			//Already there, acknowledge without moving
+			self->completed++;
+			self->changed = 1;
+			return;
+		}
+		//A servo that has never been driven could be anywhere
+		self->spanLow = self->positionKnown ? self->position : SERVOSEQUENCE_MIN_ANGLE;
+		self->spanHigh = self->positionKnown ? self->position : SERVOSEQUENCE_MAX_ANGLE;
+		self->solenoid = 1;
+		setState(self, SERVOSEQUENCE_RELEASE, now, self->timing.releaseMs);
+		return;
+
+	case SERVOSEQUENCE_RELEASE:
+		self->target = angle;
+		break;
+
+	case SERVOSEQUENCE_MOVE:
+		//Already moving to it, the deadline stays so repeated commands cannot keep the move going
+		if(angle == self->target){
+			break;
+		}
+		//The servo is somewhere between where it started and the targets it was given
+		self->target = angle;
+		startMove(self, now);
+		break;
+
+	case SERVOSEQUENCE_HOLD:
+		if(angle != self->target){
+			self->spanLow = self->target;
+			self->spanHigh = self->target;
+			self->target = angle;
+			startMove(self, now);
+		}
+		break;
+
+	case SERVOSEQUENCE_LOCK:
+		//Already at the target, let the lock complete
+		if(angle == self->target){
+			break;
+		}
+		//The pin may already be partly engaged, release it completely before moving
+		self->target = angle;
+		self->spanLow = self->position;
+		self->spanHigh = self->position;
+		self->solenoid = 1;
+		setState(self, SERVOSEQUENCE_RELEASE, now, self->timing.releaseMs);
+		break;
+	}
+	self->merged++;
+}
+
+uint8_t SERVOSEQUENCE__update(SERVOSEQUENCE* self, uint32_t now){
+	if(self->state == SERVOSEQUENCE_IDLE || (int32_t)(now - self->deadline) < 0){
+		return 0;
+	}
+
+	switch(self->state){
+	case SERVOSEQUENCE_RELEASE:
+		startMove(self, now);
+		break;
+
+	case SERVOSEQUENCE_MOVE:
+		setState(self, SERVOSEQUENCE_HOLD, now, self->timing.holdMs);
+		break;
+
+	case SERVOSEQUENCE_HOLD:
+		self->pwm = 0;
+		self->solenoid = 0;
+		self->position = self->target;
+		self->positionKnown = 1;
+		setState(self, SERVOSEQUENCE_LOCK, now, self->timing.lockMs);
+		break;
+
+	case SERVOSEQUENCE_LOCK:
+	default:
+		self->completed++;
+		setState(self, SERVOSEQUENCE_IDLE, now, 0);
+		break;
+	}
+	return 1;
+}
+
+void SERVOSEQUENCE__setMoveTime(SERVOSEQUENCE* self, uint32_t now, uint32_t ms){
+	if(self->state == SERVOSEQUENCE_MOVE){
+		self->deadline = now + ms;
+	}
+}
+
+uint32_t SERVOSEQUENCE__remaining(const SERVOSEQUENCE* self, uint32_t now){
+	int32_t remaining = (int32_t)(self->deadline - now);
+	if(self->state == SERVOSEQUENCE_IDLE || remaining < 0){
+		return 0;
+	}
+	return remaining;
+}
+
+uint8_t SERVOSEQUENCE__takeChanged(SERVOSEQUENCE* self){
+	uint8_t changed = self->changed;
+	self->changed = 0;
+	return changed;
+}
+
+void SERVOSEQUENCE__packCAN(const SERVOSEQUENCE* self, uint8_t* data){
+	uint8_t flags = 0;
+	if(self->positionKnown){
+		flags |= SERVOSEQUENCE_POSITION_KNOWN;
+	}
+	if(self->state != SERVOSEQUENCE_IDLE){
+		flags |= SERVOSEQUENCE_BUSY;
+	}
+
+	data[0] = self->state;
+	data[1] = flags;
+	data[2] = (uint16_t)self->target & 0xFF;
+	data[3] = (uint16_t)self->target >> 8;
+	data[4] = (uint16_t)self->position & 0xFF;
+	data[5] = (uint16_t)self->position >> 8;
+	data[6] = self->completed & 0xFF;
+	data[7] = self->completed >> 8;
+}
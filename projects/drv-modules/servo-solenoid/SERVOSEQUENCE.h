@@ -0,0 +1,157 @@
+/*
+ * This library sequences the wingsail trim actuation: the solenoid pin that locks the wingsail has to be released
+ * before the servo moves and engaged again once it has arrived. It is an explicit state machine,
+ *
+ *		IDLE -> RELEASE -> MOVE -> HOLD -> LOCK -> IDLE
+ *
+ * that accepts a new target angle in every state and always finishes on the most recent one, so rapid trim
+ * commands are merged into the running sequence instead of being dropped or restarting it:
+ *		-RELEASE: the new target is used when the servo starts moving
+ *		-MOVE: the move time is extended to cover the new target from anywhere the servo could be, unless the target is the same
+ *		-HOLD: the servo moves again from the old target
+ *		-LOCK: the solenoid is energized again and the sequence goes back to RELEASE, unless the target is the same
+ *
+ * It does not depend on the HAL so it can be tested on a host machine. The outputs (solenoid, PWM, target) and the
+ * time the current state ends are fields the HAL side applies after each call (see SERVOSOLENOID.c).
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef SERVOSEQUENCE_H
+#define SERVOSEQUENCE_H
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- INCLUDES ---------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- MACROS -----------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+//Range of the servo in 0.1 degrees
+#define SERVOSEQUENCE_MIN_ANGLE 0
+#define SERVOSEQUENCE_MAX_ANGLE 1800
+
+//Status flags
+#define SERVOSEQUENCE_POSITION_KNOWN 0x01 //the servo has completed at least one sequence
+#define SERVOSEQUENCE_BUSY 0x02 //a sequence is running
+
+//Size of the CAN payload produced by SERVOSEQUENCE__packCAN()
+#define SERVOSEQUENCE_CAN_PAYLOAD_SIZE 8
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------- STRUCTURES ---------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+typedef enum {
+	SERVOSEQUENCE_IDLE, //solenoid pin engaged, servo off
+	SERVOSEQUENCE_RELEASE, //solenoid energized, waiting for the pin to retract
+	SERVOSEQUENCE_MOVE, //servo driven to the target
+	SERVOSEQUENCE_HOLD, //servo at the target, waiting for the wingsail to settle
+	SERVOSEQUENCE_LOCK //servo off, solenoid released, waiting for the pin to engage
+} SERVOSEQUENCE_STATE;
+
+//Durations of the states, in ms
+typedef struct {
+	uint16_t releaseMs;
+	uint16_t msPer10Degrees; //servo speed, the move time is proportional to the distance
+	uint16_t holdMs;
+	uint16_t lockMs;
+} SERVOSEQUENCE_TIMING;
+
+//The SERVOSEQUENCE data type
+typedef struct {
+	SERVOSEQUENCE_TIMING timing;
+	SERVOSEQUENCE_STATE state;
+	uint32_t deadline; //time the current state ends in ms, not used in IDLE
+	//outputs to apply to the hardware
+	uint8_t solenoid; //1 while the solenoid is energized (pin retracted)
+	uint8_t pwm; //1 while the servo is driven
+	int16_t target; //most recent commanded angle in 0.1 degrees
+	//servo position
+	int16_t position; //angle of the last completed sequence in 0.1 degrees
+	uint8_t positionKnown;
+	int16_t spanLow; //range of angles the servo can be at during a move
+	int16_t spanHigh;
+	//statistics
+	uint16_t commands; //commands received
+	uint16_t merged; //commands received while a sequence was running
+	uint16_t completed; //sequences completed
+	uint8_t changed; //the state changed since SERVOSEQUENCE__takeChanged()
+} SERVOSEQUENCE;
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------- SERVOSEQUENCE METHODS -------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+/*
+ * Initializes a sequencer in IDLE with an unknown servo position.
+ *
+ * @param self The sequencer to initialize
+ * @param timing The durations of the states
+ */
+void SERVOSEQUENCE__init(SERVOSEQUENCE* self, const SERVOSEQUENCE_TIMING* timing);
+
+/*
+ * Commands a new target angle. Can be called in any state.
+ *
+ * @param self The sequencer
+ * @param angle The target in 0.1 degrees, clamped to the servo range
+ * @param now The current time in ms
+ */
+void SERVOSEQUENCE__command(SERVOSEQUENCE* self, int16_t angle, uint32_t now);
+
+/*
+ * Moves to the next state once the deadline of the current one is reached. Call it when the state timer expires
+ * (or periodically).
+ *
+ * @param self The sequencer
+ * @param now The current time in ms
+ * @return 1 if the state changed
+ */
+uint8_t SERVOSEQUENCE__update(SERVOSEQUENCE* self, uint32_t now);
+
+/*
+ * Replaces the estimated duration of the running move, e.g. with the length of a slew-limited ramp. Does nothing
+ * outside MOVE.
+ *
+ * @param self The sequencer
+ * @param now The current time in ms
+ * @param ms The time the move still needs in ms
+ */
+void SERVOSEQUENCE__setMoveTime(SERVOSEQUENCE* self, uint32_t now, uint32_t ms);
+
+/*
+ * Returns the time left in the current state.
+ *
+ * @param self The sequencer
+ * @param now The current time in ms
+ * @return The time left in ms, 0 in IDLE or once the deadline has passed
+ */
+uint32_t SERVOSEQUENCE__remaining(const SERVOSEQUENCE* self, uint32_t now);
+
+/*
+ * Returns whether the state changed since the last call, e.g. to send the status over CAN.
+ *
+ * @param self The sequencer
+ * @return 1 if the state changed
+ */
+uint8_t SERVOSEQUENCE__takeChanged(SERVOSEQUENCE* self);
+
+/*
+ * Packs the status into a CAN payload:
+ *		-Byte 0: state (SERVOSEQUENCE_STATE)
+ *		-Byte 1: flags (SERVOSEQUENCE_POSITION_KNOWN, SERVOSEQUENCE_BUSY)
+ *		-Bytes 2-3: target, 0.1 degrees, little endian
+ *		-Bytes 4-5: position of the last completed sequence, 0.1 degrees, little endian
+ *		-Bytes 6-7: number of completed sequences, little endian (increments on every completion)
+ *
+ * @param self The sequencer
+ * @param data Receives the SERVOSEQUENCE_CAN_PAYLOAD_SIZE bytes of the payload
+ */
+void SERVOSEQUENCE__packCAN(const SERVOSEQUENCE* self, uint8_t* data);
+
+#endif /* SERVOSEQUENCE_H */
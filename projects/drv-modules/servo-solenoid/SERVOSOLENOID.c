@@ -10,7 +10,8 @@
  * Includes:
  */
 
-#include "servosolenoid.h"
+#include "SERVOSOLENOID.h"
+#include "profiling_irq.h"
 
 /*
  * Variables:
@@ -18,12 +19,136 @@
 
 TIM_HandleTypeDef htim2;
 TIM_HandleTypeDef htim6;
-TIM_HandleTypeDef htim7;
+DMA_HandleTypeDef hdma_tim2_up;
+
+static SERVOSEQUENCE sequence;
+static SERVOTIMER servoTimer; //TIM2 servo outputs
+static uint8_t wingsailChannel = SERVOTIMER_NO_CHANNEL;
+static uint8_t pwmRunning = 0;
+
+//Slew-limited moves of the wingsail servo, streamed into CCR3 by DMA
+static SERVORAMP ramp;
+static uint32_t rampBuffer[SERVOSOLENOID_RAMP_FRAMES];
+static uint16_t rampQueued = 0; //frames in the running DMA transfer, 0 when stopped
+
+//TIM6 counts at 10 kHz, so a one-shot delay can be up to 6.5 s
+#define SEQUENCE_TICK_FREQUENCY 10000
+#define SEQUENCE_TICKS_PER_MS (SEQUENCE_TICK_FREQUENCY / 1000)
 
 /*
  * Functions:
  */
 
+static void MX_TIM2_Init(void);
+static void MX_TIM6_Init(void);
+static void MX_GPDMA1_Init(void);
+
+//Clock of the timers on APB1 (TIM2 to TIM7), twice PCLK1 when APB1 is divided
+static uint32_t timerClock(void)
+{
+	uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+	return ((RCC->CFGR2 & RCC_CFGR2_PPRE1) == RCC_HCLK_DIV1) ? pclk : 2 * pclk;
+}
+
+//Stops the DMA and brings the ramp back to the last frame TIM2 received
+static void stopRamp(void)
+{
+	if(rampQueued == 0)
+	{
+		return;
+	}
+	__HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	uint16_t used = rampQueued - __HAL_DMA_GET_COUNTER(&hdma_tim2_up) / sizeof(uint32_t);
+	HAL_DMA_Abort(&hdma_tim2_up);
+	HAL_TIM_DMABurst_WriteStop(&htim2, TIM_DMA_UPDATE);
+	rampQueued = 0;
+
+	SERVORAMP__rewind(&ramp, used);
+	SERVOTIMER__setAngle(&servoTimer, wingsailChannel, SERVORAMP__position(&ramp));
+}
+
+//Frames until the ramp stops, the ones still queued for the DMA included
+static uint32_t rampFramesLeft(void)
+{
+	uint32_t queued = (rampQueued > 0) ? __HAL_DMA_GET_COUNTER(&hdma_tim2_up) / sizeof(uint32_t) : 0;
+	return SERVORAMP__framesLeft(&ramp) + queued;
+}
+
+//Queues the next frames of the ramp, TIM2 writes one to CCR3 on each update event (CCR3 is preloaded so it takes
+//effect on the following frame)
+static void streamRamp(void)
+{
+	rampQueued = SERVORAMP__fill(&ramp, &servoTimer, wingsailChannel, rampBuffer, SERVOSOLENOID_RAMP_FRAMES);
+	if(rampQueued > 0)
+	{
+		//The GPDMA length is in bytes
+		HAL_TIM_DMABurst_MultiWriteStart(&htim2, TIM_DMABASE_CCR3, TIM_DMA_UPDATE, rampBuffer, TIM_DMABURSTLENGTH_1TRANSFER, rampQueued * sizeof(uint32_t));
+	}
+}
+
+//Applies the outputs of the sequencer and starts TIM6 for the rest of the current state.
+//Must be called with the TIM6 and GPDMA1 channel 0 interrupts unable to preempt.
+static void applySequence(void)
+{
+	if(sequence.solenoid)
+	{
+		HAL_GPIO_WritePin(SolenoidOutput_GPIO_Port, SolenoidOutput_Pin, GPIO_PIN_SET);
+	}
+
+	if(sequence.pwm && !pwmRunning)
+	{
+		//A servo that has never been driven could be anywhere, so it jumps to the first target
+		if(!sequence.positionKnown)
+		{
+			SERVORAMP__reset(&ramp, sequence.target);
+		}
+		__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_3, SERVOTIMER__setAngle(&servoTimer, wingsailChannel, SERVORAMP__position(&ramp)));
+		HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_3);
+		pwmRunning = 1;
+	}
+	else if(!sequence.pwm && pwmRunning)
+	{
+		stopRamp();
+		HAL_TIM_PWM_Stop(&htim2, TIM_CHANNEL_3);
+		HAL_GPIO_WritePin(GPIOA, GPIO_PIN_2, 0); //Forces the PWM Output Pin to a 0V state (High Impedance).
+		pwmRunning = 0;
+	}
+
+	uint8_t retarget = sequence.pwm && ramp.target != sequence.target;
+	if(retarget)
+	{
+		//New target: continue from the frame TIM2 is on at the current rate
+		stopRamp();
+		SERVORAMP__setTarget(&ramp, sequence.target);
+		streamRamp();
+	}
+	if(sequence.state == SERVOSEQUENCE_MOVE && (retarget || sequence.positionKnown))
+	{
+		//The move lasts as long as the ramp, whatever the sequencer estimated from the span. A servo that has never
+		//been driven jumps to its first target, the estimate is kept then.
+		SERVOSEQUENCE__setMoveTime(&sequence, HAL_GetTick(), (rampFramesLeft() + 1) * SERVOSOLENOID_FRAME_US / 1000);
+	}
+
+	if(!sequence.solenoid)
+	{
+		//Push Solenoid back in, after the servo is off
+		HAL_GPIO_WritePin(SolenoidOutput_GPIO_Port, SolenoidOutput_Pin, GPIO_PIN_RESET);
+	}
+
+	//One-shot TIM6 for the rest of the state
+	HAL_TIM_Base_Stop_IT(&htim6);
+	__HAL_TIM_SET_COUNTER(&htim6, 0);
+	__HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
+	if(sequence.state != SERVOSEQUENCE_IDLE)
+	{
+		uint32_t ticks = SERVOSEQUENCE__remaining(&sequence, HAL_GetTick()) * SEQUENCE_TICKS_PER_MS;
+		if(ticks == 0) ticks = 1;
+		if(ticks > 0x10000) ticks = 0x10000;
+		__HAL_TIM_SET_AUTORELOAD(&htim6, ticks - 1);
+		HAL_TIM_Base_Start_IT(&htim6);
+	}
+}
+
 void initializeServoSolenoid(void)
 {
 	//Initializes the peripherals required for the Servo motor and Solenoid
@@ -32,17 +157,24 @@ void initializeServoSolenoid(void)
 	/*       Configure the Servo Motor		  */
 	////////////////////////////////////////////
 
+	//TIM2 is a 32-bit timer, so the 20 ms frame fits without a prescaler
+	SERVOTIMER__configure(&servoTimer, timerClock(), SERVOSOLENOID_FRAME_US, 0xFFFFFFFF);
+	wingsailChannel = SERVOTIMER__addChannel(&servoTimer, TIM_CHANNEL_3, SERVOSOLENOID_PULSE_MIN_US, SERVOSOLENOID_PULSE_MAX_US, SERVOSEQUENCE_MAX_ANGLE);
+
 	MX_TIM2_Init();
-	MX_TIM7_Init();
     MX_TIM6_Init();
+    MX_GPDMA1_Init();
 
+    //The sequencer runs in both interrupts, neither may preempt the other
+    HAL_NVIC_SetPriority(TIM6_IRQn, SERVOSOLENOID_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM6_IRQn);
+    HAL_NVIC_SetPriority(GPDMA1_Channel0_IRQn, SERVOSOLENOID_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel0_IRQn);
 
 	HAL_TIM_Base_Stop_IT(&htim6);
-	HAL_TIM_Base_Stop_IT(&htim7);
+	__HAL_TIM_SET_PRESCALER(&htim6, timerClock() / SEQUENCE_TICK_FREQUENCY - 1);
 	__HAL_TIM_SET_COUNTER(&htim6, 0);
-	__HAL_TIM_SET_COUNTER(&htim7, 0);
 	__HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
-	__HAL_TIM_CLEAR_FLAG(&htim7, TIM_FLAG_UPDATE);
 
 	////////////////////////////////////////////
 	/*Configure GPIO pin : SolenoidOutput_Pin */
@@ -62,6 +194,20 @@ void initializeServoSolenoid(void)
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
     HAL_GPIO_Init(SolenoidOutput_GPIO_Port, &GPIO_InitStruct);
 
+	////////////////////////////////////////////
+	/*         Configure the Sequencer        */
+	////////////////////////////////////////////
+
+	const SERVOSEQUENCE_TIMING timing = {
+		.releaseMs = SERVOSOLENOID_RELEASE_MS,
+		.msPer10Degrees = SERVOSOLENOID_MS_PER_10_DEGREES,
+		.holdMs = SERVOSOLENOID_HOLD_MS,
+		.lockMs = SERVOSOLENOID_LOCK_MS
+	};
+	SERVOSEQUENCE__init(&sequence, &timing);
+	SERVORAMP__init(&ramp, SERVOSOLENOID_MAX_RATE, SERVOSOLENOID_MAX_ACCELERATION, SERVOSOLENOID_FRAME_US, 0);
+	pwmRunning = 0;
+	rampQueued = 0;
 }
 
 static void MX_TIM2_Init(void)
@@ -72,9 +218,9 @@ static void MX_TIM2_Init(void)
   TIM_OC_InitTypeDef sConfigOC = {0};
 
   htim2.Instance = TIM2;
-  htim2.Init.Prescaler = 1600-1;
+  htim2.Init.Prescaler = servoTimer.prescaler;
   htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim2.Init.Period = 1999;
+  htim2.Init.Period = servoTimer.reload;
   htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
@@ -97,7 +243,7 @@ static void MX_TIM2_Init(void)
     Error_Handler();
   }
   sConfigOC.OCMode = TIM_OCMODE_PWM1;
-  sConfigOC.Pulse = 0;
+  sConfigOC.Pulse = servoTimer.channels[wingsailChannel].compare;
   sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
   sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
   if (HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
@@ -134,165 +280,132 @@ static void MX_TIM6_Init(void)
 
 }
 
-static void MX_TIM7_Init(void)
+static void MX_GPDMA1_Init(void)
 {
 
-  TIM_MasterConfigTypeDef sMasterConfig = {0};
-
-  htim7.Instance = TIM7;
-  htim7.Init.Prescaler = 2472;
-  htim7.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim7.Init.Period = 65535;
-  htim7.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-  if (HAL_TIM_Base_Init(&htim7) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
-  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-  if (HAL_TIMEx_MasterConfigSynchronization(&htim7, &sMasterConfig) != HAL_OK)
+  __HAL_RCC_GPDMA1_CLK_ENABLE();
+
+  hdma_tim2_up.Instance = GPDMA1_Channel0;
+  hdma_tim2_up.Init.Request = GPDMA1_REQUEST_TIM2_UP;
+  hdma_tim2_up.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+  hdma_tim2_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_tim2_up.Init.SrcInc = DMA_SINC_INCREMENTED;
+  hdma_tim2_up.Init.DestInc = DMA_DINC_FIXED;
+  hdma_tim2_up.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_WORD;
+  hdma_tim2_up.Init.DestDataWidth = DMA_DEST_DATAWIDTH_WORD;
+  hdma_tim2_up.Init.Priority = DMA_LOW_PRIORITY_LOW_WEIGHT;
+  hdma_tim2_up.Init.SrcBurstLength = 1;
+  hdma_tim2_up.Init.DestBurstLength = 1;
+  hdma_tim2_up.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0|DMA_DEST_ALLOCATED_PORT0;
+  hdma_tim2_up.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+  hdma_tim2_up.Init.Mode = DMA_NORMAL;
+  if (HAL_DMA_Init(&hdma_tim2_up) != HAL_OK)
   {
     Error_Handler();
   }
+  __HAL_LINKDMA(&htim2, hdma[TIM_DMA_ID_UPDATE], hdma_tim2_up);
+
 }
 
 void TIM6_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM6_IRQn 0 */
-
+  PROFILING_IRQ_ENTER_TIMER(TIM6, TIM6);
   /* USER CODE END TIM6_IRQn 0 */
   HAL_TIM_IRQHandler(&htim6);
   /* USER CODE BEGIN TIM6_IRQn 1 */
-
+  PROFILING_IRQ_EXIT(TIM6);
   /* USER CODE END TIM6_IRQn 1 */
 }
 
-/**
-  * @brief This function handles TIM7 global interrupt.
-  */
-void TIM7_IRQHandler(void)
+void GPDMA1_Channel0_IRQHandler(void)
 {
-  /* USER CODE BEGIN TIM7_IRQn 0 */
-
-  /* USER CODE END TIM7_IRQn 0 */
-  HAL_TIM_IRQHandler(&htim7);
-  /* USER CODE BEGIN TIM7_IRQn 1 */
+  PROFILING_IRQ_ENTER(GPDMA1_CH0);
+  HAL_DMA_IRQHandler(&hdma_tim2_up);
+  PROFILING_IRQ_EXIT(GPDMA1_CH0);
+}
 
-  /* USER CODE END TIM7_IRQn 1 */
+void moveServo(double angle)
+{
+	//0 Degrees = 2.8% Duty Cycle (560 us), 180 Degrees = 12.8% Duty Cycle (2560 us), 50 Hz
+	setServoTarget((int16_t)(angle * 10));
 }
 
+void setServoTarget(int16_t angle)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	SERVOSEQUENCE__command(&sequence, angle, HAL_GetTick());
+	applySequence();
+	__set_PRIMASK(primask);
+}
 
-int is_TIM6_Running(void)
+uint8_t addServoChannel(uint32_t channel, uint16_t minPulseUs, uint16_t maxPulseUs, int16_t maxAngle)
 {
-	//returns TRUE (1) if TIM6 is running and FALSE (0) if TIM6 is not running
-	if((TIM6->CR1 & TIM_CR1_CEN) != 0)
+	uint8_t index = SERVOTIMER__addChannel(&servoTimer, channel, minPulseUs, maxPulseUs, maxAngle);
+	if(index == SERVOTIMER_NO_CHANNEL)
 	{
-		return 1;
+		return index;
 	}
-	else
+
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	sConfigOC.OCMode = TIM_OCMODE_PWM1;
+	sConfigOC.Pulse = servoTimer.channels[index].compare;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	if (HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, channel) != HAL_OK)
 	{
-		return 0;
+		Error_Handler();
 	}
+	return index;
 }
 
-int is_TIM7_Running(void)
+void setServoAngle(uint8_t index, int16_t angle)
 {
-	//returns TRUE (1) if TIM6 is running and FALSE (0) if TIM7 is not running
-	if((TIM7->CR1 & TIM_CR1_CEN) != 0)
+	if(index >= servoTimer.channelCount || index == wingsailChannel)
 	{
-		return 1;
+		return;
 	}
-	else
+	SERVOCHANNEL* servo = &servoTimer.channels[index];
+	__HAL_TIM_SET_COMPARE(&htim2, servo->id, SERVOTIMER__setAngle(&servoTimer, index, angle));
+	if(TIM_CHANNEL_STATE_GET(&htim2, servo->id) == HAL_TIM_CHANNEL_STATE_READY)
 	{
-		return 0;
+		HAL_TIM_PWM_Start(&htim2, servo->id);
 	}
 }
 
-void moveServo(double angle)
+SERVOSEQUENCE_STATE getServoSolenoidState(void)
 {
+	return sequence.state;
+}
 
-	/***********************************************************************************************************************************
-	* IMPORTANT NOTE:																												   *
-	*																																   *
-	* "angle" Parameter -> 0 =< angle <= 180																						   *
-	* FREQUENCY = 50 HZ (DOUBLE CHECK THIS!!)																						   *					   				   *
-	* CLOCK SPEED ON TIM 2 = 160 MHZ																							       *
-	* PRE-SCALOR = 160-1 -> NEW CLOCK SPEED = 1 MHz																					   *
-	* COUNTER-PERIOD = 5000-1 -> PWM FREQUENCY = 50 HZ = 20ms Time Period (CHECK WITH MICHAEL ON FREQUENCY/TIME PERIOD OF SERVO MOTOR) *
-	* 																																   *
-	* 0 Degrees =  2.5% Duty Cycle (DutyCycleInput == 500) -> absoluteAngle == 0;							   						   *
-	* 90 Degrees = 7.5% Duty Cycle (DutyCycleInput == 1500)	-> absoluetAngle == 90				   			   						   *
-	* 180 Degrees = 12.5% Duty Cycle (DutyCycleInput == 2500) -> absoluteAngle == 180						   						   *
-	* 																																   *
-	* GPIOE PIN 0 == SOLENOID PIN																									   *
-	* 																																   *
-	* (TIM6->CR1 && TIM_CR1_CEN) == 0 (Timer 6 is not running)																	       *
-	* (TIM6->CR1 && TIM_CR1_CEN) != 0 (Timer 6 is running)																			   *
-	* - Same Logic with TIM7																										   *
-	* 																																   *
-	* __HAL_TIM_SET_COMPARE Sets the Duty Cycle of the Servo (But does not turn it on or off)										   *
-	* 																																   *
-	* 											    													   							   *
-	***********************************************************************************************************************************/
-
-	uint32_t absoluteAngle = (uint32_t)(angle);
-
-	//Setting Servo Duty Cycle
-	uint32_t DutyCycleInput = 0;
-	DutyCycleInput = (560) + (absoluteAngle * (2500 - 500) / 180);
-
-	if(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_0) == 0 && is_TIM6_Running() == 0 && is_TIM7_Running() == 0)
-	{
-		//Set Servo Duty Cycle
-		__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_3, DutyCycleInput/10); //ARR = 20000
-
-		HAL_GPIO_WritePin(GPIOE, GPIO_PIN_0, 1);
-		HAL_TIM_Base_Start_IT(&htim7);
-
-	}
-	else if(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_0) == 1 && (is_TIM6_Running() == 0 && is_TIM7_Running() == 1))
+uint8_t servoSolenoidStatus(uint8_t* data)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t changed = SERVOSEQUENCE__takeChanged(&sequence);
+	if(changed)
 	{
-		__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_3, DutyCycleInput); //ARR = 20000
-	}
-	else if(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_0) == 1 && (is_TIM6_Running() == 1 && is_TIM7_Running() == 0))
-	{
-		HAL_TIM_Base_Stop_IT(&htim6);
-		__HAL_TIM_SET_COUNTER(&htim6, 0);
-		__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_3, DutyCycleInput); //ARR = 20000
-		HAL_TIM_Base_Start_IT(&htim6);
+		SERVOSEQUENCE__packCAN(&sequence, data);
 	}
+	__set_PRIMASK(primask);
+	return changed;
 }
 
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
-   // Handle TIM7 interrupt here as well if needed
-	if (htim->Instance == TIM7)
+	if (htim->Instance == TIM6)
 	{
-		__HAL_TIM_CLEAR_FLAG(&htim7, TIM_FLAG_UPDATE);
-		// Stop TIM7
-		HAL_TIM_Base_Stop_IT(&htim7);
-		__HAL_TIM_SET_COUNTER(&htim7, 0);
-
-		// Start TIM6 && Start Servo PWM Signal
-		HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_3);
-		HAL_TIM_Base_Start_IT(&htim6);
-
-	}
-
-    // Check if the interrupt is from TIM6
-	else if (htim->Instance == TIM6)
-    {
 		__HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
-        // Stop TIM6
-        HAL_TIM_Base_Stop_IT(&htim6);
-        __HAL_TIM_SET_COUNTER(&htim6, 0);
-        //Stop Servo PWM Signal
-        HAL_TIM_PWM_Stop(&htim2, TIM_CHANNEL_3);
-
-        HAL_GPIO_WritePin(GPIOA, GPIO_PIN_2, 0); //Forces the PWM Output Pin to a 0V state (High Impedance).
-
-        //Push Solenoid back in
-        HAL_GPIO_WritePin(GPIOE, GPIO_PIN_0, 0);
-
-    }
+		//The timer may end a little before the ms tick, wait for the deadline if so
+		SERVOSEQUENCE__update(&sequence, HAL_GetTick());
+		applySequence();
+	}
+	else if (htim->Instance == TIM2)
+	{
+		//Only the ramp DMA completes on TIM2 (its update interrupt is not enabled), queue the next frames
+		HAL_TIM_DMABurst_WriteStop(&htim2, TIM_DMA_UPDATE);
+		rampQueued = 0;
+		streamRamp();
+	}
 }
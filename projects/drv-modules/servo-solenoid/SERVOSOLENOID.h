@@ -4,6 +4,12 @@
  * Author: Faaiq Majeed
  * Date Last Updated: January 1, 2024
  * Description: Header file for moving the wingsail's servo motor and retracting and extending the solenoid. Also initialization of relevant timers and variables.
+ *
+ * The actuation is sequenced by SERVOSEQUENCE (release -> move -> hold -> lock) from the TIM6 interrupt, so
+ * moveServo() never blocks and can be called at any time: the sequence always ends on the most recent angle.
+ * Moves are slew limited by SERVORAMP: the compare values of each frame are streamed into TIM2 CCR3 by DMA on the
+ * update event and the move state lasts as long as the ramp.
+ * When servoSolenoidStatus() returns 1 the packed status should be sent over CAN.
  */
 
 #ifndef SERVOSOLENOID_H
@@ -13,37 +19,69 @@
  * Includes:
  */
 #include "main.h"
+#include "SERVOSEQUENCE.h"
+#include "SERVOCHANNEL.h"
+#include "SERVORAMP.h"
 
 /*
  * Variables
  */
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim6;
-extern TIM_HandleTypeDef htim7;
+extern DMA_HandleTypeDef hdma_tim2_up;
 extern PCD_HandleTypeDef hpcd_USB_OTG_FS;
 
 
+/*
+ * Defines
+ */
+
+//Sequence timing (ms)
+#define SERVOSOLENOID_RELEASE_MS 1000 //solenoid energized until the lock pin is retracted
+#define SERVOSOLENOID_MS_PER_10_DEGREES 30 //servo speed with margin (0.17 s per 60 degrees)
+#define SERVOSOLENOID_HOLD_MS 400 //servo kept at the target before locking
+#define SERVOSOLENOID_LOCK_MS 200 //solenoid released until the lock pin is engaged
+
+//Servo frame and pulse width (us) at 0 and 180 degrees
+#define SERVOSOLENOID_FRAME_US 20000
+#define SERVOSOLENOID_PULSE_MIN_US 560
+#define SERVOSOLENOID_PULSE_MAX_US 2560
+
+//Wingsail servo slew limits (0.1 degrees/s and 0.1 degrees/s^2), the move time follows from these
+#define SERVOSOLENOID_MAX_RATE 600
+#define SERVOSOLENOID_MAX_ACCELERATION 2400
+#define SERVOSOLENOID_RAMP_FRAMES 32 //frames per DMA transfer (0.64 s), the CPU refills the buffer once per transfer
+
+//Priority of the TIM6 and GPDMA1 channel 0 interrupts
+#define SERVOSOLENOID_IRQ_PRIORITY 2
+
 /*
  * Functions
  */
 
 void initializeServoSolenoid(void);
 
-static void MX_TIM2_Init(void);
+void TIM6_IRQHandler(void);
 
-static void MX_TIM6_Init(void);
+void GPDMA1_Channel0_IRQHandler(void);
 
-static void MX_TIM7_Init(void);
+//angle: 0 to 180 degrees
+void moveServo(double angle);
 
-void TIM6_IRQHandler(void);
+//angle: 0 to 1800 (0.1 degrees)
+void setServoTarget(int16_t angle);
 
-void TIM7_IRQHandler(void);
+//Adds another servo on a free TIM2 channel (its pin must be set up in HAL_TIM_MspPostInit()).
+//Returns the index for setServoAngle(), or SERVOTIMER_NO_CHANNEL if TIM2 is full
+uint8_t addServoChannel(uint32_t channel, uint16_t minPulseUs, uint16_t maxPulseUs, int16_t maxAngle);
 
-int is_TIM6_Running(void);
+//Drives a servo added with addServoChannel() to an angle (0 to maxAngle), the wingsail servo is only moved by setServoTarget()
+void setServoAngle(uint8_t index, int16_t angle);
 
-int is_TIM7_Running(void);
+SERVOSEQUENCE_STATE getServoSolenoidState(void);
 
-void moveServo(double angle);
+//Returns 1 and packs the status (see SERVOSEQUENCE__packCAN()) if it changed since the last call
+uint8_t servoSolenoidStatus(uint8_t* data);
 
 //Used for timer interrupt handling
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
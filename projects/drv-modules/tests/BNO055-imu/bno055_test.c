@@ -0,0 +1,149 @@
+/*
+ * bno055_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "BNO055.h"
+#include <math.h>
+#include <string.h>
+
+//-- Test definitions --
+testresult bno055_datasheet_scales(void);
+testresult bno055_exhaustive_rounding(void);
+testresult bno055_offsets(void);
+testresult bno055_calibration_profile(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Datasheet LSB scales", .func=bno055_datasheet_scales, .group=BNO055},
+		{.testname="All register values round to nearest", .func=bno055_exhaustive_rounding, .group=BNO055},
+		{.testname="Offset registers use their own units", .func=bno055_offsets, .group=BNO055},
+		{.testname="Calibration profile record", .func=bno055_calibration_profile, .group=BNO055}
+};
+
+// -- Helpers --
+//A conversion is correct if it is the reference rounded to nearest (halves may go either way)
+static int isRounded(int32_t value, double reference) {
+	return fabs(value - reference) <= 0.5 + 1e-9;
+}
+
+// -- Unit tests --
+testresult bno055_datasheet_scales(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	//Table 3-29: 1 degree = 16 LSB
+	TEST_CHECK(BNO055__angle(16, BNO055_ANGLE_MILLIDEGREES) == 1000);
+	TEST_CHECK(BNO055__angle(-16, BNO055_ANGLE_DECIDEGREES) == -10);
+	TEST_CHECK(BNO055__angle(1, BNO055_ANGLE_MILLIDEGREES) == 63);
+	TEST_CHECK(BNO055__angle(2880, BNO055_ANGLE_MICRORADIANS) == 3141593);
+	TEST_CHECK(BNO055__heading(5759, BNO055_ANGLE_MILLIDEGREES) == 359938);
+	TEST_CHECK(BNO055__heading(0xFFFF, BNO055_ANGLE_DECIDEGREES) == 40959);
+
+	//Table 3-17: 1 m/s^2 = 100 LSB
+	TEST_CHECK(BNO055__accel(981, BNO055_ACCEL_MM_PER_S2) == 9810);
+	TEST_CHECK(BNO055__accel(-100, BNO055_ACCEL_MM_PER_S2) == -1000);
+	TEST_CHECK(BNO055__accel(981, BNO055_ACCEL_MILLI_G) == 1000);
+
+	//Table 3-22: 1 dps = 16 LSB
+	TEST_CHECK(BNO055__rate(-32, BNO055_RATE_MILLIDEGREES_PER_S) == -2000);
+	TEST_CHECK(BNO055__rate(2880, BNO055_RATE_MILLIRADIANS_PER_S) == 3142);
+
+	//Table 3-19: 1 uT = 16 LSB
+	TEST_CHECK(BNO055__magnetic(800) == 50000);
+
+	//Table 3-37: 1 degree Celsius = 1 LSB
+	TEST_CHECK(BNO055__temperature(-12) == -120);
+
+	//Registers are little endian
+	const uint8_t registers[] = {0x40, 0x16, 0xF0, 0xFF};
+	TEST_CHECK(BNO055__readInt16(registers, 0) == 5696);
+	TEST_CHECK(BNO055__readInt16(registers, 2) == -16);
+	return res;
+}
+
+testresult bno055_exhaustive_rounding(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	for (int32_t raw = INT16_MIN; raw <= INT16_MAX; ++raw) {
+		double degrees = raw / 16.0;
+		TEST_CHECK(isRounded(BNO055__angle(raw, BNO055_ANGLE_MILLIDEGREES), degrees * 1000));
+		TEST_CHECK(isRounded(BNO055__angle(raw, BNO055_ANGLE_DECIDEGREES), degrees * 10));
+		TEST_CHECK(isRounded(BNO055__angle(raw, BNO055_ANGLE_MICRORADIANS), degrees * M_PI / 180 * 1e6));
+		TEST_CHECK(isRounded(BNO055__heading((uint16_t)raw, BNO055_ANGLE_MILLIDEGREES), (uint16_t)raw / 16.0 * 1000));
+
+		TEST_CHECK(BNO055__accel(raw, BNO055_ACCEL_MM_PER_S2) == raw * 10);
+		TEST_CHECK(isRounded(BNO055__accel(raw, BNO055_ACCEL_MILLI_G), raw / 100.0 / 9.80665 * 1000));
+
+		TEST_CHECK(isRounded(BNO055__rate(raw, BNO055_RATE_MILLIDEGREES_PER_S), degrees * 1000));
+		TEST_CHECK(isRounded(BNO055__rate(raw, BNO055_RATE_MILLIRADIANS_PER_S), degrees * M_PI / 180 * 1000));
+
+		TEST_CHECK(isRounded(BNO055__magnetic(raw), raw / 16.0 * 1000));
+	}
+	return res;
+}
+
+testresult bno055_offsets(void) {
+	testresult res = {TSUCCESS, {0}};
+	BNO055_OFFSETS offsets;
+	BNO055_UNITS units = {BNO055_ANGLE_MILLIDEGREES, BNO055_ACCEL_MM_PER_S2, BNO055_RATE_MILLIDEGREES_PER_S};
+
+	//Accelerometer -20, 5, 981 LSB, magnetometer -160, 16, 0 LSB, gyroscope -1, 0, 32 LSB
+	const uint8_t registers[BNO055_OFFSET_REGISTERS] = {
+		0xEC, 0xFF, 0x05, 0x00, 0xD5, 0x03,
+		0x60, 0xFF, 0x10, 0x00, 0x00, 0x00,
+		0xFF, 0xFF, 0x00, 0x00, 0x20, 0x00
+	};
+
+	BNO055__decodeOffsets(registers, &units, &offsets);
+	TEST_CHECK(offsets.acc[0] == -200 && offsets.acc[1] == 50 && offsets.acc[2] == 9810);
+	TEST_CHECK(offsets.mag[0] == -10000 && offsets.mag[1] == 1000 && offsets.mag[2] == 0);
+	TEST_CHECK(offsets.gyr[0] == -62 && offsets.gyr[1] == 0 && offsets.gyr[2] == 2000);
+
+	units.accel = BNO055_ACCEL_MILLI_G;
+	units.rate = BNO055_RATE_MILLIRADIANS_PER_S;
+	BNO055__decodeOffsets(registers, &units, &offsets);
+	TEST_CHECK(offsets.acc[2] == 1000 && offsets.gyr[2] == 35);
+	return res;
+}
+
+testresult bno055_calibration_profile(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t profile[BNO055_PROFILE_LENGTH];
+	uint8_t restored[BNO055_PROFILE_LENGTH];
+	uint8_t record[BNO055_PROFILE_RECORD_SIZE];
+
+	TEST_CHECK(BNO055__crc32((const uint8_t*)"123456789", 9) == 0xCBF43926);
+
+	for (uint8_t i = 0; i < BNO055_PROFILE_LENGTH; ++i) {
+		profile[i] = 0xA0 + i;
+	}
+	BNO055__packProfile(profile, record);
+	TEST_CHECK(record[0] == 'B' && record[1] == 'N' && record[2] == 'O' && record[3] == '1');
+	TEST_CHECK(record[BNO055_PROFILE_RECORD_SIZE - 1] == 0xFF);
+	TEST_CHECK(BNO055__unpackProfile(record, restored) && memcmp(profile, restored, BNO055_PROFILE_LENGTH) == 0);
+
+	//Erased flash
+	memset(record, 0xFF, sizeof(record));
+	TEST_CHECK(!BNO055__unpackProfile(record, restored));
+
+	//Every single bit flip in the checked part of the record is detected
+	BNO055__packProfile(profile, record);
+	for (uint16_t bit = 0; bit < 8 * 36; ++bit) {
+		record[bit / 8] ^= 1 << (bit % 8);
+		TEST_CHECK(!BNO055__unpackProfile(record, restored));
+		record[bit / 8] ^= 1 << (bit % 8);
+	}
+
+	//A record from another version is ignored
+	record[4] = BNO055_PROFILE_VERSION + 1;
+	TEST_CHECK(!BNO055__unpackProfile(record, restored));
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,441 @@
+/*
+ * imu_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "IMU.h"
+#include "pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define BNO055_ADDRESS 0x28
+#define BNO055_OUTPUT_PERIOD HAL_HOST_MS(10)
+#define BENCHMARK_MINUTES 10
+
+testresult imu_initialization(void);
+testresult imu_burst_stream(void);
+testresult imu_burst_calib_stat(void);
+testresult imu_sample_copy_consistent(void);
+testresult imu_duplicates(void);
+testresult imu_phase_tracking(void);
+testresult imu_at_rest(void);
+testresult imu_euler_and_offsets(void);
+testresult imu_bus_errors(void);
+testresult imu_calibration_flash(void);
+testresult imu_acquisition_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Initialization sequence", .func=imu_initialization, .group=BNO055},
+		{.testname="Burst stream and bus occupancy", .func=imu_burst_stream, .group=BNO055},
+		{.testname="Calibration status read with each burst", .func=imu_burst_calib_stat, .group=BNO055},
+		{.testname="Samples copied while reads complete", .func=imu_sample_copy_consistent, .group=BNO055},
+		{.testname="Duplicates when polling faster than the sensor", .func=imu_duplicates, .group=BNO055},
+		{.testname="Polling follows the sensor's updates", .func=imu_phase_tracking, .group=BNO055},
+		{.testname="Sensor at rest still published every tick", .func=imu_at_rest, .group=BNO055},
+		{.testname="Euler acquisition and offsets", .func=imu_euler_and_offsets, .group=BNO055},
+		{.testname="NACK and held bus", .func=imu_bus_errors, .group=BNO055},
+		{.testname="Calibration saved to flash and restored", .func=imu_calibration_flash, .group=BNO055},
+		{.testname="Acquisition benchmark", .func=imu_acquisition_benchmark, .group=BNO055}
+};
+
+// -- Helpers --
+//BNO055 model: a register file whose fusion outputs change every update period
+static uint8_t registers[0x80];
+static HAL_HOST_I2C_REGS bno;
+static uint64_t sensorPeriod;
+static uint32_t updates;
+static uint64_t lastUpdate;
+//At rest the updates give the same outputs again
+static uint8_t atRest;
+//Registers written by the MCU, in order
+static uint8_t writeLog[16];
+static uint8_t writes;
+
+static void put16(uint8_t reg, int16_t value) {
+	registers[reg] = (uint8_t)value;
+	registers[reg + 1] = (uint8_t)((uint16_t)value >> 8);
+}
+
+static void sensorUpdate(void* context) {
+	if (!atRest) updates++;
+	lastUpdate = hal_host_now();
+	put16(0x1A, (int16_t)((updates % 360) * 16)); //heading in whole degrees
+	put16(0x1C, (int16_t)(updates % 90)); //roll
+	put16(0x1E, (int16_t)-(updates % 90)); //pitch
+	put16(0x20, (int16_t)(BNO055_QUATERNION_ONE - updates % 100)); //w
+	put16(0x28, (int16_t)(updates % 1000)); //linear acceleration x in cm/s^2
+	hal_host_schedule(sensorPeriod, sensorUpdate, NULL);
+}
+
+static void logWrite(void* context, uint8_t reg, uint16_t length) {
+	if (length == 0) return; //register selected for a read
+	if (writes < sizeof(writeLog)) writeLog[writes] = reg;
+	writes++;
+}
+
+static I2C_HandleTypeDef hi2c;
+static DMA_HandleTypeDef hdma;
+static TIM_HandleTypeDef htim;
+static IMU* imu;
+
+//Age of the published samples, from the sensor's update to the end of the read
+static uint8_t trackAge;
+static uint32_t lastSequence;
+static uint64_t maxAge;
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* tim) {
+	IMU__updateBuffer(imu, tim);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* i2c) {
+	IMU__handleMemRxDMA(imu, i2c);
+	if (trackAge && imu->sample.sequence != lastSequence) {
+		uint64_t age = hal_host_now() - lastUpdate;
+		if (age > maxAge) maxAge = age;
+	}
+	lastSequence = imu->sample.sequence;
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* i2c) {
+	IMU__handleTxDMA(imu, i2c);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* i2c) {
+	IMU__handleRxDMA(imu, i2c);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* i2c) {
+	IMU__handleError(imu, i2c);
+}
+
+//Sensor on I2C1 at 400 kHz, the first update of its outputs after phase and then every period
+static void attachSensor(uint64_t period, uint64_t phase) {
+	bno = (HAL_HOST_I2C_REGS){.registers = registers, .size = sizeof(registers), .autoIncrement = 1, .onWrite = logWrite};
+	hal_host_i2cAttachRegs(I2C1, BNO055_ADDRESS, &bno);
+	sensorPeriod = period;
+	hal_host_schedule(phase, sensorUpdate, NULL);
+}
+
+static void setup(uint16_t samplePeriodMs, uint64_t period, uint64_t phase) {
+	hal_host_reset();
+	pool_init();
+	memset(registers, 0, sizeof(registers));
+	registers[0x35] = 0xFF; //fully calibrated
+	updates = 0;
+	atRest = 0;
+	writes = 0;
+	trackAge = 0;
+	lastSequence = 0;
+	maxAge = 0;
+	attachSensor(period, phase);
+
+	//400 kHz from 160 MHz: PRESC 0, SCLL 199, SCLH 199 -> (200 + 200) / 160 MHz = 2.5 us
+	hdma = (DMA_HandleTypeDef){.Instance = GPDMA1_Channel1};
+	hi2c = (I2C_HandleTypeDef){.Instance = I2C1, .Init = {.Timing = 0x0000C7C7}, .hdmarx = &hdma, .hdmatx = &hdma};
+	HAL_I2C_Init(&hi2c);
+	htim = (TIM_HandleTypeDef){.Instance = TIM3};
+	HAL_TIM_Base_Init(&htim);
+	imu = IMU__create(&hi2c, &htim, samplePeriodMs);
+	HAL_TIM_Base_Start_IT(&htim);
+	IMU__resetStats(imu);
+}
+
+static IMU_SAMPLE latest(void) {
+	IMU_SAMPLE s;
+	IMU__getLatest(imu, &s);
+	return s;
+}
+
+//Bus occupancy in 0.1 % measured by the host HAL since a previous snapshot, over elapsed ms
+static uint32_t measuredOccupancy(const HAL_HOST_I2C_STATS* before, uint32_t elapsed) {
+	HAL_HOST_I2C_STATS after;
+	hal_host_i2cStats(I2C1, &after);
+	return (uint32_t)((after.busyNs - before->busyNs) / ((uint64_t)elapsed * 1000));
+}
+
+// -- Unit tests --
+testresult imu_initialization(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	TEST_CHECK(imu != NULL);
+
+	//CONFIG mode and back to IMU mode, nothing restored from the erased flash
+	TEST_CHECK(writes == 2 && writeLog[0] == 0x3D && writeLog[1] == 0x3D);
+	TEST_CHECK(registers[0x3D] == 0x08 && imu->calibrationRestored == 0);
+	//The mode switch delays: 19 ms into CONFIG mode and 10 ms after the switch to IMU mode
+	TEST_CHECK(HAL_GetTick() >= 19 + 10);
+
+	//10 kHz timer counting 100 ticks a period
+	TEST_CHECK(TIM3->PSC == 15999 && TIM3->ARR == 99);
+	TEST_CHECK(latest().sequence == 0);
+	hal_host_advance(HAL_HOST_MS(10) + HAL_HOST_US(800));
+	TEST_CHECK(hal_host_timUpdates(TIM3) == 1 && latest().sequence == 1);
+	return res;
+}
+
+testresult imu_burst_stream(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	HAL_HOST_I2C_STATS before;
+	hal_host_i2cStats(I2C1, &before);
+
+	//Reads at 100 Hz end 0.7 ms after the ticks, halfway between two updates of the sensor. Stopping 2 ms after a
+	//tick leaves the latest sample matching the registers.
+	hal_host_advance(HAL_HOST_MS(1002));
+	IMU_STATS stats;
+	IMU__getStats(imu, &stats);
+	TEST_CHECK(stats.samples == 100 && stats.duplicates == 0 && stats.errors == 0 && stats.skippedTicks == 0);
+	TEST_CHECK(stats.sampleRate == 100u * 100000 / 1002 && stats.effectiveRate == stats.sampleRate);
+
+	IMU_SAMPLE s = latest();
+	TEST_CHECK(s.sequence == 100);
+	TEST_CHECK(s.heading == (int32_t)(updates % 360) * 1000);
+	TEST_CHECK(s.roll == BNO055__angle((int16_t)(updates % 90), BNO055_ANGLE_MILLIDEGREES));
+	TEST_CHECK(s.pitch == BNO055__angle((int16_t)-(updates % 90), BNO055_ANGLE_MILLIDEGREES));
+	TEST_CHECK(s.quaternion[0] == BNO055_QUATERNION_ONE - (int16_t)(updates % 100));
+	TEST_CHECK(s.linearAccel[0] == (int32_t)(updates % 1000) * 10);
+	TEST_CHECK(IMU_CALIB_SYS(s.calibStat) == 3 && BNO055_ReadCalibStat(imu)->magStat == 3);
+	TEST_CHECK(HAL_GetTick() - s.timestamp <= 2);
+
+	//The register map plans the published registers into one 28 byte read per tick
+	TEST_CHECK(imu->bus.plan.transactionCount == 1 && imu->bus.plan.length == IMU_BURST_LENGTH && imu->bus.transactions == 100);
+
+	//The occupancy estimated from the timing register is what the bus actually carried: 100 reads of 282 bits
+	TEST_CHECK(stats.busOccupancy == measuredOccupancy(&before, 1002));
+	TEST_CHECK(stats.busOccupancy == 100u * 282 * 2500 / 1002000);
+	return res;
+}
+
+testresult imu_burst_calib_stat(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	HAL_HOST_I2C_STATS before;
+	hal_host_i2cStats(I2C1, &before);
+	hal_host_advance(HAL_HOST_MS(102));
+
+	//One memory read a tick, the status comes from the same read as the angles
+	HAL_HOST_I2C_STATS after;
+	hal_host_i2cStats(I2C1, &after);
+	TEST_CHECK(after.transfers - before.transfers == 10);
+	CALIBSTAT* calib = BNO055_ReadCalibStat(imu);
+	TEST_CHECK(calib->sysStat == 3 && calib->gyrStat == 3 && calib->accStat == 3 && calib->magStat == 3);
+
+	//The magnetometer loses its calibration: the status follows the published sample, without a read of its own
+	registers[0x35] = 0xFC;
+	hal_host_advance(HAL_HOST_MS(10));
+	hal_host_i2cStats(I2C1, &before);
+	calib = BNO055_ReadCalibStat(imu);
+	TEST_CHECK(IMU_CALIB_MAG(latest().calibStat) == 0 && calib->magStat == 0 && calib->sysStat == 3);
+	hal_host_i2cStats(I2C1, &after);
+	TEST_CHECK(after.transfers == before.transfers);
+	return res;
+}
+
+//A read completing as an interrupt at one of the memory barriers of the main loop
+static uint32_t barriers;
+static uint32_t interruptAt;
+
+static void readCompletes(void) {
+	if (++barriers == interruptAt) hal_host_runNext();
+}
+
+testresult imu_sample_copy_consistent(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	hal_host_advance(HAL_HOST_MS(52));
+	IMU_SAMPLE before = latest();
+	TEST_CHECK(before.sequence == 5);
+
+	//Before and after the copy of the sample: the writer moved the lock, the copy is retried and returns the new sample
+	for (interruptAt = 1; interruptAt <= 2; ++interruptAt) {
+		while (!regmap_i2c_isBusy(&imu->bus)) hal_host_runNext();
+		barriers = 0;
+		hal_host_setBarrierHook(readCompletes);
+		IMU_SAMPLE s = latest();
+		hal_host_setBarrierHook(NULL);
+		TEST_CHECK(!regmap_i2c_isBusy(&imu->bus) && barriers == 4);
+		TEST_CHECK(s.sequence == before.sequence + 1 && s.heading != before.heading);
+		TEST_CHECK(memcmp(&s, &imu->sample, sizeof(IMU_SAMPLE)) == 0);
+		before = s;
+	}
+	return res;
+}
+
+testresult imu_duplicates(void) {
+	testresult res = {TSUCCESS, {0}};
+	//Polling at 5 ms, every other read finds the same outputs and is not published
+	setup(5, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(2));
+	TEST_CHECK(imu->phaseTracking == 0);
+	hal_host_advance(HAL_HOST_MS(1001));
+
+	IMU_STATS stats;
+	IMU__getStats(imu, &stats);
+	TEST_CHECK(stats.samples == 200 && stats.duplicates == 100);
+	TEST_CHECK(latest().sequence == 100);
+	TEST_CHECK(stats.effectiveRate * 2 == stats.sampleRate);
+	return res;
+}
+
+testresult imu_phase_tracking(void) {
+	testresult res = {TSUCCESS, {0}};
+	//A sensor clock 0.5 % slow: the reads slide across the updates and a sample can be up to a period old
+	setup(10, HAL_HOST_US(10050), HAL_HOST_MS(5));
+	imu->phaseTracking = 0;
+	trackAge = 1;
+	hal_host_advance(HAL_HOST_MS(3000));
+	uint64_t untracked = maxAge;
+	TEST_CHECK(untracked > HAL_HOST_MS(9));
+
+	//With the phase adjusted after each duplicate, the reads stay just after the updates
+	setup(10, HAL_HOST_US(10050), HAL_HOST_MS(5));
+	hal_host_advance(HAL_HOST_MS(1500));
+	TEST_CHECK(imu->duplicates > 0);
+	trackAge = 1;
+	hal_host_advance(HAL_HOST_MS(3000));
+	TEST_CHECK(maxAge < HAL_HOST_MS(3));
+	TEST_CHECK(imu->errors == 0 && imu->skippedTicks == 0);
+	return res;
+}
+
+testresult imu_at_rest(void) {
+	testresult res = {TSUCCESS, {0}};
+	for (IMU_ACQUISITION acquisition = IMU_ACQUISITION_BURST; acquisition <= IMU_ACQUISITION_EULER; ++acquisition) {
+		setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+		IMU__setAcquisition(imu, acquisition);
+		hal_host_advance(HAL_HOST_MS(1002));
+		TEST_CHECK(imu->duplicates == 0);
+
+		//The boat stops: the first repeat is taken as a missed update, the following ones as new readings
+		atRest = 1;
+		uint32_t sequence = latest().sequence;
+		uint32_t ticks = hal_host_timUpdates(TIM3);
+		IMU__resetStats(imu);
+		hal_host_advance(HAL_HOST_MS(2000));
+		IMU_STATS stats;
+		IMU__getStats(imu, &stats);
+		TEST_CHECK(stats.duplicates == 1 && stats.samples == 200);
+		TEST_CHECK(latest().sequence == sequence + 199 && HAL_GetTick() - latest().timestamp <= 10);
+		TEST_CHECK(stats.effectiveRate == 199u * 100000 / 2000);
+
+		//The timer kept its period, the polling only moved once
+		TEST_CHECK(hal_host_timUpdates(TIM3) - ticks == 200 && TIM3->ARR == 99);
+	}
+	return res;
+}
+
+testresult imu_euler_and_offsets(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	IMU__setAcquisition(imu, IMU_ACQUISITION_EULER);
+	HAL_HOST_I2C_STATS before;
+	hal_host_i2cStats(I2C1, &before);
+
+	//A register address write then a read of the 6 Euler bytes on every tick
+	hal_host_advance(HAL_HOST_MS(1002));
+	IMU_STATS stats;
+	IMU__getStats(imu, &stats);
+	TEST_CHECK(stats.samples == 100 && stats.errors == 0);
+	TEST_CHECK(latest().heading == (int32_t)(updates % 360) * 1000);
+	HAL_HOST_I2C_STATS after;
+	hal_host_i2cStats(I2C1, &after);
+	TEST_CHECK(after.transfers - before.transfers == 200);
+	TEST_CHECK(stats.busOccupancy == measuredOccupancy(&before, 1002));
+
+	//Offsets requested between two ticks: accelerometer x of 100 cm/s^2, gyroscope z of -2 deg/s
+	put16(0x55, 100);
+	put16(0x65, -32);
+	IMU_getOffset(imu);
+	hal_host_advance(HAL_HOST_MS(1));
+	BNO055_OFFSETS offsets;
+	IMU__getOffsets(imu, &offsets);
+	TEST_CHECK(offsets.acc[0] == 1000 && offsets.gyr[2] == -2000);
+	TEST_CHECK(imu->data_flag == 0);
+	return res;
+}
+
+testresult imu_bus_errors(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	hal_host_advance(HAL_HOST_MS(102));
+	TEST_CHECK(latest().sequence == 10);
+
+	//A NACK aborts the read, the next tick starts a new one
+	bno.response = HAL_HOST_I2C_NACK;
+	hal_host_advance(HAL_HOST_MS(100));
+	TEST_CHECK(imu->errors == 10 && latest().sequence == 10);
+
+	//A held bus times out the read in progress and refuses the next ones until a blocking transfer (the bus
+	//recovery's probe) goes through
+	bno.response = HAL_HOST_I2C_HOLD;
+	hal_host_advance(HAL_HOST_MS(100));
+	TEST_CHECK(imu->errors == 20);
+	bno.response = HAL_HOST_I2C_ACK;
+	hal_host_advance(HAL_HOST_MS(100));
+	TEST_CHECK(imu->errors == 30 && latest().sequence == 10);
+	TEST_CHECK(HAL_I2C_IsDeviceReady(&hi2c, BNO055_ADDRESS << 1, 1, 10) == HAL_OK);
+	hal_host_advance(HAL_HOST_MS(100));
+	TEST_CHECK(imu->errors == 30 && latest().sequence == 20);
+	TEST_CHECK(imu->skippedTicks == 0);
+	return res;
+}
+
+testresult imu_calibration_flash(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+	for (uint8_t i = 0; i < BNO055_PROFILE_LENGTH; ++i) registers[BNO055_PROFILE_REGISTER + i] = (uint8_t)(0x40 + i);
+	//Not while a read is in progress
+	IMU__updateBuffer(imu, &htim);
+	TEST_CHECK(IMU__saveCalibration(imu) == HAL_BUSY);
+	TEST_CHECK(hal_host_runNext() && !regmap_i2c_isBusy(&imu->bus));
+
+	//The profile is read in CONFIG mode, the ticks during the blocking transfers and delays are skipped
+	writes = 0;
+	TEST_CHECK(IMU__saveCalibration(imu) == HAL_OK);
+	TEST_CHECK(writes == 2 && registers[0x3D] == 0x08);
+	TEST_CHECK(imu->skippedTicks > 0);
+	TEST_CHECK(hal_host_flashErases() == 1 && hal_host_flashPrograms() == BNO055_PROFILE_RECORD_SIZE / 16);
+	//The cached record read at power up was dropped before the record was read back
+	TEST_CHECK(!hal_host_icacheStale());
+
+	//Power up once the read started by a tick during the erase ended: the sensor lost its profile, it is written
+	//back in CONFIG mode before the switch to IMU mode
+	HAL_TIM_Base_Stop_IT(&htim);
+	hal_host_advance(HAL_HOST_MS(1));
+	memset(&registers[BNO055_PROFILE_REGISTER], 0, BNO055_PROFILE_LENGTH);
+	pool_init();
+	writes = 0;
+	imu = IMU__create(&hi2c, &htim, 10);
+	TEST_CHECK(imu != NULL && imu->calibrationRestored == 1);
+	TEST_CHECK(writes == 3 && writeLog[0] == 0x3D && writeLog[1] == BNO055_PROFILE_REGISTER && writeLog[2] == 0x3D);
+	for (uint8_t i = 0; i < BNO055_PROFILE_LENGTH; ++i) TEST_CHECK(registers[BNO055_PROFILE_REGISTER + i] == 0x40 + i);
+	return res;
+}
+
+testresult imu_acquisition_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(10, BNO055_OUTPUT_PERIOD, HAL_HOST_MS(5));
+
+	//Minutes of burst reads, timing the driver and the models on the host clock
+	clock_t start = clock();
+	hal_host_advance(HAL_HOST_MS(BENCHMARK_MINUTES * 60000 + 2));
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	IMU_STATS stats;
+	IMU__getStats(imu, &stats);
+	TEST_CHECK(stats.samples == BENCHMARK_MINUTES * 6000 && stats.errors == 0);
+	printf("%lu reads (%d min at 100 Hz, bus %lu.%lu %%) in %.3f s on the host, %.2f us a read\n",
+			(unsigned long)stats.samples, BENCHMARK_MINUTES, (unsigned long)stats.busOccupancy / 10,
+			(unsigned long)stats.busOccupancy % 10, seconds, seconds * 1e6 / stats.samples);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
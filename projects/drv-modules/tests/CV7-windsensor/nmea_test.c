@@ -0,0 +1,292 @@
+/*
+ * nmea_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "NMEA.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define FUZZ_ITERS 200000
+#define BENCH_BYTES (4u * 1024u * 1024u)
+
+testresult nmea_valid_sentences(void);
+testresult nmea_rejects_bad_checksum(void);
+testresult nmea_resynchronizes(void);
+testresult nmea_parse_fixed(void);
+testresult nmea_decode_wind(void);
+testresult nmea_fuzz_random_noise(void);
+testresult nmea_fuzz_corruption(void);
+testresult nmea_throughput_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Valid sentences", .func=nmea_valid_sentences, .group=WIND},
+		{.testname="Bad checksum rejected", .func=nmea_rejects_bad_checksum, .group=WIND},
+		{.testname="Resynchronization", .func=nmea_resynchronizes, .group=WIND},
+		{.testname="Fixed point fields", .func=nmea_parse_fixed, .group=WIND},
+		{.testname="Wind and temperature decoding", .func=nmea_decode_wind, .group=WIND},
+		{.testname="Fuzz: noise between sentences", .func=nmea_fuzz_random_noise, .group=WIND},
+		{.testname="Fuzz: single byte corruption", .func=nmea_fuzz_corruption, .group=WIND},
+		{.testname="Parse throughput benchmark", .func=nmea_throughput_benchmark, .group=WIND}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x12345678;
+
+static uint32_t rng(void) {
+	//xorshift32, deterministic so failures can be reproduced
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Wraps a sentence body in "$" and "*hh\r\n", returns the length written
+static int frame(char *out, const char *body) {
+	uint8_t checksum = 0;
+	for (const char *c = body; *c != '\0'; ++c) {
+		checksum ^= (uint8_t)*c;
+	}
+	return sprintf(out, "$%s*%02X\r\n", body, checksum);
+}
+
+//Feeds a string and returns the number of completed sentences
+static int feed(NMEA_PARSER *parser, const char *data, int length) {
+	int completed = 0;
+	for (int i = 0; i < length; ++i) {
+		completed += NMEA__feed(parser, (uint8_t)data[i]);
+	}
+	return completed;
+}
+
+// -- Unit tests --
+testresult nmea_valid_sentences(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	const char *wind = "$IIMWV,226.0,R,002.4,N,A*3D\r\n";
+	const char *temp = "$WIXDR,C,022.0,C,,*52\r\n";
+
+	TEST_CHECK(feed(&parser, wind, strlen(wind)) == 1);
+	TEST_CHECK(NMEA__isSentence(&parser, "MWV"));
+	TEST_CHECK(parser.fieldCount == 6);
+	TEST_CHECK(strcmp(NMEA__field(&parser, 1), "226.0") == 0);
+	TEST_CHECK(strcmp(NMEA__field(&parser, 3), "002.4") == 0);
+	TEST_CHECK(NMEA__fieldLength(&parser, 5) == 1);
+	TEST_CHECK(NMEA__fieldLength(&parser, 6) == 0);
+
+	//Temperature first or second does not matter
+	TEST_CHECK(feed(&parser, temp, strlen(temp)) == 1);
+	TEST_CHECK(NMEA__isSentence(&parser, "XDR"));
+	TEST_CHECK(strcmp(NMEA__field(&parser, 2), "022.0") == 0);
+	TEST_CHECK(NMEA__fieldLength(&parser, 4) == 0);
+	TEST_CHECK(parser.fieldCount == 6);
+
+	TEST_CHECK(parser.sentenceCount == 2 && parser.checksumErrors == 0);
+	return res;
+}
+
+testresult nmea_rejects_bad_checksum(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	const char *bad = "$IIMWV,226.0,R,002.4,N,A*3C\r\n";
+	const char *missing = "$IIMWV,226.0,R,002.4,N,A\r\n";
+
+	TEST_CHECK(feed(&parser, bad, strlen(bad)) == 0);
+	TEST_CHECK(parser.checksumErrors == 1);
+	TEST_CHECK(parser.fieldCount == 0);
+	TEST_CHECK(NMEA__field(&parser, 1)[0] == '\0');
+
+	TEST_CHECK(feed(&parser, missing, strlen(missing)) == 0);
+	TEST_CHECK(parser.framingErrors == 1);
+	return res;
+}
+
+testresult nmea_resynchronizes(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	//A truncated sentence followed by a complete one, and a sentence longer than the buffer
+	char stream[256];
+	int length = sprintf(stream, "$IIMWV,226.0,R,0");
+	length += frame(stream + length, "IIMWV,010.0,R,001.0,N,A");
+	TEST_CHECK(feed(&parser, stream, length) == 1);
+	TEST_CHECK(strcmp(NMEA__field(&parser, 1), "010.0") == 0);
+
+	char body[NMEA_MAX_SENTENCE + 8];
+	memset(body, 'A', sizeof(body) - 1);
+	body[sizeof(body) - 1] = '\0';
+	length = frame(stream, body);
+	length += frame(stream + length, "WIXDR,C,-05.5,C,");
+	TEST_CHECK(feed(&parser, stream, length) == 1);
+	TEST_CHECK(strcmp(NMEA__field(&parser, 2), "-05.5") == 0);
+	return res;
+}
+
+testresult nmea_parse_fixed(void) {
+	testresult res = {TSUCCESS, {0}};
+	int32_t value;
+
+	TEST_CHECK(NMEA__parseFixed("226.0", 1, &value) && value == 2260);
+	TEST_CHECK(NMEA__parseFixed("002.4", 2, &value) && value == 240);
+	TEST_CHECK(NMEA__parseFixed("-05.5", 1, &value) && value == -55);
+	TEST_CHECK(NMEA__parseFixed("+3", 1, &value) && value == 30);
+	TEST_CHECK(NMEA__parseFixed("1.2345", 2, &value) && value == 123);
+	TEST_CHECK(NMEA__parseFixed(".5", 1, &value) && value == 5);
+	TEST_CHECK(NMEA__parseFixed("7.", 0, &value) && value == 7);
+	TEST_CHECK(!NMEA__parseFixed("", 1, &value));
+	TEST_CHECK(!NMEA__parseFixed("-", 1, &value));
+	TEST_CHECK(!NMEA__parseFixed("1.2.3", 1, &value));
+	TEST_CHECK(!NMEA__parseFixed("12a", 1, &value));
+	TEST_CHECK(!NMEA__parseFixed("99999999999", 1, &value));
+	return res;
+}
+
+testresult nmea_decode_wind(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA_MWV mwv;
+	int16_t temperature;
+	char sentence[64];
+	NMEA__init(&parser);
+
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,359.9,R,012.5,N,A")) == 1);
+	TEST_CHECK(NMEA__decodeMWV(&parser, &mwv));
+	TEST_CHECK(mwv.angle == 3599 && mwv.speed == 1250 && mwv.reference == 'R' && mwv.valid);
+	TEST_CHECK(!NMEA__decodeXDRTemperature(&parser, &temperature));
+
+	//10 m/s is 19.44 kn and 10 km/h is 5.40 kn
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,360.0,T,10.0,M,V")) == 1);
+	TEST_CHECK(NMEA__decodeMWV(&parser, &mwv));
+	TEST_CHECK(mwv.angle == 0 && mwv.speed == 1944 && mwv.reference == 'T' && !mwv.valid);
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,090.0,R,10.0,K,A")) == 1);
+	TEST_CHECK(NMEA__decodeMWV(&parser, &mwv) && mwv.speed == 540);
+
+	//Out of range angle, missing speed and unknown unit
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,361.0,R,1.0,N,A")) == 1);
+	TEST_CHECK(!NMEA__decodeMWV(&parser, &mwv));
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,010.0,R,,N,A")) == 1);
+	TEST_CHECK(!NMEA__decodeMWV(&parser, &mwv));
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "IIMWV,010.0,R,1.0,X,A")) == 1);
+	TEST_CHECK(!NMEA__decodeMWV(&parser, &mwv));
+
+	//Negative temperatures are supported
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "WIXDR,C,-012.3,C,,")) == 1);
+	TEST_CHECK(NMEA__decodeXDRTemperature(&parser, &temperature) && temperature == -123);
+	TEST_CHECK(!NMEA__decodeMWV(&parser, &mwv));
+	TEST_CHECK(feed(&parser, sentence, frame(sentence, "WIXDR,P,1.013,B,")) == 1);
+	TEST_CHECK(!NMEA__decodeXDRTemperature(&parser, &temperature));
+	return res;
+}
+
+testresult nmea_fuzz_random_noise(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	char body[64];
+	char sentence[96];
+	int expected = 0;
+	int found = 0;
+
+	for (int i = 0; i < FUZZ_ITERS; ++i) {
+		//Random bytes between sentences, including '$', '*' and binary data
+		int noise = rng() % 24;
+		for (int n = 0; n < noise; ++n) {
+			uint8_t byte = rng() & 0xFF;
+			if (NMEA__feed(&parser, byte) && NMEA__isSentence(&parser, "MWV") && strcmp(NMEA__field(&parser, 0), "IIMWV") == 0) {
+				found++;
+			}
+		}
+
+		unsigned angle = rng() % 3600;
+		unsigned speed = rng() % 1000;
+		sprintf(body, "IIMWV,%03u.%u,R,%03u.%u,N,A", angle / 10, angle % 10, speed / 10, speed % 10);
+		int length = frame(sentence, body);
+		expected++;
+
+		for (int n = 0; n < length; ++n) {
+			if (NMEA__feed(&parser, (uint8_t)sentence[n])) {
+				TEST_CHECK(n == length - 3);
+				TEST_CHECK(strcmp(NMEA__field(&parser, 0), "IIMWV") == 0);
+				TEST_CHECK(NMEA__field(&parser, 1)[0] == body[6]);
+				found++;
+			}
+		}
+	}
+
+	TEST_CHECK(found == expected);
+	printf("%d sentences, %lu framing errors, %lu checksum errors\r\n", expected,
+			(unsigned long)parser.framingErrors, (unsigned long)parser.checksumErrors);
+	return res;
+}
+
+testresult nmea_fuzz_corruption(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	const char *body = "IIMWV,226.0,R,002.4,N,A";
+	char sentence[64];
+	int length = frame(sentence, body);
+
+	for (int i = 0; i < FUZZ_ITERS; ++i) {
+		//Replace one body character with a different printable one that is not a delimiter
+		char corrupt[64];
+		memcpy(corrupt, sentence, length);
+		int position = 1 + rng() % strlen(body);
+		char replacement;
+		do {
+			replacement = 0x20 + rng() % 0x5F;
+		} while (replacement == corrupt[position] || replacement == '$' || replacement == '*');
+		corrupt[position] = replacement;
+
+		TEST_CHECK(feed(&parser, corrupt, length) == 0);
+		TEST_CHECK(feed(&parser, sentence, length) == 1);
+	}
+
+	TEST_CHECK(parser.checksumErrors == FUZZ_ITERS);
+	return res;
+}
+
+testresult nmea_throughput_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	NMEA_PARSER parser;
+	NMEA__init(&parser);
+
+	//A realistic CV7 output stream: a wind and a temperature sentence
+	char stream[128];
+	int length = frame(stream, "IIMWV,226.0,R,002.4,N,A");
+	length += frame(stream + length, "WIXDR,C,022.0,C,");
+
+	unsigned long sentences = 0;
+	unsigned long bytes = 0;
+	clock_t start = clock();
+	while (bytes < BENCH_BYTES) {
+		sentences += feed(&parser, stream, length);
+		bytes += length;
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	TEST_CHECK(sentences == 2 * (bytes / length));
+	if (seconds > 0) {
+		printf("%lu bytes in %.3f s: %.1f MB/s, %.2f ns/byte, %.0f ns/sentence\r\n", bytes, seconds,
+				bytes / seconds / 1e6, seconds * 1e9 / bytes, seconds * 1e9 / sentences);
+	}
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,242 @@
+/*
+ * windfusion_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "WINDFUSION.h"
+#include "fixed_trig.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//-- Test definitions --
+#define BENCH_SAMPLES 2000000
+#define IMU_PERIOD_MS 20
+
+testresult windfusion_north_reference(void);
+testresult windfusion_time_alignment(void);
+testresult windfusion_heel_correction(void);
+testresult windfusion_true_wind(void);
+testresult windfusion_matches_reference(void);
+testresult windfusion_sample_cost(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Apparent wind referenced to north", .func=windfusion_north_reference, .group=WIND},
+		{.testname="Attitude interpolated at the wind time", .func=windfusion_time_alignment, .group=WIND},
+		{.testname="Heel and pitch correction", .func=windfusion_heel_correction, .group=WIND},
+		{.testname="True wind from boat speed", .func=windfusion_true_wind, .group=WIND},
+		{.testname="Fusion matches floating point reference", .func=windfusion_matches_reference, .group=WIND},
+		{.testname="Per-sample cost benchmark", .func=windfusion_sample_cost, .group=WIND}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x13579BDF;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Smallest difference between two angles in 0.1 degrees
+static int angleError(int a, int b) {
+	return abs(fixed_wrapSigned(a - b));
+}
+
+static WINDFUSION fusion;
+
+// -- Unit tests --
+testresult windfusion_north_reference(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+
+	//Without an attitude the wind stays relative to the bow
+	WINDFUSION__init(&fusion, 0, 1000, 1000);
+	WINDFUSION__process(&fusion, 450, 1000, 100, &sample);
+	TEST_CHECK(sample.flags == WINDFUSION_VALID_APPARENT);
+	TEST_CHECK(angleError(sample.apparentDirection, 450) <= 1);
+
+	//Heading 300 and wind 45 degrees off the starboard bow comes from 345
+	WINDFUSION__addAttitude(&fusion, 3000, 0, 0, 100);
+	WINDFUSION__process(&fusion, 450, 1000, 100, &sample);
+	TEST_CHECK(sample.flags == (WINDFUSION_VALID_APPARENT | WINDFUSION_VALID_ATTITUDE));
+	TEST_CHECK(angleError(sample.apparentAngle, 450) <= 1 && abs(sample.apparentSpeed - 1000) <= 1);
+	TEST_CHECK(angleError(sample.apparentDirection, 3450) <= 1);
+
+	//Across north
+	WINDFUSION__addAttitude(&fusion, 3500, 0, 0, 200);
+	WINDFUSION__process(&fusion, 900, 1000, 200, &sample);
+	TEST_CHECK(angleError(sample.apparentDirection, 800) <= 1);
+
+	//The attitude is too old to be used
+	WINDFUSION__process(&fusion, 900, 1000, 1201, &sample);
+	TEST_CHECK(!(sample.flags & WINDFUSION_VALID_ATTITUDE));
+	return res;
+}
+
+testresult windfusion_time_alignment(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+
+	//Turning from 350 to 10 degrees while heeling more, sentences take 100 ms to arrive
+	WINDFUSION__init(&fusion, 100, 1000, 1000);
+	WINDFUSION__addAttitude(&fusion, 3500, 100, -20, 1000);
+	WINDFUSION__addAttitude(&fusion, 100, 300, 20, 1200);
+	WINDFUSION__addAttitude(&fusion, 300, 300, 20, 1400);
+
+	//Measured at 1100, halfway between the first two attitudes
+	WINDFUSION__process(&fusion, 0, 1000, 1200, &sample);
+	TEST_CHECK(sample.attitude.heading == 0 && sample.attitude.roll == 200 && sample.attitude.pitch == 0);
+	TEST_CHECK(sample.attitude.timestamp == 1100);
+
+	WINDFUSION__process(&fusion, 0, 1000, 1150, &sample);
+	TEST_CHECK(sample.attitude.heading == 3550 && sample.attitude.roll == 150);
+
+	//Older than the history, the oldest attitude is used if it is recent enough
+	WINDFUSION__process(&fusion, 0, 1000, 1000, &sample);
+	TEST_CHECK((sample.flags & WINDFUSION_VALID_ATTITUDE) && sample.attitude.heading == 3500);
+
+	//History longer than the buffer
+	WINDFUSION__init(&fusion, 0, 1000, 1000);
+	for (uint32_t i = 0; i < 3 * WINDFUSION_HISTORY; ++i) {
+		WINDFUSION__addAttitude(&fusion, i * 10, 0, 0, 0xFFFFFF00u + i * IMU_PERIOD_MS);
+	}
+	//Interpolation across the tick counter wrapping
+	uint32_t time = 0xFFFFFF00u + (3 * WINDFUSION_HISTORY - 2) * IMU_PERIOD_MS + IMU_PERIOD_MS / 4;
+	WINDFUSION__process(&fusion, 0, 1000, time, &sample);
+	TEST_CHECK(sample.attitude.heading == (3 * WINDFUSION_HISTORY - 2) * 10 + 3);
+	return res;
+}
+
+testresult windfusion_heel_correction(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+
+	//A 10 knot beam wind seen by a sensor heeled 30 degrees reads 8.66 knots
+	WINDFUSION__init(&fusion, 0, 1000, 1000);
+	WINDFUSION__addAttitude(&fusion, 0, 300, 0, 0);
+	WINDFUSION__process(&fusion, 900, 866, 0, &sample);
+	TEST_CHECK(angleError(sample.apparentAngle, 900) <= 1 && abs(sample.apparentSpeed - 1000) <= 1);
+
+	//Heel only affects the athwartships component
+	WINDFUSION__process(&fusion, 0, 1000, 0, &sample);
+	TEST_CHECK(angleError(sample.apparentAngle, 0) <= 1 && abs(sample.apparentSpeed - 1000) <= 1);
+
+	//Wind 45 degrees off the bow reads closer to the bow when heeled
+	double x = 1000.0 * cos(M_PI / 4);
+	double y = 1000.0 * sin(M_PI / 4) * cos(M_PI / 6);
+	WINDFUSION__process(&fusion, (uint16_t)lround(atan2(y, x) * 1800 / M_PI), (uint16_t)lround(hypot(x, y)), 0, &sample);
+	TEST_CHECK(angleError(sample.apparentAngle, 450) <= 2 && abs(sample.apparentSpeed - 1000) <= 2);
+
+	//Pitch affects the fore and aft component, the correction is limited past WINDFUSION_MAX_TILT
+	WINDFUSION__addAttitude(&fusion, 0, 0, -900, 1);
+	WINDFUSION__process(&fusion, 1800, 500, 1, &sample);
+	TEST_CHECK(angleError(sample.apparentAngle, 1800) <= 1 && abs(sample.apparentSpeed - 1000) <= 1);
+	return res;
+}
+
+testresult windfusion_true_wind(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+	uint8_t data[WINDFUSION_CAN_PAYLOAD_SIZE];
+	const uint8_t boatSpeed[] = {0xF4, 0x01}; //5 knots
+
+	WINDFUSION__init(&fusion, 0, 1000, 2000);
+	WINDFUSION__addAttitude(&fusion, 900, 0, 0, 0);
+	WINDFUSION__setBoatSpeedCAN(&fusion, boatSpeed, 0);
+
+	//Sailing east at 5 knots in no wind gives a 5 knot apparent wind on the nose
+	WINDFUSION__process(&fusion, 0, 500, 0, &sample);
+	TEST_CHECK(sample.flags & WINDFUSION_VALID_TRUE);
+	TEST_CHECK(sample.trueSpeed <= 1);
+
+	//10 knots of true wind from the north on the port beam
+	double x = 500, y = -1000;
+	WINDFUSION__process(&fusion, fixed_wrap((int)lround(atan2(y, x) * 1800 / M_PI)), (uint16_t)lround(hypot(x, y)), 0, &sample);
+	TEST_CHECK(angleError(sample.trueAngle, 2700) <= 1 && abs(sample.trueSpeed - 1000) <= 1);
+	TEST_CHECK(angleError(sample.trueDirection, 0) <= 1);
+
+	sample.attitude.roll = -155;
+	WINDFUSION__packCAN(&sample, data);
+	TEST_CHECK((data[0] | (data[1] << 8)) == sample.apparentDirection);
+	TEST_CHECK((data[2] | (data[3] << 8)) == sample.trueDirection);
+	TEST_CHECK((data[4] | (data[5] << 8)) == sample.trueSpeed);
+	TEST_CHECK((int8_t)data[6] == -15 && data[7] == sample.flags);
+
+	//The boat speed expires
+	WINDFUSION__addAttitude(&fusion, 900, 0, 0, 2500);
+	WINDFUSION__process(&fusion, 0, 500, 2500, &sample);
+	TEST_CHECK(!(sample.flags & WINDFUSION_VALID_TRUE) && sample.trueSpeed == sample.apparentSpeed);
+	return res;
+}
+
+testresult windfusion_matches_reference(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+
+	WINDFUSION__init(&fusion, 0, 1000, 1000);
+	for (int i = 0; i < 200000; ++i) {
+		uint16_t heading = rng() % 3600;
+		int16_t roll = (int16_t)(rng() % 901) - 450;
+		int16_t pitch = (int16_t)(rng() % 301) - 150;
+		uint16_t direction = rng() % 3600;
+		uint16_t speed = 100 + rng() % 5000;
+		uint16_t boat = rng() % 1000;
+		uint32_t now = i * IMU_PERIOD_MS;
+
+		WINDFUSION__addAttitude(&fusion, heading, roll, pitch, now);
+		WINDFUSION__setBoatSpeed(&fusion, boat, now);
+		WINDFUSION__process(&fusion, direction, speed, now, &sample);
+
+		double x = speed * cos(direction * M_PI / 1800) / cos(pitch * M_PI / 1800);
+		double y = speed * sin(direction * M_PI / 1800) / cos(roll * M_PI / 1800);
+		double apparent = atan2(y, x) * 1800 / M_PI;
+		double trueAngle = atan2(y, x - boat) * 1800 / M_PI;
+		double trueSpeed = hypot(x - boat, y);
+
+		TEST_CHECK(angleError(sample.apparentAngle, (int)lround(apparent)) <= 2);
+		TEST_CHECK(fabs(sample.apparentSpeed - hypot(x, y)) <= 2.0);
+		TEST_CHECK(angleError(sample.apparentDirection, (int)lround(apparent) + heading) <= 2);
+		TEST_CHECK(fabs(sample.trueSpeed - trueSpeed) <= 2.0);
+		//The angle of a very light true wind is meaningless
+		TEST_CHECK(trueSpeed < 50 || angleError(sample.trueDirection, (int)lround(trueAngle) + heading) <= 3);
+	}
+	return res;
+}
+
+testresult windfusion_sample_cost(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDFUSION_SAMPLE sample;
+	uint32_t checksum = 0;
+
+	WINDFUSION__init(&fusion, 100, 1000, 1000);
+	WINDFUSION__setBoatSpeed(&fusion, 400, 0);
+	for (uint32_t i = 0; i < WINDFUSION_HISTORY; ++i) {
+		WINDFUSION__addAttitude(&fusion, rng() % 3600, 150, -20, i * IMU_PERIOD_MS);
+	}
+
+	//Wind samples are about 5 IMU periods old once the latency is removed
+	uint32_t now = WINDFUSION_HISTORY * IMU_PERIOD_MS;
+	clock_t start = clock();
+	for (uint32_t i = 0; i < BENCH_SAMPLES; ++i) {
+		WINDFUSION__setBoatSpeed(&fusion, 400, now);
+		WINDFUSION__process(&fusion, rng() % 3600, rng() % 3000, now, &sample);
+		checksum += sample.trueDirection;
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	TEST_CHECK(sample.flags == (WINDFUSION_VALID_APPARENT | WINDFUSION_VALID_ATTITUDE | WINDFUSION_VALID_TRUE));
+	printf("process: %.1f ns/sample (checksum %u)\r\n", seconds * 1e9 / BENCH_SAMPLES, (unsigned)checksum);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,236 @@
+/*
+ * windsensor_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "WINDSENSOR.h"
+#include "pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define CV7_BAUD 4800
+#define STREAM_SENTENCES 2000
+
+testresult windsensor_bursts_and_wraps(void);
+testresult windsensor_normal_dma(void);
+testresult windsensor_line_errors(void);
+testresult windsensor_sample_keeps_mask(void);
+testresult windsensor_temperature_timeout(void);
+testresult windsensor_stream_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Bursts across the circular buffer", .func=windsensor_bursts_and_wraps, .group=WIND},
+		{.testname="Normal DMA restarted by the driver", .func=windsensor_normal_dma, .group=WIND},
+		{.testname="Line errors and overruns", .func=windsensor_line_errors, .group=WIND},
+		{.testname="Sample copy keeps the interrupt mask", .func=windsensor_sample_keeps_mask, .group=WIND},
+		{.testname="Temperature expires without its sentence", .func=windsensor_temperature_timeout, .group=WIND},
+		{.testname="Stream benchmark", .func=windsensor_stream_benchmark, .group=WIND}
+};
+
+// -- Helpers --
+static UART_HandleTypeDef huart;
+static DMA_HandleTypeDef hdma;
+static WINDSENSOR* sensor;
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* uart, uint16_t Size) {
+	WINDSENSOR__handleRxEvent(sensor, uart, Size);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* uart) {
+	WINDSENSOR__handleError(sensor, uart);
+}
+
+//Sensor on USART2 at 4800 baud, DMA in circular or normal mode
+static void setup(uint32_t dmaMode) {
+	hal_host_reset();
+	pool_init();
+	hdma = (DMA_HandleTypeDef){.Instance = GPDMA1_Channel0, .Mode = dmaMode};
+	huart = (UART_HandleTypeDef){.Instance = USART2, .Init = {.BaudRate = CV7_BAUD}, .hdmarx = &hdma};
+	HAL_UART_Init(&huart);
+	sensor = WINDSENSOR__create(&huart);
+}
+
+//Wraps a sentence body in "$" and "*hh\r\n", returns the length written
+static int frame(char* out, const char* body) {
+	uint8_t checksum = 0;
+	for (const char* c = body; *c; ++c) checksum ^= (uint8_t)*c;
+	return sprintf(out, "$%s*%02X\r\n", body, checksum);
+}
+
+//Bytes on the line one after the other at the baud rate, the line goes idle after the last one if idle is set
+static void send(const char* text, uint16_t length, uint8_t idle) {
+	for (uint16_t i = 0; i < length; ++i) {
+		hal_host_advance(hal_host_uartByteTime(&huart, 1));
+		hal_host_uartReceive(&huart, (const uint8_t*)&text[i], 1, 0);
+	}
+	if (idle) {
+		hal_host_advance(hal_host_uartByteTime(&huart, 1));
+		hal_host_uartReceive(&huart, NULL, 0, 1);
+	}
+}
+
+static int windSentence(char* out, uint16_t direction, uint16_t speed) {
+	char body[48];
+	sprintf(body, "IIMWV,%03u.%u,R,%03u.%u,N,A", direction / 10, direction % 10, speed / 10, speed % 10);
+	return frame(out, body);
+}
+
+static WIND_SAMPLE sample(void) {
+	WIND_SAMPLE s;
+	WINDSENSOR__getSample(sensor, &s);
+	return s;
+}
+
+// -- Unit tests --
+testresult windsensor_bursts_and_wraps(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_LINKEDLIST_CIRCULAR);
+	TEST_CHECK(sensor != NULL && huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	//A wind and a temperature sentence every 200 ms, the 128 byte buffer wraps every few bursts and the half and
+	//full buffer events cut sentences anywhere
+	char burst[96];
+	for (uint16_t n = 1; n <= 60; ++n) {
+		uint16_t direction = (n * 97) % 3600;
+		uint16_t speed = n * 3;
+		int windLength = windSentence(burst, direction, speed);
+		int length = windLength + frame(burst + windLength, "WIXDR,C,021.5,C,");
+		uint64_t windEnd = hal_host_now() + hal_host_uartByteTime(&huart, windLength - 2);
+		send(burst, (uint16_t)length, 1);
+
+		WIND_SAMPLE s = sample();
+		TEST_CHECK(s.sequence == (uint8_t)n);
+		TEST_CHECK(s.direction == direction && s.speed == speed * 10u);
+		TEST_CHECK(s.temperature == 215);
+		TEST_CHECK(s.flags == (WIND_VALID_DIRECTION | WIND_VALID_SPEED | WIND_VALID_TEMPERATURE));
+		//Stamped by the first event after the checksum of the wind sentence (the CR LF are not waited for)
+		TEST_CHECK(s.timestamp >= windEnd / HAL_HOST_MS(1) && s.timestamp <= HAL_GetTick());
+		hal_host_advance(HAL_HOST_MS(200) - hal_host_uartByteTime(&huart, length + 1));
+	}
+	TEST_CHECK(hal_host_uartLost(USART2) == 0);
+	return res;
+}
+
+testresult windsensor_normal_dma(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_NORMAL);
+
+	//Each idle line or full buffer ends the reception, the driver starts the next one in the callback
+	char stream[256];
+	int length = 0;
+	for (uint16_t n = 0; n < 5; ++n) length += windSentence(stream + length, 100 + n, 50 + n);
+	TEST_CHECK(length > WIND_DMA_BUFFER_SIZE);
+	send(stream, (uint16_t)length, 1);
+	TEST_CHECK(sample().sequence == 5 && sample().direction == 104);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	send(stream, (uint16_t)windSentence(stream, 2000, 10), 1);
+	TEST_CHECK(sample().sequence == 6 && sample().direction == 2000);
+	TEST_CHECK(hal_host_uartLost(USART2) == 0);
+	return res;
+}
+
+testresult windsensor_line_errors(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_LINKEDLIST_CIRCULAR);
+	char sentence[64];
+	int length = windSentence(sentence, 450, 120);
+
+	//Noise half way through a sentence: it is lost, the reception restarts and the next one is decoded
+	send(sentence, (uint16_t)(length / 2), 0);
+	hal_host_uartError(&huart, HAL_UART_ERROR_NE);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_BUSY_RX && sensor->rxTail == 0);
+	send(sentence + length / 2, (uint16_t)(length - length / 2), 1);
+	TEST_CHECK(sample().sequence == 0);
+	send(sentence, (uint16_t)length, 1);
+	TEST_CHECK(sample().sequence == 1 && sample().direction == 450);
+
+	//An overrun the same way
+	send(sentence, 10, 0);
+	hal_host_uartError(&huart, HAL_UART_ERROR_ORE);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_BUSY_RX);
+	send(sentence, (uint16_t)length, 1);
+	TEST_CHECK(sample().sequence == 2);
+	return res;
+}
+
+testresult windsensor_sample_keeps_mask(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_LINKEDLIST_CIRCULAR);
+	char sentence[64];
+	send(sentence, (uint16_t)windSentence(sentence, 1234, 56), 1);
+
+	//The copy masks the interrupts and puts the mask back as it was, so it can be called from a critical section
+	TEST_CHECK(sample().sequence == 1 && sample().direction == 1234);
+	TEST_CHECK(__get_PRIMASK() == 0);
+	__disable_irq();
+	TEST_CHECK(sample().sequence == 1);
+	TEST_CHECK(__get_PRIMASK() == 1);
+	__enable_irq();
+	return res;
+}
+
+testresult windsensor_temperature_timeout(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_LINKEDLIST_CIRCULAR);
+	const uint8_t all = WIND_VALID_DIRECTION | WIND_VALID_SPEED | WIND_VALID_TEMPERATURE;
+
+	char text[64];
+	send(text, (uint16_t)frame(text, "WIXDR,C,021.5,C,"), 1);
+	uint32_t received = HAL_GetTick();
+	send(text, (uint16_t)windSentence(text, 900, 100), 1);
+	TEST_CHECK(sample().flags == all && sample().temperature == 215);
+
+	//Only wind sentences from now on: the temperature is valid up to the timeout, whether a wind sentence came or not
+	hal_host_advance(HAL_HOST_MS(received + WIND_TEMPERATURE_TIMEOUT_MS) - hal_host_now());
+	TEST_CHECK(sample().flags == all);
+	hal_host_advance(HAL_HOST_MS(1));
+	TEST_CHECK(sample().flags == (WIND_VALID_DIRECTION | WIND_VALID_SPEED));
+	send(text, (uint16_t)windSentence(text, 910, 100), 1);
+	TEST_CHECK(sample().flags == (WIND_VALID_DIRECTION | WIND_VALID_SPEED) && sample().direction == 910);
+
+	//Still not valid long after, the wind sentences do not bring it back
+	hal_host_advance(HAL_HOST_MS(60000));
+	send(text, (uint16_t)windSentence(text, 920, 100), 1);
+	TEST_CHECK(sample().flags == (WIND_VALID_DIRECTION | WIND_VALID_SPEED));
+
+	//Valid again with the next temperature sentence
+	send(text, (uint16_t)frame(text, "WIXDR,C,-003.0,C,"), 1);
+	TEST_CHECK(sample().flags == all && sample().temperature == -30);
+	return res;
+}
+
+testresult windsensor_stream_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(DMA_LINKEDLIST_CIRCULAR);
+	static char stream[STREAM_SENTENCES * 64];
+	int length = 0;
+	for (uint16_t n = 0; n < STREAM_SENTENCES; ++n) length += windSentence(stream + length, (n * 7) % 3600, n % 600);
+
+	//Whole stream in idle terminated bursts of 3 sentences, timing the driver on the host clock
+	clock_t start = clock();
+	int offset = 0;
+	for (uint16_t n = 0; n < STREAM_SENTENCES; n += 3) {
+		int end = offset;
+		for (uint16_t k = 0; k < 3 && n + k < STREAM_SENTENCES; ++k) end = (int)(strchr(stream + end, '\n') - stream) + 1;
+		send(stream + offset, (uint16_t)(end - offset), 1);
+		offset = end;
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	TEST_CHECK(offset == length);
+	TEST_CHECK(sample().sequence == (uint8_t)STREAM_SENTENCES);
+	printf("%d bytes (%.1f s at %u baud) in %.3f s on the host\n", length, hal_host_now() / 1e9, CV7_BAUD, seconds);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
@@ -0,0 +1,245 @@
+/*
+ * windstats_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "WINDSTATS.h"
+#include "fixed_trig.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//-- Test definitions --
+#define BENCH_SAMPLES 2000000
+#define SAMPLE_PERIOD_MS 500
+
+testresult trig_accuracy(void);
+testresult windstats_wraparound(void);
+testresult windstats_matches_reference(void);
+testresult windstats_gust_window(void);
+testresult windstats_publish_period(void);
+testresult windstats_sample_cost(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Fixed point trigonometry accuracy", .func=trig_accuracy, .group=WIND},
+		{.testname="Mean direction across 0/360", .func=windstats_wraparound, .group=WIND},
+		{.testname="Statistics match floating point reference", .func=windstats_matches_reference, .group=WIND},
+		{.testname="Gust and window expiry", .func=windstats_gust_window, .group=WIND},
+		{.testname="Publishing period", .func=windstats_publish_period, .group=WIND},
+		{.testname="Per-sample cost benchmark", .func=windstats_sample_cost, .group=WIND}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x2468ACE1;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Smallest difference between two angles in 0.1 degrees
+static int angleError(int a, int b) {
+	return abs(fixed_wrapSigned(a - b));
+}
+
+static WINDSTATS stats;
+
+// -- Unit tests --
+testresult trig_accuracy(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	for (int angle = -3600; angle <= 7200; ++angle) {
+		double radians = angle * M_PI / 1800.0;
+		TEST_CHECK(fabs(fixed_sin(angle) - sin(radians) * FIXED_TRIG_ONE) <= 2.0);
+		TEST_CHECK(fabs(fixed_cos(angle) - cos(radians) * FIXED_TRIG_ONE) <= 2.0);
+	}
+
+	for (int i = 0; i < 200000; ++i) {
+		int32_t x = (int32_t)(rng() >> (rng() % 31)) * ((rng() & 1) ? 1 : -1);
+		int32_t y = (int32_t)(rng() >> (rng() % 31)) * ((rng() & 1) ? 1 : -1);
+		if (x == 0 && y == 0) {
+			continue;
+		}
+		int expected = (int)lround(atan2((double)y, (double)x) * 1800.0 / M_PI);
+		TEST_CHECK(angleError(fixed_atan2(y, x), expected) <= 1);
+	}
+	TEST_CHECK(fixed_atan2(0, 0) == 0);
+	TEST_CHECK(fixed_atan2(0, -5) == 1800);
+	TEST_CHECK(fixed_atan2(-5, 0) == 2700);
+
+	TEST_CHECK(fixed_sqrt(0) == 0 && fixed_sqrt(15) == 3 && fixed_sqrt(16) == 4);
+	TEST_CHECK(fixed_sqrt(0xFFFFFFFFFFFFFFFFull) == 0xFFFFFFFFu);
+	return res;
+}
+
+testresult windstats_wraparound(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDSTATS_SUMMARY summary;
+
+	//Alternating 350 and 10 degrees averages to 0, not 180
+	WINDSTATS__init(&stats, 60000, 10000, 1000);
+	for (int i = 0; i < 20; ++i) {
+		WINDSTATS__add(&stats, (i & 1) ? 100 : 3500, 500, i * SAMPLE_PERIOD_MS);
+	}
+	WINDSTATS__getSummary(&stats, 20 * SAMPLE_PERIOD_MS, &summary);
+	TEST_CHECK(summary.samples == 20);
+	TEST_CHECK(angleError(summary.meanDirection, 0) <= 1);
+	TEST_CHECK(summary.directionVariance > 10 && summary.directionVariance < 20);
+
+	//355, 359, 1 and 5 degrees average to 0
+	WINDSTATS__init(&stats, 60000, 10000, 1000);
+	WINDSTATS__add(&stats, 3550, 100, 0);
+	WINDSTATS__add(&stats, 3590, 100, 1);
+	WINDSTATS__add(&stats, 10, 100, 2);
+	WINDSTATS__add(&stats, 50, 100, 3);
+	WINDSTATS__getSummary(&stats, 3, &summary);
+	TEST_CHECK(angleError(summary.meanDirection, 0) <= 1);
+
+	//Steady wind has no variance
+	WINDSTATS__init(&stats, 60000, 10000, 1000);
+	for (int i = 0; i < 10; ++i) {
+		WINDSTATS__add(&stats, 2700, 1234, i);
+	}
+	WINDSTATS__getSummary(&stats, 10, &summary);
+	TEST_CHECK(angleError(summary.meanDirection, 2700) <= 1);
+	TEST_CHECK(summary.directionVariance == 0 && summary.speedVariance == 0 && summary.meanSpeed == 1234);
+	return res;
+}
+
+testresult windstats_matches_reference(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDSTATS_SUMMARY summary;
+	const int window = 64;
+	uint16_t directions[4096];
+	uint16_t speeds[4096];
+
+	WINDSTATS__init(&stats, window * SAMPLE_PERIOD_MS, window * SAMPLE_PERIOD_MS, 1000);
+	for (int i = 0; i < 4096; ++i) {
+		//Wind oscillating around a slowly turning mean direction, crossing north many times
+		directions[i] = fixed_wrap(i * 7 + (int)(rng() % 900) - 450);
+		speeds[i] = 200 + rng() % 2000;
+		WINDSTATS__add(&stats, directions[i], speeds[i], i * SAMPLE_PERIOD_MS);
+
+		if (i < window || i % 17 != 0) {
+			continue;
+		}
+		WINDSTATS__getSummary(&stats, i * SAMPLE_PERIOD_MS, &summary);
+
+		//Reference over the samples in the window (a sample exactly windowMs old is still in)
+		double s = 0, c = 0, sum = 0, sumSquared = 0, gust = 0;
+		int n = 0;
+		for (int k = i - window; k <= i; ++k, ++n) {
+			s += sin(directions[k] * M_PI / 1800.0);
+			c += cos(directions[k] * M_PI / 1800.0);
+			sum += speeds[k];
+			sumSquared += (double)speeds[k] * speeds[k];
+			gust = (speeds[k] > gust) ? speeds[k] : gust;
+		}
+		double mean = sum / n;
+		double variance = sumSquared / n - mean * mean;
+		double direction = atan2(s, c) * 1800.0 / M_PI;
+		double circularVariance = 1000.0 * (1.0 - sqrt(s * s + c * c) / n);
+
+		TEST_CHECK(summary.samples == n);
+		TEST_CHECK(angleError(summary.meanDirection, (int)lround(direction)) <= 2);
+		TEST_CHECK(fabs(summary.directionVariance - circularVariance) <= 2.0);
+		TEST_CHECK(fabs(summary.meanSpeed - mean) <= 0.5);
+		TEST_CHECK(fabs(summary.speedVariance - variance) <= 1.0);
+		TEST_CHECK(summary.gustSpeed == gust);
+	}
+	return res;
+}
+
+testresult windstats_gust_window(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDSTATS_SUMMARY summary;
+
+	WINDSTATS__init(&stats, 10000, 3000, 1000);
+	WINDSTATS__add(&stats, 0, 900, 0);
+	WINDSTATS__add(&stats, 0, 100, 1000);
+	WINDSTATS__add(&stats, 0, 500, 2000);
+	WINDSTATS__add(&stats, 0, 300, 3000);
+
+	WINDSTATS__getSummary(&stats, 3000, &summary);
+	TEST_CHECK(summary.gustSpeed == 900 && summary.samples == 4);
+
+	//The 900 gust leaves the 3 s gust window but stays in the 10 s mean
+	WINDSTATS__getSummary(&stats, 3001, &summary);
+	TEST_CHECK(summary.gustSpeed == 500 && summary.samples == 4 && summary.meanSpeed == 450);
+	WINDSTATS__getSummary(&stats, 5001, &summary);
+	TEST_CHECK(summary.gustSpeed == 300);
+
+	//Everything expires
+	WINDSTATS__getSummary(&stats, 13001, &summary);
+	TEST_CHECK(summary.samples == 0 && summary.gustSpeed == 0 && summary.meanSpeed == 0);
+
+	//A window longer than the buffer keeps the newest WINDSTATS_MAX_SAMPLES samples
+	WINDSTATS__init(&stats, 0xFFFFFFFF, 0xFFFFFFFF, 1000);
+	for (int i = 0; i < 3 * WINDSTATS_MAX_SAMPLES; ++i) {
+		WINDSTATS__add(&stats, 0, (i < WINDSTATS_MAX_SAMPLES) ? 5000 : i, 20000 + i);
+	}
+	WINDSTATS__getSummary(&stats, 20000 + 3 * WINDSTATS_MAX_SAMPLES, &summary);
+	TEST_CHECK(summary.samples == WINDSTATS_MAX_SAMPLES);
+	TEST_CHECK(summary.gustSpeed == 3 * WINDSTATS_MAX_SAMPLES - 1);
+	return res;
+}
+
+testresult windstats_publish_period(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDSTATS_SUMMARY summary = {.meanDirection = 3599, .directionVariance = 1000, .meanSpeed = 1250,
+			.gustSpeed = 0xABCD, .speedVariance = 10000, .samples = 3};
+	uint8_t data[WINDSTATS_CAN_PAYLOAD_SIZE];
+	int published = 0;
+
+	//2 Hz samples published at 0.2 Hz
+	WINDSTATS__init(&stats, 60000, 10000, 5000);
+	for (uint32_t now = 5000; now < 65000; now += SAMPLE_PERIOD_MS) {
+		published += WINDSTATS__isDue(&stats, now);
+	}
+	TEST_CHECK(published == 12);
+
+	WINDSTATS__packCAN(&summary, data);
+	TEST_CHECK(data[0] == 0x0F && data[1] == 0x0E);
+	TEST_CHECK(data[2] == 0xE2 && data[3] == 0x04);
+	TEST_CHECK(data[4] == 0xCD && data[5] == 0xAB);
+	TEST_CHECK(data[6] == 10 && data[7] == 100);
+	return res;
+}
+
+testresult windstats_sample_cost(void) {
+	testresult res = {TSUCCESS, {0}};
+	WINDSTATS_SUMMARY summary;
+
+	WINDSTATS__init(&stats, 60000, 10000, 1000);
+	clock_t start = clock();
+	for (uint32_t i = 0; i < BENCH_SAMPLES; ++i) {
+		WINDSTATS__add(&stats, rng() % 3600, rng() % 3000, i * SAMPLE_PERIOD_MS);
+	}
+	double addSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	uint32_t checksum = 0;
+	for (uint32_t i = 0; i < BENCH_SAMPLES / 10; ++i) {
+		WINDSTATS__getSummary(&stats, (BENCH_SAMPLES - 1) * SAMPLE_PERIOD_MS, &summary);
+		checksum += summary.meanDirection;
+	}
+	double summarySeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	TEST_CHECK(summary.samples == 121);
+	printf("add: %.1f ns/sample, summary: %.1f ns (window of %u samples, checksum %u)\r\n",
+			addSeconds * 1e9 / BENCH_SAMPLES, summarySeconds * 1e9 / (BENCH_SAMPLES / 10), summary.samples,
+			(unsigned)checksum);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
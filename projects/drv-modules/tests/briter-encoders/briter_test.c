@@ -0,0 +1,282 @@
+/*
+ * briter_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "BRITER.h"
+#include "pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define ENCODER_BAUD 9600
+#define SAMPLE_PERIOD 50
+#define STREAM_SECONDS 600
+
+testresult briter_init_commands(void);
+testresult briter_position_stream(void);
+testresult briter_bad_frames(void);
+testresult briter_zero_position(void);
+testresult briter_silence(void);
+testresult briter_stream_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Initialization commands", .func=briter_init_commands, .group=ENCODER},
+		{.testname="Position stream", .func=briter_position_stream, .group=ENCODER},
+		{.testname="Bad length, CRC and header", .func=briter_bad_frames, .group=ENCODER},
+		{.testname="Zero position", .func=briter_zero_position, .group=ENCODER},
+		{.testname="Silence after the encoder stops", .func=briter_silence, .group=ENCODER},
+		{.testname="Stream benchmark", .func=briter_stream_benchmark, .group=ENCODER}
+};
+
+// -- Helpers --
+//Reference MODBUS CRC-16 (polynomial 0xA001 reflected, initial 0xFFFF)
+static uint16_t crc16(const uint8_t* data, uint16_t length) {
+	uint16_t crc = 0xFFFF;
+	for (uint16_t i = 0; i < length; ++i) {
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; ++bit) crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+	}
+	return crc;
+}
+
+//Encoder model: answers the write commands and sends its position every period once in automatic mode
+typedef struct {
+	UART_HandleTypeDef* huart;
+	uint16_t position; //raw, 1024 counts a turn
+	uint16_t zero;
+	uint16_t period; //ms
+	uint8_t automatic;
+	uint8_t silent; //powered off
+	uint32_t commands;
+	uint32_t badCommands;
+	uint32_t frames;
+} ENCODER_MODEL;
+
+static ENCODER_MODEL encoder;
+static UART_HandleTypeDef huart;
+static DMA_HandleTypeDef hdma;
+static BRITER* briter;
+
+static void positionFrame(uint8_t* frame, uint16_t raw) {
+	frame[0] = ENCODER_ADDRESS;
+	frame[1] = 0x03;
+	frame[2] = 0x04;
+	frame[3] = 0;
+	frame[4] = 0;
+	frame[5] = raw >> 8;
+	frame[6] = raw & 0xFF;
+	uint16_t crc = crc16(frame, 7);
+	frame[7] = crc & 0xFF;
+	frame[8] = crc >> 8;
+}
+
+static void sendPosition(void* context) {
+	ENCODER_MODEL* model = context;
+	if (!model->automatic || model->silent) return;
+	uint8_t frame[9];
+	positionFrame(frame, (uint16_t)((model->position - model->zero) & 0x3FF));
+	model->frames++;
+	hal_host_uartReceive(model->huart, frame, sizeof(frame), 1);
+	hal_host_schedule(HAL_HOST_MS(model->period), sendPosition, model);
+}
+
+static void encoderCommand(void* context, UART_HandleTypeDef* uart, const uint8_t* data, uint16_t length) {
+	ENCODER_MODEL* model = context;
+	(void)uart;
+	uint16_t crc = crc16(data, length - 2);
+	if (length != 8 || data[0] != ENCODER_ADDRESS || data[1] != 0x06 || data[6] != (crc & 0xFF) || data[7] != crc >> 8) {
+		model->badCommands++;
+		return;
+	}
+	model->commands++;
+	uint16_t reg = data[2] << 8 | data[3];
+	uint16_t value = data[4] << 8 | data[5];
+	if (reg == 0x0006) {
+		model->automatic = value == 1;
+		hal_host_cancel(sendPosition, model);
+		//The first frame after the period, from the end of the command
+		hal_host_schedule(HAL_HOST_MS(model->period) + hal_host_uartByteTime(model->huart, 9), sendPosition, model);
+	}
+	else if (reg == 0x0007) {
+		model->period = value;
+	}
+	else if (reg == 0x0008) {
+		model->zero = model->position;
+	}
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* uart, uint16_t Size) {
+	BRITER__handleDMA(briter, uart, Size);
+}
+
+static void setup(uint16_t position) {
+	hal_host_reset();
+	pool_init();
+	errlog_init(HAL_GetTick);
+	hdma = (DMA_HandleTypeDef){.Instance = GPDMA1_Channel3, .Mode = DMA_NORMAL};
+	huart = (UART_HandleTypeDef){.Instance = USART3, .Init = {.BaudRate = ENCODER_BAUD}, .hdmarx = &hdma};
+	HAL_UART_Init(&huart);
+	encoder = (ENCODER_MODEL){.huart = &huart, .position = position, .period = 20};
+	HAL_HOST_UART_MODEL model = {.transmit = encoderCommand, .context = &encoder};
+	hal_host_uartAttach(USART3, &model);
+	briter = BRITER__create(&huart, SAMPLE_PERIOD);
+}
+
+// -- Unit tests --
+testresult briter_init_commands(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(0);
+	TEST_CHECK(briter != NULL);
+
+	//Automatic position return, then the sample period, each followed by a 100 ms pause
+	uint8_t sent[32];
+	TEST_CHECK(hal_host_uartSent(USART3, sent, sizeof(sent)) == 16);
+	const uint8_t automatic[] = {0x01, 0x06, 0x00, 0x06, 0x00, 0x01};
+	const uint8_t rate[] = {0x01, 0x06, 0x00, 0x07, 0x00, SAMPLE_PERIOD};
+	TEST_CHECK(memcmp(sent, automatic, 6) == 0 && memcmp(&sent[8], rate, 6) == 0);
+	TEST_CHECK(encoder.commands == 2 && encoder.badCommands == 0);
+	TEST_CHECK(encoder.automatic && encoder.period == SAMPLE_PERIOD);
+	TEST_CHECK(hal_host_now() >= HAL_HOST_MS(200) + hal_host_uartByteTime(&huart, 16));
+	TEST_CHECK(hal_host_now() <= HAL_HOST_MS(202) + 2 * hal_host_uartByteTime(&huart, 8));
+
+	//Frames sent at the default period before the reception was started were lost
+	TEST_CHECK(hal_host_uartLost(USART3) > 0);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_BUSY_RX && huart.ReceptionType == HAL_UART_RECEPTION_TOIDLE);
+	return res;
+}
+
+testresult briter_position_stream(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(0);
+	uint32_t lost = hal_host_uartLost(USART3);
+
+	//Every raw position turns into its angle and the clamped value
+	for (uint16_t raw = 0; raw < 1024; raw += 7) {
+		encoder.position = raw;
+		uint32_t frames = encoder.frames;
+		hal_host_advance(HAL_HOST_MS(SAMPLE_PERIOD));
+		TEST_CHECK(encoder.frames == frames + 1);
+		TEST_CHECK(BRITER__getEncoderRaw(briter) == raw);
+		int16_t angle = (int16_t)(raw * 360 / 1024);
+		TEST_CHECK(briter->angleVal == angle);
+		int16_t signedAngle = angle < 180 ? angle : angle - 360;
+		TEST_CHECK(briter->passval == (signedAngle > 45 ? 45 : signedAngle < -45 ? -45 : signedAngle));
+	}
+	TEST_CHECK(hal_host_uartLost(USART3) == lost);
+	TEST_CHECK(errlog_count(BRITER_ERROR_LENGTH) == 0 && errlog_count(BRITER_ERROR_CRC) == 0);
+	TEST_CHECK(errlog_count(BRITER_ERROR_TIMEOUT) == 0);
+	return res;
+}
+
+testresult briter_bad_frames(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(100);
+	encoder.silent = 1;
+	uint8_t frame[9];
+
+	//Short frame
+	positionFrame(frame, 300);
+	hal_host_uartReceive(&huart, frame, 7, 1);
+	TEST_CHECK(errlog_count(BRITER_ERROR_LENGTH) == 1 && huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	//Broken CRC
+	frame[8] ^= 0x40;
+	hal_host_uartReceive(&huart, frame, 9, 1);
+	TEST_CHECK(errlog_count(BRITER_ERROR_CRC) == 1 && huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	//Valid CRC on another function code
+	frame[1] = 0x06;
+	uint16_t crc = crc16(frame, 7);
+	frame[7] = crc & 0xFF;
+	frame[8] = crc >> 8;
+	hal_host_uartReceive(&huart, frame, 9, 1);
+	TEST_CHECK(errlog_count(BRITER_ERROR_FORMAT) == 1);
+	TEST_CHECK(BRITER__getEncoderRaw(briter) != 300);
+
+	//Still in sync for the next good frame
+	positionFrame(frame, 300);
+	hal_host_uartReceive(&huart, frame, 9, 1);
+	TEST_CHECK(BRITER__getEncoderRaw(briter) == 300);
+
+	//Two frames in one burst: cut into a full 16 byte reception and a 2 byte one, both dropped
+	uint8_t burst[18];
+	positionFrame(burst, 10);
+	positionFrame(&burst[9], 11);
+	hal_host_uartReceive(&huart, burst, sizeof(burst), 1);
+	TEST_CHECK(errlog_count(BRITER_ERROR_LENGTH) == 3 && BRITER__getEncoderRaw(briter) == 300);
+	return res;
+}
+
+testresult briter_zero_position(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(700);
+	hal_host_advance(HAL_HOST_MS(SAMPLE_PERIOD));
+	TEST_CHECK(BRITER__getEncoderRaw(briter) == 700);
+
+	BRITER__zeroPosition(briter);
+	TEST_CHECK(encoder.commands == 3 && encoder.zero == 700);
+	hal_host_advance(HAL_HOST_MS(SAMPLE_PERIOD));
+	TEST_CHECK(BRITER__getEncoderRaw(briter) == 0 && briter->angleVal == 0 && briter->passval == 0);
+	encoder.position = 690;
+	hal_host_advance(HAL_HOST_MS(SAMPLE_PERIOD));
+	TEST_CHECK(BRITER__getEncoderRaw(briter) == 1014 && briter->passval == -4);
+	return res;
+}
+
+testresult briter_silence(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(0);
+	hal_host_advance(HAL_HOST_MS(500));
+	TEST_CHECK(errlog_count(BRITER_ERROR_TIMEOUT) == 0);
+
+	//The check only runs when a frame arrives, so a long silence is reported by the first frame after it
+	encoder.silent = 1;
+	hal_host_advance(HAL_HOST_MS(6000));
+	TEST_CHECK(errlog_count(BRITER_ERROR_TIMEOUT) == 0);
+	encoder.silent = 0;
+	hal_host_schedule(0, sendPosition, &encoder);
+	hal_host_advance(HAL_HOST_MS(1));
+	TEST_CHECK(errlog_count(BRITER_ERROR_TIMEOUT) == 1);
+	errlog_entry entry;
+	uint8_t found = 0;
+	while (errlog_pop(&entry)) {
+		if (entry.code == BRITER_ERROR_TIMEOUT) {
+			found = 1;
+			TEST_CHECK(entry.detail >= 6000 && entry.detail <= 6000 + SAMPLE_PERIOD + 1);
+		}
+	}
+	TEST_CHECK(found);
+	return res;
+}
+
+testresult briter_stream_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup(0);
+	uint32_t frames = encoder.frames;
+
+	//Minutes of positions at the sample period, timing the driver on the host clock
+	clock_t start = clock();
+	for (uint32_t ms = 0; ms < STREAM_SECONDS * 1000u; ms += SAMPLE_PERIOD) {
+		encoder.position = (uint16_t)(ms / SAMPLE_PERIOD) & 0x3FF;
+		hal_host_advance(HAL_HOST_MS(SAMPLE_PERIOD));
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	frames = encoder.frames - frames;
+	TEST_CHECK(frames == STREAM_SECONDS * 1000u / SAMPLE_PERIOD);
+	TEST_CHECK(errlog_count(BRITER_ERROR_LENGTH) == 0 && errlog_count(BRITER_ERROR_CRC) == 0);
+	printf("%lu frames (%u s at %u ms) in %.3f s on the host, %.2f us a frame\n", (unsigned long)frames,
+			STREAM_SECONDS, SAMPLE_PERIOD, seconds, seconds * 1e6 / frames);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
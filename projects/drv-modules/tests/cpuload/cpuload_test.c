@@ -0,0 +1,218 @@
+/*
+ * cpuload_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "cpuload.h"
+
+//-- Test definitions --
+#define WINDOW 1000 // one tick per thousandth
+#define RANDOM_WINDOWS 5000
+
+testresult cpuload_busy(void);
+testresult cpuload_residencies(void);
+testresult cpuload_split(void);
+testresult cpuload_wrap(void);
+testresult cpuload_rounding(void);
+testresult cpuload_ignored(void);
+testresult cpuload_can(void);
+testresult cpuload_random(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Windows without idle time", .func=cpuload_busy, .group=LOAD},
+		{.testname="Sleep and Stop2 residencies", .func=cpuload_residencies, .group=LOAD},
+		{.testname="Idle period across windows", .func=cpuload_split, .group=LOAD},
+		{.testname="Time wrapping around", .func=cpuload_wrap, .group=LOAD},
+		{.testname="Rounding", .func=cpuload_rounding, .group=LOAD},
+		{.testname="Ignored periods", .func=cpuload_ignored, .group=LOAD},
+		{.testname="CAN frame", .func=cpuload_can, .group=LOAD},
+		{.testname="Random idle loop", .func=cpuload_random, .group=LOAD}
+};
+
+// -- Helpers --
+static uint32_t rng = 0x1D1E5EED;
+static uint32_t rnd(void) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+static uint16_t sum(const CPULOAD* load) {
+	return load->residency[CPULOAD_RUN] + load->residency[CPULOAD_SLEEP] + load->residency[CPULOAD_STOP2];
+}
+
+// -- Unit tests --
+testresult cpuload_busy(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	cpuload_init(&load, WINDOW, 0);
+
+	//Nothing to report before the first window ends
+	TEST_CHECK(cpuload_update(&load, WINDOW - 1) == 0 && load.windows == 0 && cpuload_load(&load) == 0);
+	TEST_CHECK(cpuload_update(&load, WINDOW) == 1 && cpuload_load(&load) == CPULOAD_SCALE && load.peakLoad == CPULOAD_SCALE);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_SLEEP) == 0 && cpuload_residency(&load, CPULOAD_STOP2) == 0);
+
+	//A long gap closes every window in it
+	TEST_CHECK(cpuload_update(&load, 6 * WINDOW + 10) == 5 && load.windows == 6 && load.windowStart == 6 * WINDOW);
+	return res;
+}
+
+testresult cpuload_residencies(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	cpuload_init(&load, WINDOW, 0);
+	cpuload_idle(&load, CPULOAD_SLEEP, 100, 250);
+	cpuload_idle(&load, CPULOAD_STOP2, 300, 500);
+	cpuload_idle(&load, CPULOAD_SLEEP, 600, 750);
+	TEST_CHECK(cpuload_update(&load, WINDOW) == 1);
+	TEST_CHECK(cpuload_load(&load) == 500 && cpuload_residency(&load, CPULOAD_RUN) == 500);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_SLEEP) == 300 && cpuload_residency(&load, CPULOAD_STOP2) == 200);
+	TEST_CHECK(load.peakLoad == 500);
+
+	//The next window starts empty, the peak stays the highest
+	cpuload_idle(&load, CPULOAD_STOP2, WINDOW, WINDOW + 900);
+	cpuload_update(&load, 2 * WINDOW);
+	TEST_CHECK(cpuload_load(&load) == 100 && cpuload_residency(&load, CPULOAD_STOP2) == 900 && load.peakLoad == 500);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_SLEEP) == 0);
+	cpuload_update(&load, 3 * WINDOW);
+	TEST_CHECK(cpuload_load(&load) == CPULOAD_SCALE && load.peakLoad == CPULOAD_SCALE);
+	return res;
+}
+
+testresult cpuload_split(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	cpuload_init(&load, WINDOW, 0);
+
+	//The part before the end of the window closes it as soon as the period is counted
+	cpuload_idle(&load, CPULOAD_SLEEP, 900, 1300);
+	TEST_CHECK(load.windows == 1 && cpuload_residency(&load, CPULOAD_SLEEP) == 100 && cpuload_load(&load) == 900);
+	cpuload_update(&load, 2 * WINDOW);
+	TEST_CHECK(load.windows == 2 && cpuload_residency(&load, CPULOAD_SLEEP) == 300 && cpuload_load(&load) == 700);
+
+	//An idle period starting in a later window closes the ones before it
+	cpuload_idle(&load, CPULOAD_STOP2, 4 * WINDOW + 200, 4 * WINDOW + 400);
+	TEST_CHECK(load.windows == 4 && cpuload_load(&load) == CPULOAD_SCALE);
+	cpuload_update(&load, 5 * WINDOW);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_STOP2) == 200);
+
+	//Ending exactly at the end of a window
+	cpuload_idle(&load, CPULOAD_SLEEP, 5 * WINDOW + 500, 6 * WINDOW);
+	TEST_CHECK(load.windows == 6 && cpuload_residency(&load, CPULOAD_SLEEP) == 500 && load.idle[CPULOAD_SLEEP] == 0);
+	return res;
+}
+
+testresult cpuload_wrap(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	uint32_t start = UINT32_MAX - 300;
+	cpuload_init(&load, WINDOW, start);
+	cpuload_idle(&load, CPULOAD_SLEEP, start + 100, start + 500);
+	TEST_CHECK(cpuload_update(&load, start + WINDOW - 1) == 0);
+	TEST_CHECK(cpuload_update(&load, start + WINDOW) == 1 && cpuload_residency(&load, CPULOAD_SLEEP) == 400);
+
+	cpuload_idle(&load, CPULOAD_STOP2, start + 1800, start + 2100);
+	TEST_CHECK(load.windows == 2 && cpuload_residency(&load, CPULOAD_STOP2) == 200);
+	return res;
+}
+
+testresult cpuload_rounding(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	cpuload_init(&load, 3000, 0);
+	cpuload_idle(&load, CPULOAD_SLEEP, 0, 1001);
+	cpuload_idle(&load, CPULOAD_STOP2, 1001, 2002);
+	cpuload_update(&load, 3000);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_SLEEP) == 333 && cpuload_residency(&load, CPULOAD_STOP2) == 333);
+	TEST_CHECK(cpuload_load(&load) == 334 && sum(&load) == CPULOAD_SCALE);
+
+	//A window longer than 2^32 / CPULOAD_SCALE does not overflow
+	cpuload_init(&load, 1000000, 0);
+	cpuload_idle(&load, CPULOAD_STOP2, 0, 999999);
+	cpuload_update(&load, 1000000);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_STOP2) == 999 && cpuload_load(&load) == 1);
+	return res;
+}
+
+testresult cpuload_ignored(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	cpuload_init(&load, WINDOW, 0);
+	cpuload_idle(&load, CPULOAD_RUN, 0, 500);
+	cpuload_idle(&load, CPULOAD_STATES, 0, 500);
+	cpuload_idle(&load, CPULOAD_SLEEP, 500, 500);
+	cpuload_idle(&load, CPULOAD_SLEEP, 600, 500);
+	cpuload_update(&load, WINDOW);
+	TEST_CHECK(cpuload_load(&load) == CPULOAD_SCALE);
+
+	//The part of a period in a window already closed is not counted again
+	cpuload_idle(&load, CPULOAD_SLEEP, WINDOW - 100, WINDOW + 100);
+	cpuload_update(&load, 2 * WINDOW);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_SLEEP) == 100);
+	TEST_CHECK(cpuload_residency(&load, CPULOAD_STATES) == 0);
+
+	//A zero window is taken as one tick
+	cpuload_init(&load, 0, 0);
+	TEST_CHECK(cpuload_update(&load, 3) == 3);
+	return res;
+}
+
+testresult cpuload_can(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	uint8_t data[CPULOAD_CAN_PAYLOAD_SIZE];
+	cpuload_init(&load, WINDOW, 0);
+	cpuload_idle(&load, CPULOAD_STOP2, 0, 100);
+	cpuload_update(&load, WINDOW);
+	cpuload_idle(&load, CPULOAD_SLEEP, WINDOW, WINDOW + 250);
+	cpuload_idle(&load, CPULOAD_STOP2, WINDOW + 300, WINDOW + 700);
+	cpuload_update(&load, 2 * WINDOW);
+	cpuload_packCan(&load, data);
+
+	const uint16_t expected[4] = {350, 900, 250, 400};
+	for (uint8_t i = 0; i < 4; ++i) {
+		TEST_CHECK((data[2 * i] | data[2 * i + 1] << 8) == expected[i]);
+	}
+	return res;
+}
+
+testresult cpuload_random(void) {
+	testresult res = {TSUCCESS, {0}};
+	CPULOAD load;
+	static uint16_t expected[RANDOM_WINDOWS][CPULOAD_STATES];
+	uint32_t origin = rnd();
+	cpuload_init(&load, WINDOW, origin);
+
+	//A loop that runs then sleeps for random times, each idle period is also split by hand into the windows
+	uint32_t now = 0;
+	while (now < (RANDOM_WINDOWS - 1) * WINDOW) {
+		now += rnd() % 50;
+		CPULOAD_STATE state = rnd() % 2 ? CPULOAD_SLEEP : CPULOAD_STOP2;
+		uint32_t end = now + rnd() % 300;
+		for (uint32_t t = now; t < end; t = (t / WINDOW + 1) * WINDOW) {
+			uint32_t windowEnd = (t / WINDOW + 1) * WINDOW;
+			expected[t / WINDOW][state] += (end < windowEnd ? end : windowEnd) - t;
+		}
+
+		uint32_t windows = load.windows;
+		cpuload_idle(&load, state, origin + now, origin + end);
+		if (load.windows != windows) {
+			TEST_CHECK(load.residency[CPULOAD_SLEEP] == expected[load.windows - 1][CPULOAD_SLEEP]);
+			TEST_CHECK(load.residency[CPULOAD_STOP2] == expected[load.windows - 1][CPULOAD_STOP2]);
+			TEST_CHECK(sum(&load) == CPULOAD_SCALE);
+		}
+		now = end;
+	}
+	TEST_CHECK(load.windows >= RANDOM_WINDOWS - 2);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
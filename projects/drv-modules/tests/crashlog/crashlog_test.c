@@ -0,0 +1,227 @@
+/*
+ * crashlog_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "crashlog.h"
+#include <stddef.h>
+#include <string.h>
+
+//-- Test definitions --
+#define STACK_SIZE 64
+#define EXC_RETURN_MSP 0xFFFFFFF9 // thread mode, main stack, no FPU frame
+#define EXC_RETURN_PSP_FPU 0xFFFFFFED // thread mode, process stack, FPU frame
+
+testresult crashlog_basic_frame(void);
+testresult crashlog_fpu_aligned_frame(void);
+testresult crashlog_stack_bounds(void);
+testresult crashlog_boot_record(void);
+testresult crashlog_text_lines(void);
+testresult crashlog_can_frames(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Basic exception frame and stack", .func=crashlog_basic_frame, .group=CRASH},
+		{.testname="FPU frame and alignment word", .func=crashlog_fpu_aligned_frame, .group=CRASH},
+		{.testname="Stack pointer outside the stack", .func=crashlog_stack_bounds, .group=CRASH},
+		{.testname="Record across resets", .func=crashlog_boot_record, .group=CRASH},
+		{.testname="Text lines", .func=crashlog_text_lines, .group=CRASH},
+		{.testname="CAN frames", .func=crashlog_can_frames, .group=CRASH}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0xC0FFEE11;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//The no-init record starts as whatever was in RAM
+static CRASHLOG_RECORD record;
+static uint32_t stack[STACK_SIZE];
+static const CRASHLOG_FAULT fault = {.cfsr = 0x00008200, .hfsr = 0x40000000, .mmfar = 0xE000ED34, .bfar = 0x30000000};
+
+static void randomRecord(void) {
+	uint8_t* bytes = (uint8_t*)&record;
+	for (size_t i = 0; i < sizeof(record); ++i) bytes[i] = rng();
+}
+
+//Fills the stack with recognisable words and puts an exception frame at the given index
+static void fillStack(uint32_t frame, uint32_t xpsr) {
+	for (uint32_t i = 0; i < STACK_SIZE; ++i) stack[i] = 0x20000000 + i;
+	const uint32_t registers[8] = {0x10, 0x11, 0x12, 0x13, 0x1C, 0x08001235, 0x08004320, xpsr};
+	memcpy(&stack[frame], registers, sizeof(registers));
+}
+
+static void capture(uint32_t frame, uint32_t excReturn) {
+	crashlog_capture(&record, &stack[frame], excReturn, &fault, 123456, (uintptr_t)stack, (uintptr_t)&stack[STACK_SIZE]);
+}
+
+// -- Unit tests --
+testresult crashlog_basic_frame(void) {
+	testresult res = {TSUCCESS, {0}};
+	randomRecord();
+	TEST_CHECK(!crashlog_boot(&record));
+	fillStack(10, 0x61000000);
+	capture(10, EXC_RETURN_MSP);
+
+	TEST_CHECK(crashlog_valid(&record) && record.pending && record.crashes == 1);
+	TEST_CHECK(record.r0 == 0x10 && record.r1 == 0x11 && record.r2 == 0x12 && record.r3 == 0x13 && record.r12 == 0x1C);
+	TEST_CHECK(record.lr == 0x08001235 && record.pc == 0x08004320 && record.xpsr == 0x61000000);
+	TEST_CHECK(record.excReturn == EXC_RETURN_MSP && record.uptimeMs == 123456);
+	TEST_CHECK(memcmp(&record.fault, &fault, sizeof(fault)) == 0);
+
+	//The stack of the code that faulted starts right after the 8 stacked registers
+	TEST_CHECK(record.sp == (uint32_t)(uintptr_t)&stack[18]);
+	TEST_CHECK(record.stackWords == CRASHLOG_STACK_WORDS);
+	for (uint32_t i = 0; i < CRASHLOG_STACK_WORDS; ++i) TEST_CHECK(record.stack[i] == 0x20000000 + 18 + i);
+	return res;
+}
+
+testresult crashlog_fpu_aligned_frame(void) {
+	testresult res = {TSUCCESS, {0}};
+	randomRecord();
+	crashlog_boot(&record);
+
+	//s0 to s15, FPSCR and a reserved word follow the basic frame
+	fillStack(4, 0x21000000);
+	capture(4, EXC_RETURN_PSP_FPU);
+	TEST_CHECK(record.sp == (uint32_t)(uintptr_t)&stack[30] && record.stack[0] == 0x20000000 + 30);
+
+	//The core skipped a word to align the frame, the caller's stack starts one word higher
+	fillStack(4, 0x21000200);
+	capture(4, EXC_RETURN_MSP);
+	TEST_CHECK(record.sp == (uint32_t)(uintptr_t)&stack[13] && record.stack[0] == 0x20000000 + 13);
+	TEST_CHECK(record.crashes == 2);
+	return res;
+}
+
+testresult crashlog_stack_bounds(void) {
+	testresult res = {TSUCCESS, {0}};
+	randomRecord();
+	crashlog_boot(&record);
+
+	//Near the top only the words below the top are copied, the rest reads as 0
+	fillStack(STACK_SIZE - 12, 0x61000000);
+	capture(STACK_SIZE - 12, EXC_RETURN_MSP);
+	TEST_CHECK(record.pc == 0x08004320 && record.stackWords == 4);
+	TEST_CHECK(record.stack[3] == 0x20000000 + STACK_SIZE - 1 && record.stack[4] == 0);
+
+	//A frame right at the top: registers, but no stack
+	fillStack(STACK_SIZE - 8, 0x61000000);
+	capture(STACK_SIZE - 8, EXC_RETURN_MSP);
+	TEST_CHECK(record.pc == 0x08004320 && record.stackWords == 0);
+
+	//Overflowed stack, stack pointer below the stack or not aligned: nothing is read
+	const uint32_t* outside[] = {(const uint32_t*)((uintptr_t)stack - 16), &stack[STACK_SIZE - 2],
+			(const uint32_t*)((uintptr_t)&stack[8] + 2)};
+	for (uint8_t i = 0; i < sizeof(outside) / sizeof(outside[0]); ++i) {
+		crashlog_capture(&record, outside[i], EXC_RETURN_MSP, &fault, 1, (uintptr_t)stack, (uintptr_t)&stack[STACK_SIZE]);
+		TEST_CHECK(crashlog_valid(&record) && record.pending);
+		TEST_CHECK(record.pc == 0 && record.lr == 0 && record.xpsr == 0 && record.fault.cfsr == fault.cfsr);
+	}
+	TEST_CHECK(record.stackWords == 0);
+	return res;
+}
+
+testresult crashlog_boot_record(void) {
+	testresult res = {TSUCCESS, {0}};
+
+	//Random power-on RAM is never taken for a crash
+	for (uint16_t i = 0; i < 1000; ++i) {
+		randomRecord();
+		TEST_CHECK(!crashlog_boot(&record) && crashlog_valid(&record) && record.crashes == 0);
+	}
+
+	//Reported once, counted across resets
+	fillStack(10, 0x61000000);
+	capture(10, EXC_RETURN_MSP);
+	TEST_CHECK(crashlog_boot(&record) && record.crashes == 1);
+	crashlog_reported(&record);
+	TEST_CHECK(!crashlog_boot(&record) && crashlog_valid(&record) && record.crashes == 1);
+	capture(10, EXC_RETURN_MSP);
+	TEST_CHECK(crashlog_boot(&record) && record.crashes == 2);
+
+	//Any flipped bit clears the record
+	CRASHLOG_RECORD saved = record;
+	for (size_t bit = 0; bit < 8 * sizeof(record); ++bit) {
+		record = saved;
+		((uint8_t*)&record)[bit / 8] ^= 1 << (bit % 8);
+		TEST_CHECK(!crashlog_boot(&record) && record.crashes == 0);
+	}
+	return res;
+}
+
+testresult crashlog_text_lines(void) {
+	testresult res = {TSUCCESS, {0}};
+	char line[CRASHLOG_LINE_SIZE];
+	randomRecord();
+	crashlog_boot(&record);
+	fillStack(10, 0x61000000);
+	capture(10, EXC_RETURN_MSP);
+	record.sp = 0x2000FFC0; //the host address does not fit the expected line
+	record.stack[15] = 0x0800ABCD;
+
+	const char* expected[] = {
+		"CRASH n=1 up=1e240 exc=fffffff9\r\n",
+		"CRASH pc=08004320 lr=08001235 psr=61000000 sp=2000ffc0\r\n",
+		"CRASH r0=00000010 r1=00000011 r2=00000012 r3=00000013\r\n",
+		"CRASH r12=0000001c cfsr=00008200 hfsr=40000000\r\n",
+		"CRASH mmfar=e000ed34 bfar=30000000\r\n",
+		"CRASH s0=20000012 20000013 20000014 20000015\r\n",
+		"CRASH s4=20000016 20000017 20000018 20000019\r\n",
+		"CRASH s8=2000001a 2000001b 2000001c 2000001d\r\n",
+		"CRASH sc=2000001e 2000001f 20000020 0800abcd\r\n"
+	};
+	uint8_t lines = sizeof(expected) / sizeof(expected[0]);
+	for (uint8_t i = 0; i < lines; ++i) {
+		uint8_t length = crashlog_formatLine(&record, i, line);
+		TEST_CHECK(strcmp(line, expected[i]) == 0 && length == strlen(line));
+	}
+	TEST_CHECK(crashlog_formatLine(&record, lines, line) == 0 && line[0] == '\0');
+
+	//A partial last stack line, every line fits with the largest values
+	record.stackWords = 6;
+	TEST_CHECK(crashlog_formatLine(&record, 6, line) > 0 && strcmp(line, "CRASH s4=20000016 20000017\r\n") == 0);
+	TEST_CHECK(crashlog_formatLine(&record, 7, line) == 0);
+	memset(&record, 0xFF, sizeof(record));
+	record.stackWords = CRASHLOG_STACK_WORDS;
+	for (uint8_t i = 0; i < lines; ++i) {
+		uint8_t length = crashlog_formatLine(&record, i, line);
+		TEST_CHECK(length > 0 && length < CRASHLOG_LINE_SIZE - 1 && line[length - 1] == '\n');
+	}
+	return res;
+}
+
+testresult crashlog_can_frames(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t data[CRASHLOG_CAN_PAYLOAD_SIZE];
+	randomRecord();
+	crashlog_boot(&record);
+	fillStack(STACK_SIZE - 12, 0x61000000);
+	capture(STACK_SIZE - 12, EXC_RETURN_MSP);
+	TEST_CHECK(crashlog_words(&record) == CRASHLOG_HEADER_WORDS + 4);
+
+	const uint32_t header[CRASHLOG_HEADER_WORDS] = {1, 123456, 0x08004320, 0x08001235, 0x61000000, record.sp,
+			EXC_RETURN_MSP, 0x10, 0x11, 0x12, 0x13, 0x1C, fault.cfsr, fault.hfsr, fault.mmfar, fault.bfar};
+	for (uint8_t i = 0; i < crashlog_words(&record); ++i) {
+		uint32_t word = i < CRASHLOG_HEADER_WORDS ? header[i] : 0x20000000u + STACK_SIZE - 4 + i - CRASHLOG_HEADER_WORDS;
+		crashlog_packCan(&record, i, data);
+		TEST_CHECK(crashlog_word(&record, i) == word);
+		TEST_CHECK(data[0] == i && data[1] == CRASHLOG_HEADER_WORDS + 4 && data[2] == 0 && data[3] == 0);
+		TEST_CHECK(data[4] == (word & 0xFF) && data[5] == ((word >> 8) & 0xFF) && data[6] == ((word >> 16) & 0xFF) && data[7] == word >> 24);
+	}
+	TEST_CHECK(crashlog_word(&record, CRASHLOG_HEADER_WORDS + 4) == 0);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,209 @@
+/*
+ * errlog_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "errlog.h"
+#include <pthread.h>
+#include <string.h>
+
+//-- Test definitions --
+#define PRODUCERS 4
+#define REPORTS_PER_PRODUCER 60000 //fits the 16 bit detail
+
+testresult errlog_code_layout(void);
+testresult errlog_queue_order(void);
+testresult errlog_rate_limit(void);
+testresult errlog_ring_full(void);
+testresult errlog_wire_formats(void);
+testresult errlog_concurrent_producers(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Code layout", .func=errlog_code_layout, .group=ERRLOG},
+		{.testname="Queue order and timestamps", .func=errlog_queue_order, .group=ERRLOG},
+		{.testname="Rate limit per code", .func=errlog_rate_limit, .group=ERRLOG},
+		{.testname="Full ring drops without blocking", .func=errlog_ring_full, .group=ERRLOG},
+		{.testname="CAN and text formats", .func=errlog_wire_formats, .group=ERRLOG},
+		{.testname="Concurrent producers and consumer", .func=errlog_concurrent_producers, .group=ERRLOG}
+};
+
+// -- Helpers --
+static uint32_t fakeTime = 0;
+
+static uint32_t fakeClock(void) {
+	return fakeTime;
+}
+
+//Every call is a new rate window so nothing is suppressed
+static uint32_t fastClock(void) {
+	return __atomic_add_fetch(&fakeTime, ERRLOG_RATE_WINDOW_MS, __ATOMIC_RELAXED);
+}
+
+#define CODE_A ERRLOG_CODE(ERRLOG_MODULE_BRITER, 1, ERRLOG_MID)
+#define CODE_B ERRLOG_CODE(ERRLOG_MODULE_I2C, 7, ERRLOG_HIGH)
+
+// -- Unit tests --
+testresult errlog_code_layout(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint16_t code = ERRLOG_CODE(ERRLOG_MODULE_WIND, 0xAB, ERRLOG_FATAL);
+	TEST_CHECK(ERRLOG_MODULE(code) == ERRLOG_MODULE_WIND && ERRLOG_NUMBER(code) == 0xAB && ERRLOG_SEVERITY(code) == ERRLOG_FATAL);
+	TEST_CHECK(code == 0xC9AB);
+
+	errlog_init(fakeClock);
+	TEST_CHECK(errlog_report(ERRLOG_NONE, 1) == ERRLOG_IGNORED && errlog_latest() == ERRLOG_NONE);
+	return res;
+}
+
+testresult errlog_queue_order(void) {
+	testresult res = {TSUCCESS, {0}};
+	errlog_entry entry;
+	errlog_init(fakeClock);
+	TEST_CHECK(!errlog_pop(&entry));
+
+	fakeTime = 100;
+	TEST_CHECK(errlog_report(CODE_A, 1) == ERRLOG_QUEUED);
+	fakeTime = 250;
+	TEST_CHECK(errlog_report(CODE_B, 2) == ERRLOG_QUEUED);
+	TEST_CHECK(errlog_latest() == CODE_B);
+
+	TEST_CHECK(errlog_pop(&entry) && entry.time == 100 && entry.code == CODE_A && entry.detail == 1);
+	TEST_CHECK(errlog_pop(&entry) && entry.time == 250 && entry.code == CODE_B && entry.detail == 2);
+	TEST_CHECK(!errlog_pop(&entry));
+
+	TEST_CHECK(errlog_count(CODE_A) == 1 && errlog_count(CODE_B) == 1 && errlog_count(CODE_A + 1) == 0);
+	TEST_CHECK(errlog_severity_count(ERRLOG_MID) == 1 && errlog_severity_count(ERRLOG_HIGH) == 1);
+	TEST_CHECK(errlog_severity_count(ERRLOG_LOW) == 0);
+	return res;
+}
+
+testresult errlog_rate_limit(void) {
+	testresult res = {TSUCCESS, {0}};
+	errlog_entry entry;
+	errlog_stats stats;
+	errlog_init(fakeClock);
+	fakeTime = 5000;
+
+	//A burst of one code only queues the first few, another code is not affected
+	for (uint16_t i = 0; i < 1000; ++i) {
+		errlog_result result = errlog_report(CODE_A, i);
+		TEST_CHECK(result == (i < ERRLOG_RATE_LIMIT ? ERRLOG_QUEUED : ERRLOG_SUPPRESSED));
+	}
+	TEST_CHECK(errlog_report(CODE_B, 0) == ERRLOG_QUEUED);
+	TEST_CHECK(errlog_stats_of(CODE_A, &stats) && stats.count == 1000 && stats.suppressed == 1000 - ERRLOG_RATE_LIMIT);
+	TEST_CHECK(errlog_suppressed() == 1000 - ERRLOG_RATE_LIMIT && errlog_dropped() == 0);
+
+	uint8_t queued = 0;
+	while (errlog_pop(&entry)) ++queued;
+	TEST_CHECK(queued == ERRLOG_RATE_LIMIT + 1);
+
+	//The next window lets the code through again
+	fakeTime += ERRLOG_RATE_WINDOW_MS - 1;
+	TEST_CHECK(errlog_report(CODE_A, 0) == ERRLOG_SUPPRESSED);
+	fakeTime += 1;
+	TEST_CHECK(errlog_report(CODE_A, 0) == ERRLOG_QUEUED);
+	return res;
+}
+
+testresult errlog_ring_full(void) {
+	testresult res = {TSUCCESS, {0}};
+	errlog_entry entry;
+	errlog_init(fakeClock);
+
+	//More distinct codes than the ring and the counter table hold
+	for (uint16_t i = 0; i < ERRLOG_RING_SIZE; ++i) {
+		TEST_CHECK(errlog_report(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, i, ERRLOG_LOW), i) == ERRLOG_QUEUED);
+	}
+	TEST_CHECK(errlog_report(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 200, ERRLOG_LOW), 0) == ERRLOG_DROPPED);
+	TEST_CHECK(errlog_dropped() == 1);
+	TEST_CHECK(errlog_count(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 200, ERRLOG_LOW)) == 0);
+
+	//Popping one frees one cell, the order is kept
+	TEST_CHECK(errlog_pop(&entry) && entry.detail == 0);
+	TEST_CHECK(errlog_report(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, 1, ERRLOG_LOW), 99) == ERRLOG_QUEUED);
+	for (uint16_t i = 1; i < ERRLOG_RING_SIZE; ++i) {
+		TEST_CHECK(errlog_pop(&entry) && entry.detail == i);
+	}
+	TEST_CHECK(errlog_pop(&entry) && entry.detail == 99 && !errlog_pop(&entry));
+	return res;
+}
+
+testresult errlog_wire_formats(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t data[ERRLOG_CAN_PAYLOAD_SIZE];
+	char line[ERRLOG_LINE_SIZE];
+	errlog_entry entry = {.time = 0x12345678, .code = CODE_B, .detail = 0xBEEF};
+
+	errlog_pack_can(&entry, data);
+	const uint8_t expected[] = {0x78, 0x56, 0x34, 0x12, CODE_B & 0xFF, CODE_B >> 8, 0xEF, 0xBE};
+	TEST_CHECK(memcmp(data, expected, sizeof(expected)) == 0);
+
+	uint8_t length = errlog_format(&entry, line);
+	TEST_CHECK(strcmp(line, "E 305419896 3.7 H 48879\r\n") == 0 && length == strlen(line));
+
+	//Summary counters saturate
+	errlog_init(fakeClock);
+	for (uint32_t i = 0; i < 70000; ++i) errlog_report(CODE_B, 0);
+	errlog_pack_summary(data);
+	TEST_CHECK(data[0] == 0xFF && data[1] == 0xFF); //suppressed
+	TEST_CHECK(data[2] == 0 && data[3] == 0); //dropped
+	TEST_CHECK(data[4] == 0xFF && data[6] == 0xFF);
+	return res;
+}
+
+static void* producer(void* argument) {
+	uint16_t id = (uint16_t)(uintptr_t)argument;
+	for (uint32_t i = 0; i < REPORTS_PER_PRODUCER; ++i) {
+		errlog_report(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, id, ERRLOG_LOW), i);
+	}
+	return NULL;
+}
+
+testresult errlog_concurrent_producers(void) {
+	testresult res = {TSUCCESS, {0}};
+	pthread_t threads[PRODUCERS];
+	uint32_t popped[PRODUCERS] = {0};
+	uint16_t next[PRODUCERS] = {0};
+	errlog_entry entry;
+
+	errlog_init(fastClock);
+	for (uintptr_t i = 0; i < PRODUCERS; ++i) {
+		pthread_create(&threads[i], NULL, producer, (void*)(i + 1));
+	}
+
+	//Consume while the producers run: the entries of one producer come out in order
+	uint32_t total = 0;
+	uint8_t running = 1;
+	while (running) {
+		running = errlog_dropped() + total < (uint32_t)PRODUCERS * REPORTS_PER_PRODUCER;
+		while (errlog_pop(&entry)) {
+			uint8_t id = ERRLOG_NUMBER(entry.code) - 1;
+			TEST_CHECK(id < PRODUCERS);
+			TEST_CHECK(entry.detail >= next[id]);
+			next[id] = entry.detail + 1;
+			++popped[id];
+			++total;
+		}
+	}
+	for (uint8_t i = 0; i < PRODUCERS; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	while (errlog_pop(&entry)) ++total;
+
+	//Every report is counted and either popped or dropped
+	TEST_CHECK(total + errlog_dropped() == (uint32_t)PRODUCERS * REPORTS_PER_PRODUCER);
+	TEST_CHECK(errlog_suppressed() == 0 && total > 0);
+	for (uint8_t i = 0; i < PRODUCERS; ++i) {
+		TEST_CHECK(errlog_count(ERRLOG_CODE(ERRLOG_MODULE_SYSTEM, i + 1, ERRLOG_LOW)) == REPORTS_PER_PRODUCER);
+	}
+	TEST_CHECK(errlog_severity_count(ERRLOG_LOW) == (uint32_t)PRODUCERS * REPORTS_PER_PRODUCER);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,535 @@
+/*
+ * hal_host_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include <string.h>
+
+//-- Test definitions --
+testresult shim_clock_and_events(void);
+testresult shim_delay_and_dwt(void);
+testresult shim_uart_transmit(void);
+testresult shim_uart_toidle_dma(void);
+testresult shim_uart_normal_and_errors(void);
+testresult shim_i2c_memory(void);
+testresult shim_i2c_failures(void);
+testresult shim_tim_updates(void);
+testresult shim_gpio_and_dac(void);
+testresult shim_fdcan(void);
+testresult shim_flash(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Clock, events and interrupt mask", .func=shim_clock_and_events, .group=HAL_HOST},
+		{.testname="HAL_Delay and DWT", .func=shim_delay_and_dwt, .group=HAL_HOST},
+		{.testname="UART transmit", .func=shim_uart_transmit, .group=HAL_HOST},
+		{.testname="UART circular DMA to idle", .func=shim_uart_toidle_dma, .group=HAL_HOST},
+		{.testname="UART normal DMA and errors", .func=shim_uart_normal_and_errors, .group=HAL_HOST},
+		{.testname="I2C memory transfers", .func=shim_i2c_memory, .group=HAL_HOST},
+		{.testname="I2C NACK and held bus", .func=shim_i2c_failures, .group=HAL_HOST},
+		{.testname="TIM update rate", .func=shim_tim_updates, .group=HAL_HOST},
+		{.testname="GPIO and DAC", .func=shim_gpio_and_dac, .group=HAL_HOST},
+		{.testname="FDCAN transmission and reception", .func=shim_fdcan, .group=HAL_HOST},
+		{.testname="Flash erase and program", .func=shim_flash, .group=HAL_HOST}
+};
+
+// -- Helpers --
+//Events run by the clock, in the order they ran
+static uint8_t order[8];
+static uint8_t ran;
+static uint64_t ranAt[8];
+
+static void recordEvent(void* context) {
+	ranAt[ran] = hal_host_now();
+	order[ran++] = (uint8_t)(uintptr_t)context;
+}
+
+//Callbacks of the HAL, counted
+static uint32_t rxEvents;
+static uint16_t rxEventSize[8];
+static HAL_UART_RxEventTypeTypeDef rxEventType[8];
+static uint32_t uartErrors;
+static uint32_t txComplete;
+static uint32_t memRx;
+static uint32_t memTx;
+static uint32_t i2cErrors;
+static uint32_t periods;
+static uint32_t canRx;
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {
+	if (rxEvents < 8) {
+		rxEventSize[rxEvents] = Size;
+		rxEventType[rxEvents] = huart->RxEventType;
+	}
+	rxEvents++;
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {
+	(void)huart;
+	uartErrors++;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {
+	(void)huart;
+	txComplete++;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	(void)hi2c;
+	memRx++;
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	(void)hi2c;
+	memTx++;
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) {
+	(void)hi2c;
+	i2cErrors++;
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+	(void)htim;
+	periods++;
+}
+
+void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef* hfdcan, uint32_t RxFifo0ITs) {
+	(void)hfdcan;
+	(void)RxFifo0ITs;
+	canRx++;
+}
+
+static void reset(void) {
+	hal_host_reset();
+	memset(order, 0, sizeof(order));
+	ran = 0;
+	rxEvents = uartErrors = txComplete = memRx = memTx = i2cErrors = periods = canRx = 0;
+}
+
+static UART_HandleTypeDef uart(uint32_t baud) {
+	UART_HandleTypeDef huart = {.Instance = USART1, .Init = {.BaudRate = baud}};
+	HAL_UART_Init(&huart);
+	return huart;
+}
+
+static I2C_HandleTypeDef i2c(void) {
+	//100 kHz from 160 MHz: PRESC 3, SCLL 199, SCLH 199 -> 4 * (200 + 200) / 160 MHz = 10 us
+	I2C_HandleTypeDef hi2c = {.Instance = I2C1, .Init = {.Timing = 0x3000C7C7}};
+	HAL_I2C_Init(&hi2c);
+	return hi2c;
+}
+
+// -- Unit tests --
+testresult shim_clock_and_events(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	TEST_CHECK(hal_host_now() == 0 && HAL_GetTick() == 0);
+
+	//Time order, then queue order among events due together
+	TEST_CHECK(hal_host_schedule(HAL_HOST_US(30), recordEvent, (void*)3));
+	TEST_CHECK(hal_host_schedule(HAL_HOST_US(10), recordEvent, (void*)1));
+	TEST_CHECK(hal_host_schedule(HAL_HOST_US(30), recordEvent, (void*)4));
+	TEST_CHECK(hal_host_schedule(HAL_HOST_US(20), recordEvent, (void*)2));
+	hal_host_advance(HAL_HOST_US(25));
+	TEST_CHECK(ran == 2 && order[0] == 1 && order[1] == 2);
+	TEST_CHECK(ranAt[0] == HAL_HOST_US(10) && ranAt[1] == HAL_HOST_US(20));
+	TEST_CHECK(hal_host_now() == HAL_HOST_US(25));
+	TEST_CHECK(hal_host_runNext() == 1);
+	TEST_CHECK(ran == 4 && order[2] == 3 && order[3] == 4 && hal_host_now() == HAL_HOST_US(30));
+	TEST_CHECK(hal_host_runNext() == 0);
+
+	//Masked interrupts wait for the mask to be lifted
+	hal_host_schedule(HAL_HOST_US(5), recordEvent, (void*)5);
+	__disable_irq();
+	hal_host_advance(HAL_HOST_US(10));
+	TEST_CHECK(ran == 4 && __get_PRIMASK() == 1);
+	__enable_irq();
+	TEST_CHECK(ran == 5 && order[4] == 5);
+
+	//Cancelled events never run, a full queue refuses more
+	hal_host_schedule(HAL_HOST_US(5), recordEvent, (void*)6);
+	hal_host_cancel(recordEvent, (void*)6);
+	hal_host_advance(HAL_HOST_US(10));
+	TEST_CHECK(ran == 5);
+	for (uint8_t i = 0; i < HAL_HOST_EVENTS; ++i) TEST_CHECK(hal_host_schedule(HAL_HOST_MS(1), recordEvent, (void*)7));
+	TEST_CHECK(!hal_host_schedule(HAL_HOST_MS(1), recordEvent, (void*)7));
+	reset();
+	TEST_CHECK(hal_host_runNext() == 0);
+	return res;
+}
+
+testresult shim_delay_and_dwt(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+
+	//Like the HAL, HAL_Delay() waits at least the delay and up to one tick more
+	hal_host_advance(HAL_HOST_US(300));
+	HAL_Delay(10);
+	TEST_CHECK(HAL_GetTick() == 11 && hal_host_now() == HAL_HOST_MS(11));
+	HAL_Delay(0);
+	TEST_CHECK(HAL_GetTick() == 12);
+
+	//The cycle counter follows the core clock once enabled, each access takes a little time
+	TEST_CHECK(DWT->CYCCNT == 0);
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	uint32_t start = DWT->CYCCNT;
+	uint64_t startNs = hal_host_now();
+	while (DWT->CYCCNT - start < SystemCoreClock / 1000000u * 100u) {
+	}
+	uint64_t waited = hal_host_now() - startNs;
+	TEST_CHECK(waited >= HAL_HOST_US(100) && waited <= HAL_HOST_US(100) + HAL_HOST_DWT_ACCESS_NS);
+	return res;
+}
+
+static uint8_t echoed[32];
+static uint16_t echoedLength;
+
+static void echoModel(void* context, UART_HandleTypeDef* huart, const uint8_t* data, uint16_t length) {
+	(void)context;
+	(void)huart;
+	memcpy(echoed, data, length);
+	echoedLength = length;
+}
+
+testresult shim_uart_transmit(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	UART_HandleTypeDef huart = uart(115200);
+	HAL_HOST_UART_MODEL model = {.transmit = echoModel};
+	hal_host_uartAttach(USART1, &model);
+	TEST_CHECK(hal_host_uartByteTime(&huart, 1) == 1000000000ull * 10 / 115200 + 1);
+
+	//Blocking: the clock moves by the transfer time
+	uint8_t frame[] = "$PING*00\r\n";
+	TEST_CHECK(HAL_UART_Transmit(&huart, frame, 10, 100) == HAL_OK);
+	TEST_CHECK(hal_host_now() == hal_host_uartByteTime(&huart, 10));
+	TEST_CHECK(echoedLength == 10 && memcmp(echoed, frame, 10) == 0);
+
+	//Interrupt: busy until the last byte is out
+	uint64_t start = hal_host_now();
+	TEST_CHECK(HAL_UART_Transmit_IT(&huart, frame, 4) == HAL_OK);
+	TEST_CHECK(HAL_UART_Transmit_IT(&huart, frame, 4) == HAL_BUSY);
+	TEST_CHECK(txComplete == 0 && huart.gState == HAL_UART_STATE_BUSY_TX);
+	TEST_CHECK(hal_host_runNext());
+	TEST_CHECK(txComplete == 1 && huart.gState == HAL_UART_STATE_READY);
+	TEST_CHECK(hal_host_now() - start == hal_host_uartByteTime(&huart, 4));
+	TEST_CHECK(HAL_UART_Transmit_DMA(&huart, frame, 4) == HAL_ERROR);
+
+	uint8_t sent[32];
+	TEST_CHECK(hal_host_uartSent(USART1, sent, sizeof(sent)) == 14);
+	TEST_CHECK(memcmp(sent, frame, 10) == 0 && memcmp(&sent[10], frame, 4) == 0);
+	TEST_CHECK(hal_host_uartSent(USART1, sent, sizeof(sent)) == 0);
+	return res;
+}
+
+testresult shim_uart_toidle_dma(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	DMA_HandleTypeDef dma = {.Instance = GPDMA1_Channel0, .Mode = DMA_LINKEDLIST_CIRCULAR};
+	UART_HandleTypeDef huart = uart(115200);
+	huart.hdmarx = &dma;
+	uint8_t buffer[16];
+	uint8_t bytes[40];
+	for (uint8_t i = 0; i < sizeof(bytes); ++i) bytes[i] = i;
+
+	TEST_CHECK(HAL_UARTEx_ReceiveToIdle_DMA(&huart, buffer, sizeof(buffer)) == HAL_OK);
+	TEST_CHECK(__HAL_DMA_GET_COUNTER(&dma) == 16);
+
+	//A short burst: idle event with the position reached
+	TEST_CHECK(hal_host_uartReceive(&huart, bytes, 5, 1) == 5);
+	TEST_CHECK(rxEvents == 1 && rxEventSize[0] == 5 && rxEventType[0] == HAL_UART_RXEVENT_IDLE);
+	TEST_CHECK(__HAL_DMA_GET_COUNTER(&dma) == 11 && huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	//Across the half and the end of the buffer: HT and TC events, then the position after wrapping
+	TEST_CHECK(hal_host_uartReceive(&huart, &bytes[5], 15, 1) == 15);
+	TEST_CHECK(rxEvents == 4);
+	TEST_CHECK(rxEventSize[1] == 8 && rxEventType[1] == HAL_UART_RXEVENT_HT);
+	TEST_CHECK(rxEventSize[2] == 16 && rxEventType[2] == HAL_UART_RXEVENT_TC);
+	TEST_CHECK(rxEventSize[3] == 4 && rxEventType[3] == HAL_UART_RXEVENT_IDLE);
+	TEST_CHECK(memcmp(buffer, &bytes[16], 4) == 0 && memcmp(&buffer[4], &bytes[4], 12) == 0);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_BUSY_RX);
+
+	//An idle line exactly at the end of the buffer raises no idle event (the DMA counter is back to the size)
+	TEST_CHECK(hal_host_uartReceive(&huart, &bytes[20], 12, 1) == 12);
+	TEST_CHECK(rxEvents == 6 && rxEventType[4] == HAL_UART_RXEVENT_HT && rxEventType[5] == HAL_UART_RXEVENT_TC);
+	TEST_CHECK(hal_host_uartLost(USART1) == 0);
+	return res;
+}
+
+testresult shim_uart_normal_and_errors(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	DMA_HandleTypeDef dma = {.Instance = GPDMA1_Channel1, .Mode = DMA_NORMAL};
+	UART_HandleTypeDef huart = uart(9600);
+	huart.hdmarx = &dma;
+	uint8_t buffer[16];
+	uint8_t bytes[16] = {0};
+
+	//Normal mode: an idle line ends the reception
+	TEST_CHECK(HAL_UARTEx_ReceiveToIdle_DMA(&huart, buffer, 9) == HAL_OK);
+	TEST_CHECK(hal_host_uartReceive(&huart, bytes, 3, 1) == 3);
+	TEST_CHECK(rxEvents == 1 && rxEventSize[0] == 3 && huart.RxState == HAL_UART_STATE_READY);
+
+	//Bytes with no reception running overrun
+	TEST_CHECK(hal_host_uartReceive(&huart, bytes, 4, 0) == 0);
+	TEST_CHECK(hal_host_uartLost(USART1) == 4);
+
+	//A full buffer completes the reception
+	TEST_CHECK(HAL_UARTEx_ReceiveToIdle_DMA(&huart, buffer, 9) == HAL_OK);
+	TEST_CHECK(HAL_UARTEx_ReceiveToIdle_DMA(&huart, buffer, 9) == HAL_BUSY);
+	TEST_CHECK(hal_host_uartReceive(&huart, bytes, 12, 0) == 9);
+	TEST_CHECK(rxEvents == 3 && rxEventSize[2] == 9 && rxEventType[2] == HAL_UART_RXEVENT_TC);
+	TEST_CHECK(huart.RxState == HAL_UART_STATE_READY && hal_host_uartLost(USART1) == 7);
+
+	//A line error aborts the reception
+	TEST_CHECK(HAL_UARTEx_ReceiveToIdle_DMA(&huart, buffer, 9) == HAL_OK);
+	hal_host_uartError(&huart, HAL_UART_ERROR_NE);
+	TEST_CHECK(uartErrors == 1 && huart.ErrorCode == HAL_UART_ERROR_NE && huart.RxState == HAL_UART_STATE_READY);
+	return res;
+}
+
+static uint8_t registers[0x40];
+
+testresult shim_i2c_memory(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	I2C_HandleTypeDef hi2c = i2c();
+	HAL_HOST_I2C_REGS regs = {.registers = registers, .size = sizeof(registers), .autoIncrement = 1};
+	for (uint8_t i = 0; i < sizeof(registers); ++i) registers[i] = i;
+	hal_host_i2cAttachRegs(I2C1, 0x28, &regs);
+
+	//Blocking read: START, address, register, repeated START, address, 4 bytes, STOP at 10 us a bit
+	uint8_t data[8];
+	TEST_CHECK(HAL_I2C_Mem_Read(&hi2c, 0x28 << 1, 0x10, I2C_MEMADD_SIZE_8BIT, data, 4, 10) == HAL_OK);
+	TEST_CHECK(data[0] == 0x10 && data[3] == 0x13);
+	TEST_CHECK(hal_host_now() == (1 + 9 + 9 + 1 + 9 + 4 * 9 + 1) * HAL_HOST_US(10));
+
+	//Write then read back through DMA, the callbacks run when the transfer ends
+	DMA_HandleTypeDef dma = {.Instance = GPDMA1_Channel2};
+	hi2c.hdmatx = &dma;
+	hi2c.hdmarx = &dma;
+	uint8_t values[2] = {0xAB, 0xCD};
+	TEST_CHECK(HAL_I2C_Mem_Write_DMA(&hi2c, 0x28 << 1, 0x20, I2C_MEMADD_SIZE_8BIT, values, 2) == HAL_OK);
+	TEST_CHECK(HAL_I2C_Mem_Read_DMA(&hi2c, 0x28 << 1, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_BUSY);
+	TEST_CHECK(memTx == 0 && registers[0x20] == 0x20);
+	TEST_CHECK(hal_host_runNext());
+	TEST_CHECK(memTx == 1 && registers[0x20] == 0xAB && registers[0x21] == 0xCD);
+	TEST_CHECK(HAL_I2C_Mem_Read_DMA(&hi2c, 0x28 << 1, 0x20, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_OK);
+	TEST_CHECK(hal_host_runNext());
+	TEST_CHECK(memRx == 1 && data[0] == 0xAB && data[1] == 0xCD);
+
+	//Command code devices: 16 bit registers, the pointer stays on the selected one
+	HAL_HOST_I2C_REGS words = {.registers = registers, .size = sizeof(registers), .width = 2};
+	hal_host_i2cAttachRegs(I2C1, 0x10, &words);
+	TEST_CHECK(HAL_I2C_Mem_Read(&hi2c, 0x10 << 1, 0x04, I2C_MEMADD_SIZE_8BIT, data, 4, 10) == HAL_OK);
+	TEST_CHECK(data[0] == 0x08 && data[1] == 0x09 && data[2] == 0x08 && data[3] == 0x09);
+
+	HAL_HOST_I2C_STATS stats;
+	hal_host_i2cStats(I2C1, &stats);
+	TEST_CHECK(stats.transfers == 4 && stats.nacks == 0 && stats.timeouts == 0);
+	TEST_CHECK(stats.bytes == (3 + 4) + (2 + 2) + (3 + 2) + (3 + 4));
+	return res;
+}
+
+testresult shim_i2c_failures(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	I2C_HandleTypeDef hi2c = i2c();
+	HAL_HOST_I2C_REGS regs = {.registers = registers, .size = sizeof(registers), .autoIncrement = 1};
+	hal_host_i2cAttachRegs(I2C1, 0x28, &regs);
+	uint8_t data[2];
+
+	//Nobody at the address
+	TEST_CHECK(HAL_I2C_Mem_Read(&hi2c, 0x29 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2, 10) == HAL_ERROR);
+	TEST_CHECK(HAL_I2C_GetError(&hi2c) == HAL_I2C_ERROR_AF && HAL_I2C_GetState(&hi2c) == HAL_I2C_STATE_READY);
+	TEST_CHECK(HAL_I2C_IsDeviceReady(&hi2c, 0x28 << 1, 1, 10) == HAL_OK);
+
+	//NACK in an interrupt transfer: error callback
+	regs.response = HAL_HOST_I2C_NACK;
+	TEST_CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_OK);
+	TEST_CHECK(hal_host_runNext());
+	TEST_CHECK(i2cErrors == 1 && memRx == 0 && hi2c.ErrorCode == HAL_I2C_ERROR_AF);
+
+	//A held bus times out the blocking transfers and refuses the others until it is released
+	regs.response = HAL_HOST_I2C_HOLD;
+	uint64_t start = hal_host_now();
+	TEST_CHECK(HAL_I2C_Mem_Read(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2, 10) == HAL_ERROR);
+	TEST_CHECK(hi2c.ErrorCode == HAL_I2C_ERROR_TIMEOUT && hal_host_now() - start == HAL_HOST_MS(25));
+	TEST_CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_BUSY);
+	regs.response = HAL_HOST_I2C_ACK;
+	TEST_CHECK(HAL_I2C_Mem_Read(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2, 10) == HAL_OK);
+	TEST_CHECK(HAL_I2C_Mem_Read_IT(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_OK);
+	TEST_CHECK(HAL_I2C_Mem_Read_DMA(&hi2c, 0x28 << 1, 0, I2C_MEMADD_SIZE_8BIT, data, 2) == HAL_BUSY);
+
+	HAL_HOST_I2C_STATS stats;
+	hal_host_i2cStats(I2C1, &stats);
+	TEST_CHECK(stats.nacks == 2 && stats.timeouts == 1);
+	return res;
+}
+
+testresult shim_tim_updates(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	//1 MHz counter, 1 ms period
+	TIM_HandleTypeDef htim = {.Instance = TIM2, .Init = {.Prescaler = 159, .Period = 999}};
+	HAL_TIM_Base_Init(&htim);
+	TEST_CHECK(HAL_TIM_Base_Start_IT(&htim) == HAL_OK);
+	hal_host_advance(HAL_HOST_US(10500));
+	TEST_CHECK(periods == 10 && hal_host_timUpdates(TIM2) == 10);
+	TEST_CHECK(__HAL_TIM_GET_COUNTER(&htim) == 500);
+
+	//A new period takes effect right away, keeping the count
+	__HAL_TIM_SET_AUTORELOAD(&htim, 1999);
+	hal_host_advance(HAL_HOST_US(1500));
+	TEST_CHECK(periods == 11 && __HAL_TIM_GET_COUNTER(&htim) == 0);
+
+	//APB1 divided by 2: the timer clock stays at 160 MHz
+	RCC->CFGR2 = (RCC->CFGR2 & ~RCC_CFGR2_PPRE1) | RCC_HCLK_DIV2;
+	__HAL_TIM_SET_COUNTER(&htim, 0);
+	hal_host_advance(HAL_HOST_MS(4));
+	TEST_CHECK(periods == 13);
+
+	//Stopped, the counter holds
+	HAL_TIM_Base_Stop_IT(&htim);
+	uint32_t held = __HAL_TIM_GET_COUNTER(&htim);
+	hal_host_advance(HAL_HOST_MS(10));
+	TEST_CHECK(periods == 13 && __HAL_TIM_GET_COUNTER(&htim) == held);
+	return res;
+}
+
+//Open drain line that a slave holds low
+static uint8_t heldLow;
+
+static GPIO_PinState holdLine(void* context, GPIO_TypeDef* port, uint16_t pin, GPIO_PinState level) {
+	(void)context;
+	(void)port;
+	return (heldLow && pin == GPIO_PIN_9) ? GPIO_PIN_RESET : level;
+}
+
+testresult shim_gpio_and_dac(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	GPIO_InitTypeDef out = {.Pin = GPIO_PIN_8 | GPIO_PIN_9, .Mode = GPIO_MODE_OUTPUT_OD};
+	HAL_GPIO_Init(GPIOB, &out);
+	HAL_GPIO_WritePin(GPIOB, GPIO_PIN_8 | GPIO_PIN_9, GPIO_PIN_SET);
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_9) == GPIO_PIN_SET);
+	HAL_HOST_GPIO_MODEL model = {.read = holdLine};
+	hal_host_gpioAttach(GPIOB, &model);
+	heldLow = 1;
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_9) == GPIO_PIN_RESET);
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_8) == GPIO_PIN_SET);
+	HAL_GPIO_TogglePin(GPIOB, GPIO_PIN_8);
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_8) == GPIO_PIN_RESET);
+	TEST_CHECK(hal_host_gpioWrites(GPIOB, GPIO_PIN_8) == 2 && hal_host_gpioWrites(GPIOB, GPIO_PIN_9) == 1);
+
+	//Inputs read the level given by the test
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_RESET);
+	hal_host_gpioInput(GPIOA, GPIO_PIN_0, GPIO_PIN_SET);
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_SET);
+
+	DAC_HandleTypeDef hdac = {.Instance = DAC1};
+	HAL_DAC_Init(&hdac);
+	HAL_DAC_Start(&hdac, DAC_CHANNEL_1);
+	HAL_DAC_SetValue(&hdac, DAC_CHANNEL_1, DAC_ALIGN_12B_R, 0x1234);
+	TEST_CHECK(HAL_DAC_GetValue(&hdac, DAC_CHANNEL_1) == 0x234);
+	HAL_DAC_SetValue(&hdac, DAC_CHANNEL_2, DAC_ALIGN_8B_R, 0x80);
+	TEST_CHECK(HAL_DAC_GetValue(&hdac, DAC_CHANNEL_2) == 0x800);
+	return res;
+}
+
+testresult shim_fdcan(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	//2 Mbit/s like the board: 160 MHz / 16 / (1 + 2 + 2)
+	FDCAN_HandleTypeDef hfdcan = {.Instance = FDCAN1, .Init = {.NominalPrescaler = 16, .NominalTimeSeg1 = 2, .NominalTimeSeg2 = 2}};
+	TEST_CHECK(HAL_FDCAN_Init(&hfdcan) == HAL_OK);
+	TEST_CHECK(hal_host_canFrameTime(&hfdcan, 8) == (47 + 64) * 500);
+	FDCAN_TxHeaderTypeDef header = {.Identifier = 0x123, .IdType = FDCAN_STANDARD_ID, .DataLength = FDCAN_DLC_BYTES_8};
+	uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	TEST_CHECK(HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan, &header, data) == HAL_ERROR);
+	TEST_CHECK(HAL_FDCAN_Start(&hfdcan) == HAL_OK);
+
+	//Three frames fill the FIFO and leave one after the other
+	for (uint8_t i = 0; i < 3; ++i) {
+		header.Identifier = 0x100 + i;
+		TEST_CHECK(HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan, &header, data) == HAL_OK);
+	}
+	TEST_CHECK(HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan) == 0 && FDCAN1->TXBRP == 0x7);
+	TEST_CHECK(HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan, &header, data) == HAL_ERROR);
+	hal_host_advance(HAL_HOST_MS(1));
+	TEST_CHECK(FDCAN1->TXBRP == 0 && HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan) == 3);
+	HAL_HOST_CAN_FRAME frame;
+	for (uint8_t i = 0; i < 3; ++i) {
+		TEST_CHECK(hal_host_canTake(&frame));
+		TEST_CHECK(frame.id == 0x100u + i && frame.length == 8 && memcmp(frame.data, data, 8) == 0);
+		TEST_CHECK(frame.time == (i + 1u) * hal_host_canFrameTime(&hfdcan, 8));
+	}
+	TEST_CHECK(!hal_host_canTake(&frame));
+
+	//With nobody acknowledging the frames stay pending
+	hal_host_canAcknowledge(0);
+	TEST_CHECK(HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan, &header, data) == HAL_OK);
+	hal_host_advance(HAL_HOST_MS(10));
+	TEST_CHECK(FDCAN1->TXBRP != 0 && !hal_host_canTake(&frame));
+	hal_host_canAcknowledge(1);
+	hal_host_advance(HAL_HOST_MS(1));
+	TEST_CHECK(FDCAN1->TXBRP == 0 && hal_host_canTake(&frame));
+
+	//Reception through a mask filter, the others rejected
+	FDCAN_FilterTypeDef filter = {.IdType = FDCAN_STANDARD_ID, .FilterIndex = 0, .FilterType = FDCAN_FILTER_MASK,
+			.FilterConfig = FDCAN_FILTER_TO_RXFIFO0, .FilterID1 = 0x200, .FilterID2 = 0x7F0};
+	hfdcan.Init.StdFiltersNbr = 1;
+	TEST_CHECK(HAL_FDCAN_ConfigFilter(&hfdcan, &filter) == HAL_OK);
+	HAL_FDCAN_ConfigGlobalFilter(&hfdcan, FDCAN_REJECT, FDCAN_REJECT, FDCAN_FILTER_REMOTE, FDCAN_FILTER_REMOTE);
+	HAL_FDCAN_ActivateNotification(&hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0);
+	TEST_CHECK(!hal_host_canReceive(&hfdcan, 0x300, data, 2));
+	for (uint8_t i = 0; i < 3; ++i) TEST_CHECK(hal_host_canReceive(&hfdcan, 0x20A, &data[i], 2));
+	TEST_CHECK(!hal_host_canReceive(&hfdcan, 0x20B, data, 2));
+	TEST_CHECK(canRx == 3 && HAL_FDCAN_GetRxFifoFillLevel(&hfdcan, FDCAN_RX_FIFO0) == 3);
+	FDCAN_RxHeaderTypeDef rxHeader;
+	uint8_t rxData[8];
+	TEST_CHECK(HAL_FDCAN_GetRxMessage(&hfdcan, FDCAN_RX_FIFO0, &rxHeader, rxData) == HAL_OK);
+	TEST_CHECK(rxHeader.Identifier == 0x20A && rxHeader.DataLength == FDCAN_DLC_BYTES_2 && rxData[0] == 1 && rxData[1] == 2);
+	TEST_CHECK(HAL_FDCAN_GetRxFifoFillLevel(&hfdcan, FDCAN_RX_FIFO0) == 2);
+	return res;
+}
+
+testresult shim_flash(void) {
+	testresult res = {TSUCCESS, {0}};
+	reset();
+	static uint32_t quad[4] = {0x11111111, 0x22222222, 0x33333333, 0x44444444};
+	uint32_t address = (uint32_t)(FLASH_BASE + FLASH_BANK_SIZE);
+	uint32_t pageError;
+	FLASH_EraseInitTypeDef erase = {.TypeErase = FLASH_TYPEERASE_PAGES, .Banks = FLASH_BANK_2, .Page = 0, .NbPages = 1};
+
+	//Locked
+	TEST_CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, address, (uint32_t)(uintptr_t)quad) == HAL_ERROR);
+	TEST_CHECK(HAL_FLASHEx_Erase(&erase, &pageError) == HAL_ERROR);
+
+	HAL_FLASH_Unlock();
+	TEST_CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, address, (uint32_t)(uintptr_t)quad) == HAL_OK);
+	TEST_CHECK(memcmp((const void*)(uintptr_t)address, quad, 16) == 0);
+	//Written quad-words and misaligned addresses can not be programmed
+	TEST_CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, address, (uint32_t)(uintptr_t)quad) == HAL_ERROR);
+	TEST_CHECK(HAL_FLASH_GetError() == HAL_FLASH_ERROR_PROG);
+	TEST_CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, address + 8, (uint32_t)(uintptr_t)quad) == HAL_ERROR);
+
+	uint64_t start = hal_host_now();
+	TEST_CHECK(HAL_FLASHEx_Erase(&erase, &pageError) == HAL_OK);
+	TEST_CHECK(hal_host_now() - start == HAL_HOST_FLASH_ERASE_NS);
+	TEST_CHECK(*(const uint32_t*)(uintptr_t)address == 0xFFFFFFFF);
+	TEST_CHECK(HAL_FLASH_Program(FLASH_TYPEPROGRAM_QUADWORD, address, (uint32_t)(uintptr_t)quad) == HAL_OK);
+	HAL_FLASH_Lock();
+	TEST_CHECK(hal_host_flashErases() == 1 && hal_host_flashPrograms() == 2);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
@@ -0,0 +1,278 @@
+/*
+ * i2c_recovery_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "i2c_recovery.h"
+#include <stdio.h>
+#include <string.h>
+
+//-- Test definitions --
+#define BIT_US 10 //100 kHz
+#define TIMEOUT_US 10000 //HAL timeout waiting for the bus
+#define ADDRESS 0x10
+
+testresult i2c_recovery_clean_transfer(void);
+testresult i2c_recovery_transient_nack(void);
+testresult i2c_recovery_locked_peripheral(void);
+testresult i2c_recovery_stuck_slave(void);
+testresult i2c_recovery_missing_device(void);
+testresult i2c_recovery_stuck_clock(void);
+testresult i2c_recovery_times(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Clean transfer", .func=i2c_recovery_clean_transfer, .group=I2C},
+		{.testname="Transient NACK recovered by retries", .func=i2c_recovery_transient_nack, .group=I2C},
+		{.testname="Locked peripheral recovered by re-init", .func=i2c_recovery_locked_peripheral, .group=I2C},
+		{.testname="Stuck slave released by SCL pulses", .func=i2c_recovery_stuck_slave, .group=I2C},
+		{.testname="Missing device does not reset", .func=i2c_recovery_missing_device, .group=I2C},
+		{.testname="Stuck clock escalates to reset", .func=i2c_recovery_stuck_clock, .group=I2C},
+		{.testname="Recovery time per scenario", .func=i2c_recovery_times, .group=I2C}
+};
+
+// -- Simulated bus --
+typedef struct {
+	uint32_t now; //us
+	uint8_t gpio; //pins taken from the peripheral
+	uint8_t scl, sda; //levels driven by the master as GPIO
+	uint8_t slaveBits; //SCL falling edges until the slave releases SDA, 0 when it is idle
+	uint8_t sclHeld; //a slave holds SCL low for good
+	uint8_t locked; //peripheral stuck until it is initialised again
+	uint32_t nacks; //transfers still NACKed
+	uint8_t absent;
+	uint32_t transfers, reinits, pulses, stops, resets;
+} SIM;
+
+static uint8_t lineSda(SIM* sim) {
+	return (!sim->gpio || sim->sda) && sim->slaveBits == 0;
+}
+
+static uint8_t lineScl(SIM* sim) {
+	return (!sim->gpio || sim->scl) && !sim->sclHeld;
+}
+
+static I2C_RECOVERY_STATUS simTransfer(void* context, const I2C_RECOVERY_TRANSFER* transfer) {
+	SIM* sim = context;
+	sim->transfers++;
+	if (sim->gpio || sim->locked) {
+		sim->now += 20;
+		return I2C_RECOVERY_BUS_ERROR;
+	}
+	if (!lineSda(sim) || !lineScl(sim)) {
+		sim->now += TIMEOUT_US;
+		return I2C_RECOVERY_TIMEOUT;
+	}
+	if (sim->absent || sim->nacks > 0) {
+		if (sim->nacks > 0) sim->nacks--;
+		sim->now += 10 * BIT_US;
+		return I2C_RECOVERY_NACK;
+	}
+	if (transfer->read) memset(transfer->data, 0xA5, transfer->length);
+	sim->now += (3 + transfer->length) * 9 * BIT_US;
+	return I2C_RECOVERY_OK;
+}
+
+static void simReinit(void* context) {
+	SIM* sim = context;
+	sim->gpio = 0;
+	sim->locked = 0;
+	sim->reinits++;
+	sim->now += 20;
+}
+
+static void simReleasePins(void* context) {
+	SIM* sim = context;
+	sim->gpio = 1;
+	sim->scl = 1;
+	sim->sda = 1;
+}
+
+static void simSetScl(void* context, uint8_t level) {
+	SIM* sim = context;
+	if (sim->scl && !level && sim->slaveBits > 0) {
+		sim->slaveBits--;
+		sim->pulses++;
+	}
+	sim->scl = level;
+}
+
+static void simSetSda(void* context, uint8_t level) {
+	SIM* sim = context;
+	if (!sim->sda && level && lineScl(sim) && sim->slaveBits == 0) sim->stops++;
+	sim->sda = level;
+}
+
+static uint8_t simReadScl(void* context) {
+	return lineScl(context);
+}
+
+static uint8_t simReadSda(void* context) {
+	return lineSda(context);
+}
+
+static void simDelayUs(void* context, uint32_t us) {
+	((SIM*)context)->now += us;
+}
+
+static uint32_t simNowUs(void* context) {
+	return ((SIM*)context)->now;
+}
+
+static void simReset(void* context) {
+	((SIM*)context)->resets++;
+}
+
+static const I2C_RECOVERY_OPS simOps = {
+	.transfer = simTransfer,
+	.reinit = simReinit,
+	.releasePins = simReleasePins,
+	.setScl = simSetScl,
+	.setSda = simSetSda,
+	.readScl = simReadScl,
+	.readSda = simReadSda,
+	.delayUs = simDelayUs,
+	.nowUs = simNowUs,
+	.reset = simReset
+};
+
+// -- Helpers --
+static I2C_RECOVERY_STATUS readOnce(I2C_RECOVERY* recovery, SIM* sim, const I2C_RECOVERY_CONFIG* config) {
+	uint8_t data[2] = {0};
+	errlog_init(NULL);
+	i2c_recovery_init(recovery, &simOps, sim, config);
+	return i2c_recovery_read(recovery, ADDRESS, 0x08, data, sizeof(data));
+}
+
+// -- Unit tests --
+testresult i2c_recovery_clean_transfer(void) {
+	testresult res = {TSUCCESS, {0}};
+	SIM sim = {0};
+	I2C_RECOVERY recovery;
+	uint8_t data[2] = {0};
+
+	errlog_init(NULL);
+	i2c_recovery_init(&recovery, &simOps, &sim, NULL);
+	TEST_CHECK(i2c_recovery_read(&recovery, ADDRESS, 0x08, data, sizeof(data)) == I2C_RECOVERY_OK && data[1] == 0xA5);
+	TEST_CHECK(i2c_recovery_write(&recovery, ADDRESS, 0x00, data, sizeof(data)) == I2C_RECOVERY_OK);
+	TEST_CHECK(recovery.stats.transfers == 2 && recovery.stats.failures == 0 && sim.transfers == 2);
+	TEST_CHECK(errlog_latest() == ERRLOG_NONE);
+	return res;
+}
+
+testresult i2c_recovery_transient_nack(void) {
+	testresult res = {TSUCCESS, {0}};
+	SIM sim = {.nacks = 2};
+	I2C_RECOVERY recovery;
+
+	TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_OK);
+	TEST_CHECK(recovery.stats.failures == 1 && recovery.stats.retries == 2 && recovery.stats.recovered == 1);
+	TEST_CHECK(recovery.stats.reinits == 0 && recovery.stats.busClears == 0 && sim.reinits == 0);
+	TEST_CHECK(errlog_count(I2C_RECOVERY_ERROR_RETRY) == 2 && errlog_count(I2C_RECOVERY_ERROR_REINIT) == 0);
+
+	//Backoff of 500 and 1000 us plus the transfers
+	TEST_CHECK(recovery.stats.lastRecoveryUs >= 1500 && recovery.stats.lastRecoveryUs < 2500);
+	return res;
+}
+
+testresult i2c_recovery_locked_peripheral(void) {
+	testresult res = {TSUCCESS, {0}};
+	SIM sim = {.locked = 1};
+	I2C_RECOVERY recovery;
+
+	TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_OK);
+	TEST_CHECK(recovery.stats.retries == 3 && recovery.stats.reinits == 1 && sim.reinits == 1);
+	TEST_CHECK(recovery.stats.busClears == 0 && recovery.stats.stops == 0 && recovery.stats.resets == 0);
+	TEST_CHECK(errlog_count(I2C_RECOVERY_ERROR_REINIT) == 1);
+	return res;
+}
+
+testresult i2c_recovery_stuck_slave(void) {
+	testresult res = {TSUCCESS, {0}};
+	I2C_RECOVERY recovery;
+
+	//The slave can be anywhere in its byte when the master was reset
+	for (uint8_t bits = 1; bits <= I2C_RECOVERY_CLOCK_PULSES; ++bits) {
+		SIM sim = {.slaveBits = bits};
+		TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_OK);
+		TEST_CHECK(recovery.stats.retries == 0 && recovery.stats.busClears == 1);
+		TEST_CHECK(recovery.stats.clockPulses == bits && sim.pulses == bits);
+		TEST_CHECK(recovery.stats.stops == 1 && sim.stops == 1 && recovery.stats.resets == 0 && sim.resets == 0);
+		TEST_CHECK(!sim.gpio && recovery.stats.recovered == 1);
+		TEST_CHECK(errlog_count(I2C_RECOVERY_ERROR_BUS_CLEAR) == 1 && errlog_count(I2C_RECOVERY_ERROR_STOP) == 1);
+	}
+
+	//A bus that is already free gets no pulses, only the STOP
+	SIM sim = {0};
+	i2c_recovery_init(&recovery, &simOps, &sim, NULL);
+	TEST_CHECK(i2c_recovery_clearBus(&recovery) && sim.pulses == 0 && sim.stops == 1);
+	return res;
+}
+
+testresult i2c_recovery_missing_device(void) {
+	testresult res = {TSUCCESS, {0}};
+	SIM sim = {.absent = 1};
+	I2C_RECOVERY recovery;
+
+	//The whole ladder runs, but the bus is free so the controller keeps running
+	TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_NACK);
+	TEST_CHECK(recovery.stats.retries == 3 && recovery.stats.reinits == 2 && recovery.stats.busClears == 1);
+	TEST_CHECK(recovery.stats.stops == 1 && recovery.stats.unrecovered == 1 && recovery.stats.recovered == 0);
+	TEST_CHECK(recovery.stats.resets == 0 && sim.resets == 0 && !sim.gpio);
+	TEST_CHECK(errlog_count(I2C_RECOVERY_ERROR_UNRECOVERED) == 1 && errlog_count(I2C_RECOVERY_ERROR_RESET) == 0);
+	TEST_CHECK(errlog_latest() == I2C_RECOVERY_ERROR_UNRECOVERED);
+	return res;
+}
+
+testresult i2c_recovery_stuck_clock(void) {
+	testresult res = {TSUCCESS, {0}};
+	I2C_RECOVERY recovery;
+	SIM sim = {.sclHeld = 1};
+
+	TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_TIMEOUT);
+	TEST_CHECK(recovery.stats.retries == 0 && recovery.stats.busClears == 1 && recovery.stats.clockPulses == 0);
+	TEST_CHECK(recovery.stats.resets == 1 && sim.resets == 1);
+	TEST_CHECK(errlog_count(I2C_RECOVERY_ERROR_RESET) == 1 && errlog_latest() == I2C_RECOVERY_ERROR_RESET);
+
+	//Without the reset the failure is only reported
+	I2C_RECOVERY_CONFIG config = I2C_RECOVERY_DEFAULT_CONFIG;
+	config.resetOnFailure = 0;
+	sim = (SIM){.sclHeld = 1};
+	TEST_CHECK(readOnce(&recovery, &sim, &config) == I2C_RECOVERY_TIMEOUT);
+	TEST_CHECK(recovery.stats.resets == 0 && sim.resets == 0 && recovery.stats.unrecovered == 1);
+	return res;
+}
+
+testresult i2c_recovery_times(void) {
+	testresult res = {TSUCCESS, {0}};
+	I2C_RECOVERY recovery;
+	const struct {
+		const char* name;
+		SIM sim;
+		uint32_t maxUs;
+	} scenarios[] = {
+		{"1 NACK", {.nacks = 1}, 1500},
+		{"3 NACKs", {.nacks = 3}, 5000},
+		{"locked peripheral", {.locked = 1}, 5000},
+		{"slave holding SDA, 1 bit left", {.slaveBits = 1}, 2 * TIMEOUT_US + 1000},
+		{"slave holding SDA, 9 bits left", {.slaveBits = 9}, 2 * TIMEOUT_US + 1000}
+	};
+
+	//Simulated time: a held bus costs two HAL timeouts (first attempt and after the re-init) before it is cleared
+	for (uint8_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i) {
+		SIM sim = scenarios[i].sim;
+		TEST_CHECK(readOnce(&recovery, &sim, NULL) == I2C_RECOVERY_OK);
+		TEST_CHECK(recovery.stats.lastRecoveryUs == recovery.stats.maxRecoveryUs);
+		TEST_CHECK(recovery.stats.lastRecoveryUs <= scenarios[i].maxUs);
+		printf("%s: recovered in %lu us\r\n", scenarios[i].name, (unsigned long)recovery.stats.lastRecoveryUs);
+	}
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
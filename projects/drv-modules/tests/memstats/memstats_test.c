@@ -0,0 +1,165 @@
+/*
+ * memstats_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "memstats.h"
+
+//-- Test definitions --
+#define ZONE_WORDS 1024
+#define RANDOM_RUNS 2000
+
+testresult memstats_high_water(void);
+testresult memstats_holes(void);
+testresult memstats_edges(void);
+testresult memstats_fragmentation_share(void);
+testresult memstats_can_frames(void);
+testresult memstats_random_use(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="High-water mark", .func=memstats_high_water, .group=MEMORY},
+		{.testname="Words the stack skipped", .func=memstats_holes, .group=MEMORY},
+		{.testname="Empty and fully used zones", .func=memstats_edges, .group=MEMORY},
+		{.testname="Heap fragmentation", .func=memstats_fragmentation_share, .group=MEMORY},
+		{.testname="CAN frames", .func=memstats_can_frames, .group=MEMORY},
+		{.testname="Random stack use", .func=memstats_random_use, .group=MEMORY}
+};
+
+// -- Helpers --
+static uint32_t rng = 0x57AC4ED;
+static uint32_t rnd(void) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+//Stands for the RAM below the stack, the top of the stack is the end of the array
+static uint32_t zone[ZONE_WORDS];
+
+//Uses the stack down to a word, from the top like the core does
+static void use(uint32_t deepest) {
+	for (uint32_t i = ZONE_WORDS; i > deepest; --i) zone[i - 1] = i;
+}
+
+// -- Unit tests --
+testresult memstats_high_water(void) {
+	testresult res = {TSUCCESS, {0}};
+	memstats_paint(zone, zone + ZONE_WORDS);
+	for (uint32_t i = 0; i < ZONE_WORDS; ++i) TEST_CHECK(zone[i] == MEMSTATS_PAINT);
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == ZONE_WORDS);
+
+	use(ZONE_WORDS - 10);
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == ZONE_WORDS - 10);
+	use(300);
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == 300);
+
+	//The mark stays at the deepest use once the stack comes back up
+	zone[ZONE_WORDS - 1] = MEMSTATS_PAINT;
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == 300);
+
+	//Painting only part of the zone leaves the rest alone
+	memstats_paint(zone + 100, zone + 200);
+	TEST_CHECK(zone[99] == MEMSTATS_PAINT && zone[200] == MEMSTATS_PAINT && zone[300] == 301);
+	return res;
+}
+
+testresult memstats_holes(void) {
+	testresult res = {TSUCCESS, {0}};
+	memstats_paint(zone, zone + ZONE_WORDS);
+
+	//A local array that was never written leaves painted words between used ones
+	use(ZONE_WORDS - 50);
+	zone[ZONE_WORDS - 200] = 0;
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == ZONE_WORDS - 200);
+
+	//A zero is a use like any other value
+	zone[17] = 0;
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == 17);
+	return res;
+}
+
+testresult memstats_edges(void) {
+	testresult res = {TSUCCESS, {0}};
+	memstats_paint(zone, zone);
+	TEST_CHECK(memstats_untouched(zone, zone) == 0);
+
+	memstats_paint(zone, zone + ZONE_WORDS);
+	use(0);
+	TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == 0);
+
+	//The scan never reads past the end of the zone
+	memstats_paint(zone, zone + ZONE_WORDS);
+	TEST_CHECK(memstats_untouched(zone + 10, zone + 20) == 10);
+	return res;
+}
+
+testresult memstats_fragmentation_share(void) {
+	testresult res = {TSUCCESS, {0}};
+	MEMSTATS stats = {.heapArena = 1000, .heapInUse = 250};
+	TEST_CHECK(memstats_fragmentation(&stats) == 750);
+	stats.heapInUse = 1000;
+	TEST_CHECK(memstats_fragmentation(&stats) == 0);
+	stats.heapInUse = 1200;
+	TEST_CHECK(memstats_fragmentation(&stats) == 0);
+	stats = (MEMSTATS){0};
+	TEST_CHECK(memstats_fragmentation(&stats) == 0);
+
+	//No overflow with the whole RAM as arena
+	stats = (MEMSTATS){.heapArena = 768 * 1024, .heapInUse = 1024};
+	TEST_CHECK(memstats_fragmentation(&stats) == 998);
+	return res;
+}
+
+testresult memstats_can_frames(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t data[MEMSTATS_CAN_PAYLOAD_SIZE];
+	MEMSTATS stats = {
+		.stackPeak = 0x3A8, .stackReserve = 0x400, .stackPainted = 0x4000, .gap = 0x12345,
+		.heapPeak = 0x2F0, .heapReserve = 0x200, .heapArena = 0x300, .heapInUse = 0x1E0,
+		.runtimeCalls = 3, .locked = 1
+	};
+
+	memstats_packCan(&stats, 0, data);
+	const uint8_t frame0[MEMSTATS_CAN_PAYLOAD_SIZE] = {0, 1, 0xA8, 0x03, 0x00, 0x04, 0xFF, 0xFF};
+	for (uint8_t i = 0; i < MEMSTATS_CAN_PAYLOAD_SIZE; ++i) TEST_CHECK(data[i] == frame0[i]);
+
+	//0x120 free of 0x300 is 375 thousandths, sent as 38 percent
+	memstats_packCan(&stats, 1, data);
+	const uint8_t frame1[MEMSTATS_CAN_PAYLOAD_SIZE] = {1, 38, 0xF0, 0x02, 0xE0, 0x01, 0x03, 0x00};
+	for (uint8_t i = 0; i < MEMSTATS_CAN_PAYLOAD_SIZE; ++i) TEST_CHECK(data[i] == frame1[i]);
+	return res;
+}
+
+testresult memstats_random_use(void) {
+	testresult res = {TSUCCESS, {0}};
+	for (uint32_t run = 0; run < RANDOM_RUNS; ++run) {
+		memstats_paint(zone, zone + ZONE_WORDS);
+		uint32_t deepest = ZONE_WORDS;
+
+		//Calls of random depths that each write a few of their words
+		uint32_t calls = 1 + rnd() % 8;
+		for (uint32_t c = 0; c < calls; ++c) {
+			uint32_t bottom = rnd() % ZONE_WORDS;
+			uint32_t writes = 1 + rnd() % 16;
+			for (uint32_t w = 0; w < writes; ++w) {
+				uint32_t word = bottom + rnd() % (ZONE_WORDS - bottom);
+				uint32_t value = rnd();
+				if (value == MEMSTATS_PAINT) continue;
+				zone[word] = value;
+				if (word < deepest) deepest = word;
+			}
+		}
+		TEST_CHECK(memstats_untouched(zone, zone + ZONE_WORDS) == deepest);
+	}
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,182 @@
+/*
+ * rudderpid_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "RUDDERPID.h"
+#include <math.h>
+#include <string.h>
+
+//-- Test definitions --
+#define CONTROL_PERIOD_MS 20
+#define MOTOR_MAX_SPEED 2000.0f //encoder counts per second at full output
+#define MOTOR_DEAD_ZONE 0.04f //output below which the motor does not turn
+
+testresult rudderpid_set_motor(void);
+testresult rudderpid_dac_step(void);
+testresult rudderpid_pi_output(void);
+testresult rudderpid_no_reversal(void);
+testresult rudderpid_closed_loop(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="DAC value and direction pin", .func=rudderpid_set_motor, .group=MOTOR},
+		{.testname="DAC steps", .func=rudderpid_dac_step, .group=MOTOR},
+		{.testname="PI output, dead zone and integral limit", .func=rudderpid_pi_output, .group=MOTOR},
+		{.testname="Stops before reversing", .func=rudderpid_no_reversal, .group=MOTOR},
+		{.testname="Closed loop on a motor model", .func=rudderpid_closed_loop, .group=MOTOR}
+};
+
+// -- Helpers --
+//The handle of the board, used by the driver
+DAC_HandleTypeDef hdac1;
+
+//State of one controller, the arguments of PI_Motor()
+typedef struct {
+	float integral;
+	uint32_t lastTime;
+	int32_t pastHeading;
+	int8_t pastDirection;
+} CONTROLLER;
+
+static CONTROLLER controller;
+
+static void control(int32_t desired, int32_t current) {
+	PI_Motor(desired, current, &controller.integral, &controller.lastTime, &controller.pastHeading, &controller.pastDirection);
+}
+
+//Motor and rudder model: every ms the rudder turns at a speed set by the DAC, in the direction of PA7
+static float rudder;
+
+static void motorStep(void* context) {
+	float output = HAL_DAC_GetValue(&hdac1, DAC_CHANNEL_1) / 4095.0f;
+	if (output > MOTOR_DEAD_ZONE) {
+		float speed = (output - MOTOR_DEAD_ZONE) / (1.0f - MOTOR_DEAD_ZONE) * MOTOR_MAX_SPEED;
+		rudder += (HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_7) == GPIO_PIN_SET ? speed : -speed) / 1000.0f;
+	}
+	hal_host_schedule(HAL_HOST_MS(1), motorStep, NULL);
+}
+
+static void setup(void) {
+	hal_host_reset();
+	//PA7 as an output, like the board
+	GPIO_InitTypeDef pin = {.Pin = GPIO_PIN_7, .Mode = GPIO_MODE_OUTPUT_PP};
+	HAL_GPIO_Init(GPIOA, &pin);
+	hdac1 = (DAC_HandleTypeDef){.Instance = DAC1};
+	HAL_DAC_Init(&hdac1);
+	HAL_DAC_Start(&hdac1, DAC_CHANNEL_1);
+	memset(&controller, 0, sizeof(controller));
+	rudder = 0;
+}
+
+static uint32_t dac(void) {
+	return HAL_DAC_GetValue(&hdac1, DAC_CHANNEL_1);
+}
+
+static GPIO_PinState direction(void) {
+	return HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_7);
+}
+
+// -- Unit tests --
+testresult rudderpid_set_motor(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	Set_Motor(0.5f);
+	TEST_CHECK(dac() == 2047 && direction() == GPIO_PIN_SET);
+	Set_Motor(-1.0f);
+	TEST_CHECK(dac() == 4095 && direction() == GPIO_PIN_RESET);
+	Set_Motor(MOTOR_STOP);
+	TEST_CHECK(dac() == 0 && direction() == GPIO_PIN_SET);
+	TEST_CHECK(hal_host_gpioWrites(GPIOA, GPIO_PIN_7) == 3);
+	return res;
+}
+
+testresult rudderpid_dac_step(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	DAC_STEP(0);
+	TEST_CHECK(dac() == 0);
+	DAC_STEP(25);
+	TEST_CHECK(dac() == 2047);
+	DAC_STEP(50);
+	TEST_CHECK(dac() == 4095);
+	return res;
+}
+
+testresult rudderpid_pi_output(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+
+	//100 counts to go after 100 ms: the integral gains 10 count seconds
+	hal_host_advance(HAL_HOST_MS(100));
+	control(100, 0);
+	TEST_CHECK(controller.integral == 10.0f && controller.lastTime == 100 && controller.pastDirection == 1);
+	TEST_CHECK(dac() == (uint32_t)(fabsf(PROPORTIONAL_GAIN * 100 + INTEGRAL_GAIN * 10.0f) * 4095.0f));
+
+	//Small errors drive the motor at the minimum output, in their direction
+	hal_host_advance(HAL_HOST_MS(100));
+	control(-10, 0);
+	TEST_CHECK(dac() == (uint32_t)(0.06f * 4095.0f) && direction() == GPIO_PIN_RESET);
+
+	//Within the threshold the motor stops and the integral is cleared
+	hal_host_advance(HAL_HOST_MS(100));
+	control(0, 0);
+	TEST_CHECK(dac() == 0 && controller.integral == 0.0f && controller.lastTime == 300);
+
+	//The integral is clamped, a large error saturates the output
+	controller.integral = INTEGRAL_LIMIT - 1;
+	hal_host_advance(HAL_HOST_MS(1000));
+	control(1000, 0);
+	TEST_CHECK(controller.integral == INTEGRAL_LIMIT && dac() == 4095 && direction() == GPIO_PIN_SET);
+	return res;
+}
+
+testresult rudderpid_no_reversal(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	hal_host_advance(HAL_HOST_MS(CONTROL_PERIOD_MS));
+	control(500, 100);
+	TEST_CHECK(dac() > 0 && direction() == GPIO_PIN_SET);
+
+	//The target moved behind the rudder while it still turns forward: stop first, reverse on a later call
+	hal_host_advance(HAL_HOST_MS(CONTROL_PERIOD_MS));
+	control(0, 110);
+	TEST_CHECK(dac() == 0 && controller.integral == 0.0f && controller.pastHeading == 110);
+	hal_host_advance(HAL_HOST_MS(CONTROL_PERIOD_MS));
+	control(0, 110);
+	TEST_CHECK(dac() > 0 && direction() == GPIO_PIN_RESET);
+	return res;
+}
+
+testresult rudderpid_closed_loop(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	hal_host_schedule(HAL_HOST_MS(1), motorStep, NULL);
+
+	//From 0 to 800 counts with the controller called every 20 ms, as the encoder reads the rudder
+	const int32_t target = 800;
+	float highest = 0;
+	uint32_t settled = 0;
+	for (uint32_t step = 0; step < 4000 / CONTROL_PERIOD_MS && !settled; ++step) {
+		hal_host_advance(HAL_HOST_MS(CONTROL_PERIOD_MS));
+		control(target, (int32_t)rudder);
+		if (rudder > highest) highest = rudder;
+		if (dac() == 0 && fabsf(target - rudder) < ERROR_THRESHOLD + 1) settled = HAL_GetTick();
+	}
+	TEST_CHECK(settled != 0 && settled < 4000);
+	TEST_CHECK(highest < target + 2);
+
+	//Stopped, the rudder stays there
+	hal_host_advance(HAL_HOST_MS(500));
+	TEST_CHECK(dac() == 0 && fabsf(target - rudder) < ERROR_THRESHOLD + 1);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner)/sizeof(t_test));
+}
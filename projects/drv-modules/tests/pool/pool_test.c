@@ -0,0 +1,299 @@
+/*
+ * pool_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//-- Test definitions --
+#define RANDOM_RUNS 200000
+#define MAX_LIVE 64
+#define BENCH_ROUNDS 2000000
+
+testresult pool_first_use_interrupted(void);
+testresult pool_size_classes(void);
+testresult pool_spill_and_exhaust(void);
+testresult pool_free_and_reuse(void);
+testresult pool_invalid_frees(void);
+testresult pool_random_use(void);
+testresult pool_malloc_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		//First, while nothing has built the pool yet
+		{.testname="First use interrupted before the lock", .func=pool_first_use_interrupted, .group=POOL},
+		{.testname="Size classes", .func=pool_size_classes, .group=POOL},
+		{.testname="Spill to larger classes and exhaustion", .func=pool_spill_and_exhaust, .group=POOL},
+		{.testname="Free and reuse", .func=pool_free_and_reuse, .group=POOL},
+		{.testname="Invalid frees", .func=pool_invalid_frees, .group=POOL},
+		{.testname="Random use against a reference", .func=pool_random_use, .group=POOL},
+		{.testname="Benchmark against malloc", .func=pool_malloc_benchmark, .group=POOL}
+};
+
+// -- Helpers --
+static uint32_t rng = 0x9001F00D;
+static uint32_t rnd(void) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+static const uint16_t sizes[POOL_CLASS_COUNT] = {
+#define POOL_CLASS(blockSize, blocks) blockSize,
+#include "pool_config.h"
+#undef POOL_CLASS
+};
+
+static const uint16_t counts[POOL_CLASS_COUNT] = {
+#define POOL_CLASS(blockSize, blocks) blocks,
+#include "pool_config.h"
+#undef POOL_CLASS
+};
+
+static POOL_STATS stats(POOL_CLASS_ID id) {
+	POOL_STATS result;
+	pool_stats(id, &result);
+	return result;
+}
+
+//Blocks of a class given out and not freed
+static uint8_t inUse(POOL_CLASS_ID id) {
+	return (uint8_t)stats(id).inUse;
+}
+
+//Interrupt taken once at the next lock of the pool (POOL_HOST_LOCK_HOOK), allocating a block
+static uint8_t interruptArmed;
+static void* interruptBlock;
+
+void poolTestLock(void) {
+	if (!interruptArmed) return;
+	interruptArmed = 0;
+	interruptBlock = pool_alloc(1);
+}
+
+// -- Unit tests --
+testresult pool_first_use_interrupted(void) {
+	testresult res = {TSUCCESS, {0}};
+	//The interrupt allocates between the first use's check and its lock, its block is still given out after it
+	interruptArmed = 1;
+	void* block = pool_alloc(1);
+	TEST_CHECK(interruptArmed == 0 && interruptBlock != NULL && block != NULL && block != interruptBlock);
+	TEST_CHECK(inUse(POOL_CLASS_16) == 2 && stats(POOL_CLASS_16).allocs == 2);
+	pool_free(block);
+	pool_free(interruptBlock);
+	TEST_CHECK(inUse(POOL_CLASS_16) == 0 && pool_invalidFrees() == 0);
+	return res;
+}
+
+testresult pool_size_classes(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) {
+		POOL_STATS s = stats(i);
+		TEST_CHECK(s.blockSize == sizes[i] && s.blocks == counts[i] && s.inUse == 0 && s.peak == 0);
+	}
+
+	//Every size goes to the smallest class that holds it
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) {
+		size_t smallest = i == 0 ? 0 : sizes[i - 1] + 1u;
+		size_t edges[] = {smallest, sizes[i]};
+		for (uint8_t e = 0; e < 2; ++e) {
+			uint8_t* block = pool_alloc(edges[e]);
+			TEST_CHECK(block != NULL);
+			TEST_CHECK((uintptr_t)block % POOL_ALIGN == 0);
+			TEST_CHECK(inUse(i) == 1);
+			memset(block, 0xA5, sizes[i]);
+			pool_free(block);
+			TEST_CHECK(inUse(i) == 0);
+		}
+	}
+
+	//Larger than every class
+	TEST_CHECK(pool_alloc(sizes[POOL_CLASS_COUNT - 1] + 1u) == NULL);
+	TEST_CHECK(pool_oversize() == 1);
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) TEST_CHECK(stats(i).failures == 0);
+	return res;
+}
+
+testresult pool_spill_and_exhaust(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+	uint16_t total = 0;
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) total += counts[i];
+
+	//The smallest requests take every block of the pool, larger classes once the smaller ones are used up
+	void* blocks[total];
+	for (uint16_t n = 0; n < total; ++n) {
+		blocks[n] = pool_alloc(1);
+		TEST_CHECK(blocks[n] != NULL);
+		for (uint16_t m = 0; m < n; ++m) TEST_CHECK(blocks[m] != blocks[n]);
+	}
+	TEST_CHECK(stats(0).spills == (uint32_t)(total - counts[0]));
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) TEST_CHECK(stats(i).inUse == counts[i] && stats(i).peak == counts[i]);
+
+	//Nothing left: the failure counts against the class asked for
+	TEST_CHECK(pool_alloc(1) == NULL);
+	TEST_CHECK(pool_alloc(sizes[POOL_CLASS_COUNT - 1]) == NULL);
+	TEST_CHECK(stats(0).failures == 1 && stats(POOL_CLASS_COUNT - 1).failures == 1);
+
+	//A block freed in the largest class serves the next small request
+	pool_free(blocks[total - 1]);
+	TEST_CHECK(pool_alloc(1) == blocks[total - 1]);
+
+	for (uint16_t n = 0; n < total; ++n) pool_free(blocks[n]);
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) TEST_CHECK(inUse(i) == 0 && stats(i).peak == counts[i]);
+	TEST_CHECK(pool_invalidFrees() == 0);
+	return res;
+}
+
+testresult pool_free_and_reuse(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+
+	//The last block freed is the next one given out
+	void* a = pool_alloc(sizes[0]);
+	void* b = pool_alloc(sizes[0]);
+	TEST_CHECK(a != NULL && b != NULL && a != b);
+	pool_free(a);
+	TEST_CHECK(pool_alloc(sizes[0]) == a);
+	pool_free(b);
+	pool_free(a);
+	TEST_CHECK(pool_alloc(sizes[0]) == a);
+	TEST_CHECK(pool_alloc(sizes[0]) == b);
+
+	POOL_STATS s = stats(0);
+	TEST_CHECK(s.inUse == 2 && s.peak == 2 && s.allocs == 5);
+
+	//pool_init() gives every block back
+	pool_init();
+	TEST_CHECK(inUse(0) == 0 && stats(0).allocs == 0);
+	TEST_CHECK(pool_alloc(sizes[0]) == a);
+	return res;
+}
+
+testresult pool_invalid_frees(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+	uint8_t* block = pool_alloc(sizes[1]);
+	uint32_t local;
+
+	pool_free(NULL);
+	TEST_CHECK(pool_invalidFrees() == 0);
+	pool_free(block + 4);
+	pool_free(&local);
+	TEST_CHECK(pool_invalidFrees() == 2);
+	TEST_CHECK(inUse(1) == 1);
+
+	pool_free(block);
+	TEST_CHECK(inUse(1) == 0);
+
+	//A class with nothing in use cannot take a block back
+	pool_free(block);
+	TEST_CHECK(pool_invalidFrees() == 3 && inUse(1) == 0);
+	return res;
+}
+
+testresult pool_random_use(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+	uint8_t* live[MAX_LIVE];
+	size_t liveSize[MAX_LIVE];
+	uint8_t liveTag[MAX_LIVE];
+	uint16_t liveCount = 0;
+	uint32_t refused = 0;
+
+	for (uint32_t run = 0; run < RANDOM_RUNS; ++run) {
+		if (liveCount < MAX_LIVE && (liveCount == 0 || rnd() % 2)) {
+			size_t size = rnd() % (sizes[POOL_CLASS_COUNT - 1] + 1u);
+			uint8_t* block = pool_alloc(size);
+			if (block == NULL) {
+				refused++;
+				continue;
+			}
+
+			//No block given out twice, and each one holds its size without touching another
+			for (uint16_t n = 0; n < liveCount; ++n) {
+				TEST_CHECK(block + size <= live[n] || live[n] + liveSize[n] <= block);
+			}
+			uint8_t tag = (uint8_t)rnd();
+			memset(block, tag, size);
+			live[liveCount] = block;
+			liveSize[liveCount] = size;
+			liveTag[liveCount] = tag;
+			liveCount++;
+		}
+		else {
+			uint16_t n = (uint16_t)(rnd() % liveCount);
+			for (size_t i = 0; i < liveSize[n]; ++i) TEST_CHECK(live[n][i] == liveTag[n]);
+			pool_free(live[n]);
+			liveCount--;
+			live[n] = live[liveCount];
+			liveSize[n] = liveSize[liveCount];
+			liveTag[n] = liveTag[liveCount];
+		}
+
+		uint32_t used = 0;
+		for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) used += inUse(i);
+		TEST_CHECK(used == liveCount);
+	}
+
+	//Refusals only happen with the larger classes used up
+	uint32_t failures = 0;
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) failures += stats(i).failures;
+	TEST_CHECK(failures == refused);
+	TEST_CHECK(pool_oversize() == 0 && pool_invalidFrees() == 0);
+
+	while (liveCount > 0) pool_free(live[--liveCount]);
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) TEST_CHECK(inUse(i) == 0);
+	return res;
+}
+
+testresult pool_malloc_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	pool_init();
+
+	//The sizes the drivers ask for, several blocks held at once like a driver creating its buffers
+	const size_t pattern[] = {16, 28, 1, 4, 16, 300, 200, 24};
+	const uint8_t held = sizeof(pattern) / sizeof(pattern[0]);
+	void* blocks[sizeof(pattern) / sizeof(pattern[0])];
+	uint32_t checksum = 0;
+
+	clock_t start = clock();
+	for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+		for (uint8_t i = 0; i < held; ++i) blocks[i] = pool_alloc(pattern[i]);
+		for (uint8_t i = 0; i < held; ++i) {
+			checksum += (uint32_t)(uintptr_t)blocks[i];
+			pool_free(blocks[(i + round) % held]);
+		}
+	}
+	double poolSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+		for (uint8_t i = 0; i < held; ++i) blocks[i] = malloc(pattern[i]);
+		for (uint8_t i = 0; i < held; ++i) {
+			checksum += (uint32_t)(uintptr_t)blocks[i];
+			free(blocks[(i + round) % held]);
+		}
+	}
+	double mallocSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	for (uint8_t i = 0; i < POOL_CLASS_COUNT; ++i) TEST_CHECK(inUse(i) == 0 && stats(i).failures == 0);
+	double pairs = (double)BENCH_ROUNDS * held;
+	printf("pool %.1f ns, malloc %.1f ns per alloc/free pair (checksum %08lX)\r\n", poolSeconds * 1e9 / pairs,
+			mallocSeconds * 1e9 / pairs, (unsigned long)checksum);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
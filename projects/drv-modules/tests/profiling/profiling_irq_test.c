@@ -0,0 +1,230 @@
+/*
+ * profiling_irq_test.c
+ *
+ * Build with -DPROFILING_ENABLE, without it the module is empty. The times given to profiling_irqEnter() and
+ * profiling_irqExit() are made up, only the overhead measured by profiling_init() comes from the clock.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "profiling_irq.h"
+#include <string.h>
+
+//-- Test definitions --
+#define START 1000
+
+testresult profiling_irq_duration(void);
+testresult profiling_irq_nesting(void);
+testresult profiling_irq_latency(void);
+testresult profiling_irq_mismatch(void);
+testresult profiling_irq_dump_lines(void);
+testresult profiling_irq_can_frames(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Duration of a handler", .func=profiling_irq_duration, .group=PROFILING},
+		{.testname="Nested handlers and preemptions", .func=profiling_irq_nesting, .group=PROFILING},
+		{.testname="Latency", .func=profiling_irq_latency, .group=PROFILING},
+		{.testname="Mismatched exits and nesting overflow", .func=profiling_irq_mismatch, .group=PROFILING},
+		{.testname="Dump lines", .func=profiling_irq_dump_lines, .group=PROFILING},
+		{.testname="CAN frames", .func=profiling_irq_can_frames, .group=PROFILING}
+};
+
+// -- Helpers --
+//Runs a handler that takes `ticks` from `start`, without latency
+static void handler(uint8_t irq, uint32_t start, uint32_t ticks) {
+	profiling_irqEnter(irq, start, PROFILING_IRQ_NO_LATENCY);
+	profiling_irqExit(irq, start + ticks);
+}
+
+// -- Unit tests --
+testresult profiling_irq_duration(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_IRQ_STATS stats;
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+
+	profiling_irqStats(PROFILING_IRQ_USART1, &stats);
+	TEST_CHECK(stats.duration.count == 0 && stats.duration.min == UINT32_MAX && stats.latency.count == 0);
+
+	//The overhead is taken off, the time wraps around like the cycle counter
+	handler(PROFILING_IRQ_USART1, START, overhead + 200);
+	handler(PROFILING_IRQ_USART1, UINT32_MAX - 10, overhead + 600);
+	profiling_irqStats(PROFILING_IRQ_USART1, &stats);
+	TEST_CHECK(stats.duration.count == 2 && stats.duration.min == 200 && stats.duration.max == 600);
+	TEST_CHECK(stats.duration.total == 800 && stats.preempted == 0 && stats.latency.count == 0);
+	TEST_CHECK(stats.duration.histogram[profiling_bucket(200)] == 1 && stats.duration.histogram[profiling_bucket(600)] == 1);
+
+	//One interrupt never preempted gives a nesting of 1
+	PROFILING_IRQ_NESTING nesting;
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == 1 && nesting.irqs[0] == PROFILING_IRQ_USART1);
+
+	//Unknown interrupts are ignored
+	handler(PROFILING_IRQ_COUNT, START, 100);
+	profiling_irqStats(PROFILING_IRQ_SYSTICK, &stats);
+	TEST_CHECK(stats.duration.count == 0);
+
+	profiling_reset();
+	profiling_irqStats(PROFILING_IRQ_USART1, &stats);
+	TEST_CHECK(stats.duration.count == 0 && stats.duration.min == UINT32_MAX);
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == 0);
+	return res;
+}
+
+testresult profiling_irq_nesting(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_IRQ_STATS stats;
+	PROFILING_IRQ_NESTING nesting;
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+
+	//USART1 runs 1000 ticks of its own, preempted by SysTick which is itself preempted by the DMA
+	profiling_irqEnter(PROFILING_IRQ_USART1, START, PROFILING_IRQ_NO_LATENCY);
+	profiling_irqEnter(PROFILING_IRQ_SYSTICK, START + 400, PROFILING_IRQ_NO_LATENCY);
+	handler(PROFILING_IRQ_GPDMA1_CH1, START + 500, overhead + 100);
+	profiling_irqExit(PROFILING_IRQ_SYSTICK, START + 400 + 2 * overhead + 300 + 100);
+	handler(PROFILING_IRQ_I2C1_EV, START + 2000, overhead + 50);
+	profiling_irqExit(PROFILING_IRQ_USART1, START + 2 * overhead + 400 + overhead + 50 + overhead + 1000);
+
+	profiling_irqStats(PROFILING_IRQ_GPDMA1_CH1, &stats);
+	TEST_CHECK(stats.duration.count == 1 && stats.duration.max == 100 && stats.preempted == 0);
+	profiling_irqStats(PROFILING_IRQ_SYSTICK, &stats);
+	TEST_CHECK(stats.duration.count == 1 && stats.duration.max == 300 && stats.preempted == 1);
+	profiling_irqStats(PROFILING_IRQ_USART1, &stats);
+	TEST_CHECK(stats.duration.count == 1 && stats.duration.max == 1000 && stats.preempted == 2);
+
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == 3);
+	TEST_CHECK(nesting.irqs[0] == PROFILING_IRQ_USART1 && nesting.irqs[1] == PROFILING_IRQ_SYSTICK);
+	TEST_CHECK(nesting.irqs[2] == PROFILING_IRQ_GPDMA1_CH1);
+
+	//A shallower nesting later does not replace the deepest one
+	profiling_irqEnter(PROFILING_IRQ_ADC1, START, PROFILING_IRQ_NO_LATENCY);
+	handler(PROFILING_IRQ_I2C1_ER, START + 10, overhead + 10);
+	profiling_irqExit(PROFILING_IRQ_ADC1, START + 100);
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == 3 && nesting.irqs[0] == PROFILING_IRQ_USART1);
+	return res;
+}
+
+testresult profiling_irq_latency(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_IRQ_STATS stats;
+	profiling_init();
+
+	//Latencies are kept as given, without the overhead
+	const uint32_t latencies[] = {12, 30, 500};
+	for (uint8_t i = 0; i < 3; ++i) {
+		profiling_irqEnter(PROFILING_IRQ_ADC1, START, latencies[i]);
+		profiling_irqExit(PROFILING_IRQ_ADC1, START + 100);
+	}
+	handler(PROFILING_IRQ_ADC1, START, 100);
+	profiling_irqStats(PROFILING_IRQ_ADC1, &stats);
+	TEST_CHECK(stats.duration.count == 4 && stats.latency.count == 3);
+	TEST_CHECK(stats.latency.min == 12 && stats.latency.max == 500 && stats.latency.total == 542);
+	TEST_CHECK(stats.latency.histogram[0] == 2 && stats.latency.histogram[profiling_bucket(500)] == 1);
+	return res;
+}
+
+testresult profiling_irq_mismatch(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_IRQ_STATS stats;
+	PROFILING_IRQ_NESTING nesting;
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+
+	//An exit without its enter, or of an interrupt that is not the innermost, is ignored
+	profiling_irqExit(PROFILING_IRQ_USART1, START);
+	profiling_irqEnter(PROFILING_IRQ_USART1, START, PROFILING_IRQ_NO_LATENCY);
+	profiling_irqExit(PROFILING_IRQ_SYSTICK, START + 50);
+	profiling_irqStats(PROFILING_IRQ_SYSTICK, &stats);
+	TEST_CHECK(stats.duration.count == 0);
+	profiling_irqExit(PROFILING_IRQ_USART1, START + overhead + 80);
+	profiling_irqStats(PROFILING_IRQ_USART1, &stats);
+	TEST_CHECK(stats.duration.count == 1 && stats.duration.max == 80);
+
+	//Interrupts deeper than PROFILING_IRQ_MAX_DEPTH are not timed, the outer ones still are
+	for (uint8_t i = 0; i < PROFILING_IRQ_MAX_DEPTH + 2; ++i) {
+		profiling_irqEnter(i % PROFILING_IRQ_COUNT, START + i, PROFILING_IRQ_NO_LATENCY);
+	}
+	for (int8_t i = PROFILING_IRQ_MAX_DEPTH + 1; i >= 0; --i) {
+		profiling_irqExit(i % PROFILING_IRQ_COUNT, START + 100 - i);
+	}
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == PROFILING_IRQ_MAX_DEPTH);
+
+	//The stack is empty again
+	profiling_reset();
+	handler(PROFILING_IRQ_I2C1_EV, START, overhead + 5);
+	profiling_irqNesting(&nesting);
+	TEST_CHECK(nesting.depth == 1 && nesting.irqs[0] == PROFILING_IRQ_I2C1_EV);
+	return res;
+}
+
+testresult profiling_irq_dump_lines(void) {
+	testresult res = {TSUCCESS, {0}};
+	char line[PROFILING_LINE_SIZE];
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+
+	profiling_irqFormatLine(0, line);
+	TEST_CHECK(strcmp(line, "NEST 0\r\n") == 0);
+
+	profiling_irqEnter(PROFILING_IRQ_I2C1_EV, START, 40);
+	handler(PROFILING_IRQ_SYSTICK, START + 10, overhead + 90);
+	profiling_irqExit(PROFILING_IRQ_I2C1_EV, START + 2 * overhead + 90 + 2000);
+	handler(PROFILING_IRQ_I2C1_EV, START, overhead + 1000);
+
+	TEST_CHECK(profiling_irqFormatLine(0, line) == strlen("NEST 2 I2C1_EV SYSTICK\r\n"));
+	TEST_CHECK(strcmp(line, "NEST 2 I2C1_EV SYSTICK\r\n") == 0);
+
+	//Three lines per interrupt in the order of profiling_irqs.h
+	uint16_t index = 1 + 3 * PROFILING_IRQ_I2C1_EV;
+	profiling_irqFormatLine(index, line);
+	TEST_CHECK(strcmp(line, "IRQ I2C1_EV n=2 preempted=1 dur=1000/1500/2000 lat=1 40/40/40\r\n") == 0);
+	profiling_irqFormatLine(index + 1, line);
+	TEST_CHECK(strcmp(line, "IDUR I2C1_EV 0 0 0 0 0 1 1 0 0 0 0 0 0 0 0 0\r\n") == 0);
+	profiling_irqFormatLine(index + 2, line);
+	TEST_CHECK(strcmp(line, "ILAT I2C1_EV 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n") == 0);
+	profiling_irqFormatLine(1 + 3 * PROFILING_IRQ_ADC1, line);
+	TEST_CHECK(strcmp(line, "IRQ ADC1 n=0 preempted=0 dur=0/0/0 lat=0 0/0/0\r\n") == 0);
+	TEST_CHECK(strcmp(profiling_irqName(PROFILING_IRQ_GPDMA1_CH4), "GPDMA1_CH4") == 0);
+
+	TEST_CHECK(profiling_irqFormatLine(1 + 3 * PROFILING_IRQ_COUNT, line) == 0 && line[0] == '\0');
+	return res;
+}
+
+testresult profiling_irq_can_frames(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t data[PROFILING_CAN_PAYLOAD_SIZE];
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+
+	profiling_irqEnter(PROFILING_IRQ_USART1, START, 0x20);
+	handler(PROFILING_IRQ_GPDMA1_CH4, START + 1, overhead + 0x10);
+	profiling_irqExit(PROFILING_IRQ_USART1, START + 2 * overhead + 0x10 + 0x12345);
+	profiling_irqEnter(PROFILING_IRQ_USART1, START, 0x40);
+	profiling_irqExit(PROFILING_IRQ_USART1, START + overhead + 0x10001);
+
+	const uint32_t expected[PROFILING_IRQ_CAN_FRAMES] = {2, 0x111A3, 0x12345, 0x30, 0x40, 1};
+	for (uint8_t frame = 0; frame < PROFILING_IRQ_CAN_FRAMES; ++frame) {
+		profiling_irqPackCan(PROFILING_IRQ_USART1, frame, data);
+		uint32_t value = data[2] | data[3] << 8 | data[4] << 16 | (uint32_t)data[5] << 24;
+		TEST_CHECK(data[0] == (PROFILING_IRQ_CAN_FLAG | PROFILING_IRQ_USART1) && data[1] == frame && value == expected[frame]);
+		TEST_CHECK(data[6] == 0 && data[7] == 0);
+	}
+
+	profiling_irqPackNesting(data);
+	TEST_CHECK(data[0] == PROFILING_IRQ_CAN_NESTING && data[1] == 2);
+	TEST_CHECK(data[2] == PROFILING_IRQ_USART1 && data[3] == PROFILING_IRQ_GPDMA1_CH4 && data[4] == 0xFF && data[7] == 0xFF);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
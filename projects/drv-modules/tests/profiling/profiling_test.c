@@ -0,0 +1,185 @@
+/*
+ * profiling_test.c
+ *
+ * Build with -DPROFILING_ENABLE, without it the module is empty.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "profiling.h"
+#include <stdio.h>
+#include <string.h>
+
+//-- Test definitions --
+#define SLEEP_NS 2000000
+#define BENCHMARK_RUNS 1000000
+
+testresult profiling_buckets(void);
+testresult profiling_statistics(void);
+testresult profiling_scopes(void);
+testresult profiling_dump_lines(void);
+testresult profiling_can_frames(void);
+testresult profiling_probe_cost(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Histogram buckets", .func=profiling_buckets, .group=PROFILING},
+		{.testname="Min, max, mean and overhead", .func=profiling_statistics, .group=PROFILING},
+		{.testname="Scopes, early returns and enter/exit", .func=profiling_scopes, .group=PROFILING},
+		{.testname="Dump lines", .func=profiling_dump_lines, .group=PROFILING},
+		{.testname="CAN frames", .func=profiling_can_frames, .group=PROFILING},
+		{.testname="Cost of a probe", .func=profiling_probe_cost, .group=PROFILING}
+};
+
+// -- Helpers --
+static void sleepNs(long ns) {
+	struct timespec time = {.tv_sec = 0, .tv_nsec = ns};
+	nanosleep(&time, NULL);
+}
+
+//Stands for a driver callback with an early return
+static uint8_t handler(uint8_t valid) {
+	PROFILING_SCOPE(BRITER_HANDLE_DMA);
+	if (!valid) return 0;
+	sleepNs(SLEEP_NS);
+	return 1;
+}
+
+// -- Unit tests --
+testresult profiling_buckets(void) {
+	testresult res = {TSUCCESS, {0}};
+	TEST_CHECK(profiling_bucket(0) == 0 && profiling_bucket(31) == 0);
+	for (uint8_t k = 1; k < PROFILING_BUCKETS - 1; ++k) {
+		uint32_t low = 1u << (k + PROFILING_BUCKET_SHIFT - 1);
+		TEST_CHECK(profiling_bucket(low - 1) == k - 1 && profiling_bucket(low) == k && profiling_bucket(2 * low - 1) == k);
+	}
+	TEST_CHECK(profiling_bucket(1u << (PROFILING_BUCKETS + PROFILING_BUCKET_SHIFT - 2)) == PROFILING_BUCKETS - 1);
+	TEST_CHECK(profiling_bucket(UINT32_MAX) == PROFILING_BUCKETS - 1);
+	return res;
+}
+
+testresult profiling_statistics(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_STATS stats;
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+	TEST_CHECK(overhead < 10000);
+
+	profiling_stats(PROFILING_PROBE_PI_MOTOR, &stats);
+	TEST_CHECK(stats.count == 0 && stats.max == 0 && stats.total == 0);
+
+	//Durations are recorded without the overhead, shorter than the overhead counts as 0
+	const uint32_t durations[] = {100, 40, 3000, 40};
+	for (uint8_t i = 0; i < 4; ++i) profiling_record(PROFILING_PROBE_PI_MOTOR, overhead + durations[i]);
+	if (overhead > 0) profiling_record(PROFILING_PROBE_PI_MOTOR, overhead - 1);
+	else profiling_record(PROFILING_PROBE_PI_MOTOR, 0);
+	profiling_stats(PROFILING_PROBE_PI_MOTOR, &stats);
+	TEST_CHECK(stats.count == 5 && stats.min == 0 && stats.max == 3000 && stats.total == 3180);
+	TEST_CHECK(stats.histogram[0] == 1 && stats.histogram[profiling_bucket(40)] == 2 && stats.histogram[profiling_bucket(100)] == 1);
+	TEST_CHECK(stats.histogram[profiling_bucket(3000)] == 1);
+
+	//Other probes are not affected, unknown probes are ignored
+	profiling_record(PROFILING_PROBE_COUNT, 5);
+	profiling_stats(PROFILING_PROBE_IMU_HANDLE_RX_DMA, &stats);
+	TEST_CHECK(stats.count == 0);
+
+	profiling_reset();
+	profiling_stats(PROFILING_PROBE_PI_MOTOR, &stats);
+	TEST_CHECK(stats.count == 0 && stats.min == UINT32_MAX);
+
+	//The same accumulation outside the table
+	PROFILING_STATS own = {.min = UINT32_MAX};
+	profiling_accumulate(&own, 7);
+	profiling_accumulate(&own, 70);
+	TEST_CHECK(own.count == 2 && own.min == 7 && own.max == 70 && own.histogram[0] == 1 && own.histogram[2] == 1);
+	return res;
+}
+
+testresult profiling_scopes(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_STATS stats;
+	profiling_init();
+
+	//Every return ends the scope
+	TEST_CHECK(handler(0) == 0 && handler(1) == 1 && handler(0) == 0);
+	profiling_stats(PROFILING_PROBE_BRITER_HANDLE_DMA, &stats);
+	TEST_CHECK(stats.count == 3 && stats.max >= SLEEP_NS && stats.min < SLEEP_NS / 10);
+
+	{
+		PROFILING_ENTER(WIND_SENSOR_DATA);
+		sleepNs(SLEEP_NS / 2);
+		PROFILING_EXIT(WIND_SENSOR_DATA);
+	}
+	profiling_stats(PROFILING_PROBE_WIND_SENSOR_DATA, &stats);
+	TEST_CHECK(stats.count == 1 && stats.min >= SLEEP_NS / 2 && stats.min < 50 * SLEEP_NS);
+	return res;
+}
+
+testresult profiling_dump_lines(void) {
+	testresult res = {TSUCCESS, {0}};
+	char line[PROFILING_LINE_SIZE];
+	char expected[PROFILING_LINE_SIZE];
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+	profiling_record(PROFILING_PROBE_IMU_HANDLE_RX_DMA, overhead + 10);
+	profiling_record(PROFILING_PROBE_IMU_HANDLE_RX_DMA, overhead + 1000);
+	profiling_record(PROFILING_PROBE_IMU_HANDLE_RX_DMA, overhead + 1001);
+
+	snprintf(expected, sizeof(expected), "PROF 1000000000 %lu\r\n", (unsigned long)overhead);
+	TEST_CHECK(profiling_formatLine(0, line) == strlen(expected) && strcmp(line, expected) == 0);
+
+	//Two lines per probe in the order of profiling_probes.h
+	uint16_t index = 1 + 2 * PROFILING_PROBE_IMU_HANDLE_RX_DMA;
+	profiling_formatLine(index, line);
+	TEST_CHECK(strcmp(line, "PROF IMU_HANDLE_RX_DMA n=3 min=10 mean=670 max=1001\r\n") == 0);
+	profiling_formatLine(index + 1, line);
+	TEST_CHECK(strcmp(line, "HIST IMU_HANDLE_RX_DMA 1 0 0 0 0 2 0 0 0 0 0 0 0 0 0 0\r\n") == 0);
+	profiling_formatLine(1 + 2 * PROFILING_PROBE_PI_MOTOR, line);
+	TEST_CHECK(strcmp(line, "PROF PI_MOTOR n=0 min=0 mean=0 max=0\r\n") == 0);
+	TEST_CHECK(strcmp(profiling_name(PROFILING_PROBE_PI_MOTOR), "PI_MOTOR") == 0);
+
+	TEST_CHECK(profiling_formatLine(1 + 2 * PROFILING_PROBE_COUNT, line) == 0 && line[0] == '\0');
+	return res;
+}
+
+testresult profiling_can_frames(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t data[PROFILING_CAN_PAYLOAD_SIZE];
+	profiling_init();
+	uint32_t overhead = profiling_overhead();
+	profiling_record(PROFILING_PROBE_PI_MOTOR, overhead + 0x12345);
+	profiling_record(PROFILING_PROBE_PI_MOTOR, overhead + 0x10001);
+
+	const uint32_t expected[PROFILING_CAN_FRAMES] = {2, 0x10001, 0x111A3, 0x12345};
+	for (uint8_t frame = 0; frame < PROFILING_CAN_FRAMES; ++frame) {
+		profiling_packCan(PROFILING_PROBE_PI_MOTOR, frame, data);
+		uint32_t value = data[2] | data[3] << 8 | data[4] << 16 | (uint32_t)data[5] << 24;
+		TEST_CHECK(data[0] == PROFILING_PROBE_PI_MOTOR && data[1] == frame && value == expected[frame]);
+		TEST_CHECK(data[6] == 0 && data[7] == 0);
+	}
+	return res;
+}
+
+testresult profiling_probe_cost(void) {
+	testresult res = {TSUCCESS, {0}};
+	PROFILING_STATS stats;
+	profiling_init();
+
+	uint32_t start = profiling_now();
+	for (uint32_t i = 0; i < BENCHMARK_RUNS; ++i) {
+		PROFILING_SCOPE(PI_MOTOR);
+	}
+	uint32_t elapsed = profiling_now() - start;
+	profiling_stats(PROFILING_PROBE_PI_MOTOR, &stats);
+	TEST_CHECK(stats.count == BENCHMARK_RUNS);
+	printf("Probe: %.1f ns per empty scope, overhead %lu ns taken off, mean %lu ns left\n",
+			(double)elapsed / BENCHMARK_RUNS, (unsigned long)profiling_overhead(), (unsigned long)(stats.total / stats.count));
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,300 @@
+/*
+ * regmap_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "regmap.h"
+#include "regmap_i2c.h"
+#include "hal_host.h"
+#include "BNO055.h"
+#include <string.h>
+
+//-- Test definitions --
+#define FUZZ_PLANS 20000
+
+testresult regmap_bno055_burst(void);
+testresult regmap_gap_merging(void);
+testresult regmap_command_code_device(void);
+testresult regmap_decode_encode(void);
+testresult regmap_bno055_scales(void);
+testresult regmap_limits(void);
+testresult regmap_random_plans(void);
+testresult regmap_i2c_callback_results(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="BNO055 output block is one read", .func=regmap_bno055_burst, .group=REGMAP},
+		{.testname="Reads merged across small gaps only", .func=regmap_gap_merging, .group=REGMAP},
+		{.testname="No merging without auto-increment", .func=regmap_command_code_device, .group=REGMAP},
+		{.testname="Byte order, sign and width", .func=regmap_decode_encode, .group=REGMAP},
+		{.testname="Table scales match BNO055 conversions", .func=regmap_bno055_scales, .group=REGMAP},
+		{.testname="Invalid and oversized plans", .func=regmap_limits, .group=REGMAP},
+		{.testname="Random plans read every register", .func=regmap_random_plans, .group=REGMAP},
+		{.testname="Read results kept during the callback", .func=regmap_i2c_callback_results, .group=REGMAP}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x2468ACE1;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Runs a plan against a simulated auto-incrementing device
+static void execute(const REGMAP_PLAN* plan, const uint8_t* memory, uint8_t* buffer) {
+	for (uint8_t i = 0; i < plan->transactionCount; ++i) {
+		memcpy(&buffer[plan->transactions[i].offset], &memory[plan->transactions[i].address], plan->transactions[i].length);
+	}
+}
+
+//A VEML3328 style device: 16 bit command code registers without auto-increment
+static const REGMAP_REGISTER commandRegisters[] = {
+	{0x00, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+	{0x05, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+	{0x06, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1},
+	{0x07, 2, REGMAP_LITTLE_ENDIAN, 0, 1, 1}
+};
+
+static const REGMAP_DEVICE commandDevice = {0x10, 0, 0, 2, commandRegisters, 4};
+
+//The same device behind the host HAL, with a poller that reads its results in the completion callback
+static I2C_HandleTypeDef hi2c;
+static REGMAP_I2C bus;
+static uint8_t registers[2 * 0x08];
+static HAL_HOST_I2C_REGS device;
+static const uint8_t channels[] = {1, 2, 3};
+static const uint8_t control[] = {0};
+static HAL_StatusTypeDef chained;
+static uint8_t busyInCallback;
+static int32_t results[3];
+static uint32_t completions;
+
+static void readDone(void* context, HAL_StatusTypeDef status) {
+	//A poller starting its next read first, then taking the results
+	chained = regmap_i2c_read(&bus, control, sizeof(control), NULL, NULL);
+	busyInCallback = regmap_i2c_isBusy(&bus);
+	for (uint8_t i = 0; i < 3; ++i) results[i] = regmap_i2c_raw(&bus, channels[i]);
+	completions++;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* i2c) {
+	regmap_i2c_handleRxCplt(&bus, i2c);
+}
+
+// -- Unit tests --
+testresult regmap_bno055_burst(void) {
+	testresult res = {TSUCCESS, {0}};
+	REGMAP_PLAN plan;
+
+	//The registers read by the IMU burst, in any order
+	const uint8_t burst[] = {
+		BNO055_REG_CALIB_STAT, BNO055_REG_HEADING, BNO055_REG_ROLL, BNO055_REG_PITCH,
+		BNO055_REG_QUA_W, BNO055_REG_QUA_X, BNO055_REG_QUA_Y, BNO055_REG_QUA_Z,
+		BNO055_REG_LIA_X, BNO055_REG_LIA_Y, BNO055_REG_LIA_Z
+	};
+	TEST_CHECK(regmap_plan(&BNO055_REGMAP, burst, sizeof(burst), &plan));
+	TEST_CHECK(plan.transactionCount == 1);
+	TEST_CHECK(plan.transactions[0].address == 0x1A && plan.transactions[0].length == 28);
+	TEST_CHECK(plan.offsets[BNO055_REG_HEADING] == 0);
+	TEST_CHECK(plan.offsets[BNO055_REG_QUA_W] == 6);
+	TEST_CHECK(plan.offsets[BNO055_REG_LIA_X] == 14);
+	TEST_CHECK(plan.offsets[BNO055_REG_CALIB_STAT] == 27);
+	TEST_CHECK(plan.offsets[BNO055_REG_ACC_X] == REGMAP_NOT_PLANNED);
+	return res;
+}
+
+testresult regmap_gap_merging(void) {
+	testresult res = {TSUCCESS, {0}};
+	REGMAP_PLAN plan;
+
+	//0x0A to 0x0E is a 4 byte gap, read through
+	const uint8_t nearby[] = {BNO055_REG_MAG_X, BNO055_REG_ACC_X, BNO055_REG_ACC_X};
+	TEST_CHECK(regmap_plan(&BNO055_REGMAP, nearby, sizeof(nearby), &plan));
+	TEST_CHECK(plan.transactionCount == 1);
+	TEST_CHECK(plan.transactions[0].address == 0x08 && plan.transactions[0].length == 8);
+	TEST_CHECK(plan.offsets[BNO055_REG_MAG_X] == 6);
+
+	//0x0A to 0x14 is too far, two reads
+	const uint8_t distant[] = {BNO055_REG_GYR_X, BNO055_REG_ACC_X};
+	TEST_CHECK(regmap_plan(&BNO055_REGMAP, distant, sizeof(distant), &plan));
+	TEST_CHECK(plan.transactionCount == 2);
+	TEST_CHECK(plan.transactions[0].address == 0x08 && plan.transactions[0].length == 2);
+	TEST_CHECK(plan.transactions[1].address == 0x14 && plan.transactions[1].offset == 2);
+	TEST_CHECK(plan.offsets[BNO055_REG_GYR_X] == 2 && plan.length == 4);
+	return res;
+}
+
+testresult regmap_command_code_device(void) {
+	testresult res = {TSUCCESS, {0}};
+	REGMAP_PLAN plan;
+	uint8_t buffer[REGMAP_MAX_BUFFER];
+
+	const uint8_t rgb[] = {3, 1, 2};
+	TEST_CHECK(regmap_plan(&commandDevice, rgb, sizeof(rgb), &plan));
+	TEST_CHECK(plan.transactionCount == 3 && plan.length == 6);
+	for (uint8_t i = 0; i < 3; ++i) {
+		TEST_CHECK(plan.transactions[i].address == 0x05 + i && plan.transactions[i].length == 2);
+		TEST_CHECK(plan.offsets[1 + i] == 2 * i);
+	}
+
+	buffer[2] = 0x34;
+	buffer[3] = 0xF2;
+	TEST_CHECK(regmap_value(&commandDevice, &plan, buffer, 2) == 0xF234);
+	TEST_CHECK(regmap_value(&commandDevice, &plan, buffer, 0) == 0);
+	return res;
+}
+
+testresult regmap_decode_encode(void) {
+	testresult res = {TSUCCESS, {0}};
+	uint8_t bytes[4];
+
+	const REGMAP_REGISTER le16 = {0, 2, REGMAP_LITTLE_ENDIAN, 1, 1, 1};
+	const REGMAP_REGISTER be16 = {0, 2, REGMAP_BIG_ENDIAN, 1, 1, 1};
+	const REGMAP_REGISTER u8 = {0, 1, REGMAP_LITTLE_ENDIAN, 0, 1, 1};
+	const REGMAP_REGISTER s24 = {0, 3, REGMAP_BIG_ENDIAN, 1, 1, 1};
+	const REGMAP_REGISTER s32 = {0, 4, REGMAP_LITTLE_ENDIAN, 1, 1, 1};
+
+	const uint8_t data[] = {0xF0, 0xFF, 0x80, 0x01};
+	TEST_CHECK(regmap_raw(&le16, data) == -16);
+	TEST_CHECK(regmap_raw(&be16, data) == -3841);
+	TEST_CHECK(regmap_raw(&u8, data) == 0xF0);
+	TEST_CHECK(regmap_raw(&s24, data) == -983168);
+	TEST_CHECK(regmap_raw(&s32, data) == 0x0180FFF0);
+
+	for (int32_t value = -8388608; value < 8388608; value += 4099) {
+		regmap_encode(&s24, value, bytes);
+		TEST_CHECK(regmap_raw(&s24, bytes) == value);
+	}
+	regmap_encode(&be16, -2, bytes);
+	TEST_CHECK(bytes[0] == 0xFF && bytes[1] == 0xFE);
+	regmap_encode(&le16, 0x1234, bytes);
+	TEST_CHECK(bytes[0] == 0x34 && bytes[1] == 0x12);
+	return res;
+}
+
+testresult regmap_bno055_scales(void) {
+	testresult res = {TSUCCESS, {0}};
+	const REGMAP_REGISTER* registers = BNO055_REGMAP.registers;
+
+	for (int32_t raw = INT16_MIN; raw <= INT16_MAX; ++raw) {
+		TEST_CHECK(regmap_scale(&registers[BNO055_REG_ROLL], raw) == BNO055__angle(raw, BNO055_ANGLE_MILLIDEGREES));
+		TEST_CHECK(regmap_scale(&registers[BNO055_REG_ACC_X], raw) == BNO055__accel(raw, BNO055_ACCEL_MM_PER_S2));
+		TEST_CHECK(regmap_scale(&registers[BNO055_REG_GYR_Z], raw) == BNO055__rate(raw, BNO055_RATE_MILLIDEGREES_PER_S));
+		TEST_CHECK(regmap_scale(&registers[BNO055_REG_MAG_Y], raw) == BNO055__magnetic(raw));
+		TEST_CHECK(regmap_scale(&registers[BNO055_REG_QUA_W], raw) == raw);
+	}
+
+	const uint8_t heading[] = {0x7F, 0x16};
+	TEST_CHECK(regmap_scale(&registers[BNO055_REG_HEADING], regmap_raw(&registers[BNO055_REG_HEADING], heading)) == BNO055__heading(5759, BNO055_ANGLE_MILLIDEGREES));
+	const uint8_t temperature[] = {0xF4};
+	TEST_CHECK(regmap_scale(&registers[BNO055_REG_TEMP], regmap_raw(&registers[BNO055_REG_TEMP], temperature)) == BNO055__temperature(-12));
+	return res;
+}
+
+testresult regmap_limits(void) {
+	testresult res = {TSUCCESS, {0}};
+	REGMAP_PLAN plan;
+
+	const uint8_t outOfRange[] = {BNO055_REG_COUNT};
+	TEST_CHECK(!regmap_plan(&BNO055_REGMAP, outOfRange, 1, &plan));
+
+	TEST_CHECK(regmap_plan(&BNO055_REGMAP, outOfRange, 0, &plan));
+	TEST_CHECK(plan.transactionCount == 0 && plan.length == 0);
+
+	//Every other register of a command code device gives one transaction each
+	REGMAP_REGISTER many[REGMAP_MAX_TRANSACTIONS + 1];
+	uint8_t indices[REGMAP_MAX_TRANSACTIONS + 1];
+	for (uint8_t i = 0; i <= REGMAP_MAX_TRANSACTIONS; ++i) {
+		many[i] = (REGMAP_REGISTER){2 * i, 1, REGMAP_LITTLE_ENDIAN, 0, 1, 1};
+		indices[i] = i;
+	}
+	REGMAP_DEVICE device = {0x20, 0, 0, 1, many, REGMAP_MAX_TRANSACTIONS + 1};
+	TEST_CHECK(regmap_plan(&device, indices, REGMAP_MAX_TRANSACTIONS, &plan));
+	TEST_CHECK(!regmap_plan(&device, indices, REGMAP_MAX_TRANSACTIONS + 1, &plan));
+
+	//With auto-increment and a large enough gap they are one read
+	device.autoIncrement = 1;
+	device.maxGap = 1;
+	device.maxBlock = 64;
+	TEST_CHECK(regmap_plan(&device, indices, REGMAP_MAX_TRANSACTIONS + 1, &plan));
+	TEST_CHECK(plan.transactionCount == 1 && plan.length == 2 * REGMAP_MAX_TRANSACTIONS + 1);
+
+	//Blocks are split at the maximum block length
+	device.maxBlock = 4;
+	TEST_CHECK(regmap_plan(&device, indices, 4, &plan));
+	TEST_CHECK(plan.transactionCount == 2 && plan.transactions[1].address == 4);
+	return res;
+}
+
+testresult regmap_random_plans(void) {
+	testresult res = {TSUCCESS, {0}};
+	REGMAP_PLAN plan;
+	uint8_t memory[256];
+	uint8_t buffer[REGMAP_MAX_BUFFER];
+	uint8_t indices[2 * BNO055_REG_COUNT];
+
+	for (uint32_t run = 0; run < FUZZ_PLANS; ++run) {
+		for (uint16_t i = 0; i < sizeof(memory); ++i) {
+			memory[i] = rng();
+		}
+		uint8_t count = rng() % sizeof(indices);
+		for (uint8_t i = 0; i < count; ++i) {
+			indices[i] = rng() % BNO055_REG_COUNT;
+		}
+		TEST_CHECK(regmap_plan(&BNO055_REGMAP, indices, count, &plan));
+		execute(&plan, memory, buffer);
+
+		//Transactions are in address order, do not overlap and respect the gap limit
+		for (uint8_t i = 1; i < plan.transactionCount; ++i) {
+			const REGMAP_TRANSACTION* previous = &plan.transactions[i - 1];
+			TEST_CHECK(plan.transactions[i].address > previous->address + previous->length + BNO055_REGMAP.maxGap);
+		}
+
+		//Every requested register decodes as if it was read on its own
+		for (uint8_t i = 0; i < count; ++i) {
+			const REGMAP_REGISTER* reg = &BNO055_REGMAP.registers[indices[i]];
+			int32_t expected = regmap_scale(reg, regmap_raw(reg, &memory[reg->address]));
+			TEST_CHECK(regmap_value(&BNO055_REGMAP, &plan, buffer, indices[i]) == expected);
+		}
+	}
+	return res;
+}
+
+testresult regmap_i2c_callback_results(void) {
+	testresult res = {TSUCCESS, {0}};
+	hal_host_reset();
+	for (uint8_t i = 0; i < sizeof(registers); ++i) registers[i] = 0x10 + i;
+	device = (HAL_HOST_I2C_REGS){.registers = registers, .size = sizeof(registers), .width = 2};
+	hal_host_i2cAttachRegs(I2C1, commandDevice.address, &device);
+	hi2c = (I2C_HandleTypeDef){.Instance = I2C1, .Init = {.Timing = 0x10707DBC}};
+	HAL_I2C_Init(&hi2c);
+	regmap_i2c_init(&bus, &hi2c, &commandDevice);
+
+	//Three transactions, the callback after the last one: the read it starts is refused, so the plan and buffer of
+	//the results stay in place until it returns
+	TEST_CHECK(regmap_i2c_read(&bus, channels, sizeof(channels), readDone, NULL) == HAL_OK);
+	while (hal_host_runNext()) {}
+	TEST_CHECK(completions == 1 && busyInCallback && chained == HAL_BUSY);
+	for (uint8_t i = 0; i < 3; ++i) {
+		uint8_t reg = commandRegisters[channels[i]].address;
+		TEST_CHECK(results[i] == (registers[2 * reg] | registers[2 * reg + 1] << 8));
+	}
+	TEST_CHECK(!regmap_i2c_isBusy(&bus) && bus.transactions == 3);
+
+	//Started after the callback, the next read goes through
+	TEST_CHECK(regmap_i2c_read(&bus, control, sizeof(control), NULL, NULL) == HAL_OK);
+	while (hal_host_runNext()) {}
+	TEST_CHECK(regmap_i2c_raw(&bus, 0) == (registers[0] | registers[1] << 8) && bus.transactions == 4);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
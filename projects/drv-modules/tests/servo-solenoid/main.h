@@ -0,0 +1,22 @@
+/*
+ * main.h
+ *
+ * The part of the wingsail board's main.h used by SERVOSOLENOID.c, for the host build of servosolenoid_test.c.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+#include "stm32u5xx_hal.h"
+
+#define SolenoidOutput_Pin GPIO_PIN_0
+#define SolenoidOutput_GPIO_Port GPIOE
+
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
+
+void Error_Handler(void);
+
+#endif /* MAIN_H */
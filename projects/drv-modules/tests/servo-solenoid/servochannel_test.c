@@ -0,0 +1,180 @@
+/*
+ * servochannel_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "SERVOCHANNEL.h"
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+//-- Test definitions --
+#define BENCHMARK_ITERATIONS 10000000
+
+testresult servochannel_timer_config(void);
+testresult servochannel_compare_accuracy(void);
+testresult servochannel_reversed_and_clamped(void);
+testresult servochannel_multiple_channels(void);
+testresult servochannel_resolution(void);
+testresult servochannel_benchmark(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Timer configuration", .func=servochannel_timer_config, .group=SERVO},
+		{.testname="Compare values against a floating point reference", .func=servochannel_compare_accuracy, .group=SERVO},
+		{.testname="Reversed servo and clamping", .func=servochannel_reversed_and_clamped, .group=SERVO},
+		{.testname="Several channels on one timer", .func=servochannel_multiple_channels, .group=SERVO},
+		{.testname="Angle resolution", .func=servochannel_resolution, .group=SERVO},
+		{.testname="Compare value cost benchmark", .func=servochannel_benchmark, .group=SERVO}
+};
+
+// -- Helpers --
+//Exact pulse in timer ticks
+static double referenceTicks(const SERVOTIMER* timer, const SERVOCHANNEL* channel, int16_t angle) {
+	double pulseUs = channel->minPulseUs + (double)angle * (channel->maxPulseUs - channel->minPulseUs) / channel->maxAngle;
+	return pulseUs * timer->clockHz / (timer->prescaler + 1) / 1e6;
+}
+
+// -- Unit tests --
+testresult servochannel_timer_config(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+
+	//32-bit timer at 160 MHz: no prescaler needed
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF));
+	TEST_CHECK(timer.prescaler == 0 && timer.reload == 3199999 && timer.tickHz == 160000000);
+
+	//16-bit timer at 160 MHz: the smallest divider fitting 3.2 M ticks in 65536
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFF));
+	TEST_CHECK(timer.prescaler == 48 && timer.reload == 65305);
+
+	//4 MHz MSI on a 16-bit timer
+	TEST_CHECK(SERVOTIMER__configure(&timer, 4000000, 20000, 0xFFFF));
+	TEST_CHECK(timer.prescaler == 1 && timer.reload == 39999 && timer.tickHz == 2000000);
+
+	//The period of every configuration is within half a tick of the request
+	const uint32_t clocks[] = {4000000, 16000000, 48000000, 80000000, 110000000, 160000000};
+	for (uint8_t i = 0; i < sizeof(clocks) / sizeof(clocks[0]); ++i) {
+		TEST_CHECK(SERVOTIMER__configure(&timer, clocks[i], 20000, 0xFFFF));
+		TEST_CHECK(timer.reload <= 0xFFFF);
+		double periodUs = (timer.reload + 1.0) * (timer.prescaler + 1) * 1e6 / clocks[i];
+		TEST_CHECK(fabs(periodUs - 20000) <= 0.5 * (timer.prescaler + 1) * 1e6 / clocks[i]);
+	}
+
+	//Too long for the prescaler
+	TEST_CHECK(!SERVOTIMER__configure(&timer, 160000000, 60000000, 0xFFFF));
+	TEST_CHECK(SERVOTIMER__addChannel(&timer, 0, 1000, 2000, 1800) == SERVOTIMER_NO_CHANNEL);
+	return res;
+}
+
+testresult servochannel_compare_accuracy(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+	const uint32_t clocks[] = {4000000, 16000000, 48000000, 160000000};
+	const uint32_t reloads[] = {0xFFFF, 0xFFFFFFFF};
+
+	for (uint8_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); ++c) {
+		for (uint8_t r = 0; r < 2; ++r) {
+			TEST_CHECK(SERVOTIMER__configure(&timer, clocks[c], 20000, reloads[r]));
+			uint8_t index = SERVOTIMER__addChannel(&timer, 0, 560, 2560, 1800);
+			TEST_CHECK(index == 0);
+
+			uint32_t previous = 0;
+			for (int16_t angle = 0; angle <= 1800; ++angle) {
+				uint32_t compare = SERVOTIMER__compare(&timer, index, angle);
+				TEST_CHECK(fabs(compare - referenceTicks(&timer, &timer.channels[index], angle)) <= 1.0);
+				TEST_CHECK(compare >= previous);
+				previous = compare;
+			}
+		}
+	}
+	return res;
+}
+
+testresult servochannel_reversed_and_clamped(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF));
+	uint8_t forward = SERVOTIMER__addChannel(&timer, 0, 1000, 2000, 900);
+	uint8_t reversed = SERVOTIMER__addChannel(&timer, 1, 2000, 1000, 900);
+
+	for (int16_t angle = 0; angle <= 900; ++angle) {
+		TEST_CHECK(SERVOTIMER__compare(&timer, reversed, angle) == SERVOTIMER__compare(&timer, forward, 900 - angle));
+	}
+	TEST_CHECK(SERVOTIMER__compare(&timer, forward, 0) == 160000);
+	TEST_CHECK(SERVOTIMER__compare(&timer, forward, 900) == 320000);
+
+	TEST_CHECK(SERVOTIMER__setAngle(&timer, forward, -50) == 160000 && timer.channels[forward].angle == 0);
+	TEST_CHECK(SERVOTIMER__setAngle(&timer, forward, 2000) == 320000 && timer.channels[forward].angle == 900);
+
+	//Invalid ranges
+	TEST_CHECK(SERVOTIMER__addChannel(&timer, 2, 1500, 1500, 900) == SERVOTIMER_NO_CHANNEL);
+	TEST_CHECK(SERVOTIMER__addChannel(&timer, 2, 1000, 2000, 0) == SERVOTIMER_NO_CHANNEL);
+	TEST_CHECK(SERVOTIMER__addChannel(&timer, 2, 1000, 25000, 900) == SERVOTIMER_NO_CHANNEL);
+	return res;
+}
+
+testresult servochannel_multiple_channels(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF));
+
+	for (uint8_t i = 0; i < SERVOTIMER_MAX_CHANNELS; ++i) {
+		TEST_CHECK(SERVOTIMER__addChannel(&timer, 100 + i, 500 + 100 * i, 2500 - 100 * i, 1800) == i);
+	}
+	TEST_CHECK(SERVOTIMER__addChannel(&timer, 200, 1000, 2000, 1800) == SERVOTIMER_NO_CHANNEL);
+
+	//Channels are independent and parked at angle 0
+	for (uint8_t i = 0; i < SERVOTIMER_MAX_CHANNELS; ++i) {
+		TEST_CHECK(timer.channels[i].id == 100u + i && timer.channels[i].angle == 0);
+		TEST_CHECK(timer.channels[i].compare == (500u + 100 * i) * 160);
+	}
+	SERVOTIMER__setAngle(&timer, 2, 900);
+	TEST_CHECK(timer.channels[2].compare == 1500 * 160 && timer.channels[1].compare == 600 * 160);
+
+	//Reconfiguring removes the channels
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF) && timer.channelCount == 0);
+	return res;
+}
+
+testresult servochannel_resolution(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+
+	//160 MHz 32-bit: 2000 us over 1800 steps is 177.8 ticks per 0.1 degree
+	TEST_CHECK(SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF));
+	uint8_t index = SERVOTIMER__addChannel(&timer, 0, 560, 2560, 1800);
+	TEST_CHECK(SERVOTIMER__resolution(&timer, index) == 6);
+
+	//16 MHz 16-bit: divided by 5 to 3.2 MHz, 3.56 ticks per 0.1 degree
+	TEST_CHECK(SERVOTIMER__configure(&timer, 16000000, 20000, 0xFFFF));
+	TEST_CHECK(timer.prescaler == 4 && timer.tickHz == 3200000);
+	index = SERVOTIMER__addChannel(&timer, 0, 560, 2560, 1800);
+	TEST_CHECK(SERVOTIMER__resolution(&timer, index) == 281);
+	return res;
+}
+
+testresult servochannel_benchmark(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+	SERVOTIMER__configure(&timer, 160000000, 20000, 0xFFFFFFFF);
+	uint8_t index = SERVOTIMER__addChannel(&timer, 0, 560, 2560, 1800);
+
+	volatile uint32_t sink = 0;
+	clock_t start = clock();
+	for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i) {
+		sink += SERVOTIMER__setAngle(&timer, index, i % 1801);
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("%.1f ns per compare value\n", seconds * 1e9 / BENCHMARK_ITERATIONS);
+	(void)sink;
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
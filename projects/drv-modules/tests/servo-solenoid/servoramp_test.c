@@ -0,0 +1,223 @@
+/*
+ * servoramp_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "SERVORAMP.h"
+#include <math.h>
+#include <stdlib.h>
+
+//-- Test definitions --
+#define FRAME_US 20000
+#define MAX_RATE 600 //60 degrees/s in 0.1 degrees
+#define MAX_ACCELERATION 2400 //240 degrees/s^2
+#define RANDOM_RUNS 500
+#define MAX_FRAMES 5000
+
+testresult servoramp_config(void);
+testresult servoramp_rest_to_rest(void);
+testresult servoramp_short_moves(void);
+testresult servoramp_reverse(void);
+testresult servoramp_fill_rewind(void);
+testresult servoramp_random_retargets(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Rate and acceleration per frame", .func=servoramp_config, .group=SERVO},
+		{.testname="Full range move profile", .func=servoramp_rest_to_rest, .group=SERVO},
+		{.testname="Short moves", .func=servoramp_short_moves, .group=SERVO},
+		{.testname="Reversing during a move", .func=servoramp_reverse, .group=SERVO},
+		{.testname="DMA buffer fill and rewind", .func=servoramp_fill_rewind, .group=SERVO},
+		{.testname="Random retargets stay within the limits", .func=servoramp_random_retargets, .group=SERVO}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x5EED5EED;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Steps a ramp to its target, checking the limits on every frame. Returns the number of frames or -1 on a violation.
+static int32_t runChecked(SERVORAMP* ramp, uint8_t allowOvershoot) {
+	int32_t target = (int32_t)ramp->target << SERVORAMP_FRACTION_BITS;
+	int32_t startSide = ramp->position < target ? -1 : 1;
+	int32_t frames = 0;
+
+	while (!SERVORAMP__done(ramp)) {
+		int32_t velocity = ramp->velocity;
+		if (!SERVORAMP__step(ramp) || ++frames > MAX_FRAMES) return -1;
+		if (abs(ramp->velocity) > ramp->maxVelocity) return -1;
+		if (abs(ramp->velocity - velocity) > ramp->maxAcceleration) return -1;
+		if (!allowOvershoot && ramp->position != target && (ramp->position < target ? -1 : 1) != startSide) return -1;
+	}
+	return frames;
+}
+
+//Frames of a continuous trapezoid or triangle profile
+static double idealFrames(const SERVORAMP* ramp, double distance) {
+	double v = ramp->maxVelocity, a = ramp->maxAcceleration;
+	distance *= 1 << SERVORAMP_FRACTION_BITS;
+	if (distance >= v * v / a) return distance / v + v / a;
+	return 2 * sqrt(distance / a);
+}
+
+// -- Unit tests --
+testresult servoramp_config(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVORAMP ramp;
+	SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 900);
+
+	//12 units per frame, 0.96 units per frame squared (Q8)
+	TEST_CHECK(ramp.maxVelocity == 3072 && ramp.maxAcceleration == 245);
+	TEST_CHECK(SERVORAMP__done(&ramp) && SERVORAMP__position(&ramp) == 900 && SERVORAMP__framesLeft(&ramp) == 0);
+	TEST_CHECK(!SERVORAMP__step(&ramp));
+
+	//A very low acceleration never rounds to zero
+	SERVORAMP__init(&ramp, 1, 1, FRAME_US, 0);
+	TEST_CHECK(ramp.maxVelocity == 5 && ramp.maxAcceleration == 1);
+	return res;
+}
+
+testresult servoramp_rest_to_rest(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVORAMP ramp;
+
+	SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 0);
+	SERVORAMP__setTarget(&ramp, 1800);
+	uint32_t expected = SERVORAMP__framesLeft(&ramp);
+
+	//The full range reaches the rate limit, so 3 s of cruise plus 0.25 s of acceleration
+	int32_t frames = runChecked(&ramp, 0);
+	TEST_CHECK(frames > 0 && (uint32_t)frames == expected);
+	TEST_CHECK(fabs(frames - idealFrames(&ramp, 1800)) <= 3);
+	TEST_CHECK(SERVORAMP__position(&ramp) == 1800 && ramp.velocity == 0);
+
+	//And back
+	SERVORAMP__setTarget(&ramp, 0);
+	TEST_CHECK(runChecked(&ramp, 0) == frames);
+	return res;
+}
+
+testresult servoramp_short_moves(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVORAMP ramp;
+
+	for (int16_t distance = 1; distance <= 400; ++distance) {
+		SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 700);
+		SERVORAMP__setTarget(&ramp, 700 + distance);
+		int32_t frames = runChecked(&ramp, 0);
+		TEST_CHECK(frames > 0);
+		TEST_CHECK(fabs(frames - idealFrames(&ramp, distance)) <= 3);
+		TEST_CHECK(SERVORAMP__position(&ramp) == 700 + distance);
+	}
+	return res;
+}
+
+testresult servoramp_reverse(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVORAMP ramp;
+	SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 0);
+
+	//Reverse at full rate: the ramp brakes, passes the new target and comes back
+	SERVORAMP__setTarget(&ramp, 1800);
+	for (uint8_t i = 0; i < 50; ++i) SERVORAMP__step(&ramp);
+	TEST_CHECK(ramp.velocity == ramp.maxVelocity);
+	int16_t reversedAt = SERVORAMP__position(&ramp);
+	SERVORAMP__setTarget(&ramp, reversedAt - 10);
+
+	int16_t furthest = reversedAt;
+	while (!SERVORAMP__done(&ramp)) {
+		int32_t velocity = ramp.velocity;
+		SERVORAMP__step(&ramp);
+		TEST_CHECK(abs(ramp.velocity - velocity) <= ramp.maxAcceleration);
+		if (SERVORAMP__position(&ramp) > furthest) furthest = SERVORAMP__position(&ramp);
+	}
+	TEST_CHECK(SERVORAMP__position(&ramp) == reversedAt - 10);
+
+	//Stopping from 12 units per frame with 0.96 per frame squared takes about 75 units
+	TEST_CHECK(furthest > reversedAt + 60 && furthest < reversedAt + 90);
+	return res;
+}
+
+testresult servoramp_fill_rewind(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOTIMER timer;
+	SERVOTIMER__configure(&timer, 160000000, FRAME_US, 0xFFFFFFFF);
+	uint8_t channel = SERVOTIMER__addChannel(&timer, 0, 560, 2560, 1800);
+
+	SERVORAMP ramp, reference;
+	SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 300);
+	SERVORAMP__setTarget(&ramp, 1500);
+	reference = ramp;
+	uint32_t buffer[32];
+	uint32_t total = SERVORAMP__framesLeft(&ramp);
+
+	//Chunks hold the same compare values as stepping frame by frame, the last one on the target
+	uint32_t frames = 0;
+	uint16_t count;
+	while ((count = SERVORAMP__fill(&ramp, &timer, channel, buffer, 32)) > 0) {
+		for (uint16_t i = 0; i < count; ++i) {
+			TEST_CHECK(SERVORAMP__step(&reference));
+			TEST_CHECK(buffer[i] == SERVOTIMER__compare(&timer, channel, SERVORAMP__position(&reference)));
+		}
+		frames += count;
+		TEST_CHECK(count == 32 || SERVORAMP__done(&ramp));
+	}
+	TEST_CHECK(frames == total && buffer[(total - 1) % 32] == SERVOTIMER__compare(&timer, channel, 1500));
+
+	//Rewinding to any frame of a chunk gives the state of that frame
+	SERVORAMP__init(&ramp, MAX_RATE, MAX_ACCELERATION, FRAME_US, 300);
+	SERVORAMP__setTarget(&ramp, 1500);
+	SERVORAMP__fill(&ramp, &timer, channel, buffer, 32);
+	for (uint16_t used = 0; used <= 32; ++used) {
+		SERVORAMP__rewind(&ramp, used);
+		reference = ramp;
+		SERVORAMP__rewind(&reference, 0);
+		for (uint16_t i = 0; i < used; ++i) SERVORAMP__step(&reference);
+		TEST_CHECK(ramp.position == reference.position && ramp.velocity == reference.velocity);
+		TEST_CHECK(used == 0 || SERVOTIMER__compare(&timer, channel, SERVORAMP__position(&ramp)) == buffer[used - 1]);
+	}
+	return res;
+}
+
+testresult servoramp_random_retargets(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVORAMP ramp;
+
+	for (uint32_t run = 0; run < RANDOM_RUNS; ++run) {
+		uint32_t rate = 100 + rng() % 3000;
+		uint32_t acceleration = 200 + rng() % 20000;
+		SERVORAMP__init(&ramp, rate, acceleration, FRAME_US, rng() % 1801);
+
+		//Retarget after a random number of frames, as a DMA stop and rewind would
+		uint8_t retargets = 1 + rng() % 8;
+		for (uint8_t i = 0; i < retargets; ++i) {
+			SERVORAMP__setTarget(&ramp, rng() % 1801);
+			uint32_t frames = rng() % 100;
+			for (uint32_t f = 0; f < frames; ++f) {
+				int32_t velocity = ramp.velocity;
+				SERVORAMP__step(&ramp);
+				TEST_CHECK(abs(ramp.velocity) <= ramp.maxVelocity);
+				TEST_CHECK(abs(ramp.velocity - velocity) <= ramp.maxAcceleration);
+			}
+		}
+
+		uint32_t expected = SERVORAMP__framesLeft(&ramp);
+		int32_t frames = runChecked(&ramp, 1);
+		TEST_CHECK(frames >= 0 && (uint32_t)frames == expected);
+		TEST_CHECK(SERVORAMP__position(&ramp) == ramp.target);
+	}
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
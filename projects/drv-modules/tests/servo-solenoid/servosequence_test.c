@@ -0,0 +1,271 @@
+/*
+ * servosequence_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "SERVOSEQUENCE.h"
+
+//-- Test definitions --
+#define STORM_RUNS 2000
+
+testresult servosequence_full_sequence(void);
+testresult servosequence_merge_release(void);
+testresult servosequence_merge_move(void);
+testresult servosequence_merge_hold_lock(void);
+testresult servosequence_already_there(void);
+testresult servosequence_move_time(void);
+testresult servosequence_command_storm(void);
+testresult servosequence_can_status(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Release, move, hold and lock", .func=servosequence_full_sequence, .group=SERVO},
+		{.testname="Commands during release use the latest", .func=servosequence_merge_release, .group=SERVO},
+		{.testname="Commands during a move extend it, repeats do not", .func=servosequence_merge_move, .group=SERVO},
+		{.testname="Commands during hold and lock move again", .func=servosequence_merge_hold_lock, .group=SERVO},
+		{.testname="Command to the current position", .func=servosequence_already_there, .group=SERVO},
+		{.testname="Move time set by a ramp", .func=servosequence_move_time, .group=SERVO},
+		{.testname="Random command storms end on the last command", .func=servosequence_command_storm, .group=SERVO},
+		{.testname="CAN status", .func=servosequence_can_status, .group=SERVO}
+};
+
+// -- Helpers --
+static const SERVOSEQUENCE_TIMING timing = {.releaseMs = 1000, .msPer10Degrees = 30, .holdMs = 400, .lockMs = 200};
+
+static uint32_t rngState = 0x0BADCAFE;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//Runs the sequencer until it is idle, as the state timer would
+static uint32_t runToIdle(SERVOSEQUENCE* sequence, uint32_t now) {
+	while (sequence->state != SERVOSEQUENCE_IDLE) {
+		now += SERVOSEQUENCE__remaining(sequence, now);
+		SERVOSEQUENCE__update(sequence, now);
+	}
+	return now;
+}
+
+// -- Unit tests --
+testresult servosequence_full_sequence(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 900, 0);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_RELEASE && sequence.solenoid && !sequence.pwm);
+	TEST_CHECK(SERVOSEQUENCE__takeChanged(&sequence) && !SERVOSEQUENCE__takeChanged(&sequence));
+
+	TEST_CHECK(!SERVOSEQUENCE__update(&sequence, 999));
+	TEST_CHECK(SERVOSEQUENCE__update(&sequence, 1000));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_MOVE && sequence.solenoid && sequence.pwm);
+
+	//Unknown start position: 90 degrees either way at 30 ms per 10 degrees
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 1000) == 270);
+	TEST_CHECK(SERVOSEQUENCE__update(&sequence, 1270));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_HOLD && sequence.pwm);
+
+	TEST_CHECK(SERVOSEQUENCE__update(&sequence, 1670));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_LOCK && !sequence.solenoid && !sequence.pwm);
+	TEST_CHECK(sequence.positionKnown && sequence.position == 900);
+
+	TEST_CHECK(SERVOSEQUENCE__update(&sequence, 1870));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_IDLE && sequence.completed == 1);
+	TEST_CHECK(!SERVOSEQUENCE__update(&sequence, 5000));
+
+	//Known position: only the distance is moved
+	SERVOSEQUENCE__command(&sequence, 1200, 10000);
+	SERVOSEQUENCE__update(&sequence, 11000);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 11000) == 90);
+
+	//Out of range angles are clamped
+	SERVOSEQUENCE__command(&sequence, 2500, 11000);
+	TEST_CHECK(sequence.target == SERVOSEQUENCE_MAX_ANGLE);
+	return res;
+}
+
+testresult servosequence_merge_release(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 300, 0);
+	SERVOSEQUENCE__command(&sequence, 600, 200);
+	SERVOSEQUENCE__command(&sequence, 450, 400);
+
+	//The release is not restarted
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_RELEASE && SERVOSEQUENCE__remaining(&sequence, 400) == 600);
+	TEST_CHECK(sequence.target == 450 && sequence.commands == 3 && sequence.merged == 2);
+
+	runToIdle(&sequence, 400);
+	TEST_CHECK(sequence.position == 450 && sequence.completed == 1);
+	return res;
+}
+
+testresult servosequence_merge_move(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 900, 0);
+	runToIdle(&sequence, 0);
+
+	//Move from 90 to 120 degrees (90 ms), then to 60 degrees half way
+	SERVOSEQUENCE__command(&sequence, 1200, 10000);
+	SERVOSEQUENCE__update(&sequence, 11000);
+	SERVOSEQUENCE__command(&sequence, 600, 11045);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_MOVE && sequence.target == 600);
+
+	//The servo can be anywhere from 90 to 120 degrees, so 60 degrees away at worst
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 11045) == 180);
+	TEST_CHECK(sequence.spanLow == 600 && sequence.spanHigh == 1200);
+
+	//The same target sent again faster than the move takes does not push the end of the move back
+	for (uint32_t now = 11095; now < 11225; now += 50) {
+		SERVOSEQUENCE__command(&sequence, 600, now);
+		TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, now) == 11225 - now);
+	}
+	TEST_CHECK(!SERVOSEQUENCE__update(&sequence, 11224) && SERVOSEQUENCE__update(&sequence, 11225));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_HOLD);
+
+	runToIdle(&sequence, 11225);
+	TEST_CHECK(sequence.position == 600 && sequence.completed == 2);
+	return res;
+}
+
+testresult servosequence_merge_hold_lock(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 900, 0);
+	SERVOSEQUENCE__update(&sequence, 1000);
+	SERVOSEQUENCE__update(&sequence, 1270);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_HOLD);
+
+	//Same target while holding changes nothing, another one moves from the held angle
+	SERVOSEQUENCE__command(&sequence, 900, 1300);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_HOLD);
+	SERVOSEQUENCE__command(&sequence, 1000, 1300);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_MOVE && sequence.pwm && SERVOSEQUENCE__remaining(&sequence, 1300) == 30);
+
+	SERVOSEQUENCE__update(&sequence, 1330);
+	SERVOSEQUENCE__update(&sequence, 1730);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_LOCK && sequence.position == 1000);
+
+	//The same target again lets the lock go on, the pin is not released
+	uint32_t remaining = SERVOSEQUENCE__remaining(&sequence, 1750);
+	SERVOSEQUENCE__command(&sequence, 1000, 1750);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_LOCK && !sequence.solenoid && !sequence.pwm);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 1750) == remaining);
+
+	//During the lock the pin is released again before moving
+	SERVOSEQUENCE__command(&sequence, 200, 1800);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_RELEASE && sequence.solenoid && !sequence.pwm);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 1800) == 1000);
+
+	SERVOSEQUENCE__update(&sequence, 2800);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 2800) == 240);
+	runToIdle(&sequence, 2800);
+	TEST_CHECK(sequence.position == 200 && sequence.completed == 1);
+	return res;
+}
+
+testresult servosequence_already_there(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 900, 0);
+	runToIdle(&sequence, 0);
+	SERVOSEQUENCE__takeChanged(&sequence);
+
+	SERVOSEQUENCE__command(&sequence, 900, 5000);
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_IDLE && !sequence.solenoid);
+	TEST_CHECK(sequence.completed == 2 && SERVOSEQUENCE__takeChanged(&sequence));
+	return res;
+}
+
+testresult servosequence_move_time(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	//Ignored outside a move
+	SERVOSEQUENCE__command(&sequence, 900, 0);
+	SERVOSEQUENCE__setMoveTime(&sequence, 0, 5000);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 0) == 1000);
+
+	SERVOSEQUENCE__update(&sequence, 1000);
+	SERVOSEQUENCE__setMoveTime(&sequence, 1000, 3260);
+	TEST_CHECK(SERVOSEQUENCE__remaining(&sequence, 1000) == 3260);
+	TEST_CHECK(!SERVOSEQUENCE__update(&sequence, 4259) && SERVOSEQUENCE__update(&sequence, 4260));
+	TEST_CHECK(sequence.state == SERVOSEQUENCE_HOLD);
+	return res;
+}
+
+testresult servosequence_command_storm(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+
+	for (uint32_t run = 0; run < STORM_RUNS; ++run) {
+		SERVOSEQUENCE__init(&sequence, &timing);
+		uint32_t now = rng() % 1000;
+		int16_t last = 0;
+		uint8_t commands = 1 + rng() % 20;
+
+		for (uint8_t i = 0; i < commands; ++i) {
+			last = rng() % 1801;
+			SERVOSEQUENCE__command(&sequence, last, now);
+
+			//Advance a random time, firing the state timer on the way
+			uint32_t until = now + rng() % 1500;
+			while (sequence.state != SERVOSEQUENCE_IDLE && now + SERVOSEQUENCE__remaining(&sequence, now) <= until) {
+				now += SERVOSEQUENCE__remaining(&sequence, now);
+				SERVOSEQUENCE__update(&sequence, now);
+
+				//The servo is only driven with the pin released
+				TEST_CHECK(!sequence.pwm || sequence.solenoid);
+				TEST_CHECK(sequence.state != SERVOSEQUENCE_MOVE || (sequence.target >= sequence.spanLow && sequence.target <= sequence.spanHigh));
+			}
+			now = until;
+		}
+
+		runToIdle(&sequence, now);
+		TEST_CHECK(sequence.position == last && sequence.positionKnown);
+		TEST_CHECK(!sequence.pwm && !sequence.solenoid);
+		TEST_CHECK(sequence.completed >= 1 && sequence.completed <= commands);
+	}
+	return res;
+}
+
+testresult servosequence_can_status(void) {
+	testresult res = {TSUCCESS, {0}};
+	SERVOSEQUENCE sequence;
+	uint8_t data[SERVOSEQUENCE_CAN_PAYLOAD_SIZE];
+	SERVOSEQUENCE__init(&sequence, &timing);
+
+	SERVOSEQUENCE__command(&sequence, 1234, 0);
+	SERVOSEQUENCE__packCAN(&sequence, data);
+	TEST_CHECK(data[0] == SERVOSEQUENCE_RELEASE && data[1] == SERVOSEQUENCE_BUSY);
+	TEST_CHECK(data[2] == (1234 & 0xFF) && data[3] == (1234 >> 8));
+
+	runToIdle(&sequence, 0);
+	SERVOSEQUENCE__packCAN(&sequence, data);
+	TEST_CHECK(data[0] == SERVOSEQUENCE_IDLE && data[1] == SERVOSEQUENCE_POSITION_KNOWN);
+	TEST_CHECK(data[4] == (1234 & 0xFF) && data[5] == (1234 >> 8));
+	TEST_CHECK(data[6] == 1 && data[7] == 0);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,128 @@
+/*
+ * servosolenoid_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "hal_host.h"
+#include "SERVOSOLENOID.h"
+
+//-- Test definitions --
+testresult servosolenoid_repeat_during_ramp(void);
+testresult servosolenoid_retarget_during_ramp(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Repeated command during a ramp", .func=servosolenoid_repeat_during_ramp, .group=SERVO},
+		{.testname="New target during a ramp", .func=servosolenoid_retarget_during_ramp, .group=SERVO}
+};
+
+// -- Helpers --
+//Called by the driver on the board
+static uint32_t errors;
+
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim) {
+}
+
+void Error_Handler(void) {
+	errors++;
+}
+
+//The wingsail servo as the driver sets it up on a 160 MHz TIM2
+static SERVOTIMER servoTimer;
+
+static void setup(void) {
+	hal_host_reset();
+	errors = 0;
+	SERVOTIMER__configure(&servoTimer, 160000000, SERVOSOLENOID_FRAME_US, 0xFFFFFFFF);
+	SERVOTIMER__addChannel(&servoTimer, TIM_CHANNEL_3, SERVOSOLENOID_PULSE_MIN_US, SERVOSOLENOID_PULSE_MAX_US, SERVOSEQUENCE_MAX_ANGLE);
+	initializeServoSolenoid();
+}
+
+static void advanceTo(uint32_t ms) {
+	hal_host_advance(HAL_HOST_MS(ms) - hal_host_now());
+}
+
+//Ramp of the driver between two angles, in frames
+static uint32_t rampFrames(int16_t from, int16_t to) {
+	SERVORAMP ramp;
+	SERVORAMP__init(&ramp, SERVOSOLENOID_MAX_RATE, SERVOSOLENOID_MAX_ACCELERATION, SERVOSOLENOID_FRAME_US, from);
+	SERVORAMP__setTarget(&ramp, to);
+	return SERVORAMP__framesLeft(&ramp);
+}
+
+//The pulse of the wingsail servo is at an angle and no frame is left to stream
+static uint8_t pulseAt(int16_t angle) {
+	return TIM2->CCR3 == SERVOTIMER__compare(&servoTimer, 0, angle) && hdma_tim2_up.State != HAL_DMA_STATE_BUSY;
+}
+
+//First sequence to 0 degrees, the servo jumps there and the position is known from then on
+static void moveToZero(void) {
+	setServoTarget(0);
+	advanceTo(3000);
+}
+
+// -- Unit tests --
+testresult servosolenoid_repeat_during_ramp(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	moveToZero();
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_IDLE && pulseAt(0));
+
+	//After the release the move lasts as long as the ramp, a frame more for the last one to be output
+	setServoTarget(900);
+	advanceTo(4000);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_MOVE);
+	uint32_t moveEnd = 4000 + (rampFrames(0, 900) + 1) * SERVOSOLENOID_FRAME_US / 1000;
+	TEST_CHECK(moveEnd > 5500);
+
+	//Repeating the command does not shorten the move to the estimate of the sequencer (270 ms) or extend it
+	for (uint32_t now = 4100; now < moveEnd; now += 100) {
+		advanceTo(now);
+		setServoTarget(900);
+		TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_MOVE && HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_0) == GPIO_PIN_SET);
+	}
+	advanceTo(moveEnd - 1);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_MOVE && pulseAt(900));
+	advanceTo(moveEnd);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_HOLD);
+
+	//The pin engages with the servo on the target
+	advanceTo(moveEnd + SERVOSOLENOID_HOLD_MS);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_LOCK && pulseAt(900));
+	TEST_CHECK(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_0) == GPIO_PIN_RESET);
+	advanceTo(moveEnd + SERVOSOLENOID_HOLD_MS + SERVOSOLENOID_LOCK_MS);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_IDLE && errors == 0);
+	return res;
+}
+
+testresult servosolenoid_retarget_during_ramp(void) {
+	testresult res = {TSUCCESS, {0}};
+	setup();
+	moveToZero();
+
+	//Half way to 90 degrees, back to 30 degrees: the ramp brakes and reverses, the move follows it to the end
+	setServoTarget(900);
+	advanceTo(4800);
+	setServoTarget(300);
+	uint32_t arrived = 0;
+	while (getServoSolenoidState() == SERVOSEQUENCE_MOVE && hal_host_now() < HAL_HOST_MS(10000)) {
+		hal_host_advance(HAL_HOST_MS(1));
+		if (arrived == 0 && pulseAt(300)) {
+			arrived = HAL_GetTick();
+		}
+	}
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_HOLD && pulseAt(300));
+	TEST_CHECK(arrived > 4800 && HAL_GetTick() - arrived <= 2 * SERVOSOLENOID_FRAME_US / 1000);
+
+	advanceTo(HAL_GetTick() + SERVOSOLENOID_HOLD_MS + SERVOSOLENOID_LOCK_MS);
+	TEST_CHECK(getServoSolenoidState() == SERVOSEQUENCE_IDLE && pulseAt(300) && errors == 0);
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,211 @@
+/*
+ * supervisor_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "test_engine.h"
+#include "supervisor.h"
+#include <stddef.h>
+
+//-- Test definitions --
+#define POLL_MS 10
+#define LOOP_DEADLINE 100
+#define SENSOR_DEADLINE 1000
+
+testresult supervisor_healthy_tasks(void);
+testresult supervisor_missed_deadline(void);
+testresult supervisor_report_after_reset(void);
+testresult supervisor_power_on_record(void);
+testresult supervisor_time_edges(void);
+testresult supervisor_table_full(void);
+
+// -- Add to test runner here --
+const t_test test_runner[] = {
+//		{"Name of test", "function definition", "testgroup id"
+		{.testname="Healthy tasks keep the watchdog refreshed", .func=supervisor_healthy_tasks, .group=WATCHDOG},
+		{.testname="Missed deadline latches and records the task", .func=supervisor_missed_deadline, .group=WATCHDOG},
+		{.testname="Record reported after a watchdog reset", .func=supervisor_report_after_reset, .group=WATCHDOG},
+		{.testname="Random or corrupted record is ignored", .func=supervisor_power_on_record, .group=WATCHDOG},
+		{.testname="Tick wrap and check-ins after the poll time", .func=supervisor_time_edges, .group=WATCHDOG},
+		{.testname="Task table limit", .func=supervisor_table_full, .group=WATCHDOG}
+};
+
+// -- Helpers --
+static uint32_t rngState = 0x5EED5EED;
+
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//The no-init record starts as whatever was in RAM
+static SUPERVISOR_RECORD record;
+
+static void randomRecord(void) {
+	uint8_t* bytes = (uint8_t*)&record;
+	for (uint8_t i = 0; i < sizeof(record); ++i) bytes[i] = rng();
+}
+
+//Runs a control loop and a sensor task until the supervisor stops refreshing or the time is up, returns the time
+static uint32_t run(SUPERVISOR* supervisor, uint32_t now, uint32_t until, uint32_t loopHangAt, uint8_t* refreshed) {
+	uint8_t loop = 0, sensor = 1;
+	uint32_t nextSensor = now;
+	*refreshed = 1;
+	for (; now < until; now += POLL_MS) {
+		if (now < loopHangAt) supervisor_checkIn(supervisor, loop, now - rng() % POLL_MS);
+		if (now >= nextSensor) {
+			supervisor_checkIn(supervisor, sensor, now);
+			nextSensor = now + 200 + rng() % 600;
+		}
+		if (!supervisor_poll(supervisor, now)) {
+			*refreshed = 0;
+			return now;
+		}
+	}
+	return now;
+}
+
+// -- Unit tests --
+testresult supervisor_healthy_tasks(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	uint8_t refreshed;
+	randomRecord();
+	supervisor_init(&supervisor, &record, 0, NULL);
+
+	TEST_CHECK(supervisor_addTask(&supervisor, LOOP_DEADLINE, 0) == 0);
+	TEST_CHECK(supervisor_addTask(&supervisor, SENSOR_DEADLINE, 0) == 1);
+	run(&supervisor, 0, 600000, 0xFFFFFFFF, &refreshed);
+	TEST_CHECK(refreshed && !supervisor.latched && record.task == SUPERVISOR_NO_TASK);
+	return res;
+}
+
+testresult supervisor_missed_deadline(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	uint8_t refreshed;
+	randomRecord();
+	supervisor_init(&supervisor, &record, 0, NULL);
+	supervisor_addTask(&supervisor, LOOP_DEADLINE, 0);
+	supervisor_addTask(&supervisor, SENSOR_DEADLINE, 0);
+
+	//The control loop hangs in a blocking call at 5 s, found by the first poll after its deadline
+	uint32_t stoppedAt = run(&supervisor, 0, 20000, 5000, &refreshed);
+	TEST_CHECK(!refreshed && stoppedAt >= 5000 + LOOP_DEADLINE - POLL_MS && stoppedAt <= 5000 + LOOP_DEADLINE + POLL_MS);
+	TEST_CHECK(record.task == 0 && record.lateMs > LOOP_DEADLINE && record.uptimeMs == stoppedAt);
+
+	//Latched: a late check-in does not bring the refreshes back and the record is kept
+	supervisor_checkIn(&supervisor, 0, stoppedAt);
+	TEST_CHECK(!supervisor_poll(&supervisor, stoppedAt + POLL_MS));
+	TEST_CHECK(record.task == 0 && record.uptimeMs == stoppedAt);
+	return res;
+}
+
+testresult supervisor_report_after_reset(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	SUPERVISOR_BOOT boot;
+	randomRecord();
+	supervisor_init(&supervisor, &record, 0, &boot);
+	TEST_CHECK(!boot.watchdogReset && boot.task == SUPERVISOR_NO_TASK && boot.watchdogResets == 0);
+
+	//Three runs where the sensor task stops, each followed by a watchdog reset
+	for (uint32_t i = 1; i <= 3; ++i) {
+		supervisor_addTask(&supervisor, LOOP_DEADLINE, 0);
+		supervisor_addTask(&supervisor, SENSOR_DEADLINE, 0);
+		uint32_t now = 0;
+		for (; supervisor_poll(&supervisor, now); now += POLL_MS) supervisor_checkIn(&supervisor, 0, now);
+		TEST_CHECK(now == SENSOR_DEADLINE + POLL_MS);
+
+		supervisor_init(&supervisor, &record, 1, &boot);
+		TEST_CHECK(boot.watchdogReset && boot.task == 1 && boot.lateMs == SENSOR_DEADLINE + POLL_MS);
+		TEST_CHECK(boot.uptimeMs == now && boot.watchdogResets == i);
+
+		//Cleared for this run, the count stays
+		TEST_CHECK(record.task == SUPERVISOR_NO_TASK && record.watchdogResets == i && supervisor.count == 0);
+	}
+
+	//A watchdog reset without a late task: interrupts were blocked, the poll never ran
+	supervisor_init(&supervisor, &record, 1, &boot);
+	TEST_CHECK(boot.watchdogReset && boot.task == SUPERVISOR_NO_TASK && boot.watchdogResets == 4);
+
+	//Another reset cause keeps the count but reports nothing
+	supervisor_init(&supervisor, &record, 0, &boot);
+	TEST_CHECK(!boot.watchdogReset && boot.task == SUPERVISOR_NO_TASK && boot.watchdogResets == 4);
+	return res;
+}
+
+testresult supervisor_power_on_record(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	SUPERVISOR_BOOT boot;
+
+	//Random RAM is never taken for a record, even after a watchdog reset
+	for (uint32_t i = 0; i < 100000; ++i) {
+		randomRecord();
+		if (i & 1) record.magic = SUPERVISOR_RECORD_MAGIC;
+		supervisor_init(&supervisor, &record, 1, &boot);
+		TEST_CHECK(boot.task == SUPERVISOR_NO_TASK && boot.watchdogResets == 0);
+	}
+
+	//Any single flipped bit of a valid record is detected
+	SUPERVISOR_RECORD valid;
+	supervisor_addTask(&supervisor, LOOP_DEADLINE, 0);
+	supervisor_poll(&supervisor, 1000);
+	valid = record;
+	for (uint16_t bit = 0; bit < 8 * offsetof(SUPERVISOR_RECORD, check); ++bit) {
+		record = valid;
+		((uint8_t*)&record)[bit / 8] ^= 1 << (bit % 8);
+		supervisor_init(&supervisor, &record, 1, &boot);
+		TEST_CHECK(boot.task == SUPERVISOR_NO_TASK && boot.watchdogResets == 0);
+	}
+	record = valid;
+	supervisor_init(&supervisor, &record, 1, &boot);
+	TEST_CHECK(boot.task == 0 && boot.watchdogResets == 1);
+	return res;
+}
+
+testresult supervisor_time_edges(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	supervisor_init(&supervisor, &record, 0, NULL);
+
+	//Across the 32 bit tick wrap
+	uint32_t now = 0xFFFFFFFF - 50;
+	uint8_t task = supervisor_addTask(&supervisor, LOOP_DEADLINE, now);
+	TEST_CHECK(supervisor_poll(&supervisor, now + LOOP_DEADLINE));
+	supervisor_checkIn(&supervisor, task, now + LOOP_DEADLINE);
+	TEST_CHECK(supervisor_poll(&supervisor, now + 2 * LOOP_DEADLINE));
+
+	//A check-in from an interrupt that read the tick after the poll did
+	supervisor_checkIn(&supervisor, task, now + 2 * LOOP_DEADLINE + 1);
+	TEST_CHECK(supervisor_poll(&supervisor, now + 2 * LOOP_DEADLINE));
+
+	TEST_CHECK(!supervisor_poll(&supervisor, now + 3 * LOOP_DEADLINE + 2));
+	TEST_CHECK(record.task == task && record.lateMs == LOOP_DEADLINE + 1);
+
+	//Check-ins of unknown tasks are ignored
+	supervisor_checkIn(&supervisor, SUPERVISOR_NO_TASK, 0);
+	return res;
+}
+
+testresult supervisor_table_full(void) {
+	testresult res = {TSUCCESS, {0}};
+	SUPERVISOR supervisor;
+	supervisor_init(&supervisor, &record, 0, NULL);
+	for (uint8_t i = 0; i < SUPERVISOR_MAX_TASKS; ++i) TEST_CHECK(supervisor_addTask(&supervisor, 10, 0) == i);
+	TEST_CHECK(supervisor_addTask(&supervisor, 10, 0) == SUPERVISOR_NO_TASK);
+
+	//No tasks: always refreshed
+	supervisor_init(&supervisor, &record, 0, NULL);
+	TEST_CHECK(supervisor_poll(&supervisor, 123456));
+	return res;
+}
+
+int main(void) {
+	return test_main(test_runner, sizeof(test_runner) / sizeof(t_test));
+}
@@ -0,0 +1,32 @@
+/*
+ * uconfig.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef UCONFIG_H_
+#define UCONFIG_H_
+
+typedef enum {
+	ALL,
+	WIND,
+	BNO055,
+	REGMAP,
+	SERVO,
+	ERRLOG,
+	I2C,
+	WATCHDOG,
+	CRASH,
+	PROFILING,
+	LOAD,
+	MEMORY,
+	POOL,
+	HAL_HOST,
+	ENCODER,
+	MOTOR
+} testgroup;
+
+#define TEST_GROUP_SEL ALL
+
+#endif /* UCONFIG_H_ */
@@ -0,0 +1,77 @@
+/*
+ * cpuload.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "cpuload.h"
+
+static void closeWindow(CPULOAD* self){
+	uint32_t idle = 0;
+	for(uint8_t state = CPULOAD_SLEEP; state < CPULOAD_STATES; state++){
+		uint32_t ticks = self->idle[state] < self->windowTicks - idle ? self->idle[state] : self->windowTicks - idle;
+		idle += ticks;
+		self->residency[state] = (uint16_t)((uint64_t)ticks * CPULOAD_SCALE / self->windowTicks);
+		self->idle[state] = 0;
+	}
+	// The rounding goes to the load so that the residencies add up to the whole window
+	uint16_t load = CPULOAD_SCALE;
+	for(uint8_t state = CPULOAD_SLEEP; state < CPULOAD_STATES; state++){
+		load -= self->residency[state];
+	}
+	self->residency[CPULOAD_RUN] = load;
+	if(load > self->peakLoad){
+		self->peakLoad = load;
+	}
+	self->windows++;
+	self->windowStart += self->windowTicks;
+}
+
+void cpuload_init(CPULOAD* self, uint32_t windowTicks, uint32_t now){
+	*self = (CPULOAD){.windowTicks = windowTicks > 0 ? windowTicks : 1, .windowStart = now};
+}
+
+uint32_t cpuload_update(CPULOAD* self, uint32_t now){
+	uint32_t closed = 0;
+	while(now - self->windowStart >= self->windowTicks && (int32_t)(now - self->windowStart) > 0){
+		closeWindow(self);
+		closed++;
+	}
+	return closed;
+}
+
+void cpuload_idle(CPULOAD* self, CPULOAD_STATE state, uint32_t start, uint32_t end){
+	if(state <= CPULOAD_RUN || state >= CPULOAD_STATES || (int32_t)(end - start) <= 0){
+		return;
+	}
+	cpuload_update(self, start);
+	if((int32_t)(start - self->windowStart) < 0){
+		start = self->windowStart; // the start belongs to a window already closed
+	}
+	while(end - self->windowStart >= self->windowTicks){
+		uint32_t windowEnd = self->windowStart + self->windowTicks;
+		self->idle[state] += windowEnd - start;
+		start = windowEnd;
+		closeWindow(self);
+	}
+	self->idle[state] += end - start;
+}
+
+uint16_t cpuload_load(const CPULOAD* self){
+	return self->residency[CPULOAD_RUN];
+}
+
+uint16_t cpuload_residency(const CPULOAD* self, CPULOAD_STATE state){
+	return state < CPULOAD_STATES ? self->residency[state] : 0;
+}
+
+void cpuload_packCan(const CPULOAD* self, uint8_t* data){
+	const uint16_t values[CPULOAD_CAN_PAYLOAD_SIZE / 2] = {
+		cpuload_load(self), self->peakLoad, self->residency[CPULOAD_SLEEP], self->residency[CPULOAD_STOP2]
+	};
+	for(uint8_t i = 0; i < CPULOAD_CAN_PAYLOAD_SIZE / 2; i++){
+		data[2 * i] = (uint8_t)values[i];
+		data[2 * i + 1] = (uint8_t)(values[i] >> 8);
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ * cpuload.h
+ *
+ * CPU load and power state residency. The idle loop reports each period it spent waiting for an interrupt and the
+ * low power state it used, everything else counts as running. Time is cut into fixed windows (one second on the
+ * board): when a window ends its load and residencies are kept until the next one ends, so a report always covers
+ * a whole window.
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine, the time is given by the caller in
+ * any unit (microseconds on the board) and may wrap around.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+#include <stdint.h>
+
+// Residencies and loads are given in thousandths of the window
+#define CPULOAD_SCALE 1000
+
+#define CPULOAD_CAN_PAYLOAD_SIZE 8
+
+typedef enum {
+	CPULOAD_RUN,
+	CPULOAD_SLEEP, // core stopped, clocks and peripherals running
+	CPULOAD_STOP2, // clocks stopped, woken by the low power timer or an interrupt
+	CPULOAD_STATES
+} CPULOAD_STATE;
+
+typedef struct {
+	uint32_t windowTicks;
+	uint32_t windowStart;
+	uint32_t idle[CPULOAD_STATES]; // ticks of the current window in each low power state, CPULOAD_RUN unused
+	uint16_t residency[CPULOAD_STATES]; // of the last complete window, in CPULOAD_SCALE
+	uint16_t peakLoad; // highest load of a complete window since cpuload_init()
+	uint32_t windows; // complete windows since cpuload_init()
+} CPULOAD;
+
+/*
+ * Starts the first window.
+ *
+ * @param self The measurement
+ * @param windowTicks Length of a window
+ * @param now Current time
+ */
+void cpuload_init(CPULOAD* self, uint32_t windowTicks, uint32_t now);
+
+/*
+ * Counts an idle period, split between the windows it overlaps. Windows that end before it are closed first.
+ *
+ * @param self The measurement
+ * @param state CPULOAD_SLEEP or CPULOAD_STOP2
+ * @param start Time the core stopped
+ * @param end Time it woke up, at most one window after start
+ */
+void cpuload_idle(CPULOAD* self, CPULOAD_STATE state, uint32_t start, uint32_t end);
+
+/*
+ * Closes the windows that ended, a window without any idle period is fully loaded.
+ *
+ * @param self The measurement
+ * @param now Current time
+ * @return Number of windows closed
+ */
+uint32_t cpuload_update(CPULOAD* self, uint32_t now);
+
+// Load of the last complete window in CPULOAD_SCALE, the residency of CPULOAD_RUN
+uint16_t cpuload_load(const CPULOAD* self);
+
+// Residency of a state in the last complete window, in CPULOAD_SCALE
+uint16_t cpuload_residency(const CPULOAD* self, CPULOAD_STATE state);
+
+/*
+ * Writes the report of the last complete window: load, peak load, Sleep and Stop2 residencies, each in
+ * CPULOAD_SCALE as 16 bit little endian.
+ *
+ * @param self The measurement
+ * @param data Receives CPULOAD_CAN_PAYLOAD_SIZE bytes
+ */
+void cpuload_packCan(const CPULOAD* self, uint8_t* data);
+
+#endif /* CPULOAD_H_ */
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Decodes the crash record sent by a board after a fault (crashlog.h).
+
+Reads the "CRASH" lines the board prints on its UART, or the frames of its crash CAN ID in candump format
+("can0 7E2 [8] 00 20 00 00 34 12 00 08" or "can0 7E2#0020000034120008"), from a file or stdin. The fault status
+registers are explained and the PC, LR and the stack words that look like return addresses are symbolized with
+addr2line against the ELF of the build that crashed:
+
+    crash_decode.py -e "Communication Module.elf" uart.log
+    candump can0,7E2:7FF | crash_decode.py -e "Communication Module.elf" --can-id 7E2
+"""
+
+import argparse
+import re
+import shutil
+import subprocess
+import sys
+
+# Order of the words in the CAN frames, see crashlog_word()
+HEADER = ["n", "up", "pc", "lr", "psr", "sp", "exc", "r0", "r1", "r2", "r3", "r12", "cfsr", "hfsr", "mmfar", "bfar"]
+
+CFSR_BITS = {
+    0: "IACCVIOL: instruction fetch from a location that does not allow execution",
+    1: "DACCVIOL: data access violation, MMFAR holds the address",
+    3: "MUNSTKERR: MemManage fault on exception return unstacking",
+    4: "MSTKERR: MemManage fault on exception entry stacking",
+    5: "MLSPERR: MemManage fault during lazy FPU state preservation",
+    7: "MMARVALID: MMFAR is valid",
+    8: "IBUSERR: bus fault on instruction fetch",
+    9: "PRECISERR: precise data bus error, BFAR holds the address",
+    10: "IMPRECISERR: imprecise data bus error, the PC is after the access",
+    11: "UNSTKERR: bus fault on exception return unstacking",
+    12: "STKERR: bus fault on exception entry stacking (stack overflow?)",
+    13: "LSPERR: bus fault during lazy FPU state preservation",
+    15: "BFARVALID: BFAR is valid",
+    16: "UNDEFINSTR: undefined instruction",
+    17: "INVSTATE: invalid state (branch to an address without the Thumb bit)",
+    18: "INVPC: invalid EXC_RETURN on exception return",
+    19: "NOCP: coprocessor access while disabled (FPU not enabled?)",
+    20: "STKOF: stack limit reached",
+    24: "UNALIGNED: unaligned access",
+    25: "DIVBYZERO: division by zero",
+}
+
+HFSR_BITS = {
+    1: "VECTTBL: bus fault on a vector table read",
+    30: "FORCED: escalated from a configurable fault, see CFSR",
+    31: "DEBUGEVT: debug event",
+}
+
+FLASH = (0x08000000, 0x08200000)
+
+
+def parse_lines(lines, can_id):
+    """Returns the record as a dictionary of words, the stack as a list."""
+    record = {}
+    stack = {}
+    can = re.compile(r"\b%X\b(?:\s+\[\d\])?\s*[#\s]\s*((?:[0-9A-Fa-f]{2}\s*){8})" % can_id)
+    for line in lines:
+        if "CRASH" in line:
+            for key, value in re.findall(r"(\w+)=([0-9a-fA-F]+(?: [0-9a-fA-F]{8})*)", line):
+                words = [int(word, 16) for word in value.split()]
+                if key.startswith("s") and key not in HEADER:
+                    first = int(key[1:], 16)
+                    for i, word in enumerate(words):
+                        stack[first + i] = word
+                else:
+                    record[key] = words[0]
+            continue
+        match = can.search(line.upper())
+        if match:
+            data = bytes.fromhex(re.sub(r"\s", "", match.group(1)))
+            index, count, word = data[0], data[1], int.from_bytes(data[4:8], "little")
+            if index < len(HEADER):
+                record[HEADER[index]] = word
+            elif index < count:
+                stack[index - len(HEADER)] = word
+    return record, [stack[i] for i in sorted(stack)]
+
+
+def symbolize(elf, addresses):
+    """Returns "function at file:line" for each address, or "" without an ELF or addr2line."""
+    tool = shutil.which("arm-none-eabi-addr2line")
+    if elf is None or tool is None or not addresses:
+        return ["" for _ in addresses]
+    output = subprocess.run([tool, "-f", "-C", "-e", elf] + ["0x%08x" % a for a in addresses],
+                            capture_output=True, text=True, check=False).stdout.splitlines()
+    return ["%s at %s" % (output[2 * i], output[2 * i + 1]) if 2 * i + 1 < len(output) else ""
+            for i in range(len(addresses))]
+
+
+def code_address(word):
+    return FLASH[0] <= word < FLASH[1] and word & 1
+
+
+def explain(register, value, bits):
+    return ["  %s: %s" % (register, text) for bit, text in sorted(bits.items()) if value >> bit & 1]
+
+
+def decode(record, stack, elf):
+    out = []
+    out.append("Crash %d of this power-on, after %d ms" % (record.get("n", 0), record.get("up", 0)))
+    exc = record.get("exc", 0)
+    out.append("EXC_RETURN %08x: %s stack, %s frame" % (exc, "process" if exc & 4 else "main",
+                                                       "basic" if exc & 0x10 else "FPU"))
+
+    # The PC is the faulting instruction, the return addresses point after a call so the call itself is looked up
+    pc, lr = record.get("pc", 0), record.get("lr", 0)
+    returns = [word for word in stack if code_address(word)]
+    names = symbolize(elf, [pc & ~1, (lr & ~1) - 2] + [(word & ~1) - 2 for word in returns])
+    out.append("PC  %08x %s" % (pc, names[0]))
+    out.append("LR  %08x %s" % (lr, names[1]))
+    out.append("PSR %08x SP %08x" % (record.get("psr", 0), record.get("sp", 0)))
+    out.append("R0 %08x R1 %08x R2 %08x R3 %08x R12 %08x" % tuple(record.get(r, 0) for r in
+                                                                ["r0", "r1", "r2", "r3", "r12"]))
+
+    cfsr, hfsr = record.get("cfsr", 0), record.get("hfsr", 0)
+    out.append("CFSR %08x HFSR %08x" % (cfsr, hfsr))
+    out += explain("HFSR", hfsr, HFSR_BITS)
+    out += explain("CFSR", cfsr, CFSR_BITS)
+    if cfsr & (1 << 7):
+        out.append("  MMFAR %08x" % record.get("mmfar", 0))
+    if cfsr & (1 << 15):
+        out.append("  BFAR %08x" % record.get("bfar", 0))
+
+    out.append("Stack above the frame, words that look like return addresses are symbolized:")
+    symbols = iter(names[2:])
+    for i, word in enumerate(stack):
+        out.append("  SP+%02x %08x %s" % (4 * i, word, next(symbols) if code_address(word) else ""))
+    return [line.rstrip() for line in out]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="UART or candump log, stdin if omitted")
+    parser.add_argument("-e", "--elf", help="ELF of the build that crashed")
+    parser.add_argument("--can-id", default="7E2", help="CAN ID of the crash frames (FAULT_CAN_ID), hexadecimal")
+    args = parser.parse_args()
+
+    source = open(args.log) if args.log else sys.stdin
+    record, stack = parse_lines(source, int(args.can_id, 16))
+    if not record:
+        sys.exit("no crash record found")
+    print("\n".join(decode(record, stack, args.elf)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,161 @@
+/*
+ * crashlog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "crashlog.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#define BASIC_FRAME_WORDS 8 // r0 to r3, r12, lr, pc, xpsr
+#define FPU_FRAME_WORDS 26 // and s0 to s15, fpscr, reserved
+#define EXC_RETURN_FPU_UNUSED (1u << 4) // clear when the FPU registers were stacked too
+#define XPSR_STACK_ALIGNED (1u << 9) // the core added a word to align the frame to 8 bytes
+#define STACK_LINE_WORDS 4
+
+static uint32_t checkOf(const CRASHLOG_RECORD* record){
+	const uint32_t* words = (const uint32_t*)record;
+	uint32_t sum = 0;
+	for(size_t i = 0; i < offsetof(CRASHLOG_RECORD, check) / sizeof(uint32_t); i++){
+		sum += words[i];
+	}
+	return ~sum;
+}
+
+static uint8_t readable(uintptr_t address, uint32_t words, uintptr_t stackLow, uintptr_t stackHigh){
+	return (address & 3) == 0 && address >= stackLow && address <= stackHigh && words <= (stackHigh - address) / 4;
+}
+
+void crashlog_capture(CRASHLOG_RECORD* record, const uint32_t* frame, uint32_t excReturn, const CRASHLOG_FAULT* fault,
+		uint32_t uptimeMs, uintptr_t stackLow, uintptr_t stackHigh){
+	record->crashes = crashlog_valid(record) ? record->crashes + 1 : 1;
+	record->magic = CRASHLOG_RECORD_MAGIC;
+	record->pending = 1;
+	record->uptimeMs = uptimeMs;
+	record->excReturn = excReturn;
+	record->fault = *fault;
+
+	uintptr_t address = (uintptr_t)frame;
+	if(readable(address, BASIC_FRAME_WORDS, stackLow, stackHigh)){
+		record->r0 = frame[0];
+		record->r1 = frame[1];
+		record->r2 = frame[2];
+		record->r3 = frame[3];
+		record->r12 = frame[4];
+		record->lr = frame[5];
+		record->pc = frame[6];
+		record->xpsr = frame[7];
+		address += 4 * ((excReturn & EXC_RETURN_FPU_UNUSED) ? BASIC_FRAME_WORDS : FPU_FRAME_WORDS);
+		address += (record->xpsr & XPSR_STACK_ALIGNED) ? 4 : 0;
+	}
+	else{
+		record->r0 = record->r1 = record->r2 = record->r3 = record->r12 = 0;
+		record->lr = record->pc = record->xpsr = 0;
+	}
+	record->sp = (uint32_t)address;
+
+	// The stack of the code that faulted, as much as fits below the top
+	record->stackWords = 0;
+	if(readable(address, 0, stackLow, stackHigh)){
+		const uint32_t* stack = (const uint32_t*)address;
+		uintptr_t available = (stackHigh - address) / 4;
+		record->stackWords = available < CRASHLOG_STACK_WORDS ? available : CRASHLOG_STACK_WORDS;
+		for(uint32_t i = 0; i < record->stackWords; i++){
+			record->stack[i] = stack[i];
+		}
+	}
+	for(uint32_t i = record->stackWords; i < CRASHLOG_STACK_WORDS; i++){
+		record->stack[i] = 0;
+	}
+	record->check = checkOf(record);
+}
+
+uint8_t crashlog_valid(const CRASHLOG_RECORD* record){
+	return record->magic == CRASHLOG_RECORD_MAGIC && record->check == checkOf(record)
+			&& record->stackWords <= CRASHLOG_STACK_WORDS;
+}
+
+uint8_t crashlog_boot(CRASHLOG_RECORD* record){
+	if(!crashlog_valid(record)){
+		*record = (CRASHLOG_RECORD){.magic = CRASHLOG_RECORD_MAGIC};
+		record->check = checkOf(record);
+	}
+	return record->pending != 0;
+}
+
+void crashlog_reported(CRASHLOG_RECORD* record){
+	record->pending = 0;
+	record->check = checkOf(record);
+}
+
+uint8_t crashlog_words(const CRASHLOG_RECORD* record){
+	return CRASHLOG_HEADER_WORDS + record->stackWords;
+}
+
+uint32_t crashlog_word(const CRASHLOG_RECORD* record, uint8_t index){
+	const uint32_t header[CRASHLOG_HEADER_WORDS] = {
+		record->crashes, record->uptimeMs, record->pc, record->lr, record->xpsr, record->sp, record->excReturn,
+		record->r0, record->r1, record->r2, record->r3, record->r12,
+		record->fault.cfsr, record->fault.hfsr, record->fault.mmfar, record->fault.bfar
+	};
+	if(index < CRASHLOG_HEADER_WORDS){
+		return header[index];
+	}
+	index -= CRASHLOG_HEADER_WORDS;
+	return index < record->stackWords ? record->stack[index] : 0;
+}
+
+void crashlog_packCan(const CRASHLOG_RECORD* record, uint8_t index, uint8_t* data){
+	uint32_t word = crashlog_word(record, index);
+	data[0] = index;
+	data[1] = crashlog_words(record);
+	data[2] = 0;
+	data[3] = 0;
+	for(uint8_t i = 0; i < 4; i++){
+		data[4 + i] = (uint8_t)(word >> (8 * i));
+	}
+}
+
+uint8_t crashlog_formatLine(const CRASHLOG_RECORD* record, uint8_t index, char* line){
+	int length;
+	switch(index){
+	case 0:
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH n=%lx up=%lx exc=%08lx\r\n", (unsigned long)record->crashes,
+				(unsigned long)record->uptimeMs, (unsigned long)record->excReturn);
+		break;
+	case 1:
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH pc=%08lx lr=%08lx psr=%08lx sp=%08lx\r\n",
+				(unsigned long)record->pc, (unsigned long)record->lr, (unsigned long)record->xpsr, (unsigned long)record->sp);
+		break;
+	case 2:
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH r0=%08lx r1=%08lx r2=%08lx r3=%08lx\r\n",
+				(unsigned long)record->r0, (unsigned long)record->r1, (unsigned long)record->r2, (unsigned long)record->r3);
+		break;
+	case 3:
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH r12=%08lx cfsr=%08lx hfsr=%08lx\r\n",
+				(unsigned long)record->r12, (unsigned long)record->fault.cfsr, (unsigned long)record->fault.hfsr);
+		break;
+	case 4:
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH mmfar=%08lx bfar=%08lx\r\n",
+				(unsigned long)record->fault.mmfar, (unsigned long)record->fault.bfar);
+		break;
+	default:{
+		// Stack, a few words per line after the offset of the first one
+		uint32_t first = (uint32_t)(index - 5) * STACK_LINE_WORDS;
+		if(first >= record->stackWords){
+			line[0] = '\0';
+			return 0;
+		}
+		length = snprintf(line, CRASHLOG_LINE_SIZE, "CRASH s%lx=", (unsigned long)first);
+		for(uint32_t i = first; i < record->stackWords && i < first + STACK_LINE_WORDS; i++){
+			length += snprintf(&line[length], CRASHLOG_LINE_SIZE - length, i == first ? "%08lx" : " %08lx",
+					(unsigned long)record->stack[i]);
+		}
+		length += snprintf(&line[length], CRASHLOG_LINE_SIZE - length, "\r\n");
+		break;
+	}
+	}
+	return length < CRASHLOG_LINE_SIZE ? length : CRASHLOG_LINE_SIZE - 1;
+}
@@ -0,0 +1,116 @@
+/*
+ * crashlog.h
+ *
+ * Crash record for the fault handlers. On a HardFault (or a MemManage, BusFault or UsageFault) the handler gives
+ * the exception frame the core stacked, the fault status registers and a few words of the stack above the frame to
+ * crashlog_capture(), which writes them into a record kept in RAM that is not initialised at startup, then resets.
+ * The next boot finds the record with crashlog_boot() and sends it as text lines (crashlog_formatLine()) and CAN
+ * frames (crashlog_packCan()). crash_decode.py in this folder turns either of them back into function names and
+ * source lines with the ELF of the build that crashed.
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine, the fault registers are read by the
+ * caller.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef CRASHLOG_H_
+#define CRASHLOG_H_
+
+#include <stdint.h>
+
+// Words of the stack copied above the exception frame, the return addresses of the callers are usually in there
+#define CRASHLOG_STACK_WORDS 16
+
+// Marks a record written by crashlog_capture(), anything else is the random content of RAM after power-on
+#define CRASHLOG_RECORD_MAGIC 0x43525348
+
+// Longest line written by crashlog_formatLine(), with its terminator
+#define CRASHLOG_LINE_SIZE 64
+
+// CAN payload of one word of the record: index, number of words, unused, unused, the word (little endian)
+#define CRASHLOG_CAN_PAYLOAD_SIZE 8
+
+// Words of the record sent before the stack, in the order of crashlog_word()
+#define CRASHLOG_HEADER_WORDS 16
+
+// Fault status registers, read by the handler from the System Control Block
+typedef struct {
+	uint32_t cfsr;
+	uint32_t hfsr;
+	uint32_t mmfar;
+	uint32_t bfar;
+} CRASHLOG_FAULT;
+
+// Kept across resets, place it in a no-init section
+typedef struct {
+	uint32_t magic;
+	uint32_t crashes; // since power-on
+	uint32_t pending; // 1 until the boot after the crash reported it
+	uint32_t uptimeMs;
+	uint32_t r0, r1, r2, r3, r12, lr, pc, xpsr; // stacked by the core, 0 if the frame was not readable
+	uint32_t excReturn; // LR on entry to the handler: which stack, FPU frame
+	uint32_t sp; // of the code that faulted, above the exception frame
+	CRASHLOG_FAULT fault;
+	uint32_t stackWords; // valid words in stack
+	uint32_t stack[CRASHLOG_STACK_WORDS];
+	uint32_t check; // complement of the sum of the fields above
+} CRASHLOG_RECORD;
+
+/*
+ * Fills the record, called from the fault handler with interrupts masked. Only reads the stack inside the given
+ * bounds so a fault caused by a stack overflow does not fault again in here.
+ *
+ * @param record The record in no-init RAM
+ * @param frame Stack pointer on entry to the handler (MSP or PSP, from bit 2 of excReturn)
+ * @param excReturn LR on entry to the handler
+ * @param fault Fault status registers
+ * @param uptimeMs Current time in ms
+ * @param stackLow Lowest address of the stack
+ * @param stackHigh One past the highest address of the stack
+ */
+void crashlog_capture(CRASHLOG_RECORD* record, const uint32_t* frame, uint32_t excReturn, const CRASHLOG_FAULT* fault,
+		uint32_t uptimeMs, uintptr_t stackLow, uintptr_t stackHigh);
+
+/*
+ * Checks the record at boot, a record that is not valid is cleared.
+ *
+ * @param record The record in no-init RAM
+ * @return 1 if it holds a crash that was not reported yet
+ */
+uint8_t crashlog_boot(CRASHLOG_RECORD* record);
+
+// Marks the crash as reported, the record (and the count of crashes) is kept
+void crashlog_reported(CRASHLOG_RECORD* record);
+
+// 1 if the record was written by crashlog_capture() or crashlog_boot()
+uint8_t crashlog_valid(const CRASHLOG_RECORD* record);
+
+// Number of words sent by crashlog_packCan(): the header and the valid stack words
+uint8_t crashlog_words(const CRASHLOG_RECORD* record);
+
+// Word of the record in the order it is sent: crashes, uptimeMs, pc, lr, xpsr, sp, excReturn, r0 to r3, r12,
+// cfsr, hfsr, mmfar, bfar, then the stack
+uint32_t crashlog_word(const CRASHLOG_RECORD* record, uint8_t index);
+
+/*
+ * Writes one word of the record into a CAN payload.
+ *
+ * @param record The record
+ * @param index Word to send, below crashlog_words()
+ * @param data Receives CRASHLOG_CAN_PAYLOAD_SIZE bytes
+ */
+void crashlog_packCan(const CRASHLOG_RECORD* record, uint8_t index, uint8_t* data);
+
+/*
+ * Writes one line of the text form of the record, "CRASH" followed by hexadecimal key=value pairs.
+ *
+ * @param record The record
+ * @param index Line to write, from 0
+ * @param line Receives up to CRASHLOG_LINE_SIZE characters with the terminator
+ * @return Length of the line, 0 after the last one
+ */
+uint8_t crashlog_formatLine(const CRASHLOG_RECORD* record, uint8_t index, char* line);
+
+#endif /* CRASHLOG_H_ */
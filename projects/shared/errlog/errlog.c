@@ -0,0 +1,235 @@
+/*
+ * errlog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "errlog.h"
+#include <stdio.h>
+#include <string.h>
+
+// The ring is a bounded multi-producer queue: each cell carries a sequence number telling whether it is free for
+// the producer at a position or holds the entry for the consumer at that position. A producer claims a position
+// with a compare and swap on the head, writes the cell and publishes it by advancing the sequence. An interrupt
+// that preempts a producer between the two steps simply uses the next cell, the consumer stops at the unpublished
+// cell until the producer resumes.
+typedef struct {
+	uint32_t sequence;
+	errlog_entry entry;
+} errlog_cell;
+
+typedef struct {
+	uint32_t code; // 0 while the slot is free
+	uint32_t count;
+	uint32_t suppressed;
+	uint32_t window_start;
+	uint32_t window_count;
+} errlog_counter;
+
+static errlog_cell cells[ERRLOG_RING_SIZE];
+static uint32_t head;
+static uint32_t tail;
+static errlog_counter counters[ERRLOG_MAX_CODES];
+static uint32_t severity_counts[ERRLOG_SEVERITY_COUNT];
+static uint32_t suppressed_total;
+static uint32_t dropped_total;
+static uint16_t latest;
+static uint32_t (*clock_source)(void);
+
+#define RING_MASK (ERRLOG_RING_SIZE - 1)
+
+#define LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#define CAS(p, expected, desired) __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+// Finds the counters of a code, claiming a free slot the first time the code is seen
+static errlog_counter* find_counter(uint16_t code, uint8_t create){
+	uint32_t slot = ((uint32_t)code * 2654435761u) % ERRLOG_MAX_CODES;
+	for(uint8_t i = 0; i < ERRLOG_MAX_CODES; i++){
+		errlog_counter* counter = &counters[(slot + i) % ERRLOG_MAX_CODES];
+		uint32_t current = LOAD(&counter->code);
+		if(current == code){
+			return counter;
+		}
+		if(current == 0){
+			if(!create){
+				return NULL;
+			}
+			uint32_t expected = 0;
+			if(CAS(&counter->code, &expected, code) || expected == code){
+				return counter;
+			}
+		}
+	}
+	return NULL;
+}
+
+// Counts a report against the rate limit of its code, 1 if it may be queued
+static uint8_t within_rate(errlog_counter* counter, uint32_t now){
+	uint32_t start = LOAD(&counter->window_start);
+	if(now - start >= ERRLOG_RATE_WINDOW_MS){
+		// Only the producer that moves the window resets it. A report counted by another producer in between is
+		// lost from the new window, letting at most one extra report through.
+		if(CAS(&counter->window_start, &start, now)){
+			STORE(&counter->window_count, 0);
+		}
+	}
+	return ADD(&counter->window_count, 1) <= ERRLOG_RATE_LIMIT;
+}
+
+static uint8_t push(const errlog_entry* entry){
+	uint32_t position = LOAD(&head);
+	errlog_cell* cell;
+	for(;;){
+		cell = &cells[position & RING_MASK];
+		int32_t difference = (int32_t)(LOAD(&cell->sequence) - position);
+		if(difference == 0){
+			if(CAS(&head, &position, position + 1)){
+				break;
+			}
+		}
+		else if(difference < 0){
+			return 0; // full
+		}
+		else{
+			position = LOAD(&head);
+		}
+	}
+	cell->entry = *entry;
+	STORE(&cell->sequence, position + 1);
+	return 1;
+}
+
+void errlog_init(uint32_t (*clock)(void)){
+	memset(counters, 0, sizeof(counters));
+	memset(severity_counts, 0, sizeof(severity_counts));
+	for(uint32_t i = 0; i < ERRLOG_RING_SIZE; i++){
+		cells[i].sequence = i;
+	}
+	head = 0;
+	tail = 0;
+	suppressed_total = 0;
+	dropped_total = 0;
+	latest = ERRLOG_NONE;
+	clock_source = clock;
+}
+
+errlog_result errlog_report(uint16_t code, uint16_t detail){
+	if(code == ERRLOG_NONE){
+		return ERRLOG_IGNORED;
+	}
+	uint32_t now = clock_source ? clock_source() : 0;
+
+	ADD(&severity_counts[ERRLOG_SEVERITY(code)], 1);
+	__atomic_store_n(&latest, code, __ATOMIC_RELAXED);
+
+	// Codes beyond the counter table are queued without a rate limit, the ring still bounds them
+	errlog_counter* counter = find_counter(code, 1);
+	if(counter){
+		ADD(&counter->count, 1);
+		if(!within_rate(counter, now)){
+			ADD(&counter->suppressed, 1);
+			ADD(&suppressed_total, 1);
+			return ERRLOG_SUPPRESSED;
+		}
+	}
+
+	errlog_entry entry = {.time = now, .code = code, .detail = detail};
+	if(!push(&entry)){
+		ADD(&dropped_total, 1);
+		return ERRLOG_DROPPED;
+	}
+	return ERRLOG_QUEUED;
+}
+
+uint8_t errlog_pop(errlog_entry* entry){
+	uint32_t position = LOAD(&tail);
+	errlog_cell* cell;
+	for(;;){
+		cell = &cells[position & RING_MASK];
+		int32_t difference = (int32_t)(LOAD(&cell->sequence) - (position + 1));
+		if(difference == 0){
+			if(CAS(&tail, &position, position + 1)){
+				break;
+			}
+		}
+		else if(difference < 0){
+			return 0; // empty, or the next entry is still being written
+		}
+		else{
+			position = LOAD(&tail);
+		}
+	}
+	*entry = cell->entry;
+	STORE(&cell->sequence, position + ERRLOG_RING_SIZE);
+	return 1;
+}
+
+uint32_t errlog_count(uint16_t code){
+	errlog_counter* counter = find_counter(code, 0);
+	return counter ? LOAD(&counter->count) : 0;
+}
+
+uint8_t errlog_stats_of(uint16_t code, errlog_stats* stats){
+	errlog_counter* counter = find_counter(code, 0);
+	if(!counter){
+		return 0;
+	}
+	stats->code = code;
+	stats->count = LOAD(&counter->count);
+	stats->suppressed = LOAD(&counter->suppressed);
+	return 1;
+}
+
+uint32_t errlog_severity_count(errlog_severity severity){
+	return severity < ERRLOG_SEVERITY_COUNT ? LOAD(&severity_counts[severity]) : 0;
+}
+
+uint32_t errlog_suppressed(void){
+	return LOAD(&suppressed_total);
+}
+
+uint32_t errlog_dropped(void){
+	return LOAD(&dropped_total);
+}
+
+uint16_t errlog_latest(void){
+	return __atomic_load_n(&latest, __ATOMIC_RELAXED);
+}
+
+static void put16(uint8_t* data, uint32_t value){
+	if(value > 0xFFFF){
+		value = 0xFFFF;
+	}
+	data[0] = value & 0xFF;
+	data[1] = value >> 8;
+}
+
+void errlog_pack_can(const errlog_entry* entry, uint8_t* data){
+	data[0] = entry->time & 0xFF;
+	data[1] = (entry->time >> 8) & 0xFF;
+	data[2] = (entry->time >> 16) & 0xFF;
+	data[3] = entry->time >> 24;
+	put16(&data[4], entry->code);
+	put16(&data[6], entry->detail);
+}
+
+void errlog_pack_summary(uint8_t* data){
+	uint32_t total = 0;
+	for(uint8_t i = 0; i < ERRLOG_SEVERITY_COUNT; i++){
+		total += errlog_severity_count(i);
+	}
+	put16(&data[0], errlog_suppressed());
+	put16(&data[2], errlog_dropped());
+	put16(&data[4], errlog_severity_count(ERRLOG_HIGH) + errlog_severity_count(ERRLOG_FATAL));
+	put16(&data[6], total);
+}
+
+uint8_t errlog_format(const errlog_entry* entry, char* line){
+	static const char severities[ERRLOG_SEVERITY_COUNT] = {'L', 'M', 'H', 'F'};
+	int length = snprintf(line, ERRLOG_LINE_SIZE, "E %lu %u.%u %c %u\r\n", (unsigned long)entry->time,
+			ERRLOG_MODULE(entry->code), ERRLOG_NUMBER(entry->code), severities[ERRLOG_SEVERITY(entry->code)], entry->detail);
+	return length < ERRLOG_LINE_SIZE ? length : ERRLOG_LINE_SIZE - 1;
+}
@@ -0,0 +1,162 @@
+/*
+ * errlog.h
+ *
+ * Error log shared by the base library and the driver modules. An error is a 16 bit code made of the module that
+ * reported it, a number inside that module and a severity, plus a 16 bit detail (a register, a received byte, a
+ * status). errlog_report() can be called from any interrupt or from the main loop at the same time:
+ *		-every report increments the occurrence counter of its code and of its severity
+ *		-at most ERRLOG_RATE_LIMIT reports of a code per ERRLOG_RATE_WINDOW_MS are timestamped and queued in a
+ *		 lock-free ring, the others are only counted as suppressed, so an error burst (e.g. a CRC storm on an
+ *		 encoder) costs a few atomic increments in the interrupt and cannot flood the log
+ *		-when the ring is full the report is dropped and counted, it never blocks
+ *
+ * The ring is read with errlog_pop(), typically in batches by the board code that forwards the entries over CAN and
+ * UART (see error.c in the base library). errlog_pack_can() and errlog_format() give the wire formats.
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine. The clock is given to errlog_init().
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef ERRLOG_H_
+#define ERRLOG_H_
+
+#include <stdint.h>
+
+// Entries kept in the ring, a power of two
+#define ERRLOG_RING_SIZE 32
+
+// Distinct codes with their own counters
+#define ERRLOG_MAX_CODES 32
+
+// Entries of one code queued per window, the rest are suppressed
+#define ERRLOG_RATE_LIMIT 4
+#define ERRLOG_RATE_WINDOW_MS 1000
+
+// Size of the CAN payload produced by errlog_pack_can()
+#define ERRLOG_CAN_PAYLOAD_SIZE 8
+
+// Longest line produced by errlog_format(), with the terminating null
+#define ERRLOG_LINE_SIZE 40
+
+// Code layout: severity (2 bits) | module (6 bits) | number (8 bits)
+#define ERRLOG_CODE(module, number, severity) ((uint16_t)((((severity) & 0x3) << 14) | (((module) & 0x3F) << 8) | ((number) & 0xFF)))
+#define ERRLOG_MODULE(code) (((code) >> 8) & 0x3F)
+#define ERRLOG_NUMBER(code) ((code) & 0xFF)
+#define ERRLOG_SEVERITY(code) (((code) >> 14) & 0x3)
+
+// Not an error, never logged
+#define ERRLOG_NONE 0
+
+typedef enum {
+	ERRLOG_LOW,
+	ERRLOG_MID,
+	ERRLOG_HIGH,
+	ERRLOG_FATAL,
+	ERRLOG_SEVERITY_COUNT
+} errlog_severity;
+
+// Modules that report errors, the numbers inside a module are defined by the module
+typedef enum {
+	ERRLOG_MODULE_SYSTEM = 1,
+	ERRLOG_MODULE_CAN,
+	ERRLOG_MODULE_I2C,
+	ERRLOG_MODULE_UART,
+	ERRLOG_MODULE_VEML3328,
+	ERRLOG_MODULE_BNO055,
+	ERRLOG_MODULE_BRITER,
+	ERRLOG_MODULE_SERVO,
+	ERRLOG_MODULE_WIND
+} errlog_module;
+
+typedef enum {
+	ERRLOG_QUEUED, // counted and queued in the ring
+	ERRLOG_SUPPRESSED, // counted, over the rate limit of its code
+	ERRLOG_DROPPED, // counted, the ring was full
+	ERRLOG_IGNORED // ERRLOG_NONE
+} errlog_result;
+
+// One queued report
+typedef struct {
+	uint32_t time; // ms
+	uint16_t code;
+	uint16_t detail;
+} errlog_entry;
+
+// Counters of one code
+typedef struct {
+	uint16_t code;
+	uint32_t count; // every report
+	uint32_t suppressed; // reports over the rate limit
+} errlog_stats;
+
+/*
+ * Clears the log and its counters. Must not run concurrently with errlog_report().
+ *
+ * @param clock Returns the time in ms for the timestamps, NULL for 0
+ */
+void errlog_init(uint32_t (*clock)(void));
+
+/*
+ * Reports an error. Safe from any interrupt and the main loop, never blocks.
+ *
+ * @param code The error code (ERRLOG_CODE())
+ * @param detail A value saved with the entry
+ * @return What happened to the report
+ */
+errlog_result errlog_report(uint16_t code, uint16_t detail);
+
+/*
+ * Takes the oldest queued entry.
+ *
+ * @param entry Receives the entry
+ * @return 1 if an entry was taken, 0 if the ring is empty
+ */
+uint8_t errlog_pop(errlog_entry* entry);
+
+// Number of reports of a code since errlog_init()
+uint32_t errlog_count(uint16_t code);
+
+// Counters of a code, 0 if it was never reported
+uint8_t errlog_stats_of(uint16_t code, errlog_stats* stats);
+
+// Number of reports of a severity
+uint32_t errlog_severity_count(errlog_severity severity);
+
+// Totals of reports over the rate limit and reports lost because the ring was full
+uint32_t errlog_suppressed(void);
+uint32_t errlog_dropped(void);
+
+// Most recent code reported, ERRLOG_NONE if none
+uint16_t errlog_latest(void);
+
+/*
+ * Packs an entry into a CAN payload:
+ *		-Bytes 0-3: time in ms, little endian
+ *		-Bytes 4-5: code, little endian
+ *		-Bytes 6-7: detail, little endian
+ *
+ * @param entry The entry
+ * @param data Receives the ERRLOG_CAN_PAYLOAD_SIZE bytes
+ */
+void errlog_pack_can(const errlog_entry* entry, uint8_t* data);
+
+/*
+ * Packs the totals into a CAN payload (all little endian): bytes 0-1 suppressed, 2-3 dropped, 4-5 high and fatal
+ * reports, 6-7 all reports, each saturated at 0xFFFF.
+ *
+ * @param data Receives the ERRLOG_CAN_PAYLOAD_SIZE bytes
+ */
+void errlog_pack_summary(uint8_t* data);
+
+/*
+ * Formats an entry as a text line "E <time> <module>.<number> <severity> <detail>\r\n".
+ *
+ * @param entry The entry
+ * @param line Receives at most ERRLOG_LINE_SIZE characters
+ * @return The length of the line
+ */
+uint8_t errlog_format(const errlog_entry* entry, char* line);
+
+#endif /* ERRLOG_H_ */
@@ -0,0 +1,122 @@
+/*
+ * fixed_trig.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "fixed_trig.h"
+
+// sin(n degrees) in Q15 for n = 0..90
+static const uint16_t sinTable[91] = {
+	0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126, 5690, 6252, 6813, 7371, 7927, 8481,
+	9032, 9580, 10126, 10668, 11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886, 16384, 16877,
+	17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622, 21063, 21498, 21926, 22348, 22763, 23170, 23571, 23965,
+	24351, 24730, 25102, 25466, 25822, 26170, 26510, 26842, 27166, 27482, 27789, 28088, 28378, 28660, 28932, 29197,
+	29452, 29698, 29935, 30163, 30382, 30592, 30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166,
+	32270, 32365, 32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763, 32768
+};
+
+// atan(n / 64) in 0.01 degrees for n = 0..64
+static const uint16_t atanTable[65] = {
+	0, 90, 179, 268, 358, 447, 536, 624, 713, 800, 888, 975, 1062, 1148, 1234, 1319,
+	1404, 1488, 1571, 1653, 1735, 1817, 1897, 1977, 2056, 2134, 2211, 2287, 2363, 2438, 2511, 2584,
+	2657, 2728, 2798, 2867, 2936, 3003, 3070, 3136, 3201, 3264, 3327, 3390, 3451, 3511, 3571, 3629,
+	3687, 3744, 3800, 3855, 3909, 3963, 4016, 4067, 4119, 4169, 4218, 4267, 4315, 4363, 4409, 4455,
+	4500
+};
+
+int32_t fixed_wrap(int32_t angle) {
+	angle %= FIXED_TRIG_TURN;
+	return (angle < 0) ? angle + FIXED_TRIG_TURN : angle;
+}
+
+int32_t fixed_wrapSigned(int32_t angle) {
+	angle = fixed_wrap(angle);
+	return (angle >= FIXED_TRIG_TURN / 2) ? angle - FIXED_TRIG_TURN : angle;
+}
+
+// Sine of an angle in [0, 900] 0.1 degrees, interpolated between whole degrees
+static int32_t quarterSin(int32_t angle) {
+	int32_t index = angle / 10;
+	int32_t fraction = angle % 10;
+	if (fraction == 0) {
+		return sinTable[index];
+	}
+	return sinTable[index] + ((sinTable[index + 1] - sinTable[index]) * fraction + 5) / 10;
+}
+
+int32_t fixed_sin(int32_t angle) {
+	angle = fixed_wrap(angle);
+	if (angle <= 900) {
+		return quarterSin(angle);
+	}
+	if (angle <= 1800) {
+		return quarterSin(1800 - angle);
+	}
+	if (angle <= 2700) {
+		return -quarterSin(angle - 1800);
+	}
+	return -quarterSin(FIXED_TRIG_TURN - angle);
+}
+
+int32_t fixed_cos(int32_t angle) {
+	return fixed_sin(angle + 900);
+}
+
+int32_t fixed_atan2(int32_t y, int32_t x) {
+	uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+	uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+	uint32_t small = (ax < ay) ? ax : ay;
+	uint32_t large = (ax < ay) ? ay : ax;
+
+	if (large == 0) {
+		return 0;
+	}
+
+	// Reduce both to 15 bits so the ratio fits a 32 bit division
+	while (large > 0x7FFF) {
+		large >>= 1;
+		small >>= 1;
+	}
+
+	// Ratio in [0, 1] with 16 fractional bits, split into a table index (6 bits) and a fraction (10 bits)
+	uint32_t ratio = (small << 16) / large;
+	uint32_t index = ratio >> 10;
+	uint32_t fraction = ratio & 0x3FF;
+	int32_t angle = atanTable[index];
+	if (index < 64) {
+		angle += ((atanTable[index + 1] - atanTable[index]) * fraction + 512) >> 10;
+	}
+
+	// angle is in [0, 4500] 0.01 degrees within the first octant, unfold it to the full circle
+	if (ay > ax) {
+		angle = 9000 - angle;
+	}
+	if (x < 0) {
+		angle = 18000 - angle;
+	}
+	if (y < 0) {
+		angle = 36000 - angle;
+	}
+	return fixed_wrap((angle + 5) / 10);
+}
+
+uint32_t fixed_sqrt(uint64_t value) {
+	uint64_t result = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= result + bit) {
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)result;
+}
@@ -0,0 +1,41 @@
+/*
+ * fixed_trig.h
+ *
+ * Integer trigonometry for the driver modules, so angles can be processed without the FPU or soft-float
+ * (e.g. inside interrupts). Angles are in 0.1 degrees and sines/cosines are Q15 (FIXED_TRIG_ONE is 1.0).
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef FIXED_TRIG_H_
+#define FIXED_TRIG_H_
+
+#include <stdint.h>
+
+// 1.0 in the Q15 format returned by fixed_sin() and fixed_cos()
+#define FIXED_TRIG_ONE 32768
+
+// A full turn in 0.1 degrees
+#define FIXED_TRIG_TURN 3600
+
+// Wraps an angle in 0.1 degrees into [0, 3600)
+int32_t fixed_wrap(int32_t angle);
+
+// Wraps an angle difference in 0.1 degrees into [-1800, 1800)
+int32_t fixed_wrapSigned(int32_t angle);
+
+// Sine of an angle in 0.1 degrees, in Q15. Maximum error is 2 LSB.
+int32_t fixed_sin(int32_t angle);
+
+// Cosine of an angle in 0.1 degrees, in Q15. Maximum error is 2 LSB.
+int32_t fixed_cos(int32_t angle);
+
+// Angle of the vector (x, y) from the x axis towards the y axis, in 0.1 degrees in [0, 3600).
+// Returns 0 for the null vector. Maximum error is 0.1 degrees.
+int32_t fixed_atan2(int32_t y, int32_t x);
+
+// Integer square root, rounded down
+uint32_t fixed_sqrt(uint64_t value);
+
+#endif /* FIXED_TRIG_H_ */
@@ -0,0 +1,347 @@
+/*
+ * hal_host.c
+ *
+ * Virtual clock, event queue, core (interrupt mask, DWT, reset), RCC, tick and flash of the host HAL.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_CORE_CLOCK 160000000u
+
+typedef struct {
+	uint64_t time;
+	uint64_t order; //queued first runs first among events due at the same time
+	HAL_HOST_EVENT event;
+	void* context;
+	uint8_t used;
+} EVENT;
+
+static EVENT events[HAL_HOST_EVENTS];
+static uint64_t now;
+static uint64_t queued;
+static uint32_t primask;
+static void (*resetHook)(void);
+static void (*barrierHook)(void);
+static uint8_t inBarrierHook;
+static uint32_t resets;
+static DWT_Type dwt;
+static uint8_t flashLocked;
+static uint32_t flashError;
+static uint32_t flashErases;
+static uint32_t flashPrograms;
+static uint8_t icacheStale;
+
+uint32_t SystemCoreClock = DEFAULT_CORE_CLOCK;
+CoreDebug_Type hal_host_coreDebug;
+RCC_TypeDef hal_host_rcc;
+DMA_Channel_TypeDef hal_host_gpdma1[16];
+uint8_t hal_host_flash[FLASH_SIZE] __attribute__((aligned(16)));
+
+//-- Clock and events --
+static EVENT* earliest(void){
+	EVENT* first = NULL;
+	for(uint8_t i = 0; i < HAL_HOST_EVENTS; i++){
+		EVENT* e = &events[i];
+		if(e->used && (first == NULL || e->time < first->time || (e->time == first->time && e->order < first->order))){
+			first = e;
+		}
+	}
+	return first;
+}
+
+//Runs the events due up to a time while the interrupts are not masked. An event may move the clock itself (a
+//blocking call in a callback), the events it passes are then run late, in order.
+static void runDue(uint64_t until){
+	EVENT* e;
+	while(!primask && (e = earliest()) != NULL && e->time <= until){
+		if(e->time > now){
+			now = e->time;
+		}
+		HAL_HOST_EVENT event = e->event;
+		void* context = e->context;
+		e->used = 0;
+		event(context);
+	}
+}
+
+void hal_host_reset(void){
+	if((uintptr_t)hal_host_flash + FLASH_SIZE > UINT32_MAX){
+		fprintf(stderr, "hal_host: the flash is above 4 GB, build without PIE (-no-pie)\n");
+		abort();
+	}
+	memset(events, 0, sizeof(events));
+	now = 0;
+	queued = 0;
+	primask = 0;
+	resetHook = NULL;
+	barrierHook = NULL;
+	inBarrierHook = 0;
+	resets = 0;
+	memset(&dwt, 0, sizeof(dwt));
+	memset(&hal_host_coreDebug, 0, sizeof(hal_host_coreDebug));
+	memset(&hal_host_rcc, 0, sizeof(hal_host_rcc));
+	memset(hal_host_gpdma1, 0, sizeof(hal_host_gpdma1));
+	SystemCoreClock = DEFAULT_CORE_CLOCK;
+	memset(hal_host_flash, 0xFF, FLASH_SIZE);
+	flashLocked = 1;
+	flashError = HAL_FLASH_ERROR_NONE;
+	flashErases = 0;
+	flashPrograms = 0;
+	icacheStale = 0;
+	hal_host_gpioReset();
+	hal_host_timReset();
+	hal_host_uartReset();
+	hal_host_i2cReset();
+	hal_host_canReset();
+}
+
+uint64_t hal_host_now(void){
+	return now;
+}
+
+void hal_host_advance(uint64_t ns){
+	uint64_t until = now + ns;
+	runDue(until);
+	if(until > now){
+		now = until;
+	}
+}
+
+uint8_t hal_host_runNext(void){
+	EVENT* e = earliest();
+	if(e == NULL){
+		return 0;
+	}
+	if(e->time > now){
+		now = e->time;
+	}
+	runDue(now);
+	return 1;
+}
+
+uint8_t hal_host_schedule(uint64_t delay, HAL_HOST_EVENT event, void* context){
+	for(uint8_t i = 0; i < HAL_HOST_EVENTS; i++){
+		EVENT* e = &events[i];
+		if(!e->used){
+			*e = (EVENT){.time = now + delay, .order = queued++, .event = event, .context = context, .used = 1};
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void hal_host_cancel(HAL_HOST_EVENT event, void* context){
+	for(uint8_t i = 0; i < HAL_HOST_EVENTS; i++){
+		EVENT* e = &events[i];
+		if(e->used && e->event == event && e->context == context){
+			e->used = 0;
+		}
+	}
+}
+
+void hal_host_setResetHook(void (*hook)(void)){
+	resetHook = hook;
+}
+
+uint32_t hal_host_resets(void){
+	return resets;
+}
+
+void hal_host_setBarrierHook(void (*hook)(void)){
+	barrierHook = hook;
+}
+
+//-- Core --
+void hal_host_barrier(void){
+	__sync_synchronize();
+	if(barrierHook != NULL && !inBarrierHook){
+		inBarrierHook = 1;
+		barrierHook();
+		inBarrierHook = 0;
+	}
+}
+
+uint32_t __get_PRIMASK(void){
+	return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask){
+	primask = priMask & 1u;
+	//Interrupts that became pending while masked are taken as soon as the mask is lifted
+	runDue(now);
+}
+
+void __disable_irq(void){
+	primask = 1;
+}
+
+void __enable_irq(void){
+	__set_PRIMASK(0);
+}
+
+void __WFI(void){
+	hal_host_runNext();
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority){
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn){
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn){
+}
+
+void NVIC_SystemReset(void){
+	resets++;
+	if(resetHook == NULL){
+		fprintf(stderr, "hal_host: NVIC_SystemReset() with no reset hook\n");
+		abort();
+	}
+	resetHook();
+}
+
+DWT_Type* hal_host_dwt(void){
+	hal_host_advance(HAL_HOST_DWT_ACCESS_NS);
+	if(dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk){
+		dwt.CYCCNT = (uint32_t)((unsigned __int128)now * SystemCoreClock / 1000000000u);
+	}
+	return &dwt;
+}
+
+//-- Tick --
+HAL_StatusTypeDef HAL_Init(void){
+	return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void){
+	return (uint32_t)(now / HAL_HOST_MS(1));
+}
+
+void HAL_Delay(uint32_t Delay){
+	//Like the HAL, the wait is at least one full tick longer than asked
+	uint64_t wait = Delay;
+	if(wait < HAL_MAX_DELAY){
+		wait++;
+	}
+	uint64_t until = HAL_HOST_MS(now / HAL_HOST_MS(1) + wait);
+	hal_host_advance(until - now);
+}
+
+//-- RCC --
+uint32_t HAL_RCC_GetSysClockFreq(void){
+	return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void){
+	return SystemCoreClock;
+}
+
+//APB prescaler: 0xx is not divided, 100 to 111 divide by 2 to 16
+static uint32_t apbClock(uint32_t ppre){
+	return (ppre < 4) ? SystemCoreClock : SystemCoreClock >> (ppre - 3);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void){
+	return apbClock((hal_host_rcc.CFGR2 & RCC_CFGR2_PPRE1) >> 4);
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void){
+	return apbClock((hal_host_rcc.CFGR2 >> 8) & 0x7u);
+}
+
+//-- FLASH --
+HAL_StatusTypeDef HAL_FLASH_Unlock(void){
+	flashLocked = 0;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void){
+	flashLocked = 1;
+	return HAL_OK;
+}
+
+uint32_t HAL_FLASH_GetError(void){
+	return flashError;
+}
+
+uint32_t hal_host_flashErases(void){
+	return flashErases;
+}
+
+uint32_t hal_host_flashPrograms(void){
+	return flashPrograms;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef* pEraseInit, uint32_t* PageError){
+	*PageError = 0xFFFFFFFFu;
+	flashError = HAL_FLASH_ERROR_NONE;
+	if(flashLocked){
+		flashError = HAL_FLASH_ERROR_OP;
+		return HAL_ERROR;
+	}
+
+	uint32_t first = 0;
+	uint32_t pages = 0;
+	if(pEraseInit->TypeErase == FLASH_TYPEERASE_MASSERASE){
+		pages = 2 * FLASH_PAGE_NB;
+	}
+	else if(pEraseInit->Banks == FLASH_BANK_1 || pEraseInit->Banks == FLASH_BANK_2){
+		first = (pEraseInit->Banks == FLASH_BANK_2 ? FLASH_PAGE_NB : 0) + pEraseInit->Page;
+		pages = pEraseInit->NbPages;
+	}
+	if(pages == 0 || pEraseInit->Page + pEraseInit->NbPages > FLASH_PAGE_NB){
+		flashError = HAL_FLASH_ERROR_OP;
+		*PageError = pEraseInit->Page;
+		return HAL_ERROR;
+	}
+
+	for(uint32_t page = first; page < first + pages; page++){
+		hal_host_advance(HAL_HOST_FLASH_ERASE_NS);
+		memset(&hal_host_flash[page * FLASH_PAGE_SIZE], 0xFF, FLASH_PAGE_SIZE);
+		flashErases++;
+		icacheStale = 1;
+	}
+	return HAL_OK;
+}
+
+//Only erased quad-words can be programmed, the ECC of a written one would be wrong
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint32_t DataAddress){
+	flashError = HAL_FLASH_ERROR_NONE;
+	uintptr_t offset = (uintptr_t)Address - FLASH_BASE;
+	if(flashLocked){
+		flashError = HAL_FLASH_ERROR_OP;
+		return HAL_ERROR;
+	}
+	if(TypeProgram != FLASH_TYPEPROGRAM_QUADWORD || (uintptr_t)Address < FLASH_BASE || offset + 16 > FLASH_SIZE || offset % 16 != 0){
+		flashError = HAL_FLASH_ERROR_PGA;
+		return HAL_ERROR;
+	}
+	for(uint8_t i = 0; i < 16; i++){
+		if(hal_host_flash[offset + i] != 0xFF){
+			flashError = HAL_FLASH_ERROR_PROG;
+			return HAL_ERROR;
+		}
+	}
+	hal_host_advance(HAL_HOST_FLASH_PROGRAM_NS);
+	memcpy(&hal_host_flash[offset], (const void*)(uintptr_t)DataAddress, 16);
+	flashPrograms++;
+	icacheStale = 1;
+	return HAL_OK;
+}
+
+//-- ICACHE --
+HAL_StatusTypeDef HAL_ICACHE_Invalidate(void){
+	icacheStale = 0;
+	return HAL_OK;
+}
+
+uint8_t hal_host_icacheStale(void){
+	return icacheStale;
+}
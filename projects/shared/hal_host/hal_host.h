@@ -0,0 +1,222 @@
+/*
+ * hal_host.h
+ *
+ * Virtual clock and device models behind the host HAL (stm32u5xx_hal.h). Nothing happens on its own: time only
+ * moves when a test calls hal_host_advance() or the code under test waits (HAL_Delay(), the DWT cycle counter,
+ * blocking transfers, __WFI()). Completions of interrupt and DMA transfers, timer updates, CAN frames leaving the bus
+ * and the events scheduled by a test are queued on the clock and run as interrupts once it reaches them, in time
+ * order, so the HAL callbacks of the code under test are called like on the board. While the interrupts are
+ * masked (__disable_irq()) they wait for the mask to be lifted.
+ *
+ * The peripherals are driven by scriptable models:
+ * 		UART: the bytes sent by the MCU are captured (hal_host_uartSent()) and passed to a model, which answers with
+ * 		hal_host_uartReceive(), idle lines and errors
+ * 		I2C: devices attached at 7 bit addresses answer each transfer, hal_host_i2cAttachRegs() turns a register array
+ * 		into a device that also NACKs or holds the bus on demand
+ * 		GPIO: input levels and a model that sees the outputs and decides what an input reads
+ * 		FDCAN: frames leave the bus after their bit time at the configured bitrate into a log (hal_host_canTake()),
+ * 		frames from other nodes are received into RX FIFO 0
+ * 		TIM, DAC and FLASH: registers, update interrupts at the programmed rate and DMA bursts into a timer register
+ * 		on each update, a 2 MB flash erased to 0xFF and whether the instruction cache was invalidated after it changed
+ *
+ * Transfer durations follow the configured baud rate, I2C timing register and CAN bitrate, so the bus occupancy and
+ * throughput the drivers report can be checked against the simulated time.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include "stm32u5xx_hal.h"
+
+//Virtual time is counted in ns
+#define HAL_HOST_US(us) ((uint64_t)(us) * 1000u)
+#define HAL_HOST_MS(ms) ((uint64_t)(ms) * 1000000u)
+
+//Events queued on the clock at once (transfers in progress, running timers, events of the test)
+#define HAL_HOST_EVENTS 64
+
+//Time taken by each access to DWT, the few instructions of a busy wait loop at 160 MHz
+#define HAL_HOST_DWT_ACCESS_NS 50
+
+//Typical page erase and quad-word programming times of the flash
+#define HAL_HOST_FLASH_ERASE_NS HAL_HOST_MS(2)
+#define HAL_HOST_FLASH_PROGRAM_NS HAL_HOST_US(120)
+
+//Kernel clock of FDCAN1 when its bit timing is not configured, and the bitrate used then
+#define HAL_HOST_FDCAN_CLOCK 160000000u
+#define HAL_HOST_FDCAN_DEFAULT_BITRATE 500000u
+
+//-- Clock and events --
+typedef void (*HAL_HOST_EVENT)(void* context);
+
+// Back to time 0 with 160 MHz clocks: queued events dropped, registers cleared, models detached, flash erased
+void hal_host_reset(void);
+
+// Virtual time since hal_host_reset() in ns
+uint64_t hal_host_now(void);
+
+// Moves the clock forward, running the events due on the way
+void hal_host_advance(uint64_t ns);
+
+// Moves the clock to the next queued event and runs it, returns 0 if none is queued
+uint8_t hal_host_runNext(void);
+
+/*
+ * Queues an event, run as an interrupt once the clock reaches it. Events due at the same time run in the order
+ * they were queued.
+ *
+ * @param delay From now, in ns
+ * @return 0 if the queue is full
+ */
+uint8_t hal_host_schedule(uint64_t delay, HAL_HOST_EVENT event, void* context);
+
+// Drops the queued events with this function and context
+void hal_host_cancel(HAL_HOST_EVENT event, void* context);
+
+// Called by NVIC_SystemReset(), which aborts without one. A test leaves it with longjmp() or returns to go on.
+void hal_host_setResetHook(void (*hook)(void));
+
+// Calls of NVIC_SystemReset() since hal_host_reset()
+uint32_t hal_host_resets(void);
+
+// Called at each __DMB() of the code under test, to take an interrupt between two accesses of a lock-free reader.
+// The barriers of the code run by the hook do not call it again.
+void hal_host_setBarrierHook(void (*hook)(void));
+
+//-- UART --
+typedef struct {
+	// Bytes sent by the MCU, once their transmission ended. Runs as an interrupt.
+	void (*transmit)(void* context, UART_HandleTypeDef* huart, const uint8_t* data, uint16_t length);
+	void* context;
+} HAL_HOST_UART_MODEL;
+
+#define HAL_HOST_UART_CAPTURE 1024 //bytes sent kept for hal_host_uartSent()
+
+void hal_host_uartAttach(USART_TypeDef* instance, const HAL_HOST_UART_MODEL* model);
+
+/*
+ * Bytes arriving now on the RX line, written into the reception in progress. The half and full transfer events of
+ * a DMA reception are raised on the way, and the idle event after the last byte if idle is set. Bytes that arrive
+ * with no reception running are lost (overrun) and counted.
+ *
+ * @return Bytes written into a reception
+ */
+uint16_t hal_host_uartReceive(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t length, uint8_t idle);
+
+// A reception error (HAL_UART_ERROR_*): the DMA reception is aborted and HAL_UART_ErrorCallback() called
+void hal_host_uartError(UART_HandleTypeDef* huart, uint32_t error);
+
+// Takes up to size of the bytes sent since the last call, returns how many
+uint16_t hal_host_uartSent(USART_TypeDef* instance, uint8_t* data, uint16_t size);
+
+// Bytes received with no reception running since hal_host_reset()
+uint32_t hal_host_uartLost(USART_TypeDef* instance);
+
+// Time to send bytes at the baud rate of the UART (10 bits each)
+uint64_t hal_host_uartByteTime(const UART_HandleTypeDef* huart, uint32_t bytes);
+
+//-- I2C --
+typedef enum {
+	HAL_HOST_I2C_ACK,
+	HAL_HOST_I2C_NACK, //the address or a byte is not acknowledged
+	HAL_HOST_I2C_HOLD //SDA or SCL held low, the transfer times out
+} HAL_HOST_I2C_RESPONSE;
+
+typedef struct {
+	// Bytes written by the MCU in one transaction, the register address first for memory transfers
+	HAL_HOST_I2C_RESPONSE (*write)(void* context, const uint8_t* data, uint16_t length);
+	// Bytes read by the MCU in one transaction
+	HAL_HOST_I2C_RESPONSE (*read)(void* context, uint8_t* data, uint16_t length);
+	void* context;
+} HAL_HOST_I2C_DEVICE;
+
+// Register file device: the first byte written selects a register, the next ones and the reads go on from there
+typedef struct {
+	uint8_t* registers;
+	uint16_t size; //bytes of registers
+	uint8_t width; //bytes per register address, 2 for command code devices with 16 bit registers
+	uint8_t autoIncrement; //reads and writes go on to the next register, otherwise they stay on the selected one
+	HAL_HOST_I2C_RESPONSE response; //what the device does, ACK unless a test breaks it
+	uint16_t pointer; //byte offset of the next access
+	uint32_t writes; //transactions
+	uint32_t reads;
+	// Optional, after the bytes of a write are stored and before those of a read are copied
+	void (*onWrite)(void* context, uint8_t reg, uint16_t length);
+	void (*onRead)(void* context, uint8_t reg, uint16_t length);
+	void* context;
+} HAL_HOST_I2C_REGS;
+
+// address is the 7 bit address, a second device at the same address replaces the first
+void hal_host_i2cAttach(I2C_TypeDef* instance, uint8_t address, const HAL_HOST_I2C_DEVICE* device);
+void hal_host_i2cAttachRegs(I2C_TypeDef* instance, uint8_t address, HAL_HOST_I2C_REGS* regs);
+
+typedef struct {
+	uint32_t transfers; //transactions, START to STOP
+	uint32_t bytes; //data and address bytes
+	uint32_t nacks;
+	uint32_t timeouts;
+	uint64_t busyNs; //time the bus was in use
+} HAL_HOST_I2C_STATS;
+
+void hal_host_i2cStats(I2C_TypeDef* instance, HAL_HOST_I2C_STATS* stats);
+
+//-- GPIO --
+typedef struct {
+	// After an output changed
+	void (*write)(void* context, GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+	// Level read on a pin: level is what the port drives or the input level, the model may pull it low
+	GPIO_PinState (*read)(void* context, GPIO_TypeDef* port, uint16_t pin, GPIO_PinState level);
+	void* context;
+} HAL_HOST_GPIO_MODEL;
+
+void hal_host_gpioAttach(GPIO_TypeDef* port, const HAL_HOST_GPIO_MODEL* model);
+
+// Level of input pins
+void hal_host_gpioInput(GPIO_TypeDef* port, uint16_t pins, GPIO_PinState state);
+
+// Writes to a pin since hal_host_reset(), changes or not
+uint32_t hal_host_gpioWrites(GPIO_TypeDef* port, uint16_t pin);
+
+//-- TIM --
+// Update interrupts raised since hal_host_reset()
+uint32_t hal_host_timUpdates(TIM_TypeDef* instance);
+
+//-- FDCAN --
+typedef struct {
+	uint32_t id;
+	uint8_t length;
+	uint8_t data[8];
+	uint64_t time; //end of the frame on the bus
+} HAL_HOST_CAN_FRAME;
+
+#define HAL_HOST_CAN_LOG 64 //frames sent kept for hal_host_canTake(), the oldest are dropped
+
+// Takes the oldest frame sent, returns 0 if there is none
+uint8_t hal_host_canTake(HAL_HOST_CAN_FRAME* frame);
+
+// Frames dropped from the full log since hal_host_reset()
+uint32_t hal_host_canLogDropped(void);
+
+// With no other node acknowledging, the frames stay pending (automatic retransmission), 1 by default
+void hal_host_canAcknowledge(uint8_t acknowledge);
+
+// A frame from another node, into RX FIFO 0 if accepted. Returns 0 when lost (stopped, rejected or FIFO full).
+uint8_t hal_host_canReceive(FDCAN_HandleTypeDef* hfdcan, uint32_t id, const uint8_t* data, uint8_t length);
+
+// Time a classic frame with a standard ID takes on the bus at the configured bitrate, stuff bits left out
+uint64_t hal_host_canFrameTime(const FDCAN_HandleTypeDef* hfdcan, uint8_t length);
+
+//-- FLASH --
+// Pages erased and quad-words programmed since hal_host_reset()
+uint32_t hal_host_flashErases(void);
+uint32_t hal_host_flashPrograms(void);
+
+//-- ICACHE --
+// 1 if the flash was erased or programmed since the last HAL_ICACHE_Invalidate(), reads through the cache may then
+// return its old content
+uint8_t hal_host_icacheStale(void);
+
+#endif /* HAL_HOST_H_ */
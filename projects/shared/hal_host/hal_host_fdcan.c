@@ -0,0 +1,302 @@
+/*
+ * hal_host_fdcan.c
+ *
+ * FDCAN1 of the host HAL, classic frames with standard IDs. The 3 elements of the TX FIFO go out one at a time in
+ * the order they were added, each taking its bit time (hal_host_canFrameTime()) before its TXBRP bit clears and it
+ * goes to the log. With no acknowledge they stay pending, like with automatic retransmission.
+ *
+ * Frames from other nodes go through the standard filters (range, dual or mask) then the global filter into the 3
+ * elements of RX FIFO 0, a full FIFO loses the new frame (blocking mode).
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <string.h>
+
+#define TX_FIFO 3
+#define RX_FIFO 3
+#define STD_FILTERS 28
+#define FRAME_BITS(length) (47u + 8u * (length)) //standard ID data frame with the interframe space
+
+typedef struct {
+	uint32_t id;
+	uint8_t length;
+	uint8_t data[8];
+} FRAME;
+
+typedef struct {
+	FDCAN_HandleTypeDef* hfdcan;
+	//TX FIFO, pending frames in the order they were added
+	FRAME tx[TX_FIFO];
+	uint8_t txSlot[TX_FIFO]; //TXBRP bit of each pending frame
+	uint8_t txCount;
+	uint8_t sending;
+	uint8_t acknowledge;
+	//Log of the frames sent
+	HAL_HOST_CAN_FRAME log[HAL_HOST_CAN_LOG];
+	uint8_t logHead;
+	uint8_t logCount;
+	uint32_t logDropped;
+	//RX FIFO 0
+	FRAME rx[RX_FIFO];
+	uint8_t rxHead;
+	uint8_t rxCount;
+	FDCAN_FilterTypeDef filters[STD_FILTERS];
+	uint32_t nonMatching;
+	uint32_t notifications;
+} CAN_STATE;
+
+FDCAN_GlobalTypeDef hal_host_fdcan1;
+static CAN_STATE can;
+
+void hal_host_canReset(void){
+	memset(&hal_host_fdcan1, 0, sizeof(hal_host_fdcan1));
+	memset(&can, 0, sizeof(can));
+	can.acknowledge = 1;
+}
+
+uint64_t hal_host_canFrameTime(const FDCAN_HandleTypeDef* hfdcan, uint8_t length){
+	uint64_t bitrate = HAL_HOST_FDCAN_DEFAULT_BITRATE;
+	const FDCAN_InitTypeDef* init = &hfdcan->Init;
+	if(init->NominalPrescaler != 0){
+		uint64_t kernel = HAL_HOST_FDCAN_CLOCK / (init->ClockDivider == FDCAN_CLOCK_DIV1 ? 1 : 2 * init->ClockDivider);
+		bitrate = kernel / ((uint64_t)init->NominalPrescaler * (1 + init->NominalTimeSeg1 + init->NominalTimeSeg2));
+	}
+	return (FRAME_BITS(length) * 1000000000ull + bitrate - 1) / bitrate;
+}
+
+//-- Transmission --
+static void frameSent(void* context);
+
+static void sendNext(void){
+	if(can.sending || can.txCount == 0 || !can.acknowledge || can.hfdcan->State != HAL_FDCAN_STATE_BUSY){
+		return;
+	}
+	can.sending = 1;
+	hal_host_schedule(hal_host_canFrameTime(can.hfdcan, can.tx[0].length), frameSent, NULL);
+}
+
+static void frameSent(void* context){
+	UNUSED(context);
+	FDCAN_GlobalTypeDef* fdcan = can.hfdcan->Instance;
+	if(can.logCount == HAL_HOST_CAN_LOG){
+		can.logHead = (can.logHead + 1) % HAL_HOST_CAN_LOG;
+		can.logCount--;
+		can.logDropped++;
+	}
+	HAL_HOST_CAN_FRAME* logged = &can.log[(can.logHead + can.logCount++) % HAL_HOST_CAN_LOG];
+	logged->id = can.tx[0].id;
+	logged->length = can.tx[0].length;
+	memcpy(logged->data, can.tx[0].data, sizeof(logged->data));
+	logged->time = hal_host_now();
+
+	fdcan->TXBRP &= ~(1u << can.txSlot[0]);
+	can.txCount--;
+	memmove(&can.tx[0], &can.tx[1], can.txCount * sizeof(can.tx[0]));
+	memmove(&can.txSlot[0], &can.txSlot[1], can.txCount);
+	can.sending = 0;
+	sendNext();
+}
+
+uint8_t hal_host_canTake(HAL_HOST_CAN_FRAME* frame){
+	if(can.logCount == 0){
+		return 0;
+	}
+	*frame = can.log[can.logHead];
+	can.logHead = (can.logHead + 1) % HAL_HOST_CAN_LOG;
+	can.logCount--;
+	return 1;
+}
+
+uint32_t hal_host_canLogDropped(void){
+	return can.logDropped;
+}
+
+void hal_host_canAcknowledge(uint8_t acknowledge){
+	can.acknowledge = acknowledge;
+	if(can.hfdcan != NULL){
+		sendNext();
+	}
+}
+
+//-- Reception --
+static uint8_t matches(const FDCAN_FilterTypeDef* filter, uint32_t id){
+	switch(filter->FilterType){
+	case FDCAN_FILTER_RANGE:
+		return id >= filter->FilterID1 && id <= filter->FilterID2;
+	case FDCAN_FILTER_DUAL:
+		return id == filter->FilterID1 || id == filter->FilterID2;
+	case FDCAN_FILTER_MASK:
+		return (id & filter->FilterID2) == (filter->FilterID1 & filter->FilterID2);
+	default:
+		return 0;
+	}
+}
+
+static uint8_t accepted(const FDCAN_HandleTypeDef* hfdcan, uint32_t id){
+	for(uint32_t i = 0; i < hfdcan->Init.StdFiltersNbr && i < STD_FILTERS; i++){
+		const FDCAN_FilterTypeDef* filter = &can.filters[i];
+		if(filter->FilterConfig != FDCAN_FILTER_DISABLE && matches(filter, id)){
+			return filter->FilterConfig == FDCAN_FILTER_TO_RXFIFO0;
+		}
+	}
+	return can.nonMatching == FDCAN_ACCEPT_IN_RX_FIFO0;
+}
+
+uint8_t hal_host_canReceive(FDCAN_HandleTypeDef* hfdcan, uint32_t id, const uint8_t* data, uint8_t length){
+	if(hfdcan->State != HAL_FDCAN_STATE_BUSY || !accepted(hfdcan, id & 0x7FF) || can.rxCount == RX_FIFO){
+		return 0;
+	}
+	FRAME* frame = &can.rx[(can.rxHead + can.rxCount++) % RX_FIFO];
+	frame->id = id & 0x7FF;
+	frame->length = (length > 8) ? 8 : length;
+	memcpy(frame->data, data, frame->length);
+	hfdcan->Instance->RXF0S = can.rxCount;
+	if(can.notifications & FDCAN_IT_RX_FIFO0_NEW_MESSAGE){
+		HAL_FDCAN_RxFifo0Callback(hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE);
+	}
+	return 1;
+}
+
+//-- HAL --
+HAL_StatusTypeDef HAL_FDCAN_Init(FDCAN_HandleTypeDef* hfdcan){
+	if(hfdcan == NULL){
+		return HAL_ERROR;
+	}
+	can.hfdcan = hfdcan;
+	hfdcan->ErrorCode = HAL_FDCAN_ERROR_NONE;
+	hfdcan->State = HAL_FDCAN_STATE_READY;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_DeInit(FDCAN_HandleTypeDef* hfdcan){
+	HAL_FDCAN_Stop(hfdcan);
+	hfdcan->State = HAL_FDCAN_STATE_RESET;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef* hfdcan){
+	if(hfdcan->State != HAL_FDCAN_STATE_READY){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_NOT_READY;
+		return HAL_ERROR;
+	}
+	can.hfdcan = hfdcan;
+	hfdcan->State = HAL_FDCAN_STATE_BUSY;
+	sendNext();
+	return HAL_OK;
+}
+
+//Pending frames are dropped, like the transmission requests cancelled by the initialization mode
+HAL_StatusTypeDef HAL_FDCAN_Stop(FDCAN_HandleTypeDef* hfdcan){
+	if(hfdcan->State != HAL_FDCAN_STATE_BUSY){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_NOT_STARTED;
+		return HAL_ERROR;
+	}
+	hal_host_cancel(frameSent, NULL);
+	can.sending = 0;
+	can.txCount = 0;
+	hfdcan->Instance->TXBRP = 0;
+	hfdcan->State = HAL_FDCAN_STATE_READY;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef* hfdcan, const FDCAN_FilterTypeDef* sFilterConfig){
+	if(sFilterConfig->IdType != FDCAN_STANDARD_ID || sFilterConfig->FilterIndex >= STD_FILTERS){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+	can.filters[sFilterConfig->FilterIndex] = *sFilterConfig;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef* hfdcan, uint32_t NonMatchingStd, uint32_t NonMatchingExt, uint32_t RejectRemoteStd, uint32_t RejectRemoteExt){
+	UNUSED(NonMatchingExt);
+	UNUSED(RejectRemoteStd);
+	UNUSED(RejectRemoteExt);
+	can.nonMatching = NonMatchingStd;
+	hfdcan->Instance->RXGFC = NonMatchingStd << 4;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef* hfdcan, uint32_t ActiveITs, uint32_t BufferIndexes){
+	UNUSED(BufferIndexes);
+	can.notifications |= ActiveITs;
+	hfdcan->Instance->IE = can.notifications;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_DeactivateNotification(FDCAN_HandleTypeDef* hfdcan, uint32_t InactiveITs){
+	can.notifications &= ~InactiveITs;
+	hfdcan->Instance->IE = can.notifications;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef* hfdcan, const FDCAN_TxHeaderTypeDef* pTxHeader, const uint8_t* pTxData){
+	if(hfdcan->State != HAL_FDCAN_STATE_BUSY){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_NOT_STARTED;
+		return HAL_ERROR;
+	}
+	if(can.txCount == TX_FIFO){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_FIFO_FULL;
+		return HAL_ERROR;
+	}
+	//First free TX buffer
+	uint8_t slot = 0;
+	while(hfdcan->Instance->TXBRP & (1u << slot)){
+		slot++;
+	}
+	FRAME* frame = &can.tx[can.txCount];
+	frame->id = pTxHeader->Identifier & 0x7FF;
+	frame->length = (uint8_t)(pTxHeader->DataLength >> 16);
+	if(frame->length > 8){
+		frame->length = 8;
+	}
+	memset(frame->data, 0, sizeof(frame->data));
+	memcpy(frame->data, pTxData, frame->length);
+	can.txSlot[can.txCount++] = slot;
+	hfdcan->Instance->TXBRP |= 1u << slot;
+	hfdcan->LatestTxFifoQRequest = 1u << slot;
+	sendNext();
+	return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef* hfdcan){
+	UNUSED(hfdcan);
+	return TX_FIFO - can.txCount;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef* hfdcan, uint32_t RxLocation, FDCAN_RxHeaderTypeDef* pRxHeader, uint8_t* pRxData){
+	if(RxLocation != FDCAN_RX_FIFO0){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+	if(can.rxCount == 0){
+		hfdcan->ErrorCode |= HAL_FDCAN_ERROR_FIFO_EMPTY;
+		return HAL_ERROR;
+	}
+	const FRAME* frame = &can.rx[can.rxHead];
+	*pRxHeader = (FDCAN_RxHeaderTypeDef){
+		.Identifier = frame->id,
+		.IdType = FDCAN_STANDARD_ID,
+		.RxFrameType = FDCAN_DATA_FRAME,
+		.DataLength = (uint32_t)frame->length << 16,
+		.RxTimestamp = (uint32_t)(hal_host_now() / HAL_HOST_US(1)) & 0xFFFF
+	};
+	memcpy(pRxData, frame->data, frame->length);
+	can.rxHead = (can.rxHead + 1) % RX_FIFO;
+	can.rxCount--;
+	hfdcan->Instance->RXF0S = can.rxCount;
+	return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef* hfdcan, uint32_t RxFifo){
+	UNUSED(hfdcan);
+	return (RxFifo == FDCAN_RX_FIFO0) ? can.rxCount : 0;
+}
+
+__weak void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef* hfdcan, uint32_t RxFifo0ITs){
+	UNUSED(hfdcan);
+	UNUSED(RxFifo0ITs);
+}
@@ -0,0 +1,161 @@
+/*
+ * hal_host_gpio.c
+ *
+ * GPIO and DAC of the host HAL. A pin configured as an output reads back what the port drives, the others read the
+ * level given by hal_host_gpioInput(). The model of a port sees every write and may change what is read, e.g. a
+ * slave holding an open drain line low.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <string.h>
+
+#define PORTS (sizeof(hal_host_gpio) / sizeof(hal_host_gpio[0]))
+
+typedef struct {
+	uint16_t input;
+	uint16_t output; //pins configured as outputs
+	HAL_HOST_GPIO_MODEL model;
+	uint32_t writes[16];
+} PORT_STATE;
+
+GPIO_TypeDef hal_host_gpio[9];
+DAC_TypeDef hal_host_dac1;
+static PORT_STATE ports[PORTS];
+
+static PORT_STATE* portState(const GPIO_TypeDef* port){
+	return &ports[port - hal_host_gpio];
+}
+
+void hal_host_gpioReset(void){
+	memset(hal_host_gpio, 0, sizeof(hal_host_gpio));
+	memset(ports, 0, sizeof(ports));
+	memset(&hal_host_dac1, 0, sizeof(hal_host_dac1));
+}
+
+void hal_host_gpioAttach(GPIO_TypeDef* port, const HAL_HOST_GPIO_MODEL* model){
+	portState(port)->model = (model == NULL) ? (HAL_HOST_GPIO_MODEL){0} : *model;
+}
+
+void hal_host_gpioInput(GPIO_TypeDef* port, uint16_t pins, GPIO_PinState state){
+	PORT_STATE* s = portState(port);
+	s->input = (state == GPIO_PIN_SET) ? (s->input | pins) : (s->input & ~pins);
+	port->IDR = (port->ODR & s->output) | (s->input & ~s->output);
+}
+
+uint32_t hal_host_gpioWrites(GPIO_TypeDef* port, uint16_t pin){
+	uint8_t bit = 0;
+	while(bit < 15 && !(pin & (1u << bit))){
+		bit++;
+	}
+	return portState(port)->writes[bit];
+}
+
+//-- GPIO --
+void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, const GPIO_InitTypeDef* pGPIO_Init){
+	PORT_STATE* s = portState(GPIOx);
+	for(uint8_t bit = 0; bit < 16; bit++){
+		if(!(pGPIO_Init->Pin & (1u << bit))){
+			continue;
+		}
+		uint32_t mode = pGPIO_Init->Mode & 0x3u;
+		GPIOx->MODER = (GPIOx->MODER & ~(0x3u << (2 * bit))) | (mode << (2 * bit));
+		if(mode == GPIO_MODE_OUTPUT_PP){
+			s->output |= (1u << bit);
+		}
+		else{
+			s->output &= ~(1u << bit);
+		}
+	}
+	GPIOx->IDR = (GPIOx->ODR & s->output) | (s->input & ~s->output);
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef* GPIOx, uint32_t GPIO_Pin){
+	GPIO_InitTypeDef input = {.Pin = GPIO_Pin, .Mode = GPIO_MODE_INPUT};
+	HAL_GPIO_Init(GPIOx, &input);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+	PORT_STATE* s = portState(GPIOx);
+	uint16_t levels = (GPIOx->ODR & s->output) | (s->input & ~s->output);
+	GPIO_PinState level = (levels & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+	if(s->model.read != NULL){
+		level = s->model.read(s->model.context, (GPIO_TypeDef*)GPIOx, GPIO_Pin, level);
+	}
+	return level;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState){
+	PORT_STATE* s = portState(GPIOx);
+	GPIOx->ODR = (PinState == GPIO_PIN_SET) ? (GPIOx->ODR | GPIO_Pin) : (GPIOx->ODR & ~(uint32_t)GPIO_Pin);
+	GPIOx->IDR = (GPIOx->ODR & s->output) | (s->input & ~s->output);
+	for(uint8_t bit = 0; bit < 16; bit++){
+		if(GPIO_Pin & (1u << bit)){
+			s->writes[bit]++;
+		}
+	}
+	if(s->model.write != NULL){
+		s->model.write(s->model.context, GPIOx, GPIO_Pin, PinState);
+	}
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+	uint16_t set = GPIOx->ODR & GPIO_Pin;
+	if(set){
+		HAL_GPIO_WritePin(GPIOx, set, GPIO_PIN_RESET);
+	}
+	if(GPIO_Pin & ~set){
+		HAL_GPIO_WritePin(GPIOx, GPIO_Pin & ~set, GPIO_PIN_SET);
+	}
+}
+
+//-- DAC --
+HAL_StatusTypeDef HAL_DAC_Init(DAC_HandleTypeDef* hdac){
+	if(hdac == NULL){
+		return HAL_ERROR;
+	}
+	hdac->State = HAL_DAC_STATE_READY;
+	hdac->ErrorCode = 0;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DAC_Start(DAC_HandleTypeDef* hdac, uint32_t Channel){
+	hdac->Instance->CR |= (Channel == DAC_CHANNEL_1) ? DAC_CR_EN1 : DAC_CR_EN2;
+	hdac->State = HAL_DAC_STATE_READY;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DAC_Stop(DAC_HandleTypeDef* hdac, uint32_t Channel){
+	hdac->Instance->CR &= ~((Channel == DAC_CHANNEL_1) ? DAC_CR_EN1 : DAC_CR_EN2);
+	return HAL_OK;
+}
+
+//With no trigger the output register takes the holding register right away
+HAL_StatusTypeDef HAL_DAC_SetValue(DAC_HandleTypeDef* hdac, uint32_t Channel, uint32_t Alignment, uint32_t Data){
+	DAC_TypeDef* dac = hdac->Instance;
+	uint32_t value;
+	if(Alignment == DAC_ALIGN_12B_L){
+		value = (Data >> 4) & 0xFFFu;
+	}
+	else if(Alignment == DAC_ALIGN_8B_R){
+		value = (Data & 0xFFu) << 4;
+	}
+	else{
+		value = Data & 0xFFFu;
+	}
+	if(Channel == DAC_CHANNEL_1){
+		dac->DHR12R1 = value;
+		dac->DOR1 = value;
+	}
+	else{
+		dac->DHR12R2 = value;
+		dac->DOR2 = value;
+	}
+	return HAL_OK;
+}
+
+uint32_t HAL_DAC_GetValue(const DAC_HandleTypeDef* hdac, uint32_t Channel){
+	return (Channel == DAC_CHANNEL_1) ? hdac->Instance->DOR1 : hdac->Instance->DOR2;
+}
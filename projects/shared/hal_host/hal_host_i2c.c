@@ -0,0 +1,369 @@
+/*
+ * hal_host_i2c.c
+ *
+ * I2C masters of the host HAL. A transaction takes 9 SCL periods per byte (8 bits and the acknowledge) plus its
+ * START, repeated START and STOP, at the SCL period of Init.Timing (PRESC, SCLH and SCLL over PCLK1, 100 kHz when the
+ * timing is 0). The blocking transfers move the clock, the interrupt and DMA ones complete on it and exchange the
+ * bytes with the device at that moment.
+ *
+ * A device answering NACK fails the transfer with HAL_I2C_ERROR_AF, no device at the address is a NACK too. A device
+ * answering HOLD keeps the bus busy: a blocking transfer gives up after the 25 ms the HAL waits for the BUSY flag
+ * (HAL_ERROR, HAL_I2C_ERROR_TIMEOUT) and the interrupt and DMA transfers are refused with HAL_BUSY until a blocking
+ * transfer finds the bus released.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <string.h>
+
+#define BUSES (sizeof(hal_host_i2c) / sizeof(hal_host_i2c[0]))
+#define BUSY_TIMEOUT_MS 25 //I2C_TIMEOUT_BUSY of the HAL
+#define DEFAULT_SCL_PERIOD_NS 10000u
+
+typedef enum {
+	XFER_MASTER_WRITE,
+	XFER_MASTER_READ,
+	XFER_MEM_WRITE,
+	XFER_MEM_READ
+} XFER_TYPE;
+
+typedef struct {
+	HAL_HOST_I2C_DEVICE devices[128];
+	uint8_t held;
+	HAL_HOST_I2C_STATS stats;
+	//Interrupt or DMA transfer in progress
+	XFER_TYPE type;
+	uint8_t address;
+	uint16_t memAddress;
+	uint16_t memAddSize;
+} BUS_STATE;
+
+I2C_TypeDef hal_host_i2c[4];
+static BUS_STATE buses[BUSES];
+
+static BUS_STATE* busState(const I2C_TypeDef* instance){
+	return &buses[instance - hal_host_i2c];
+}
+
+void hal_host_i2cReset(void){
+	memset(hal_host_i2c, 0, sizeof(hal_host_i2c));
+	memset(buses, 0, sizeof(buses));
+}
+
+void hal_host_i2cAttach(I2C_TypeDef* instance, uint8_t address, const HAL_HOST_I2C_DEVICE* device){
+	busState(instance)->devices[address & 0x7F] = (device == NULL) ? (HAL_HOST_I2C_DEVICE){0} : *device;
+}
+
+void hal_host_i2cStats(I2C_TypeDef* instance, HAL_HOST_I2C_STATS* stats){
+	*stats = busState(instance)->stats;
+}
+
+//-- Register file device --
+//Next byte offset: on to the next register, or around the bytes of the selected one
+static void nextByte(HAL_HOST_I2C_REGS* regs){
+	if(regs->autoIncrement){
+		regs->pointer++;
+		return;
+	}
+	uint16_t base = regs->pointer - regs->pointer % regs->width;
+	regs->pointer = base + (regs->pointer - base + 1) % regs->width;
+}
+
+static HAL_HOST_I2C_RESPONSE regsWrite(void* context, const uint8_t* data, uint16_t length){
+	HAL_HOST_I2C_REGS* regs = context;
+	regs->writes++;
+	if(regs->response != HAL_HOST_I2C_ACK || length == 0){
+		return regs->response;
+	}
+	regs->pointer = (uint16_t)(data[0] * regs->width);
+	for(uint16_t i = 1; i < length; i++){
+		if(regs->pointer < regs->size){
+			regs->registers[regs->pointer] = data[i];
+		}
+		nextByte(regs);
+	}
+	if(regs->onWrite != NULL){
+		regs->onWrite(regs->context, data[0], length - 1);
+	}
+	return HAL_HOST_I2C_ACK;
+}
+
+static HAL_HOST_I2C_RESPONSE regsRead(void* context, uint8_t* data, uint16_t length){
+	HAL_HOST_I2C_REGS* regs = context;
+	regs->reads++;
+	if(regs->response != HAL_HOST_I2C_ACK){
+		return regs->response;
+	}
+	if(regs->onRead != NULL){
+		regs->onRead(regs->context, (uint8_t)(regs->pointer / regs->width), length);
+	}
+	for(uint16_t i = 0; i < length; i++){
+		data[i] = (regs->pointer < regs->size) ? regs->registers[regs->pointer] : 0xFF;
+		nextByte(regs);
+	}
+	return HAL_HOST_I2C_ACK;
+}
+
+void hal_host_i2cAttachRegs(I2C_TypeDef* instance, uint8_t address, HAL_HOST_I2C_REGS* regs){
+	if(regs->width == 0){
+		regs->width = 1;
+	}
+	HAL_HOST_I2C_DEVICE device = {.write = regsWrite, .read = regsRead, .context = regs};
+	hal_host_i2cAttach(instance, address, &device);
+}
+
+//-- Bus --
+static uint64_t sclPeriod(const I2C_HandleTypeDef* hi2c){
+	uint32_t timing = hi2c->Init.Timing;
+	if(timing == 0){
+		return DEFAULT_SCL_PERIOD_NS;
+	}
+	uint64_t prescaler = ((timing >> 28) & 0x0F) + 1;
+	uint64_t cycles = ((timing & 0xFF) + 1) + (((timing >> 8) & 0xFF) + 1);
+	return prescaler * cycles * 1000000000u / HAL_RCC_GetPCLK1Freq();
+}
+
+//Bits of a transaction: START, address, memory address bytes, repeated START and address of a read, data, STOP
+static uint32_t transactionBits(XFER_TYPE type, uint16_t memAddSize, uint16_t size){
+	switch(type){
+	case XFER_MEM_READ:
+		return 1 + 9 + 9 * memAddSize + 1 + 9 + 9 * size + 1;
+	case XFER_MEM_WRITE:
+		return 1 + 9 + 9 * memAddSize + 9 * size + 1;
+	default:
+		return 1 + 9 + 9 * size + 1;
+	}
+}
+
+//Exchanges the bytes with the device, gives the bus time actually used
+static HAL_HOST_I2C_RESPONSE exchange(I2C_HandleTypeDef* hi2c, BUS_STATE* bus, XFER_TYPE type, uint8_t address,
+		uint16_t memAddress, uint16_t memAddSize, uint8_t* data, uint16_t size, uint64_t* busyNs){
+	HAL_HOST_I2C_DEVICE* device = &bus->devices[address];
+	HAL_HOST_I2C_RESPONSE response = HAL_HOST_I2C_NACK;
+	uint32_t bits = 1 + 9 + 1; //a NACKed address
+	bus->stats.transfers++;
+
+	if(type == XFER_MEM_WRITE || type == XFER_MEM_READ){
+		uint8_t header[2 + (type == XFER_MEM_WRITE ? size : 0)];
+		uint16_t length = 0;
+		if(memAddSize == I2C_MEMADD_SIZE_16BIT){
+			header[length++] = memAddress >> 8;
+		}
+		header[length++] = memAddress & 0xFF;
+		if(type == XFER_MEM_WRITE){
+			memcpy(&header[length], data, size);
+			length += size;
+		}
+		if(device->write != NULL){
+			response = device->write(device->context, header, length);
+		}
+		if(response == HAL_HOST_I2C_ACK && type == XFER_MEM_READ){
+			response = (device->read != NULL) ? device->read(device->context, data, size) : HAL_HOST_I2C_NACK;
+		}
+	}
+	else if(type == XFER_MASTER_WRITE && device->write != NULL){
+		response = device->write(device->context, data, size);
+	}
+	else if(type == XFER_MASTER_READ && device->read != NULL){
+		response = device->read(device->context, data, size);
+	}
+
+	if(response == HAL_HOST_I2C_ACK){
+		bits = transactionBits(type, memAddSize, size);
+		bus->stats.bytes += (type == XFER_MEM_READ ? 2 : 1) + (type >= XFER_MEM_WRITE ? memAddSize : 0) + size;
+		bus->held = 0;
+	}
+	else if(response == HAL_HOST_I2C_NACK){
+		bus->stats.nacks++;
+		bus->held = 0;
+	}
+	else{
+		bus->stats.timeouts++;
+		bus->held = 1;
+		bits = 0;
+	}
+	*busyNs = bits * sclPeriod(hi2c);
+	bus->stats.busyNs += *busyNs;
+	return response;
+}
+
+static HAL_StatusTypeDef blocking(I2C_HandleTypeDef* hi2c, XFER_TYPE type, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t* pData, uint16_t Size){
+	if(hi2c->State != HAL_I2C_STATE_READY){
+		return HAL_BUSY;
+	}
+	BUS_STATE* bus = busState(hi2c->Instance);
+	hi2c->State = (type == XFER_MASTER_READ || type == XFER_MEM_READ) ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+	hi2c->Mode = (type >= XFER_MEM_WRITE) ? HAL_I2C_MODE_MEM : HAL_I2C_MODE_MASTER;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+
+	uint64_t busyNs;
+	HAL_HOST_I2C_RESPONSE response = exchange(hi2c, bus, type, (DevAddress >> 1) & 0x7F, MemAddress, MemAddSize, pData, Size, &busyNs);
+	hal_host_advance(response == HAL_HOST_I2C_HOLD ? HAL_HOST_MS(BUSY_TIMEOUT_MS) : busyNs);
+	hi2c->State = HAL_I2C_STATE_READY;
+	hi2c->Mode = HAL_I2C_MODE_NONE;
+	if(response == HAL_HOST_I2C_ACK){
+		return HAL_OK;
+	}
+	hi2c->ErrorCode |= (response == HAL_HOST_I2C_NACK) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_TIMEOUT;
+	return HAL_ERROR;
+}
+
+static void asyncDone(void* context){
+	I2C_HandleTypeDef* hi2c = context;
+	BUS_STATE* bus = busState(hi2c->Instance);
+	uint64_t busyNs;
+	HAL_HOST_I2C_RESPONSE response = exchange(hi2c, bus, bus->type, bus->address, bus->memAddress, bus->memAddSize,
+			hi2c->pBuffPtr, hi2c->XferSize, &busyNs);
+	hi2c->State = HAL_I2C_STATE_READY;
+	hi2c->Mode = HAL_I2C_MODE_NONE;
+	hi2c->XferCount = 0;
+	if(response != HAL_HOST_I2C_ACK){
+		hi2c->ErrorCode |= (response == HAL_HOST_I2C_NACK) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_TIMEOUT;
+		HAL_I2C_ErrorCallback(hi2c);
+	}
+	else if(bus->type == XFER_MEM_READ){
+		HAL_I2C_MemRxCpltCallback(hi2c);
+	}
+	else if(bus->type == XFER_MEM_WRITE){
+		HAL_I2C_MemTxCpltCallback(hi2c);
+	}
+	else if(bus->type == XFER_MASTER_READ){
+		HAL_I2C_MasterRxCpltCallback(hi2c);
+	}
+	else{
+		HAL_I2C_MasterTxCpltCallback(hi2c);
+	}
+}
+
+static HAL_StatusTypeDef async(I2C_HandleTypeDef* hi2c, XFER_TYPE type, uint16_t DevAddress, uint16_t MemAddress,
+		uint16_t MemAddSize, uint8_t* pData, uint16_t Size, DMA_HandleTypeDef* dma, uint8_t useDma){
+	BUS_STATE* bus = busState(hi2c->Instance);
+	if(hi2c->State != HAL_I2C_STATE_READY || bus->held){
+		return HAL_BUSY;
+	}
+	if(useDma && dma == NULL){
+		hi2c->ErrorCode |= HAL_I2C_ERROR_DMA;
+		return HAL_ERROR;
+	}
+	hi2c->State = (type == XFER_MASTER_READ || type == XFER_MEM_READ) ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+	hi2c->Mode = (type >= XFER_MEM_WRITE) ? HAL_I2C_MODE_MEM : HAL_I2C_MODE_MASTER;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	hi2c->pBuffPtr = pData;
+	hi2c->XferSize = Size;
+	hi2c->XferCount = Size;
+	bus->type = type;
+	bus->address = (DevAddress >> 1) & 0x7F;
+	bus->memAddress = MemAddress;
+	bus->memAddSize = MemAddSize;
+	hal_host_schedule(transactionBits(type, MemAddSize, Size) * sclPeriod(hi2c), asyncDone, hi2c);
+	return HAL_OK;
+}
+
+//-- HAL --
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c){
+	if(hi2c == NULL){
+		return HAL_ERROR;
+	}
+	hi2c->Instance->TIMINGR = hi2c->Init.Timing & 0xF0FFFFFFu;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	hi2c->State = HAL_I2C_STATE_READY;
+	hi2c->Mode = HAL_I2C_MODE_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef* hi2c){
+	hal_host_cancel(asyncDone, hi2c);
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	hi2c->State = HAL_I2C_STATE_RESET;
+	hi2c->Mode = HAL_I2C_MODE_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout){
+	UNUSED(Timeout);
+	return blocking(hi2c, XFER_MASTER_WRITE, DevAddress, 0, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout){
+	UNUSED(Timeout);
+	return blocking(hi2c, XFER_MASTER_READ, DevAddress, 0, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout){
+	UNUSED(Timeout);
+	return blocking(hi2c, XFER_MEM_WRITE, DevAddress, MemAddress, MemAddSize, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout){
+	UNUSED(Timeout);
+	return blocking(hi2c, XFER_MEM_READ, DevAddress, MemAddress, MemAddSize, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint32_t Trials, uint32_t Timeout){
+	UNUSED(Trials);
+	UNUSED(Timeout);
+	return blocking(hi2c, XFER_MASTER_WRITE, DevAddress, 0, 0, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MASTER_WRITE, DevAddress, 0, 0, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MASTER_READ, DevAddress, 0, 0, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MASTER_WRITE, DevAddress, 0, 0, pData, Size, hi2c->hdmatx, 1);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MASTER_READ, DevAddress, 0, 0, pData, Size, hi2c->hdmarx, 1);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MEM_WRITE, DevAddress, MemAddress, MemAddSize, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MEM_READ, DevAddress, MemAddress, MemAddSize, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MEM_WRITE, DevAddress, MemAddress, MemAddSize, pData, Size, hi2c->hdmatx, 1);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size){
+	return async(hi2c, XFER_MEM_READ, DevAddress, MemAddress, MemAddSize, pData, Size, hi2c->hdmarx, 1);
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(const I2C_HandleTypeDef* hi2c){
+	return hi2c->State;
+}
+
+uint32_t HAL_I2C_GetError(const I2C_HandleTypeDef* hi2c){
+	return hi2c->ErrorCode;
+}
+
+__weak void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c){
+	UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c){
+	UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c){
+	UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c){
+	UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c){
+	UNUSED(hi2c);
+}
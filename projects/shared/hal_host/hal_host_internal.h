@@ -0,0 +1,22 @@
+/*
+ * hal_host_internal.h
+ *
+ * Shared between the files of the host HAL, not for the tests.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef HAL_HOST_INTERNAL_H_
+#define HAL_HOST_INTERNAL_H_
+
+#include "hal_host.h"
+
+// Clears the state of each peripheral, called by hal_host_reset()
+void hal_host_gpioReset(void);
+void hal_host_timReset(void);
+void hal_host_uartReset(void);
+void hal_host_i2cReset(void);
+void hal_host_canReset(void);
+
+#endif /* HAL_HOST_INTERNAL_H_ */
@@ -0,0 +1,300 @@
+/*
+ * hal_host_tim.c
+ *
+ * Timers of the host HAL: up-counting from the timer clock divided by PSC + 1, an update event each ARR + 1 counts.
+ * The counter is computed from the virtual clock when it is read, so CNT is only up to date through
+ * __HAL_TIM_GET_COUNTER(). Writing the counter, the auto-reload or the prescaler of a running timer moves its next
+ * update right away (no preload), keeping the count reached. A DMA burst started on the update request writes one
+ * word of its buffer to a register at each update event.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <string.h>
+
+#define TIMERS (sizeof(hal_host_tim) / sizeof(hal_host_tim[0]))
+
+typedef struct {
+	TIM_HandleTypeDef* htim;
+	uint8_t running;
+	uint8_t interrupt;
+	int64_t base; //virtual time at which the counter was 0 in the current period
+	uint32_t updates;
+	//DMA burst on the update request, the words left are counted by the DMA channel
+	const uint32_t* burstBuffer;
+	uint32_t burstBytes;
+	uint32_t burstRegister; //offset in words from CR1
+} TIMER_STATE;
+
+TIM_TypeDef hal_host_tim[17];
+static TIMER_STATE timers[TIMERS];
+
+static TIMER_STATE* timerState(const TIM_TypeDef* instance){
+	return &timers[instance - hal_host_tim];
+}
+
+//Timers run at twice the bus clock when the bus is divided, like TIMPCLK of the board
+static uint32_t timerClock(void){
+	uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+	return ((RCC->CFGR2 & RCC_CFGR2_PPRE1) == RCC_HCLK_DIV1) ? pclk : 2 * pclk;
+}
+
+//Time of a number of counts in ns, rounded up
+static int64_t countsNs(const TIM_TypeDef* tim, uint64_t counts){
+	unsigned __int128 scaled = (unsigned __int128)counts * (tim->PSC + 1u) * 1000000000u;
+	return (int64_t)((scaled + timerClock() - 1) / timerClock());
+}
+
+static uint32_t countAt(const TIM_TypeDef* tim, const TIMER_STATE* s){
+	int64_t elapsed = (int64_t)hal_host_now() - s->base;
+	if(elapsed <= 0){
+		return 0;
+	}
+	unsigned __int128 counts = (unsigned __int128)elapsed * timerClock() / ((uint64_t)(tim->PSC + 1u) * 1000000000u);
+	return (uint32_t)(counts % ((uint64_t)tim->ARR + 1u));
+}
+
+//Writes the next word of the update DMA burst, returns 1 if it was the last one
+static uint8_t burstWrite(TIMER_STATE* s){
+	TIM_HandleTypeDef* htim = s->htim;
+	DMA_HandleTypeDef* hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+	if(!(htim->Instance->DIER & TIM_DIER_UDE) || hdma == NULL || hdma->State != HAL_DMA_STATE_BUSY){
+		return 0;
+	}
+	uint32_t left = hdma->Instance->CBR1 & 0xFFFFu;
+	*(&htim->Instance->CR1 + s->burstRegister) = s->burstBuffer[(s->burstBytes - left) / sizeof(uint32_t)];
+	left -= sizeof(uint32_t);
+	hdma->Instance->CBR1 = left;
+	if(left > 0){
+		return 0;
+	}
+	hdma->State = HAL_DMA_STATE_READY;
+	return 1;
+}
+
+static void update(void* context);
+
+static void scheduleUpdate(TIMER_STATE* s){
+	TIM_TypeDef* tim = s->htim->Instance;
+	hal_host_cancel(update, s);
+	int64_t next = s->base + countsNs(tim, (uint64_t)tim->ARR + 1u);
+	int64_t delay = next - (int64_t)hal_host_now();
+	hal_host_schedule(delay > 0 ? (uint64_t)delay : 0, update, s);
+}
+
+static void update(void* context){
+	TIMER_STATE* s = context;
+	TIM_TypeDef* tim = s->htim->Instance;
+	s->base += countsNs(tim, (uint64_t)tim->ARR + 1u);
+	s->updates++;
+	tim->SR |= TIM_SR_UIF;
+	scheduleUpdate(s);
+	uint8_t burstDone = burstWrite(s);
+	if(s->interrupt){
+		HAL_TIM_PeriodElapsedCallback(s->htim);
+	}
+	//The DMA completion is its own interrupt, taken after the update one
+	if(burstDone){
+		HAL_TIM_PeriodElapsedCallback(s->htim);
+	}
+}
+
+static void start(TIM_HandleTypeDef* htim, uint8_t interrupt){
+	TIMER_STATE* s = timerState(htim->Instance);
+	s->htim = htim;
+	s->interrupt = interrupt;
+	if(!s->running){
+		s->running = 1;
+		s->base = (int64_t)hal_host_now() - countsNs(htim->Instance, htim->Instance->CNT);
+	}
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	htim->State = HAL_TIM_STATE_READY;
+	scheduleUpdate(s);
+}
+
+static void stop(TIM_HandleTypeDef* htim){
+	TIMER_STATE* s = timerState(htim->Instance);
+	if(s->running){
+		htim->Instance->CNT = countAt(htim->Instance, s);
+		s->running = 0;
+		hal_host_cancel(update, s);
+	}
+	s->interrupt = 0;
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+}
+
+void hal_host_timReset(void){
+	memset(hal_host_tim, 0, sizeof(hal_host_tim));
+	memset(timers, 0, sizeof(timers));
+}
+
+uint32_t hal_host_timUpdates(TIM_TypeDef* instance){
+	return timerState(instance)->updates;
+}
+
+uint32_t hal_host_timCounter(TIM_HandleTypeDef* htim){
+	TIMER_STATE* s = timerState(htim->Instance);
+	if(s->running){
+		htim->Instance->CNT = countAt(htim->Instance, s);
+	}
+	return htim->Instance->CNT;
+}
+
+void hal_host_timSetCounter(TIM_HandleTypeDef* htim, uint32_t counter){
+	TIMER_STATE* s = timerState(htim->Instance);
+	htim->Instance->CNT = counter;
+	if(s->running){
+		s->base = (int64_t)hal_host_now() - countsNs(htim->Instance, counter);
+		scheduleUpdate(s);
+	}
+}
+
+//A counter above the new auto-reload starts over from 0
+void hal_host_timSetAutoreload(TIM_HandleTypeDef* htim, uint32_t autoreload){
+	uint32_t counter = hal_host_timCounter(htim);
+	htim->Instance->ARR = autoreload;
+	hal_host_timSetCounter(htim, counter > autoreload ? 0 : counter);
+}
+
+void hal_host_timSetPrescaler(TIM_HandleTypeDef* htim, uint32_t prescaler){
+	uint32_t counter = hal_host_timCounter(htim);
+	htim->Instance->PSC = prescaler;
+	hal_host_timSetCounter(htim, counter);
+}
+
+//-- HAL --
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim){
+	if(htim == NULL){
+		return HAL_ERROR;
+	}
+	htim->Instance->PSC = htim->Init.Prescaler;
+	htim->Instance->ARR = htim->Init.Period;
+	htim->State = HAL_TIM_STATE_READY;
+	for(uint8_t i = 0; i < 4; i++){
+		htim->ChannelState[i] = HAL_TIM_CHANNEL_STATE_READY;
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim){
+	start(htim, 0);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef* htim){
+	stop(htim);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim){
+	htim->Instance->DIER |= TIM_DIER_UIE;
+	start(htim, 1);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim){
+	htim->Instance->DIER &= ~TIM_DIER_UIE;
+	stop(htim);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef* htim){
+	return HAL_TIM_Base_Init(htim);
+}
+
+//CCxE of each channel in CCER, 4 bits apart
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel){
+	htim->Instance->CCER |= 1u << Channel;
+	htim->ChannelState[Channel >> 2] = HAL_TIM_CHANNEL_STATE_BUSY;
+	start(htim, timerState(htim->Instance)->interrupt);
+	return HAL_OK;
+}
+
+//The counter only stops once no channel is enabled any more
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel){
+	htim->Instance->CCER &= ~(1u << Channel);
+	htim->ChannelState[Channel >> 2] = HAL_TIM_CHANNEL_STATE_READY;
+	if((htim->Instance->CCER & 0x1111u) == 0){
+		stop(htim);
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef* htim, const TIM_OC_InitTypeDef* sConfig, uint32_t Channel){
+	__HAL_TIM_SET_COMPARE(htim, Channel, sConfig->Pulse);
+	htim->ChannelState[Channel >> 2] = HAL_TIM_CHANNEL_STATE_READY;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim, const TIM_ClockConfigTypeDef* sClockSourceConfig){
+	return sClockSourceConfig->ClockSource == TIM_CLOCKSOURCE_INTERNAL ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim, const TIM_MasterConfigTypeDef* sMasterConfig){
+	return HAL_OK;
+}
+
+//The update events of the model call the callback themselves, this only serves an update flag left pending
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim){
+	if((htim->Instance->SR & TIM_SR_UIF) && (htim->Instance->DIER & TIM_DIER_UIE)){
+		htim->Instance->SR &= ~TIM_SR_UIF;
+		HAL_TIM_PeriodElapsedCallback(htim);
+	}
+}
+
+//One register per update event, bursts of several registers are not modelled
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef* htim, uint32_t BurstBaseAddress, uint32_t BurstRequestSrc,
+	const uint32_t* BurstBuffer, uint32_t BurstLength, uint32_t DataLength){
+	DMA_HandleTypeDef* hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+	if(BurstRequestSrc != TIM_DMA_UPDATE || BurstLength != TIM_DMABURSTLENGTH_1TRANSFER || hdma == NULL || BurstBuffer == NULL
+		|| DataLength == 0 || DataLength > 0xFFFFu || DataLength % sizeof(uint32_t) != 0){
+		return HAL_ERROR;
+	}
+	if(hdma->State == HAL_DMA_STATE_BUSY){
+		return HAL_BUSY;
+	}
+	TIMER_STATE* s = timerState(htim->Instance);
+	s->htim = htim;
+	s->burstBuffer = BurstBuffer;
+	s->burstBytes = DataLength;
+	s->burstRegister = BurstBaseAddress;
+	hdma->Instance->CBR1 = DataLength;
+	hdma->State = HAL_DMA_STATE_BUSY;
+	htim->Instance->DIER |= BurstRequestSrc;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t BurstRequestSrc){
+	htim->Instance->DIER &= ~BurstRequestSrc;
+	if(htim->hdma[TIM_DMA_ID_UPDATE] != NULL){
+		HAL_DMA_Abort(htim->hdma[TIM_DMA_ID_UPDATE]);
+	}
+	return HAL_OK;
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim){
+	UNUSED(htim);
+}
+
+//-- DMA --
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma){
+	if(hdma == NULL){
+		return HAL_ERROR;
+	}
+	hdma->Mode = hdma->Init.Mode;
+	hdma->Instance->CBR1 = 0;
+	hdma->State = HAL_DMA_STATE_READY;
+	return HAL_OK;
+}
+
+//The counter keeps the bytes that were not transferred
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma){
+	hdma->State = HAL_DMA_STATE_READY;
+	return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma){
+	UNUSED(hdma);
+}
@@ -0,0 +1,341 @@
+/*
+ * hal_host_uart.c
+ *
+ * UART of the host HAL. Transmissions take 10 bits per byte at the baud rate: the blocking one moves the clock, the
+ * interrupt and DMA ones complete on it with HAL_UART_TxCpltCallback(). The bytes are then captured and passed to the
+ * model of the UART. Receptions are filled by hal_host_uartReceive() and raise the callbacks of the HAL in the same
+ * cases: half and full transfer of a DMA reception, idle line of a reception to idle (only with bytes received and
+ * the buffer not full, like the HAL), the end of a normal reception, and errors that abort a DMA reception.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "hal_host_internal.h"
+#include <string.h>
+
+#define UARTS (sizeof(hal_host_usart) / sizeof(hal_host_usart[0]))
+#define DEFAULT_BAUD_RATE 115200u
+
+typedef enum {
+	RX_NONE,
+	RX_IT,
+	RX_DMA
+} RX_MODE;
+
+typedef struct {
+	UART_HandleTypeDef* huart; //handle given to HAL_UART_Init()
+	HAL_HOST_UART_MODEL model;
+	uint8_t sent[HAL_HOST_UART_CAPTURE];
+	uint16_t sentHead; //oldest byte not taken
+	uint16_t sentCount;
+	uint32_t lost;
+	RX_MODE rxMode;
+	uint8_t circular;
+	uint16_t rxPosition; //bytes written in the current pass over the buffer
+} UART_STATE;
+
+USART_TypeDef hal_host_usart[6];
+static UART_STATE uarts[UARTS];
+
+static UART_STATE* uartState(const USART_TypeDef* instance){
+	return &uarts[instance - hal_host_usart];
+}
+
+void hal_host_uartReset(void){
+	memset(hal_host_usart, 0, sizeof(hal_host_usart));
+	memset(uarts, 0, sizeof(uarts));
+}
+
+void hal_host_uartAttach(USART_TypeDef* instance, const HAL_HOST_UART_MODEL* model){
+	uartState(instance)->model = (model == NULL) ? (HAL_HOST_UART_MODEL){0} : *model;
+}
+
+uint16_t hal_host_uartSent(USART_TypeDef* instance, uint8_t* data, uint16_t size){
+	UART_STATE* s = uartState(instance);
+	uint16_t count = 0;
+	while(count < size && s->sentCount > 0){
+		data[count++] = s->sent[s->sentHead];
+		s->sentHead = (s->sentHead + 1) % HAL_HOST_UART_CAPTURE;
+		s->sentCount--;
+	}
+	return count;
+}
+
+uint32_t hal_host_uartLost(USART_TypeDef* instance){
+	return uartState(instance)->lost;
+}
+
+uint64_t hal_host_uartByteTime(const UART_HandleTypeDef* huart, uint32_t bytes){
+	uint32_t baud = (huart->Init.BaudRate == 0) ? DEFAULT_BAUD_RATE : huart->Init.BaudRate;
+	return ((uint64_t)bytes * 10u * 1000000000u + baud - 1) / baud;
+}
+
+//Bytes on the TX line: captured (the oldest dropped when full) and passed to the model
+static void transmitted(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t length){
+	UART_STATE* s = uartState(huart->Instance);
+	for(uint16_t i = 0; i < length; i++){
+		if(s->sentCount == HAL_HOST_UART_CAPTURE){
+			s->sentHead = (s->sentHead + 1) % HAL_HOST_UART_CAPTURE;
+			s->sentCount--;
+		}
+		s->sent[(s->sentHead + s->sentCount) % HAL_HOST_UART_CAPTURE] = data[i];
+		s->sentCount++;
+	}
+	if(s->model.transmit != NULL){
+		s->model.transmit(s->model.context, huart, data, length);
+	}
+}
+
+//-- Transmission --
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart){
+	if(huart == NULL){
+		return HAL_ERROR;
+	}
+	UART_STATE* s = uartState(huart->Instance);
+	s->huart = huart;
+	s->rxMode = RX_NONE;
+	huart->gState = HAL_UART_STATE_READY;
+	huart->RxState = HAL_UART_STATE_READY;
+	huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef* huart){
+	uartState(huart->Instance)->rxMode = RX_NONE;
+	huart->gState = HAL_UART_STATE_RESET;
+	huart->RxState = HAL_UART_STATE_RESET;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout){
+	UNUSED(Timeout);
+	if(huart->gState != HAL_UART_STATE_READY){
+		return HAL_BUSY;
+	}
+	if(pData == NULL || Size == 0){
+		return HAL_ERROR;
+	}
+	huart->gState = HAL_UART_STATE_BUSY_TX;
+	huart->TxXferSize = Size;
+	hal_host_advance(hal_host_uartByteTime(huart, Size));
+	huart->TxXferCount = 0;
+	huart->gState = HAL_UART_STATE_READY;
+	transmitted(huart, pData, Size);
+	return HAL_OK;
+}
+
+//The data is read from the caller's buffer when the transfer ends, it must stay valid until then like on the board
+static void transmitDone(void* context){
+	UART_HandleTypeDef* huart = context;
+	huart->TxXferCount = 0;
+	huart->gState = HAL_UART_STATE_READY;
+	transmitted(huart, huart->pTxBuffPtr, huart->TxXferSize);
+	HAL_UART_TxCpltCallback(huart);
+}
+
+static HAL_StatusTypeDef transmitAsync(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size){
+	if(huart->gState != HAL_UART_STATE_READY){
+		return HAL_BUSY;
+	}
+	if(pData == NULL || Size == 0){
+		return HAL_ERROR;
+	}
+	huart->gState = HAL_UART_STATE_BUSY_TX;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	huart->pTxBuffPtr = pData;
+	huart->TxXferSize = Size;
+	huart->TxXferCount = Size;
+	hal_host_schedule(hal_host_uartByteTime(huart, Size), transmitDone, huart);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size){
+	return transmitAsync(huart, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size){
+	if(huart->hdmatx == NULL){
+		return HAL_ERROR;
+	}
+	return transmitAsync(huart, pData, Size);
+}
+
+//-- Reception --
+static HAL_StatusTypeDef startReception(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, RX_MODE mode, HAL_UART_RxTypeTypeDef type){
+	if(huart->RxState != HAL_UART_STATE_READY){
+		return HAL_BUSY;
+	}
+	if(pData == NULL || Size == 0 || (mode == RX_DMA && huart->hdmarx == NULL)){
+		return HAL_ERROR;
+	}
+	UART_STATE* s = uartState(huart->Instance);
+	s->huart = huart;
+	s->rxMode = mode;
+	s->circular = mode == RX_DMA && huart->hdmarx->Mode == DMA_LINKEDLIST_CIRCULAR;
+	s->rxPosition = 0;
+	huart->ReceptionType = type;
+	huart->RxEventType = HAL_UART_RXEVENT_TC;
+	huart->pRxBuffPtr = pData;
+	huart->RxXferSize = Size;
+	huart->RxXferCount = Size;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	huart->RxState = HAL_UART_STATE_BUSY_RX;
+	if(mode == RX_DMA){
+		huart->hdmarx->Instance->CBR1 = Size;
+	}
+	return HAL_OK;
+}
+
+static void endReception(UART_HandleTypeDef* huart){
+	uartState(huart->Instance)->rxMode = RX_NONE;
+	huart->RxState = HAL_UART_STATE_READY;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size){
+	return startReception(huart, pData, Size, RX_IT, HAL_UART_RECEPTION_STANDARD);
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size){
+	return startReception(huart, pData, Size, RX_DMA, HAL_UART_RECEPTION_STANDARD);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size){
+	return startReception(huart, pData, Size, RX_IT, HAL_UART_RECEPTION_TOIDLE);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size){
+	return startReception(huart, pData, Size, RX_DMA, HAL_UART_RECEPTION_TOIDLE);
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart){
+	endReception(huart);
+	huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+	huart->RxXferCount = 0;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	return HAL_OK;
+}
+
+//Half and full transfer events after a byte was written at rxPosition - 1
+static void receivedByte(UART_HandleTypeDef* huart, UART_STATE* s){
+	uint16_t size = huart->RxXferSize;
+	huart->RxXferCount = size - s->rxPosition;
+	if(s->rxMode == RX_DMA){
+		huart->hdmarx->Instance->CBR1 = huart->RxXferCount;
+		if(s->rxPosition == size / 2 && s->rxPosition < size){
+			huart->RxEventType = HAL_UART_RXEVENT_HT;
+			if(huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE){
+				HAL_UARTEx_RxEventCallback(huart, size / 2);
+			}
+			else{
+				HAL_UART_RxHalfCpltCallback(huart);
+			}
+		}
+	}
+	if(s->rxPosition < size){
+		return;
+	}
+
+	//A circular DMA starts over at the beginning of the buffer and the reception goes on
+	if(s->circular){
+		s->rxPosition = 0;
+		huart->hdmarx->Instance->CBR1 = size;
+		huart->RxXferCount = size;
+	}
+	else{
+		endReception(huart);
+	}
+	huart->RxEventType = HAL_UART_RXEVENT_TC;
+	if(huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE){
+		HAL_UARTEx_RxEventCallback(huart, size);
+	}
+	else{
+		HAL_UART_RxCpltCallback(huart);
+	}
+}
+
+static void idleLine(UART_HandleTypeDef* huart, UART_STATE* s){
+	huart->Instance->ISR |= UART_FLAG_IDLE;
+	if(s->rxMode == RX_NONE || huart->ReceptionType != HAL_UART_RECEPTION_TOIDLE){
+		return;
+	}
+	uint16_t remaining = huart->RxXferSize - s->rxPosition;
+	if(remaining == 0 || remaining == huart->RxXferSize){
+		return;
+	}
+	huart->RxEventType = HAL_UART_RXEVENT_IDLE;
+	if(!s->circular){
+		endReception(huart);
+		huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+	}
+	HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize - remaining);
+}
+
+uint16_t hal_host_uartReceive(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t length, uint8_t idle){
+	UART_STATE* s = uartState(huart->Instance);
+	uint16_t written = 0;
+	for(uint16_t i = 0; i < length; i++){
+		huart->Instance->RDR = data[i];
+		if(s->rxMode == RX_NONE){
+			//The byte stays in RDR and the next ones overrun it
+			huart->Instance->ISR |= UART_FLAG_ORE;
+			s->lost++;
+			continue;
+		}
+		huart->pRxBuffPtr[s->rxPosition++] = data[i];
+		written++;
+		receivedByte(huart, s);
+	}
+	if(idle){
+		idleLine(huart, s);
+	}
+	return written;
+}
+
+void hal_host_uartError(UART_HandleTypeDef* huart, uint32_t error){
+	UART_STATE* s = uartState(huart->Instance);
+	huart->ErrorCode |= error;
+	huart->Instance->ISR |= ((error & HAL_UART_ERROR_PE) ? UART_FLAG_PE : 0) | ((error & HAL_UART_ERROR_FE) ? UART_FLAG_FE : 0)
+			| ((error & HAL_UART_ERROR_NE) ? UART_FLAG_NE : 0) | ((error & HAL_UART_ERROR_ORE) ? UART_FLAG_ORE : 0);
+
+	//An overrun, or any error during a DMA reception, ends the reception before the callback
+	if(s->rxMode == RX_DMA || (error & HAL_UART_ERROR_ORE)){
+		endReception(huart);
+		huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+	}
+	HAL_UART_ErrorCallback(huart);
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef* huart){
+	return huart->gState | huart->RxState;
+}
+
+uint32_t HAL_UART_GetError(const UART_HandleTypeDef* huart){
+	return huart->ErrorCode;
+}
+
+HAL_UART_RxEventTypeTypeDef HAL_UARTEx_GetRxEventType(const UART_HandleTypeDef* huart){
+	return huart->RxEventType;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart){
+	UNUSED(huart);
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart){
+	UNUSED(huart);
+}
+
+__weak void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* huart){
+	UNUSED(huart);
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart){
+	UNUSED(huart);
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size){
+	UNUSED(huart);
+	UNUSED(Size);
+}
@@ -0,0 +1,951 @@
+/*
+ * stm32u5xx_hal.h
+ *
+ * Host stand-in for the STM32U5 HAL, so that the drivers and the base library build and run on a Linux machine.
+ * Only the part of the HAL they use is declared, with the names, fields and values of the real headers: the core
+ * (tick, interrupt mask, DWT cycle counter, NVIC), RCC clocks, GPIO, DAC, TIM with DMA bursts on the update event,
+ * UART with interrupt, DMA and idle line reception, I2C memory and master transfers, FDCAN and the flash. The
+ * register blocks are plain structures and the peripherals behind them are simulated on a virtual clock, see
+ * hal_host.h for the clock and the device models.
+ *
+ * Put this folder on the include path instead of Drivers/STM32U5xx_HAL_Driver/Inc and Drivers/CMSIS.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef STM32U5XX_HAL_H
+#define STM32U5XX_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-- Common --
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+	HAL_UNLOCKED = 0x00U,
+	HAL_LOCKED = 0x01U
+} HAL_LockTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+#define UNUSED(X) (void)(X)
+#define __weak __attribute__((weak))
+#define __IO volatile
+
+//-- Core (CMSIS) --
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	__IO uint32_t DHCSR;
+	__IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+// Each access to DWT takes a little virtual time, so that busy waits on the cycle counter end
+DWT_Type* hal_host_dwt(void);
+extern CoreDebug_Type hal_host_coreDebug;
+#define DWT (hal_host_dwt())
+#define CoreDebug (&hal_host_coreDebug)
+
+extern uint32_t SystemCoreClock;
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+// Runs the barrier hook of the test, see hal_host_setBarrierHook()
+void hal_host_barrier(void);
+#define __DMB() hal_host_barrier()
+#define __DSB() __sync_synchronize()
+#define __ISB() __sync_synchronize()
+#define __NOP() do {} while (0)
+void NVIC_SystemReset(void);
+
+//-- NVIC --
+// The interrupts run one at a time from the virtual clock, so priorities and enables are accepted and not modelled
+typedef enum {
+	GPDMA1_Channel0_IRQn = 29,
+	TIM2_IRQn = 45,
+	TIM6_IRQn = 49
+} IRQn_Type;
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+//-- Tick --
+HAL_StatusTypeDef HAL_Init(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+//-- RCC --
+typedef struct {
+	__IO uint32_t CR;
+	__IO uint32_t CFGR1;
+	__IO uint32_t CFGR2;
+	__IO uint32_t CFGR3;
+} RCC_TypeDef;
+
+extern RCC_TypeDef hal_host_rcc;
+#define RCC (&hal_host_rcc)
+
+#define RCC_CFGR2_PPRE1 (0x7UL << 4)
+#define RCC_HCLK_DIV1 0x00000000U
+#define RCC_HCLK_DIV2 (0x4UL << 4)
+#define RCC_HCLK_DIV4 (0x5UL << 4)
+
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+//Peripheral clocks are always on
+#define __HAL_RCC_GPIOA_CLK_ENABLE() do {} while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() do {} while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE() do {} while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE() do {} while (0)
+#define __HAL_RCC_GPIOE_CLK_ENABLE() do {} while (0)
+#define __HAL_RCC_GPDMA1_CLK_ENABLE() do {} while (0)
+
+//-- GPIO --
+typedef struct {
+	__IO uint32_t MODER;
+	__IO uint32_t OTYPER;
+	__IO uint32_t OSPEEDR;
+	__IO uint32_t PUPDR;
+	__IO uint32_t IDR;
+	__IO uint32_t ODR;
+	__IO uint32_t BSRR;
+	__IO uint32_t LCKR;
+	__IO uint32_t AFR[2];
+	__IO uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef enum {
+	GPIO_PIN_RESET = 0U,
+	GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+	uint32_t Pin;
+	uint32_t Mode;
+	uint32_t Pull;
+	uint32_t Speed;
+	uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_1 ((uint16_t)0x0002)
+#define GPIO_PIN_2 ((uint16_t)0x0004)
+#define GPIO_PIN_3 ((uint16_t)0x0008)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+#define GPIO_PIN_8 ((uint16_t)0x0100)
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+#define GPIO_PIN_All ((uint16_t)0xFFFF)
+
+#define GPIO_MODE_INPUT 0x00000000U
+#define GPIO_MODE_OUTPUT_PP 0x00000001U
+#define GPIO_MODE_OUTPUT_OD 0x00000011U
+#define GPIO_MODE_AF_PP 0x00000002U
+#define GPIO_MODE_AF_OD 0x00000012U
+#define GPIO_MODE_ANALOG 0x00000003U
+
+#define GPIO_NOPULL 0x00000000U
+#define GPIO_PULLUP 0x00000001U
+#define GPIO_PULLDOWN 0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW 0x00000000U
+#define GPIO_SPEED_FREQ_MEDIUM 0x00000001U
+#define GPIO_SPEED_FREQ_HIGH 0x00000002U
+#define GPIO_SPEED_FREQ_VERY_HIGH 0x00000003U
+
+extern GPIO_TypeDef hal_host_gpio[9];
+#define GPIOA (&hal_host_gpio[0])
+#define GPIOB (&hal_host_gpio[1])
+#define GPIOC (&hal_host_gpio[2])
+#define GPIOD (&hal_host_gpio[3])
+#define GPIOE (&hal_host_gpio[4])
+#define GPIOF (&hal_host_gpio[5])
+#define GPIOG (&hal_host_gpio[6])
+#define GPIOH (&hal_host_gpio[7])
+#define GPIOI (&hal_host_gpio[8])
+
+void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, const GPIO_InitTypeDef* pGPIO_Init);
+void HAL_GPIO_DeInit(GPIO_TypeDef* GPIOx, uint32_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+
+//-- DMA (GPDMA) --
+typedef struct {
+	__IO uint32_t CLBAR;
+	__IO uint32_t CFCR;
+	__IO uint32_t CSR;
+	__IO uint32_t CCR;
+	__IO uint32_t CTR1;
+	__IO uint32_t CTR2;
+	__IO uint32_t CBR1; // remaining bytes of the block in the low half word
+	__IO uint32_t CSAR;
+	__IO uint32_t CDAR;
+	__IO uint32_t CLLR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+	uint32_t Request;
+	uint32_t BlkHWRequest;
+	uint32_t Direction;
+	uint32_t SrcInc;
+	uint32_t DestInc;
+	uint32_t SrcDataWidth;
+	uint32_t DestDataWidth;
+	uint32_t Priority;
+	uint32_t SrcBurstLength;
+	uint32_t DestBurstLength;
+	uint32_t TransferAllocatedPort;
+	uint32_t TransferEventMode;
+	uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+	uint32_t Priority;
+	uint32_t LinkStepMode;
+	uint32_t LinkAllocatedPort;
+	uint32_t TransferEventMode;
+	uint32_t LinkedListMode;
+} DMA_InitLinkedListTypeDef;
+
+typedef struct {
+	uint32_t LinkRegisters[8];
+	uint32_t NodeInfo;
+} DMA_NodeTypeDef;
+
+typedef struct {
+	DMA_NodeTypeDef* Head;
+	uint32_t NodeNumber;
+	__IO uint32_t FirstCircularNode;
+	__IO uint32_t State;
+	__IO uint32_t ErrorCode;
+	__IO uint32_t Type;
+} DMA_QListTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+	DMA_Channel_TypeDef* Instance;
+	DMA_InitTypeDef Init;
+	DMA_InitLinkedListTypeDef InitLinkedList;
+	HAL_LockTypeDef Lock;
+	uint32_t Mode; // DMA_NORMAL, DMA_LINKEDLIST_NORMAL or DMA_LINKEDLIST_CIRCULAR
+	__IO uint32_t State;
+	__IO uint32_t ErrorCode;
+	void* Parent;
+	DMA_QListTypeDef* LinkedListQueue;
+} DMA_HandleTypeDef;
+
+#define DMA_NORMAL 0x00U
+#define DMA_LINKEDLIST 0x80U
+#define DMA_LINKEDLIST_NORMAL DMA_LINKEDLIST
+#define DMA_LINKEDLIST_CIRCULAR (DMA_LINKEDLIST | 0x01U)
+
+#define HAL_DMA_STATE_RESET 0x00U
+#define HAL_DMA_STATE_READY 0x01U
+#define HAL_DMA_STATE_BUSY 0x02U
+
+#define GPDMA1_REQUEST_TIM2_UP 65U
+#define DMA_BREQ_SINGLE_BURST 0x00000000U
+#define DMA_MEMORY_TO_PERIPH (1UL << 10)
+#define DMA_SINC_INCREMENTED (1UL << 3)
+#define DMA_DINC_FIXED 0x00000000U
+#define DMA_SRC_DATAWIDTH_WORD (2UL << 0)
+#define DMA_DEST_DATAWIDTH_WORD (2UL << 16)
+#define DMA_LOW_PRIORITY_LOW_WEIGHT 0x00000000U
+#define DMA_SRC_ALLOCATED_PORT0 0x00000000U
+#define DMA_DEST_ALLOCATED_PORT0 0x00000000U
+#define DMA_TCEM_BLOCK_TRANSFER 0x00000000U
+
+extern DMA_Channel_TypeDef hal_host_gpdma1[16];
+#define GPDMA1_Channel0 (&hal_host_gpdma1[0])
+#define GPDMA1_Channel1 (&hal_host_gpdma1[1])
+#define GPDMA1_Channel2 (&hal_host_gpdma1[2])
+#define GPDMA1_Channel3 (&hal_host_gpdma1[3])
+#define GPDMA1_Channel4 (&hal_host_gpdma1[4])
+#define GPDMA1_Channel5 (&hal_host_gpdma1[5])
+#define GPDMA1_Channel6 (&hal_host_gpdma1[6])
+#define GPDMA1_Channel7 (&hal_host_gpdma1[7])
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__) ((__HANDLE__)->Instance->CBR1 & 0xFFFFU)
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+	do { (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); (__DMA_HANDLE__).Parent = (__HANDLE__); } while (0)
+
+// Only the timer requests move data (see HAL_TIM_DMABurst_MultiWriteStart()), the completions run from the clock
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma);
+
+//-- PCD (handle only) --
+typedef struct {
+	void* Instance;
+	HAL_LockTypeDef Lock;
+	__IO uint32_t State;
+} PCD_HandleTypeDef;
+
+//-- ADC (handle only, no conversions) --
+typedef struct {
+	__IO uint32_t ISR;
+	__IO uint32_t IER;
+	__IO uint32_t CR;
+	__IO uint32_t CFGR1;
+	__IO uint32_t DR;
+} ADC_TypeDef;
+
+typedef struct {
+	ADC_TypeDef* Instance;
+	HAL_LockTypeDef Lock;
+	__IO uint32_t State;
+	__IO uint32_t ErrorCode;
+} ADC_HandleTypeDef;
+
+//-- DAC --
+typedef struct {
+	__IO uint32_t CR;
+	__IO uint32_t SWTRIGR;
+	__IO uint32_t DHR12R1;
+	__IO uint32_t DHR12L1;
+	__IO uint32_t DHR8R1;
+	__IO uint32_t DHR12R2;
+	__IO uint32_t DHR12L2;
+	__IO uint32_t DHR8R2;
+	__IO uint32_t DOR1; // output of channel 1, 12 bits
+	__IO uint32_t DOR2;
+	__IO uint32_t SR;
+} DAC_TypeDef;
+
+typedef enum {
+	HAL_DAC_STATE_RESET = 0x00U,
+	HAL_DAC_STATE_READY = 0x01U,
+	HAL_DAC_STATE_BUSY = 0x02U,
+	HAL_DAC_STATE_TIMEOUT = 0x03U,
+	HAL_DAC_STATE_ERROR = 0x04U
+} HAL_DAC_StateTypeDef;
+
+typedef struct {
+	DAC_TypeDef* Instance;
+	__IO HAL_DAC_StateTypeDef State;
+	HAL_LockTypeDef Lock;
+	DMA_HandleTypeDef* DMA_Handle1;
+	DMA_HandleTypeDef* DMA_Handle2;
+	__IO uint32_t ErrorCode;
+} DAC_HandleTypeDef;
+
+#define DAC_CHANNEL_1 0x00000000U
+#define DAC_CHANNEL_2 0x00000010U
+#define DAC_ALIGN_12B_R 0x00000000U
+#define DAC_ALIGN_12B_L 0x00000004U
+#define DAC_ALIGN_8B_R 0x00000008U
+#define DAC_CR_EN1 (1UL << 0)
+#define DAC_CR_EN2 (1UL << 16)
+
+extern DAC_TypeDef hal_host_dac1;
+#define DAC1 (&hal_host_dac1)
+
+HAL_StatusTypeDef HAL_DAC_Init(DAC_HandleTypeDef* hdac);
+HAL_StatusTypeDef HAL_DAC_Start(DAC_HandleTypeDef* hdac, uint32_t Channel);
+HAL_StatusTypeDef HAL_DAC_Stop(DAC_HandleTypeDef* hdac, uint32_t Channel);
+HAL_StatusTypeDef HAL_DAC_SetValue(DAC_HandleTypeDef* hdac, uint32_t Channel, uint32_t Alignment, uint32_t Data);
+uint32_t HAL_DAC_GetValue(const DAC_HandleTypeDef* hdac, uint32_t Channel);
+
+//-- TIM --
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMCR;
+	__IO uint32_t DIER;
+	__IO uint32_t SR;
+	__IO uint32_t EGR;
+	__IO uint32_t CCMR1;
+	__IO uint32_t CCMR2;
+	__IO uint32_t CCER;
+	__IO uint32_t CNT; // only up to date through __HAL_TIM_GET_COUNTER()
+	__IO uint32_t PSC;
+	__IO uint32_t ARR;
+	__IO uint32_t RCR;
+	__IO uint32_t CCR1;
+	__IO uint32_t CCR2;
+	__IO uint32_t CCR3;
+	__IO uint32_t CCR4;
+	__IO uint32_t BDTR;
+	__IO uint32_t DCR;
+	__IO uint32_t DMAR;
+} TIM_TypeDef;
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+	uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef enum {
+	HAL_TIM_STATE_RESET = 0x00U,
+	HAL_TIM_STATE_READY = 0x01U,
+	HAL_TIM_STATE_BUSY = 0x02U,
+	HAL_TIM_STATE_TIMEOUT = 0x03U,
+	HAL_TIM_STATE_ERROR = 0x04U
+} HAL_TIM_StateTypeDef;
+
+typedef enum {
+	HAL_TIM_ACTIVE_CHANNEL_1 = 0x01U,
+	HAL_TIM_ACTIVE_CHANNEL_2 = 0x02U,
+	HAL_TIM_ACTIVE_CHANNEL_3 = 0x04U,
+	HAL_TIM_ACTIVE_CHANNEL_4 = 0x08U,
+	HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef enum {
+	HAL_TIM_CHANNEL_STATE_RESET = 0x00U,
+	HAL_TIM_CHANNEL_STATE_READY = 0x01U,
+	HAL_TIM_CHANNEL_STATE_BUSY = 0x02U
+} HAL_TIM_ChannelStateTypeDef;
+
+typedef struct {
+	TIM_TypeDef* Instance;
+	TIM_Base_InitTypeDef Init;
+	HAL_TIM_ActiveChannel Channel;
+	DMA_HandleTypeDef* hdma[7];
+	HAL_LockTypeDef Lock;
+	__IO HAL_TIM_StateTypeDef State;
+	__IO HAL_TIM_ChannelStateTypeDef ChannelState[4];
+} TIM_HandleTypeDef;
+
+typedef struct {
+	uint32_t ClockSource;
+	uint32_t ClockPolarity;
+	uint32_t ClockPrescaler;
+	uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct {
+	uint32_t MasterOutputTrigger;
+	uint32_t MasterOutputTrigger2;
+	uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct {
+	uint32_t OCMode;
+	uint32_t Pulse;
+	uint32_t OCPolarity;
+	uint32_t OCNPolarity;
+	uint32_t OCFastMode;
+	uint32_t OCIdleState;
+	uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+#define TIM_CHANNEL_1 0x00000000U
+#define TIM_CHANNEL_2 0x00000004U
+#define TIM_CHANNEL_3 0x00000008U
+#define TIM_CHANNEL_4 0x0000000CU
+#define TIM_COUNTERMODE_UP 0x00000000U
+#define TIM_CLOCKDIVISION_DIV1 0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00000000U
+#define TIM_CR1_CEN (1UL << 0)
+#define TIM_DIER_UIE (1UL << 0)
+#define TIM_SR_UIF (1UL << 0)
+#define TIM_FLAG_UPDATE TIM_SR_UIF
+#define TIM_IT_UPDATE TIM_DIER_UIE
+#define TIM_DIER_UDE (1UL << 8)
+#define TIM_DMA_UPDATE TIM_DIER_UDE
+#define TIM_DMA_ID_UPDATE 0x0000U
+#define TIM_CLOCKSOURCE_INTERNAL (1UL << 12)
+#define TIM_TRGO_RESET 0x00000000U
+#define TIM_MASTERSLAVEMODE_DISABLE 0x00000000U
+#define TIM_OCMODE_PWM1 0x00000060U
+#define TIM_OCPOLARITY_HIGH 0x00000000U
+#define TIM_OCFAST_DISABLE 0x00000000U
+#define TIM_DMABASE_CCR1 0x0000000DU // register offsets in words from CR1, as in TIM_TypeDef
+#define TIM_DMABASE_CCR2 0x0000000EU
+#define TIM_DMABASE_CCR3 0x0000000FU
+#define TIM_DMABASE_CCR4 0x00000010U
+#define TIM_DMABURSTLENGTH_1TRANSFER 0x00000000U
+
+extern TIM_TypeDef hal_host_tim[17];
+#define TIM1 (&hal_host_tim[0])
+#define TIM2 (&hal_host_tim[1])
+#define TIM3 (&hal_host_tim[2])
+#define TIM4 (&hal_host_tim[3])
+#define TIM5 (&hal_host_tim[4])
+#define TIM6 (&hal_host_tim[5])
+#define TIM7 (&hal_host_tim[6])
+#define TIM8 (&hal_host_tim[7])
+#define TIM15 (&hal_host_tim[14])
+#define TIM16 (&hal_host_tim[15])
+#define TIM17 (&hal_host_tim[16])
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef* htim, const TIM_OC_InitTypeDef* sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim, const TIM_ClockConfigTypeDef* sClockSourceConfig);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim, const TIM_MasterConfigTypeDef* sMasterConfig);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
+
+/*
+ * DMA burst of one register per update event: each update writes the next word of the buffer to the register and
+ * takes 4 bytes off the counter of the DMA channel linked to hdma[TIM_DMA_ID_UPDATE]. HAL_TIM_PeriodElapsedCallback()
+ * is called once the last word is written, like the DMA completion of the HAL.
+ *
+ * @param DataLength In bytes, like the GPDMA block size
+ */
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef* htim, uint32_t BurstBaseAddress, uint32_t BurstRequestSrc,
+	const uint32_t* BurstBuffer, uint32_t BurstLength, uint32_t DataLength);
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t BurstRequestSrc);
+
+// The counter runs on the virtual clock, so the register macros go through the timer model
+uint32_t hal_host_timCounter(TIM_HandleTypeDef* htim);
+void hal_host_timSetCounter(TIM_HandleTypeDef* htim, uint32_t counter);
+void hal_host_timSetAutoreload(TIM_HandleTypeDef* htim, uint32_t autoreload);
+void hal_host_timSetPrescaler(TIM_HandleTypeDef* htim, uint32_t prescaler);
+
+#define __HAL_TIM_GET_COUNTER(__HANDLE__) hal_host_timCounter(__HANDLE__)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) hal_host_timSetCounter((__HANDLE__), (__COUNTER__))
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__) ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+	do { hal_host_timSetAutoreload((__HANDLE__), (__AUTORELOAD__)); (__HANDLE__)->Init.Period = (__AUTORELOAD__); } while (0)
+#define __HAL_TIM_SET_PRESCALER(__HANDLE__, __PRESC__) hal_host_timSetPrescaler((__HANDLE__), (__PRESC__))
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+	(*(&((__HANDLE__)->Instance->CCR1) + ((__CHANNEL__) >> 2U)) = (__COMPARE__))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__) (*(&((__HANDLE__)->Instance->CCR1) + ((__CHANNEL__) >> 2U)))
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->SR = ~(uint32_t)(__FLAG__))
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __DMA__) ((__HANDLE__)->Instance->DIER |= (__DMA__))
+#define __HAL_TIM_DISABLE_DMA(__HANDLE__, __DMA__) ((__HANDLE__)->Instance->DIER &= ~(__DMA__))
+#define TIM_CHANNEL_STATE_GET(__HANDLE__, __CHANNEL__) ((__HANDLE__)->ChannelState[(__CHANNEL__) >> 2U])
+
+//-- UART --
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t CR3;
+	__IO uint32_t BRR;
+	__IO uint32_t GTPR;
+	__IO uint32_t RTOR;
+	__IO uint32_t RQR;
+	__IO uint32_t ISR;
+	__IO uint32_t ICR;
+	__IO uint32_t RDR;
+	__IO uint32_t TDR;
+	__IO uint32_t PRESC;
+} USART_TypeDef;
+
+typedef struct {
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+	uint32_t Mode;
+	uint32_t HwFlowCtl;
+	uint32_t OverSampling;
+	uint32_t OneBitSampling;
+	uint32_t ClockPrescaler;
+} UART_InitTypeDef;
+
+typedef uint32_t HAL_UART_StateTypeDef;
+typedef uint32_t HAL_UART_RxTypeTypeDef;
+typedef uint32_t HAL_UART_RxEventTypeTypeDef;
+
+typedef struct __UART_HandleTypeDef {
+	USART_TypeDef* Instance;
+	UART_InitTypeDef Init;
+	const uint8_t* pTxBuffPtr;
+	uint16_t TxXferSize;
+	__IO uint16_t TxXferCount;
+	uint8_t* pRxBuffPtr;
+	uint16_t RxXferSize;
+	__IO uint16_t RxXferCount;
+	__IO HAL_UART_RxTypeTypeDef ReceptionType;
+	__IO HAL_UART_RxEventTypeTypeDef RxEventType;
+	DMA_HandleTypeDef* hdmatx;
+	DMA_HandleTypeDef* hdmarx;
+	HAL_LockTypeDef Lock;
+	__IO HAL_UART_StateTypeDef gState;
+	__IO HAL_UART_StateTypeDef RxState;
+	__IO uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#define HAL_UART_STATE_RESET 0x00000000U
+#define HAL_UART_STATE_READY 0x00000020U
+#define HAL_UART_STATE_BUSY 0x00000024U
+#define HAL_UART_STATE_BUSY_TX 0x00000021U
+#define HAL_UART_STATE_BUSY_RX 0x00000022U
+
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_PE 0x00000001U
+#define HAL_UART_ERROR_NE 0x00000002U
+#define HAL_UART_ERROR_FE 0x00000004U
+#define HAL_UART_ERROR_ORE 0x00000008U
+#define HAL_UART_ERROR_DMA 0x00000010U
+#define HAL_UART_ERROR_RTO 0x00000020U
+
+#define HAL_UART_RECEPTION_STANDARD 0x00000000U
+#define HAL_UART_RECEPTION_TOIDLE 0x00000001U
+#define HAL_UART_RXEVENT_TC 0x00000000U
+#define HAL_UART_RXEVENT_HT 0x00000001U
+#define HAL_UART_RXEVENT_IDLE 0x00000002U
+
+#define UART_WORDLENGTH_8B 0x00000000U
+#define UART_STOPBITS_1 0x00000000U
+#define UART_PARITY_NONE 0x00000000U
+#define UART_MODE_TX_RX 0x0000000CU
+#define UART_HWCONTROL_NONE 0x00000000U
+#define UART_OVERSAMPLING_16 0x00000000U
+
+#define UART_FLAG_PE (1UL << 0)
+#define UART_FLAG_FE (1UL << 1)
+#define UART_FLAG_NE (1UL << 2)
+#define UART_FLAG_ORE (1UL << 3)
+#define UART_FLAG_IDLE (1UL << 4)
+#define UART_FLAG_RXNE (1UL << 5)
+#define UART_FLAG_TC (1UL << 6)
+#define UART_FLAG_TXE (1UL << 7)
+
+extern USART_TypeDef hal_host_usart[6];
+#define USART1 (&hal_host_usart[0])
+#define USART2 (&hal_host_usart[1])
+#define USART3 (&hal_host_usart[2])
+#define UART4 (&hal_host_usart[3])
+#define UART5 (&hal_host_usart[4])
+#define LPUART1 (&hal_host_usart[5])
+
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__) (((__HANDLE__)->Instance->ISR & (__FLAG__)) == (__FLAG__))
+#define __HAL_UART_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->ISR &= ~(uint32_t)(__FLAG__))
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart);
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef* huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart);
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef* huart);
+uint32_t HAL_UART_GetError(const UART_HandleTypeDef* huart);
+HAL_UART_RxEventTypeTypeDef HAL_UARTEx_GetRxEventType(const UART_HandleTypeDef* huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size);
+
+//-- I2C --
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t OAR1;
+	__IO uint32_t OAR2;
+	__IO uint32_t TIMINGR;
+	__IO uint32_t TIMEOUTR;
+	__IO uint32_t ISR;
+	__IO uint32_t ICR;
+	__IO uint32_t PECR;
+	__IO uint32_t RXDR;
+	__IO uint32_t TXDR;
+} I2C_TypeDef;
+
+typedef struct {
+	uint32_t Timing; // PRESC[31:28], SCLH[15:8], SCLL[7:0] of TIMINGR
+	uint32_t OwnAddress1;
+	uint32_t AddressingMode;
+	uint32_t DualAddressMode;
+	uint32_t OwnAddress2;
+	uint32_t OwnAddress2Masks;
+	uint32_t GeneralCallMode;
+	uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef enum {
+	HAL_I2C_STATE_RESET = 0x00U,
+	HAL_I2C_STATE_READY = 0x20U,
+	HAL_I2C_STATE_BUSY = 0x24U,
+	HAL_I2C_STATE_BUSY_TX = 0x21U,
+	HAL_I2C_STATE_BUSY_RX = 0x22U,
+	HAL_I2C_STATE_LISTEN = 0x28U,
+	HAL_I2C_STATE_ABORT = 0x60U
+} HAL_I2C_StateTypeDef;
+
+typedef enum {
+	HAL_I2C_MODE_NONE = 0x00U,
+	HAL_I2C_MODE_MASTER = 0x10U,
+	HAL_I2C_MODE_SLAVE = 0x20U,
+	HAL_I2C_MODE_MEM = 0x40U
+} HAL_I2C_ModeTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+	I2C_TypeDef* Instance;
+	I2C_InitTypeDef Init;
+	uint8_t* pBuffPtr;
+	uint16_t XferSize;
+	__IO uint16_t XferCount;
+	__IO uint32_t XferOptions;
+	DMA_HandleTypeDef* hdmatx;
+	DMA_HandleTypeDef* hdmarx;
+	HAL_LockTypeDef Lock;
+	__IO HAL_I2C_StateTypeDef State;
+	__IO HAL_I2C_ModeTypeDef Mode;
+	__IO uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define HAL_I2C_ERROR_NONE 0x00000000U
+#define HAL_I2C_ERROR_BERR 0x00000001U
+#define HAL_I2C_ERROR_ARLO 0x00000002U
+#define HAL_I2C_ERROR_AF 0x00000004U
+#define HAL_I2C_ERROR_OVR 0x00000008U
+#define HAL_I2C_ERROR_DMA 0x00000010U
+#define HAL_I2C_ERROR_TIMEOUT 0x00000020U
+
+#define I2C_MEMADD_SIZE_8BIT 0x00000001U
+#define I2C_MEMADD_SIZE_16BIT 0x00000002U
+#define I2C_ADDRESSINGMODE_7BIT 0x00000001U
+
+extern I2C_TypeDef hal_host_i2c[4];
+#define I2C1 (&hal_host_i2c[0])
+#define I2C2 (&hal_host_i2c[1])
+#define I2C3 (&hal_host_i2c[2])
+#define I2C4 (&hal_host_i2c[3])
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint32_t Trials, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(const I2C_HandleTypeDef* hi2c);
+uint32_t HAL_I2C_GetError(const I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+//-- FDCAN --
+typedef struct {
+	__IO uint32_t CCCR;
+	__IO uint32_t NBTP;
+	__IO uint32_t PSR;
+	__IO uint32_t IR;
+	__IO uint32_t IE;
+	__IO uint32_t RXGFC;
+	__IO uint32_t RXF0S;
+	__IO uint32_t TXFQS;
+	__IO uint32_t TXBRP; // one bit per frame waiting for the bus
+	__IO uint32_t TXBTO;
+} FDCAN_GlobalTypeDef;
+
+typedef struct {
+	uint32_t ClockDivider;
+	uint32_t FrameFormat;
+	uint32_t Mode;
+	uint32_t AutoRetransmission;
+	uint32_t TransmitPause;
+	uint32_t ProtocolException;
+	uint32_t NominalPrescaler;
+	uint32_t NominalSyncJumpWidth;
+	uint32_t NominalTimeSeg1;
+	uint32_t NominalTimeSeg2;
+	uint32_t DataPrescaler;
+	uint32_t DataSyncJumpWidth;
+	uint32_t DataTimeSeg1;
+	uint32_t DataTimeSeg2;
+	uint32_t StdFiltersNbr;
+	uint32_t ExtFiltersNbr;
+	uint32_t TxFifoQueueMode;
+} FDCAN_InitTypeDef;
+
+typedef enum {
+	HAL_FDCAN_STATE_RESET = 0x00U,
+	HAL_FDCAN_STATE_READY = 0x01U,
+	HAL_FDCAN_STATE_BUSY = 0x02U,
+	HAL_FDCAN_STATE_ERROR = 0x03U
+} HAL_FDCAN_StateTypeDef;
+
+typedef struct {
+	FDCAN_GlobalTypeDef* Instance;
+	FDCAN_InitTypeDef Init;
+	uint32_t LatestTxFifoQRequest;
+	__IO HAL_FDCAN_StateTypeDef State;
+	HAL_LockTypeDef Lock;
+	__IO uint32_t ErrorCode;
+} FDCAN_HandleTypeDef;
+
+typedef struct {
+	uint32_t Identifier;
+	uint32_t IdType;
+	uint32_t TxFrameType;
+	uint32_t DataLength;
+	uint32_t ErrorStateIndicator;
+	uint32_t BitRateSwitch;
+	uint32_t FDFormat;
+	uint32_t TxEventFifoControl;
+	uint32_t MessageMarker;
+} FDCAN_TxHeaderTypeDef;
+
+typedef struct {
+	uint32_t Identifier;
+	uint32_t IdType;
+	uint32_t RxFrameType;
+	uint32_t DataLength;
+	uint32_t ErrorStateIndicator;
+	uint32_t BitRateSwitch;
+	uint32_t FDFormat;
+	uint32_t RxTimestamp;
+	uint32_t FilterIndex;
+	uint32_t IsFilterMatchingFrame;
+} FDCAN_RxHeaderTypeDef;
+
+typedef struct {
+	uint32_t IdType;
+	uint32_t FilterIndex;
+	uint32_t FilterType;
+	uint32_t FilterConfig;
+	uint32_t FilterID1;
+	uint32_t FilterID2;
+} FDCAN_FilterTypeDef;
+
+#define FDCAN_STANDARD_ID 0x00000000U
+#define FDCAN_EXTENDED_ID 0x40000000U
+#define FDCAN_DATA_FRAME 0x00000000U
+#define FDCAN_REMOTE_FRAME 0x20000000U
+#define FDCAN_DLC_BYTES_0 0x00000000U
+#define FDCAN_DLC_BYTES_1 0x00010000U
+#define FDCAN_DLC_BYTES_2 0x00020000U
+#define FDCAN_DLC_BYTES_3 0x00030000U
+#define FDCAN_DLC_BYTES_4 0x00040000U
+#define FDCAN_DLC_BYTES_5 0x00050000U
+#define FDCAN_DLC_BYTES_6 0x00060000U
+#define FDCAN_DLC_BYTES_7 0x00070000U
+#define FDCAN_DLC_BYTES_8 0x00080000U
+#define FDCAN_ESI_ACTIVE 0x00000000U
+#define FDCAN_BRS_OFF 0x00000000U
+#define FDCAN_CLASSIC_CAN 0x00000000U
+#define FDCAN_NO_TX_EVENTS 0x00000000U
+#define FDCAN_FILTER_RANGE 0x00000000U
+#define FDCAN_FILTER_DUAL 0x00000001U
+#define FDCAN_FILTER_MASK 0x00000002U
+#define FDCAN_FILTER_DISABLE 0x00000000U
+#define FDCAN_FILTER_TO_RXFIFO0 0x00000001U
+#define FDCAN_FILTER_REJECT 0x00000003U
+#define FDCAN_ACCEPT_IN_RX_FIFO0 0x00000000U
+#define FDCAN_REJECT 0x00000002U
+#define FDCAN_FILTER_REMOTE 0x00000000U
+#define FDCAN_REJECT_REMOTE 0x00000001U
+#define FDCAN_RX_FIFO0 0x00000040U
+#define FDCAN_IT_RX_FIFO0_NEW_MESSAGE (1UL << 0)
+#define FDCAN_TX_FIFO_OPERATION 0x00000000U
+#define FDCAN_FRAME_CLASSIC 0x00000000U
+#define FDCAN_MODE_NORMAL 0x00000000U
+#define FDCAN_CLOCK_DIV1 0x00000000U
+#define HAL_FDCAN_ERROR_NONE 0x00000000U
+#define HAL_FDCAN_ERROR_NOT_INITIALIZED 0x00000002U
+#define HAL_FDCAN_ERROR_NOT_READY 0x00000004U
+#define HAL_FDCAN_ERROR_NOT_STARTED 0x00000008U
+#define HAL_FDCAN_ERROR_PARAM 0x00000020U
+#define HAL_FDCAN_ERROR_FIFO_EMPTY 0x00000100U
+#define HAL_FDCAN_ERROR_FIFO_FULL 0x00000200U
+
+extern FDCAN_GlobalTypeDef hal_host_fdcan1;
+#define FDCAN1 (&hal_host_fdcan1)
+
+HAL_StatusTypeDef HAL_FDCAN_Init(FDCAN_HandleTypeDef* hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_DeInit(FDCAN_HandleTypeDef* hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef* hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_Stop(FDCAN_HandleTypeDef* hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef* hfdcan, const FDCAN_FilterTypeDef* sFilterConfig);
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef* hfdcan, uint32_t NonMatchingStd, uint32_t NonMatchingExt, uint32_t RejectRemoteStd, uint32_t RejectRemoteExt);
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef* hfdcan, uint32_t ActiveITs, uint32_t BufferIndexes);
+HAL_StatusTypeDef HAL_FDCAN_DeactivateNotification(FDCAN_HandleTypeDef* hfdcan, uint32_t InactiveITs);
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef* hfdcan, const FDCAN_TxHeaderTypeDef* pTxHeader, const uint8_t* pTxData);
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef* hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef* hfdcan, uint32_t RxLocation, FDCAN_RxHeaderTypeDef* pRxHeader, uint8_t* pRxData);
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef* hfdcan, uint32_t RxFifo);
+void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef* hfdcan, uint32_t RxFifo0ITs);
+
+//-- FLASH --
+typedef struct {
+	uint32_t TypeErase;
+	uint32_t Banks;
+	uint32_t Page;
+	uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+// The flash is a static array, the host build must not be position independent so that its address fits in 32 bits
+extern uint8_t hal_host_flash[];
+#define FLASH_SIZE 0x200000U
+#define FLASH_BASE ((uintptr_t)hal_host_flash)
+#define FLASH_BANK_SIZE (FLASH_SIZE >> 1)
+#define FLASH_PAGE_SIZE 0x2000U
+#define FLASH_PAGE_NB (FLASH_BANK_SIZE / FLASH_PAGE_SIZE)
+#define FLASH_BANK_1 0x00000001U
+#define FLASH_BANK_2 0x00000002U
+#define FLASH_TYPEERASE_PAGES 0x00000002U
+#define FLASH_TYPEERASE_MASSERASE 0x00008004U
+#define FLASH_TYPEPROGRAM_QUADWORD 0x00000001U
+
+#define HAL_FLASH_ERROR_NONE 0x00000000U
+#define HAL_FLASH_ERROR_OP 0x00000001U
+#define HAL_FLASH_ERROR_PROG 0x00000002U
+#define HAL_FLASH_ERROR_WRP 0x00000004U
+#define HAL_FLASH_ERROR_PGA 0x00000008U
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef* pEraseInit, uint32_t* PageError);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint32_t DataAddress);
+uint32_t HAL_FLASH_GetError(void);
+
+//-- ICACHE --
+HAL_StatusTypeDef HAL_ICACHE_Invalidate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32U5XX_HAL_H */
@@ -0,0 +1,128 @@
+/*
+ * i2c_recovery.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "i2c_recovery.h"
+#include <stddef.h>
+
+static const I2C_RECOVERY_CONFIG defaultConfig = I2C_RECOVERY_DEFAULT_CONFIG;
+
+static uint8_t busFree(I2C_RECOVERY* self){
+	return self->ops->readScl(self->context) && self->ops->readSda(self->context);
+}
+
+static I2C_RECOVERY_STATUS recovered(I2C_RECOVERY* self, uint32_t start){
+	uint32_t elapsed = self->ops->nowUs(self->context) - start;
+	self->stats.recovered++;
+	self->stats.lastRecoveryUs = elapsed;
+	if(elapsed > self->stats.maxRecoveryUs){
+		self->stats.maxRecoveryUs = elapsed;
+	}
+	return I2C_RECOVERY_OK;
+}
+
+void i2c_recovery_init(I2C_RECOVERY* self, const I2C_RECOVERY_OPS* ops, void* context, const I2C_RECOVERY_CONFIG* config){
+	self->ops = ops;
+	self->context = context;
+	self->config = config != NULL ? *config : defaultConfig;
+	self->stats = (I2C_RECOVERY_STATS){0};
+}
+
+uint8_t i2c_recovery_clearBus(I2C_RECOVERY* self){
+	const I2C_RECOVERY_OPS* ops = self->ops;
+	uint32_t half = self->config.halfPeriodUs;
+	ops->releasePins(self->context);
+	ops->delayUs(self->context, half);
+
+	// A slave in the middle of a read drives SDA low for its 0 bits, each pulse moves it one bit further. After
+	// its last bit the master does not acknowledge (SDA stays high), which ends the read.
+	uint8_t pulses = 0;
+	while(!ops->readSda(self->context) && pulses < I2C_RECOVERY_CLOCK_PULSES){
+		ops->setScl(self->context, 0);
+		ops->delayUs(self->context, half);
+		ops->setScl(self->context, 1);
+		ops->delayUs(self->context, half);
+		pulses++;
+	}
+	self->stats.busClears++;
+	self->stats.clockPulses += pulses;
+	errlog_report(I2C_RECOVERY_ERROR_BUS_CLEAR, pulses);
+
+	// STOP: SDA rises while SCL is high
+	ops->setScl(self->context, 0);
+	ops->delayUs(self->context, half);
+	ops->setSda(self->context, 0);
+	ops->delayUs(self->context, half);
+	ops->setScl(self->context, 1);
+	ops->delayUs(self->context, half);
+	ops->setSda(self->context, 1);
+	ops->delayUs(self->context, half);
+	self->stats.stops++;
+	errlog_report(I2C_RECOVERY_ERROR_STOP, pulses);
+
+	return busFree(self);
+}
+
+I2C_RECOVERY_STATUS i2c_recovery_transfer(I2C_RECOVERY* self, const I2C_RECOVERY_TRANSFER* transfer){
+	const I2C_RECOVERY_OPS* ops = self->ops;
+	self->stats.transfers++;
+	uint32_t start = ops->nowUs(self->context);
+	I2C_RECOVERY_STATUS status = ops->transfer(self->context, transfer);
+	if(status == I2C_RECOVERY_OK){
+		return status;
+	}
+	self->stats.failures++;
+
+	// 1. Retries, not after a timeout: the bus is held and each retry would wait for another timeout
+	uint32_t backoff = self->config.backoffUs;
+	for(uint8_t i = 0; i < self->config.retries && status != I2C_RECOVERY_TIMEOUT; i++){
+		ops->delayUs(self->context, backoff);
+		backoff = backoff * 2 < self->config.maxBackoffUs ? backoff * 2 : self->config.maxBackoffUs;
+		self->stats.retries++;
+		errlog_report(I2C_RECOVERY_ERROR_RETRY, transfer->address);
+		status = ops->transfer(self->context, transfer);
+		if(status == I2C_RECOVERY_OK){
+			return recovered(self, start);
+		}
+	}
+
+	// 2. Peripheral
+	ops->reinit(self->context);
+	self->stats.reinits++;
+	errlog_report(I2C_RECOVERY_ERROR_REINIT, transfer->address);
+	if(ops->transfer(self->context, transfer) == I2C_RECOVERY_OK){
+		return recovered(self, start);
+	}
+
+	// 3 and 4. Bus
+	uint8_t free = i2c_recovery_clearBus(self);
+	ops->reinit(self->context);
+	self->stats.reinits++;
+	status = ops->transfer(self->context, transfer);
+	if(status == I2C_RECOVERY_OK){
+		return recovered(self, start);
+	}
+
+	// 5. Reset, unless only the device is missing
+	self->stats.unrecovered++;
+	errlog_report(I2C_RECOVERY_ERROR_UNRECOVERED, transfer->address);
+	if(!free && self->config.resetOnFailure && ops->reset != NULL){
+		self->stats.resets++;
+		errlog_report(I2C_RECOVERY_ERROR_RESET, transfer->address);
+		ops->reset(self->context);
+	}
+	return status;
+}
+
+I2C_RECOVERY_STATUS i2c_recovery_read(I2C_RECOVERY* self, uint8_t address, uint8_t reg, uint8_t* data, uint16_t length){
+	I2C_RECOVERY_TRANSFER transfer = {.address = address, .reg = reg, .data = data, .length = length, .read = 1};
+	return i2c_recovery_transfer(self, &transfer);
+}
+
+I2C_RECOVERY_STATUS i2c_recovery_write(I2C_RECOVERY* self, uint8_t address, uint8_t reg, uint8_t* data, uint16_t length){
+	I2C_RECOVERY_TRANSFER transfer = {.address = address, .reg = reg, .data = data, .length = length, .read = 0};
+	return i2c_recovery_transfer(self, &transfer);
+}
@@ -0,0 +1,116 @@
+/*
+ * i2c_recovery.h
+ *
+ * Recovery ladder for blocking I2C transfers. A failed transfer climbs the ladder one step at a time and stops at
+ * the first step after which the transfer succeeds:
+ *		1. retries with an exponential backoff (a device busy writing its EEPROM, a glitch), skipped after a
+ *		   timeout since the bus is then held and every retry would wait for the timeout again
+ *		2. re-initialisation of the peripheral (peripheral stuck busy or in an error state)
+ *		3. up to 9 SCL pulses with the pins as GPIO, until the slave that holds SDA low finishes its byte
+ *		4. a STOP condition to put every slave back to idle, then the peripheral is initialised again
+ *		5. a system reset, only if the bus is still not free (SCL or SDA held low) and it is enabled
+ *
+ * A device that still NACKs on a free bus is reported as NACK without a reset: rebooting the controller does not
+ * bring a missing sensor back. Each step is counted in the statistics and reported to the error log (errlog.h).
+ *
+ * The bus is accessed through a table of operations so the ladder can run against a simulated bus on a host
+ * machine. The STM32 operations are in i2c_recovery_hal.h.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef I2C_RECOVERY_H_
+#define I2C_RECOVERY_H_
+
+#include <stdint.h>
+#include "errlog.h"
+
+// SCL pulses that finish any byte a slave can be in the middle of, with its acknowledge bit
+#define I2C_RECOVERY_CLOCK_PULSES 9
+
+// Steps reported to the error log, the detail is the 7 bit device address (the number of pulses for the bus clear)
+#define I2C_RECOVERY_ERROR_RETRY ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x10, ERRLOG_LOW)
+#define I2C_RECOVERY_ERROR_REINIT ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x11, ERRLOG_MID)
+#define I2C_RECOVERY_ERROR_BUS_CLEAR ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x12, ERRLOG_MID)
+#define I2C_RECOVERY_ERROR_STOP ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x13, ERRLOG_MID)
+#define I2C_RECOVERY_ERROR_UNRECOVERED ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x14, ERRLOG_HIGH)
+#define I2C_RECOVERY_ERROR_RESET ERRLOG_CODE(ERRLOG_MODULE_I2C, 0x15, ERRLOG_FATAL)
+
+typedef enum {
+	I2C_RECOVERY_OK,
+	I2C_RECOVERY_NACK, // the device did not acknowledge
+	I2C_RECOVERY_BUS_ERROR, // bus error, arbitration lost or peripheral busy
+	I2C_RECOVERY_TIMEOUT
+} I2C_RECOVERY_STATUS;
+
+// One register read or write
+typedef struct {
+	uint8_t address; // 7 bit
+	uint8_t reg;
+	uint8_t* data;
+	uint16_t length;
+	uint8_t read; // 1 to read, 0 to write
+} I2C_RECOVERY_TRANSFER;
+
+// Bus access, the context is given to every operation
+typedef struct {
+	I2C_RECOVERY_STATUS (*transfer)(void* context, const I2C_RECOVERY_TRANSFER* transfer);
+	void (*reinit)(void* context); // resets the peripheral and gives it the pins back
+	void (*releasePins)(void* context); // stops the peripheral, SCL and SDA become open drain outputs, released
+	void (*setScl)(void* context, uint8_t level);
+	void (*setSda)(void* context, uint8_t level);
+	uint8_t (*readScl)(void* context);
+	uint8_t (*readSda)(void* context);
+	void (*delayUs)(void* context, uint32_t us);
+	uint32_t (*nowUs)(void* context);
+	void (*reset)(void* context); // system reset, NULL if not available
+} I2C_RECOVERY_OPS;
+
+typedef struct {
+	uint8_t retries; // transfers retried before the peripheral is initialised again
+	uint32_t backoffUs; // wait before the first retry, doubled for each retry
+	uint32_t maxBackoffUs;
+	uint32_t halfPeriodUs; // of the SCL pulses
+	uint8_t resetOnFailure; // 1 to reset when the bus cannot be freed
+} I2C_RECOVERY_CONFIG;
+
+#define I2C_RECOVERY_DEFAULT_CONFIG {.retries = 3, .backoffUs = 500, .maxBackoffUs = 4000, .halfPeriodUs = 5, .resetOnFailure = 1}
+
+typedef struct {
+	uint32_t transfers;
+	uint32_t failures; // transfers that needed the ladder
+	uint32_t retries;
+	uint32_t reinits;
+	uint32_t busClears;
+	uint32_t clockPulses;
+	uint32_t stops;
+	uint32_t resets;
+	uint32_t recovered;
+	uint32_t unrecovered;
+	uint32_t lastRecoveryUs; // from the first failure to the successful transfer
+	uint32_t maxRecoveryUs;
+} I2C_RECOVERY_STATS;
+
+typedef struct {
+	const I2C_RECOVERY_OPS* ops;
+	void* context;
+	I2C_RECOVERY_CONFIG config;
+	I2C_RECOVERY_STATS stats;
+} I2C_RECOVERY;
+
+// Binds the bus operations, config NULL for I2C_RECOVERY_DEFAULT_CONFIG
+void i2c_recovery_init(I2C_RECOVERY* self, const I2C_RECOVERY_OPS* ops, void* context, const I2C_RECOVERY_CONFIG* config);
+
+// Runs a transfer, climbing the ladder if it fails. Blocks until it succeeds or the ladder is exhausted.
+I2C_RECOVERY_STATUS i2c_recovery_transfer(I2C_RECOVERY* self, const I2C_RECOVERY_TRANSFER* transfer);
+
+// Register read and write helpers
+I2C_RECOVERY_STATUS i2c_recovery_read(I2C_RECOVERY* self, uint8_t address, uint8_t reg, uint8_t* data, uint16_t length);
+I2C_RECOVERY_STATUS i2c_recovery_write(I2C_RECOVERY* self, uint8_t address, uint8_t reg, uint8_t* data, uint16_t length);
+
+// Clocks SCL until SDA is released (at most I2C_RECOVERY_CLOCK_PULSES) and sends a STOP, steps 3 and 4 of the
+// ladder on their own. The peripheral is left stopped, call reinit afterwards. Returns 1 if the bus is free.
+uint8_t i2c_recovery_clearBus(I2C_RECOVERY* self);
+
+#endif /* I2C_RECOVERY_H_ */
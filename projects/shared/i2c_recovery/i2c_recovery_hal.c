@@ -0,0 +1,117 @@
+/*
+ * i2c_recovery_hal.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "i2c_recovery_hal.h"
+
+static I2C_RECOVERY_STATUS blockingTransfer(void* context, const I2C_RECOVERY_TRANSFER* transfer){
+	I2C_RECOVERY_HAL* bus = context;
+	HAL_StatusTypeDef status;
+	if(transfer->read){
+		status = HAL_I2C_Mem_Read(bus->i2c, transfer->address << 1, transfer->reg, I2C_MEMADD_SIZE_8BIT, transfer->data, transfer->length, bus->timeoutMs);
+	}
+	else{
+		status = HAL_I2C_Mem_Write(bus->i2c, transfer->address << 1, transfer->reg, I2C_MEMADD_SIZE_8BIT, transfer->data, transfer->length, bus->timeoutMs);
+	}
+	if(status == HAL_OK){
+		return I2C_RECOVERY_OK;
+	}
+	uint32_t error = HAL_I2C_GetError(bus->i2c);
+	if(status == HAL_TIMEOUT || (error & HAL_I2C_ERROR_TIMEOUT)){
+		return I2C_RECOVERY_TIMEOUT;
+	}
+	if(error & HAL_I2C_ERROR_AF){
+		return I2C_RECOVERY_NACK;
+	}
+	return I2C_RECOVERY_BUS_ERROR;
+}
+
+static void reinit(void* context){
+	I2C_RECOVERY_HAL* bus = context;
+	if(bus->i2c->State != HAL_I2C_STATE_RESET){
+		HAL_I2C_DeInit(bus->i2c);
+	}
+	HAL_I2C_Init(bus->i2c);
+}
+
+static void releasePins(void* context){
+	I2C_RECOVERY_HAL* bus = context;
+	if(bus->i2c->State != HAL_I2C_STATE_RESET){
+		HAL_I2C_DeInit(bus->i2c);
+	}
+	HAL_GPIO_WritePin(bus->sclPort, bus->sclPin, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(bus->sdaPort, bus->sdaPin, GPIO_PIN_SET);
+	GPIO_InitTypeDef pin = {.Mode = GPIO_MODE_OUTPUT_OD, .Pull = GPIO_NOPULL, .Speed = GPIO_SPEED_FREQ_LOW};
+	pin.Pin = bus->sclPin;
+	HAL_GPIO_Init(bus->sclPort, &pin);
+	pin.Pin = bus->sdaPin;
+	HAL_GPIO_Init(bus->sdaPort, &pin);
+}
+
+static void setScl(void* context, uint8_t level){
+	I2C_RECOVERY_HAL* bus = context;
+	HAL_GPIO_WritePin(bus->sclPort, bus->sclPin, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+static void setSda(void* context, uint8_t level){
+	I2C_RECOVERY_HAL* bus = context;
+	HAL_GPIO_WritePin(bus->sdaPort, bus->sdaPin, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+static uint8_t readScl(void* context){
+	I2C_RECOVERY_HAL* bus = context;
+	return HAL_GPIO_ReadPin(bus->sclPort, bus->sclPin) == GPIO_PIN_SET;
+}
+
+static uint8_t readSda(void* context){
+	I2C_RECOVERY_HAL* bus = context;
+	return HAL_GPIO_ReadPin(bus->sdaPort, bus->sdaPin) == GPIO_PIN_SET;
+}
+
+static void delayUs(void* context, uint32_t us){
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles = us * (SystemCoreClock / 1000000);
+	while(DWT->CYCCNT - start < cycles){
+	}
+}
+
+// Microseconds accumulated from the cycle counter, which wraps every 26 s at 160 MHz
+static uint32_t nowUs(void* context){
+	static uint32_t lastCycles;
+	static uint32_t remainder;
+	static uint32_t us;
+	uint32_t cycles = DWT->CYCCNT;
+	uint32_t perUs = SystemCoreClock / 1000000;
+	uint32_t elapsed = cycles - lastCycles + remainder;
+	lastCycles = cycles;
+	us += elapsed / perUs;
+	remainder = elapsed % perUs;
+	return us;
+}
+
+static void reset(void* context){
+	NVIC_SystemReset();
+}
+
+const I2C_RECOVERY_OPS i2c_recovery_hal_ops = {
+	.transfer = blockingTransfer,
+	.reinit = reinit,
+	.releasePins = releasePins,
+	.setScl = setScl,
+	.setSda = setSda,
+	.readScl = readScl,
+	.readSda = readSda,
+	.delayUs = delayUs,
+	.nowUs = nowUs,
+	.reset = reset
+};
+
+void i2c_recovery_hal_init(I2C_RECOVERY* recovery, I2C_RECOVERY_HAL* bus, const I2C_RECOVERY_CONFIG* config){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	i2c_recovery_init(recovery, &i2c_recovery_hal_ops, bus, config);
+	nowUs(bus);
+}
@@ -0,0 +1,36 @@
+/*
+ * i2c_recovery_hal.h
+ *
+ * STM32 operations of the I2C recovery ladder (i2c_recovery.h). Transfers are blocking HAL register reads and
+ * writes with a bounded timeout. For the bus clear the peripheral is de-initialised and its pins driven as open drain
+ * GPIOs; initialising it again (through its MSP) gives the pins back to the peripheral. Microsecond delays and the
+ * recovery time use the DWT cycle counter.
+ *
+ * Do not use it on a bus while an asynchronous transfer (regmap_i2c.h) is in progress, the peripheral would be
+ * reported busy and re-initialised under it.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef I2C_RECOVERY_HAL_H_
+#define I2C_RECOVERY_HAL_H_
+
+#include "i2c_recovery.h"
+#include "stm32u5xx_hal.h"
+
+typedef struct {
+	I2C_HandleTypeDef* i2c;
+	GPIO_TypeDef* sclPort;
+	uint16_t sclPin;
+	GPIO_TypeDef* sdaPort;
+	uint16_t sdaPin;
+	uint32_t timeoutMs; // of each transfer
+} I2C_RECOVERY_HAL;
+
+extern const I2C_RECOVERY_OPS i2c_recovery_hal_ops;
+
+// Binds a recovery ladder to an I2C bus and starts the cycle counter, config NULL for the default
+void i2c_recovery_hal_init(I2C_RECOVERY* recovery, I2C_RECOVERY_HAL* bus, const I2C_RECOVERY_CONFIG* config);
+
+#endif /* I2C_RECOVERY_HAL_H_ */
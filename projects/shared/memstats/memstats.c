@@ -0,0 +1,54 @@
+/*
+ * memstats.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "memstats.h"
+
+static void put16(uint8_t* data, uint32_t value){
+	if(value > 0xFFFF){
+		value = 0xFFFF;
+	}
+	data[0] = (uint8_t)value;
+	data[1] = (uint8_t)(value >> 8);
+}
+
+void memstats_paint(uint32_t* low, const uint32_t* high){
+	// volatile: the compiler must not drop stores to memory it sees as unused
+	for(volatile uint32_t* word = low; word < high; word++){
+		*word = MEMSTATS_PAINT;
+	}
+}
+
+uint32_t memstats_untouched(const uint32_t* low, const uint32_t* high){
+	const volatile uint32_t* word = low;
+	while(word < high && *word == MEMSTATS_PAINT){
+		word++;
+	}
+	return (uint32_t)(word - low);
+}
+
+uint16_t memstats_fragmentation(const MEMSTATS* stats){
+	if(stats->heapArena == 0 || stats->heapInUse >= stats->heapArena){
+		return 0;
+	}
+	return (uint16_t)((uint64_t)(stats->heapArena - stats->heapInUse) * 1000 / stats->heapArena);
+}
+
+void memstats_packCan(const MEMSTATS* stats, uint8_t frame, uint8_t* data){
+	data[0] = frame;
+	if(frame == 0){
+		data[1] = stats->locked;
+		put16(&data[2], stats->stackPeak);
+		put16(&data[4], stats->stackReserve);
+		put16(&data[6], stats->gap);
+	}
+	else{
+		data[1] = (uint8_t)((memstats_fragmentation(stats) + 5) / 10);
+		put16(&data[2], stats->heapPeak);
+		put16(&data[4], stats->heapInUse);
+		put16(&data[6], stats->runtimeCalls);
+	}
+}
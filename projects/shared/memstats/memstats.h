@@ -0,0 +1,77 @@
+/*
+ * memstats.h
+ *
+ * Stack and heap usage. The stack is painted with a known pattern at startup, below the frame of the caller:
+ * the lowest word it no longer holds is the deepest the stack has been (high-water mark). Only a zone of the stack
+ * is painted so that the scan stays short, a high-water mark at the bottom of the zone means the stack went at
+ * least that deep. The heap figures (peak break, bytes in use and free in the arena, heap calls after the end of
+ * initialisation) are given by the caller and packed with the stack figures into CAN frames.
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine, the addresses and the heap figures
+ * come from the caller.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef MEMSTATS_H_
+#define MEMSTATS_H_
+
+#include <stdint.h>
+
+// Content of a stack word that was never used
+#define MEMSTATS_PAINT 0xC5C5C5C5
+
+// CAN frames of a report, see memstats_packCan()
+#define MEMSTATS_CAN_FRAMES 2
+#define MEMSTATS_CAN_PAYLOAD_SIZE 8
+
+typedef struct {
+	// Stack, in bytes
+	uint32_t stackPeak; // deepest use, from the top of the stack
+	uint32_t stackReserve; // space reserved by the linker script
+	uint32_t stackPainted; // from the top of the stack to the bottom of the painted zone, stackPeak saturates there
+	uint32_t gap; // never used, between the heap and the deepest use of the stack
+
+	// Heap, in bytes
+	uint32_t heapPeak; // highest break given by _sbrk()
+	uint32_t heapReserve; // space reserved by the linker script
+	uint32_t heapArena; // taken from _sbrk() by the allocator
+	uint32_t heapInUse; // allocated and not freed
+
+	uint32_t runtimeCalls; // allocator calls after the end of initialisation
+	uint8_t locked; // initialisation ended, see runtimeCalls
+} MEMSTATS;
+
+/*
+ * Paints a zone of the stack. Call it before the zone is used, with the interrupts disabled.
+ *
+ * @param low Lowest word of the zone
+ * @param high Word above the zone
+ */
+void memstats_paint(uint32_t* low, const uint32_t* high);
+
+/*
+ * Counts the words still painted from the bottom of a zone, the first used word ends the count.
+ *
+ * @param low Lowest word of the zone
+ * @param high Word above the zone
+ * @return Number of words never used
+ */
+uint32_t memstats_untouched(const uint32_t* low, const uint32_t* high);
+
+// Share of the arena that is free, in thousandths, 0 without any arena
+uint16_t memstats_fragmentation(const MEMSTATS* stats);
+
+/*
+ * Writes one CAN payload, 16 bit little endian values saturated at 0xFFFF:
+ *  frame 0: 0, locked, stack peak, stack reserve, gap
+ *  frame 1: 1, fragmentation in percent, heap peak, heap in use, allocator calls after initialisation
+ *
+ * @param stats The figures
+ * @param frame 0 to MEMSTATS_CAN_FRAMES - 1
+ * @param data Receives MEMSTATS_CAN_PAYLOAD_SIZE bytes
+ */
+void memstats_packCan(const MEMSTATS* stats, uint8_t frame, uint8_t* data);
+
+#endif /* MEMSTATS_H_ */
@@ -0,0 +1,185 @@
+/*
+ * pool.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "pool.h"
+
+#if defined(__arm__)
+#include "main.h" // CMSIS, for PRIMASK
+#define POOL_LOCK() uint32_t poolPrimask = __get_PRIMASK(); __disable_irq()
+#define POOL_UNLOCK() __set_PRIMASK(poolPrimask)
+#elif defined(POOL_HOST_LOCK_HOOK)
+// Host tests take an interrupt at the point the lock would be taken
+void POOL_HOST_LOCK_HOOK(void);
+#define POOL_LOCK() POOL_HOST_LOCK_HOOK()
+#define POOL_UNLOCK() do {} while (0)
+#else
+#define POOL_LOCK() do {} while (0)
+#define POOL_UNLOCK() do {} while (0)
+#endif
+
+#define POOL_CLASS(blockSize, blocks) \
+	_Static_assert((blockSize) >= POOL_ALIGN && (blockSize) % POOL_ALIGN == 0, "pool block size"); \
+	_Static_assert((blocks) > 0 && (blockSize) <= UINT16_MAX && (blocks) <= UINT16_MAX, "pool block count");
+#include "pool_config.h"
+#undef POOL_CLASS
+
+// A free block holds the next free block of its class
+typedef struct POOL_BLOCK {
+	struct POOL_BLOCK* next;
+} POOL_BLOCK;
+
+typedef struct {
+	uint8_t* start;
+	uint8_t* end;
+	POOL_BLOCK* free;
+	POOL_STATS stats;
+} POOL_CLASS_STATE;
+
+static const uint16_t blockSizes[POOL_CLASS_COUNT] = {
+#define POOL_CLASS(blockSize, blocks) blockSize,
+#include "pool_config.h"
+#undef POOL_CLASS
+};
+
+static const uint16_t blockCounts[POOL_CLASS_COUNT] = {
+#define POOL_CLASS(blockSize, blocks) blocks,
+#include "pool_config.h"
+#undef POOL_CLASS
+};
+
+static uint64_t arena[(0
+#define POOL_CLASS(blockSize, blocks) + (blockSize) * (blocks)
+#include "pool_config.h"
+#undef POOL_CLASS
+	) / sizeof(uint64_t)];
+
+static POOL_CLASS_STATE classes[POOL_CLASS_COUNT];
+static uint32_t oversize;
+static uint32_t invalidFrees;
+static volatile uint8_t ready;
+
+// Builds the free lists, called with the lock taken
+static void build(void){
+	uint8_t* next = (uint8_t*)arena;
+	for(uint8_t i = 0; i < POOL_CLASS_COUNT; i++){
+		POOL_CLASS_STATE* state = &classes[i];
+		state->start = next;
+		state->end = next + (uint32_t)blockSizes[i] * blockCounts[i];
+		state->stats = (POOL_STATS){.blockSize = blockSizes[i], .blocks = blockCounts[i]};
+
+		// Threaded from the last block down so that the first block is given out first
+		state->free = NULL;
+		for(uint16_t block = blockCounts[i]; block > 0; block--){
+			POOL_BLOCK* link = (POOL_BLOCK*)(next + (uint32_t)(block - 1) * blockSizes[i]);
+			link->next = state->free;
+			state->free = link;
+		}
+		next = state->end;
+	}
+	oversize = 0;
+	invalidFrees = 0;
+	ready = 1;
+}
+
+// First use without pool_init(): an interrupt can take the pool between the check and the lock, ready is checked
+// again under the lock so the lists it took a block from are not built a second time
+static void lazyInit(void){
+	POOL_LOCK();
+	if(!ready){
+		build();
+	}
+	POOL_UNLOCK();
+}
+
+void pool_init(void){
+	POOL_LOCK();
+	build();
+	POOL_UNLOCK();
+}
+
+void* pool_alloc(size_t size){
+	if(!ready){
+		lazyInit();
+	}
+
+	// The smallest class that fits, found before taking the lock
+	uint8_t first = 0;
+	while(first < POOL_CLASS_COUNT && blockSizes[first] < size){
+		first++;
+	}
+	if(first == POOL_CLASS_COUNT){
+		POOL_LOCK();
+		oversize++;
+		POOL_UNLOCK();
+		return NULL;
+	}
+
+	POOL_LOCK();
+	for(uint8_t i = first; i < POOL_CLASS_COUNT; i++){
+		POOL_CLASS_STATE* state = &classes[i];
+		POOL_BLOCK* block = state->free;
+		if(block == NULL){
+			continue;
+		}
+		state->free = block->next;
+		state->stats.allocs++;
+		if(++state->stats.inUse > state->stats.peak){
+			state->stats.peak = state->stats.inUse;
+		}
+		if(i != first){
+			classes[first].stats.spills++;
+		}
+		POOL_UNLOCK();
+		return block;
+	}
+	classes[first].stats.failures++;
+	POOL_UNLOCK();
+	return NULL;
+}
+
+void pool_free(void* block){
+	if(block == NULL){
+		return;
+	}
+	// Compared as integers, the pointer may come from anywhere
+	uintptr_t address = (uintptr_t)block;
+	POOL_LOCK();
+	for(uint8_t i = 0; i < POOL_CLASS_COUNT; i++){
+		POOL_CLASS_STATE* state = &classes[i];
+		if(address < (uintptr_t)state->start || address >= (uintptr_t)state->end){
+			continue;
+		}
+		if((address - (uintptr_t)state->start) % blockSizes[i] != 0 || state->stats.inUse == 0){
+			break;
+		}
+		POOL_BLOCK* link = (POOL_BLOCK*)block;
+		link->next = state->free;
+		state->free = link;
+		state->stats.inUse--;
+		POOL_UNLOCK();
+		return;
+	}
+	invalidFrees++;
+	POOL_UNLOCK();
+}
+
+void pool_stats(POOL_CLASS_ID id, POOL_STATS* stats){
+	if(!ready){
+		lazyInit();
+	}
+	POOL_LOCK();
+	*stats = classes[id].stats;
+	POOL_UNLOCK();
+}
+
+uint32_t pool_oversize(void){
+	return oversize;
+}
+
+uint32_t pool_invalidFrees(void){
+	return invalidFrees;
+}
@@ -0,0 +1,74 @@
+/*
+ * pool.h
+ *
+ * Fixed-size block pool for driver objects and buffers. The blocks live in a static arena cut into the size classes
+ * of pool_config.h, so the memory the drivers use is known at link time and cannot fragment. Each class keeps its
+ * free blocks in a list threaded through the blocks themselves: pool_alloc() and pool_free() take and give back the
+ * head of a list, with the interrupts disabled for a few instructions on the board, and may be called from an
+ * interrupt. The statistics of each class (blocks in use, peak, failures) size the classes.
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine, where nothing is locked.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Alignment of every block, enough for any type of the drivers
+#define POOL_ALIGN 8
+
+typedef enum {
+#define POOL_CLASS(blockSize, blocks) POOL_CLASS_##blockSize,
+#include "pool_config.h"
+#undef POOL_CLASS
+	POOL_CLASS_COUNT
+} POOL_CLASS_ID;
+
+typedef struct {
+	uint16_t blockSize; // bytes
+	uint16_t blocks;
+	uint16_t inUse;
+	uint16_t peak; // highest inUse since pool_init()
+	uint32_t allocs; // blocks given out by pool_alloc()
+	uint32_t spills; // requests of this class served by a larger one
+	uint32_t failures; // requests of this class that found no free block in it or above
+} POOL_STATS;
+
+// Builds the free lists, every block given out before is lost. pool_alloc() and pool_stats() build them on first
+// use if this was not called, which is safe against an interrupt using the pool at the same time.
+void pool_init(void);
+
+/*
+ * Takes a block of the smallest class that fits and has one free.
+ *
+ * @param size Bytes needed, 0 is served like 1
+ * @return The block, aligned on POOL_ALIGN, or NULL when the size is larger than every class or no block is free
+ */
+void* pool_alloc(size_t size);
+
+/*
+ * Gives a block back to its class. NULL is ignored, as are pointers that are not the start of a pool block
+ * (counted by pool_invalidFrees()). A block freed twice is not detected.
+ */
+void pool_free(void* block);
+
+/*
+ * Copies the statistics of a class.
+ *
+ * @param id Class, below POOL_CLASS_COUNT
+ * @param stats Receives the statistics
+ */
+void pool_stats(POOL_CLASS_ID id, POOL_STATS* stats);
+
+// Requests larger than the largest class since pool_init()
+uint32_t pool_oversize(void);
+
+// Calls of pool_free() with a pointer that is not a pool block since pool_init()
+uint32_t pool_invalidFrees(void);
+
+#endif /* POOL_H_ */
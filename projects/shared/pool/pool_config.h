@@ -0,0 +1,18 @@
+/*
+ * pool_config.h
+ *
+ * The size classes of pool.h, one POOL_CLASS(blockSize, blocks) line each, from the smallest block to the largest.
+ * Block sizes are multiples of POOL_ALIGN. A request takes a block of the smallest class it fits in, or of a larger
+ * class when that one is used up: give each class enough blocks for every object created at startup and check the
+ * peaks of pool_stats() after a run on the boat.
+ *
+ * This file is included several times on purpose, it has no include guard.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+POOL_CLASS(16, 16) // BRITER input buffer, IMU calibration status and CALIBSTAT
+POOL_CLASS(32, 8) // BRITER object, IMU input buffer
+POOL_CLASS(128, 4) // spare for transient buffers
+POOL_CLASS(512, 4) // IMU and WINDSENSOR objects
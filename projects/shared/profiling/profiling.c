@@ -0,0 +1,166 @@
+/*
+ * profiling.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "profiling.h"
+#include "profiling_irq.h"
+
+#ifdef PROFILING_ENABLE
+
+#include <stdio.h>
+
+#define CALIBRATION_RUNS 32
+#define HEADER_LINES 1
+#define LINES_PER_PROBE 2
+
+static const char* const names[PROFILING_PROBE_COUNT] = {
+#define PROFILING_PROBE(name) #name,
+#include "profiling_probes.h"
+#undef PROFILING_PROBE
+};
+
+static PROFILING_STATS table[PROFILING_PROBE_COUNT];
+static uint32_t overhead;
+
+static void put32(uint8_t* data, uint32_t value){
+	for(uint8_t i = 0; i < 4; i++){
+		data[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+uint32_t profiling_mean(const PROFILING_STATS* stats){
+	return stats->count > 0 ? (uint32_t)(stats->total / stats->count) : 0;
+}
+
+void profiling_init(void){
+#if defined(__arm__)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	// The shortest of a few empty measurements, the longer ones were interrupted
+	overhead = UINT32_MAX;
+	for(uint8_t i = 0; i < CALIBRATION_RUNS; i++){
+		uint32_t start = profiling_now();
+		uint32_t ticks = profiling_now() - start;
+		if(ticks < overhead){
+			overhead = ticks;
+		}
+	}
+	profiling_reset();
+}
+
+uint32_t profiling_tickRate(void){
+#if defined(__arm__)
+	return SystemCoreClock;
+#else
+	return 1000000000u;
+#endif
+}
+
+uint32_t profiling_overhead(void){
+	return overhead;
+}
+
+void profiling_reset(void){
+	for(uint8_t i = 0; i < PROFILING_PROBE_COUNT; i++){
+		PROFILING_LOCK();
+		table[i] = (PROFILING_STATS){.min = UINT32_MAX};
+		PROFILING_UNLOCK();
+	}
+	profiling_irqReset();
+}
+
+uint8_t profiling_bucket(uint32_t ticks){
+	uint8_t bits = ticks == 0 ? 0 : 32 - __builtin_clz(ticks);
+	if(bits <= PROFILING_BUCKET_SHIFT){
+		return 0;
+	}
+	bits -= PROFILING_BUCKET_SHIFT;
+	return bits < PROFILING_BUCKETS ? bits : PROFILING_BUCKETS - 1;
+}
+
+void profiling_accumulate(PROFILING_STATS* stats, uint32_t ticks){
+	stats->count++;
+	stats->total += ticks;
+	if(ticks < stats->min){
+		stats->min = ticks;
+	}
+	if(ticks > stats->max){
+		stats->max = ticks;
+	}
+	stats->histogram[profiling_bucket(ticks)]++;
+}
+
+void profiling_record(uint8_t probe, uint32_t ticks){
+	if(probe >= PROFILING_PROBE_COUNT){
+		return;
+	}
+	ticks = ticks > overhead ? ticks - overhead : 0;
+	PROFILING_LOCK();
+	profiling_accumulate(&table[probe], ticks);
+	PROFILING_UNLOCK();
+}
+
+void profiling_stats(uint8_t probe, PROFILING_STATS* stats){
+	PROFILING_LOCK();
+	*stats = table[probe];
+	PROFILING_UNLOCK();
+}
+
+const char* profiling_name(uint8_t probe){
+	return probe < PROFILING_PROBE_COUNT ? names[probe] : "";
+}
+
+uint16_t profiling_formatHistogram(const char* tag, const char* name, const PROFILING_STATS* stats, char* line){
+	int length = snprintf(line, PROFILING_LINE_SIZE, "%s %s", tag, name);
+	for(uint8_t i = 0; i < PROFILING_BUCKETS && length < PROFILING_LINE_SIZE; i++){
+		length += snprintf(&line[length], PROFILING_LINE_SIZE - length, " %lu", (unsigned long)stats->histogram[i]);
+	}
+	if(length < PROFILING_LINE_SIZE){
+		length += snprintf(&line[length], PROFILING_LINE_SIZE - length, "\r\n");
+	}
+	return length < PROFILING_LINE_SIZE ? length : PROFILING_LINE_SIZE - 1;
+}
+
+uint16_t profiling_formatLine(uint16_t index, char* line){
+	int length;
+	if(index < HEADER_LINES){
+		length = snprintf(line, PROFILING_LINE_SIZE, "PROF %lu %lu\r\n", (unsigned long)profiling_tickRate(),
+				(unsigned long)overhead);
+		return length < PROFILING_LINE_SIZE ? length : PROFILING_LINE_SIZE - 1;
+	}
+
+	index -= HEADER_LINES;
+	uint8_t probe = index / LINES_PER_PROBE;
+	if(probe >= PROFILING_PROBE_COUNT){
+		line[0] = '\0';
+		return 0;
+	}
+	PROFILING_STATS stats;
+	profiling_stats(probe, &stats);
+	if(index % LINES_PER_PROBE == 0){
+		length = snprintf(line, PROFILING_LINE_SIZE, "PROF %s n=%lu min=%lu mean=%lu max=%lu\r\n", names[probe],
+				(unsigned long)stats.count, (unsigned long)(stats.count > 0 ? stats.min : 0),
+				(unsigned long)profiling_mean(&stats), (unsigned long)stats.max);
+	}
+	else{
+		return profiling_formatHistogram("HIST", names[probe], &stats, line);
+	}
+	return length < PROFILING_LINE_SIZE ? length : PROFILING_LINE_SIZE - 1;
+}
+
+void profiling_packCan(uint8_t probe, uint8_t frame, uint8_t* data){
+	PROFILING_STATS stats;
+	profiling_stats(probe, &stats);
+	const uint32_t values[PROFILING_CAN_FRAMES] = {stats.count, stats.count > 0 ? stats.min : 0, profiling_mean(&stats), stats.max};
+	data[0] = probe;
+	data[1] = frame;
+	put32(&data[2], frame < PROFILING_CAN_FRAMES ? values[frame] : 0);
+	data[6] = 0;
+	data[7] = 0;
+}
+
+#endif /* PROFILING_ENABLE */
@@ -0,0 +1,158 @@
+/*
+ * profiling.h
+ *
+ * Execution time of named probes. A probe measures the code between PROFILING_ENTER(name) and
+ * PROFILING_EXIT(name), or from PROFILING_SCOPE(name) to the end of the enclosing block (every return included),
+ * and keeps its count, minimum, mean, maximum and a histogram in a fixed table. The time is read from the DWT cycle
+ * counter on the microcontroller and from clock_gettime() in nanoseconds on a host machine, the cost of reading it
+ * twice is measured by profiling_init() and taken off every measurement.
+ *
+ * The probes are listed in profiling_probes.h. profiling_formatLine() and profiling_packCan() turn the table into
+ * text lines and CAN frames for a dump. The interrupt handlers are timed separately, see profiling_irq.h.
+ *
+ * Everything compiles out unless PROFILING_ENABLE is defined for the whole project (preprocessor symbols of the
+ * compiler settings): the macros are then empty and none of the functions or the table exist.
+ *
+ * Recording is safe from interrupts, a probe can be used in an interrupt and in the main loop.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef PROFILING_H_
+#define PROFILING_H_
+
+#ifdef PROFILING_ENABLE
+
+#include <stdint.h>
+
+#if defined(__arm__)
+#include "main.h" // CMSIS, for the DWT
+#else
+#include <time.h>
+#endif
+
+// Histogram buckets: bucket 0 holds durations below 2^PROFILING_BUCKET_SHIFT ticks, bucket k the durations from
+// 2^(k + PROFILING_BUCKET_SHIFT - 1) to twice that, the last bucket everything above
+#define PROFILING_BUCKETS 16
+#define PROFILING_BUCKET_SHIFT 5
+
+// Longest line written by profiling_formatLine(), with its terminator
+#define PROFILING_LINE_SIZE 256
+
+// CAN frames per probe, see profiling_packCan()
+#define PROFILING_CAN_FRAMES 4
+#define PROFILING_CAN_PAYLOAD_SIZE 8
+
+typedef enum {
+#define PROFILING_PROBE(name) PROFILING_PROBE_##name,
+#include "profiling_probes.h"
+#undef PROFILING_PROBE
+	PROFILING_PROBE_COUNT
+} PROFILING_PROBE_ID;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min; // ticks, UINT32_MAX before the first measurement
+	uint32_t max;
+	uint64_t total;
+	uint32_t histogram[PROFILING_BUCKETS];
+} PROFILING_STATS;
+
+// A probe started by PROFILING_SCOPE()
+typedef struct {
+	uint8_t probe;
+	uint32_t start;
+} PROFILING_MARK;
+
+// Current time in ticks: CPU cycles on the microcontroller, nanoseconds on a host machine
+static inline uint32_t profiling_now(void){
+#if defined(__arm__)
+	return DWT->CYCCNT;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint32_t)((uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec);
+#endif
+}
+
+// Masks the interrupts while the tables are updated, the two must be in the same block
+#if defined(__arm__)
+#define PROFILING_LOCK() uint32_t profilingPrimask = __get_PRIMASK(); __disable_irq()
+#define PROFILING_UNLOCK() __set_PRIMASK(profilingPrimask)
+#else
+#define PROFILING_LOCK() do {} while (0)
+#define PROFILING_UNLOCK() do {} while (0)
+#endif
+
+// Starts the cycle counter, measures the overhead of a probe and clears the tables (interrupts included)
+void profiling_init(void);
+
+// Ticks per second of profiling_now()
+uint32_t profiling_tickRate(void);
+
+// Ticks taken off every measurement: the cost of reading the time twice
+uint32_t profiling_overhead(void);
+
+// Clears the tables, interrupts included
+void profiling_reset(void);
+
+// Adds a measurement to a probe, the overhead is taken off first. Safe from interrupts.
+void profiling_record(uint8_t probe, uint32_t ticks);
+
+// Adds a duration to any statistics (no overhead taken off, no interrupt lock), also used outside the table
+void profiling_accumulate(PROFILING_STATS* stats, uint32_t ticks);
+
+// Mean of the durations, 0 without any
+uint32_t profiling_mean(const PROFILING_STATS* stats);
+
+// Histogram bucket of a duration
+uint8_t profiling_bucket(uint32_t ticks);
+
+// Copies the statistics of a probe, consistent even if an interrupt records at the same time
+void profiling_stats(uint8_t probe, PROFILING_STATS* stats);
+
+// Name of a probe as listed in profiling_probes.h
+const char* profiling_name(uint8_t probe);
+
+/*
+ * Writes one line of the dump: first "PROF <tick rate> <overhead>", then for each probe
+ * "PROF <name> n=<count> min=<ticks> mean=<ticks> max=<ticks>" followed by "HIST <name> <count of each bucket>".
+ *
+ * @param index Line to write, from 0
+ * @param line Receives up to PROFILING_LINE_SIZE characters with the terminator
+ * @return Length of the line, 0 after the last one
+ */
+uint16_t profiling_formatLine(uint16_t index, char* line);
+
+// Writes "<tag> <name> <count of each bucket>" into a line of PROFILING_LINE_SIZE, returns its length
+uint16_t profiling_formatHistogram(const char* tag, const char* name, const PROFILING_STATS* stats, char* line);
+
+/*
+ * Writes one CAN payload of a probe: probe, frame, then the count (frame 0), minimum (1), mean (2) or maximum (3)
+ * in ticks, 32 bit little endian, and two unused bytes.
+ *
+ * @param probe The probe
+ * @param frame 0 to PROFILING_CAN_FRAMES - 1
+ * @param data Receives PROFILING_CAN_PAYLOAD_SIZE bytes
+ */
+void profiling_packCan(uint8_t probe, uint8_t frame, uint8_t* data);
+
+static inline void profiling_exitMark(PROFILING_MARK* mark){
+	profiling_record(mark->probe, profiling_now() - mark->start);
+}
+
+#define PROFILING_ENTER(name) uint32_t profilingStart_##name = profiling_now()
+#define PROFILING_EXIT(name) profiling_record(PROFILING_PROBE_##name, profiling_now() - profilingStart_##name)
+#define PROFILING_SCOPE(name) PROFILING_MARK profilingScope_##name __attribute__((cleanup(profiling_exitMark))) = \
+		{PROFILING_PROBE_##name, profiling_now()}
+
+#else
+
+#define PROFILING_ENTER(name) do {} while (0)
+#define PROFILING_EXIT(name) do {} while (0)
+#define PROFILING_SCOPE(name) do {} while (0)
+
+#endif /* PROFILING_ENABLE */
+
+#endif /* PROFILING_H_ */
@@ -0,0 +1,174 @@
+/*
+ * profiling_irq.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "profiling_irq.h"
+
+#ifdef PROFILING_ENABLE
+
+#include <stdio.h>
+
+#define HEADER_LINES 1
+#define LINES_PER_IRQ 3
+#define CAN_NESTING_IRQS 6
+
+// An interrupt in progress
+typedef struct {
+	uint8_t irq;
+	uint32_t start;
+	uint32_t nested; // ticks spent in the interrupts that preempted it
+} ACTIVE_IRQ;
+
+static const char* const names[PROFILING_IRQ_COUNT] = {
+#define PROFILING_IRQ(name) #name,
+#include "profiling_irqs.h"
+#undef PROFILING_IRQ
+};
+
+static PROFILING_IRQ_STATS table[PROFILING_IRQ_COUNT];
+static ACTIVE_IRQ active[PROFILING_IRQ_MAX_DEPTH];
+static uint8_t depth;
+static PROFILING_IRQ_NESTING deepest;
+
+static void put32(uint8_t* data, uint32_t value){
+	for(uint8_t i = 0; i < 4; i++){
+		data[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+static uint32_t minOf(const PROFILING_STATS* stats){
+	return stats->count > 0 ? stats->min : 0;
+}
+
+void profiling_irqReset(void){
+	PROFILING_LOCK();
+	for(uint8_t i = 0; i < PROFILING_IRQ_COUNT; i++){
+		table[i] = (PROFILING_IRQ_STATS){.duration.min = UINT32_MAX, .latency.min = UINT32_MAX};
+	}
+	// Interrupts in progress stay on the stack so that their exits still match
+	deepest = (PROFILING_IRQ_NESTING){0};
+	PROFILING_UNLOCK();
+}
+
+void profiling_irqEnter(uint8_t irq, uint32_t now, uint32_t latency){
+	if(irq >= PROFILING_IRQ_COUNT){
+		return;
+	}
+	PROFILING_LOCK();
+	if(depth < PROFILING_IRQ_MAX_DEPTH){
+		if(depth > 0){
+			table[active[depth - 1].irq].preempted++;
+		}
+		active[depth] = (ACTIVE_IRQ){.irq = irq, .start = now, .nested = 0};
+		depth++;
+		if(depth > deepest.depth){
+			deepest.depth = depth;
+			for(uint8_t i = 0; i < depth; i++){
+				deepest.irqs[i] = active[i].irq;
+			}
+		}
+		if(latency != PROFILING_IRQ_NO_LATENCY){
+			profiling_accumulate(&table[irq].latency, latency);
+		}
+	}
+	PROFILING_UNLOCK();
+}
+
+void profiling_irqExit(uint8_t irq, uint32_t now){
+	PROFILING_LOCK();
+	if(depth > 0 && active[depth - 1].irq == irq){
+		depth--;
+		uint32_t total = now - active[depth].start;
+		uint32_t own = total > active[depth].nested ? total - active[depth].nested : 0;
+		uint32_t overhead = profiling_overhead();
+		profiling_accumulate(&table[irq].duration, own > overhead ? own - overhead : 0);
+		if(depth > 0){
+			active[depth - 1].nested += total;
+		}
+	}
+	PROFILING_UNLOCK();
+}
+
+void profiling_irqStats(uint8_t irq, PROFILING_IRQ_STATS* stats){
+	PROFILING_LOCK();
+	*stats = table[irq];
+	PROFILING_UNLOCK();
+}
+
+void profiling_irqNesting(PROFILING_IRQ_NESTING* nesting){
+	PROFILING_LOCK();
+	*nesting = deepest;
+	PROFILING_UNLOCK();
+}
+
+const char* profiling_irqName(uint8_t irq){
+	return irq < PROFILING_IRQ_COUNT ? names[irq] : "";
+}
+
+uint16_t profiling_irqFormatLine(uint16_t index, char* line){
+	int length;
+	if(index < HEADER_LINES){
+		PROFILING_IRQ_NESTING nesting;
+		profiling_irqNesting(&nesting);
+		length = snprintf(line, PROFILING_LINE_SIZE, "NEST %u", nesting.depth);
+		for(uint8_t i = 0; i < nesting.depth && length < PROFILING_LINE_SIZE; i++){
+			length += snprintf(&line[length], PROFILING_LINE_SIZE - length, " %s", names[nesting.irqs[i]]);
+		}
+		if(length < PROFILING_LINE_SIZE){
+			length += snprintf(&line[length], PROFILING_LINE_SIZE - length, "\r\n");
+		}
+		return length < PROFILING_LINE_SIZE ? length : PROFILING_LINE_SIZE - 1;
+	}
+
+	index -= HEADER_LINES;
+	uint8_t irq = index / LINES_PER_IRQ;
+	if(irq >= PROFILING_IRQ_COUNT){
+		line[0] = '\0';
+		return 0;
+	}
+	PROFILING_IRQ_STATS stats;
+	profiling_irqStats(irq, &stats);
+	switch(index % LINES_PER_IRQ){
+	case 0:
+		length = snprintf(line, PROFILING_LINE_SIZE, "IRQ %s n=%lu preempted=%lu dur=%lu/%lu/%lu lat=%lu %lu/%lu/%lu\r\n",
+				names[irq], (unsigned long)stats.duration.count, (unsigned long)stats.preempted,
+				(unsigned long)minOf(&stats.duration), (unsigned long)profiling_mean(&stats.duration),
+				(unsigned long)stats.duration.max, (unsigned long)stats.latency.count,
+				(unsigned long)minOf(&stats.latency), (unsigned long)profiling_mean(&stats.latency),
+				(unsigned long)stats.latency.max);
+		return length < PROFILING_LINE_SIZE ? length : PROFILING_LINE_SIZE - 1;
+	case 1:
+		return profiling_formatHistogram("IDUR", names[irq], &stats.duration, line);
+	default:
+		return profiling_formatHistogram("ILAT", names[irq], &stats.latency, line);
+	}
+}
+
+void profiling_irqPackCan(uint8_t irq, uint8_t frame, uint8_t* data){
+	PROFILING_IRQ_STATS stats;
+	profiling_irqStats(irq, &stats);
+	const uint32_t values[PROFILING_IRQ_CAN_FRAMES] = {
+		stats.duration.count, profiling_mean(&stats.duration), stats.duration.max,
+		profiling_mean(&stats.latency), stats.latency.max, stats.preempted
+	};
+	data[0] = PROFILING_IRQ_CAN_FLAG | irq;
+	data[1] = frame;
+	put32(&data[2], frame < PROFILING_IRQ_CAN_FRAMES ? values[frame] : 0);
+	data[6] = 0;
+	data[7] = 0;
+}
+
+void profiling_irqPackNesting(uint8_t* data){
+	PROFILING_IRQ_NESTING nesting;
+	profiling_irqNesting(&nesting);
+	data[0] = PROFILING_IRQ_CAN_NESTING;
+	data[1] = nesting.depth;
+	for(uint8_t i = 0; i < CAN_NESTING_IRQS; i++){
+		data[2 + i] = i < nesting.depth ? nesting.irqs[i] : 0xFF;
+	}
+}
+
+#endif /* PROFILING_ENABLE */
@@ -0,0 +1,123 @@
+/*
+ * profiling_irq.h
+ *
+ * Latency and duration of the interrupts listed in profiling_irqs.h, with the deepest nesting seen. The handler
+ * calls PROFILING_IRQ_ENTER(name) first and PROFILING_IRQ_EXIT(name) last, in the USER CODE sections around the HAL
+ * handler, so the HAL callbacks it calls (and the driver code in them) are timed with it.
+ *
+ * The duration of an interrupt is its own time: the interrupts that preempted it are taken off and counted as
+ * preemptions instead, so each histogram shows the work done at that priority. The latency is the time from the
+ * hardware event to the start of the handler. Only a timer gives it: the counter of an up-counting timer holds the
+ * ticks since its update event, PROFILING_IRQ_ENTER_TIMER() reads it (assuming the timer kernel clock is the core
+ * clock, which is the case without APB prescaler). For the other interrupts the latency is not measured.
+ *
+ * Part of profiling.h: it compiles out unless PROFILING_ENABLE is defined, profiling_init() clears it and the
+ * dump lines follow those of the probes.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef PROFILING_IRQ_H_
+#define PROFILING_IRQ_H_
+
+#include "profiling.h"
+
+#ifdef PROFILING_ENABLE
+
+// Nesting levels tracked, deeper interrupts are not timed
+#define PROFILING_IRQ_MAX_DEPTH 8
+
+// Latency given to profiling_irqEnter() when the interrupt has no way to measure it
+#define PROFILING_IRQ_NO_LATENCY UINT32_MAX
+
+// CAN frames per interrupt, see profiling_irqPackCan()
+#define PROFILING_IRQ_CAN_FRAMES 6
+
+// First byte of the CAN payloads: interrupt frames have this bit set, the nesting frame is PROFILING_IRQ_CAN_NESTING
+#define PROFILING_IRQ_CAN_FLAG 0x80
+#define PROFILING_IRQ_CAN_NESTING 0xFF
+
+typedef enum {
+#define PROFILING_IRQ(name) PROFILING_IRQ_##name,
+#include "profiling_irqs.h"
+#undef PROFILING_IRQ
+	PROFILING_IRQ_COUNT
+} PROFILING_IRQ_ID;
+
+typedef struct {
+	PROFILING_STATS duration; // own time, without the interrupts that preempted it
+	PROFILING_STATS latency; // from the hardware event, empty if it cannot be measured
+	uint32_t preempted; // times another timed interrupt ran inside this one
+} PROFILING_IRQ_STATS;
+
+typedef struct {
+	uint8_t depth; // deepest nesting seen, 1 if no interrupt ever preempted another
+	uint8_t irqs[PROFILING_IRQ_MAX_DEPTH]; // the interrupts active at that moment, outermost first
+} PROFILING_IRQ_NESTING;
+
+// Clears the statistics and the nesting, done by profiling_init() and profiling_reset()
+void profiling_irqReset(void);
+
+/*
+ * Start of a handler.
+ *
+ * @param irq The interrupt
+ * @param now profiling_now()
+ * @param latency Ticks since the hardware event, PROFILING_IRQ_NO_LATENCY if unknown
+ */
+void profiling_irqEnter(uint8_t irq, uint32_t now, uint32_t latency);
+
+// End of a handler, ignored if it is not the innermost interrupt entered
+void profiling_irqExit(uint8_t irq, uint32_t now);
+
+// Copies the statistics of an interrupt
+void profiling_irqStats(uint8_t irq, PROFILING_IRQ_STATS* stats);
+
+// Copies the deepest nesting seen
+void profiling_irqNesting(PROFILING_IRQ_NESTING* nesting);
+
+// Name of an interrupt as listed in profiling_irqs.h
+const char* profiling_irqName(uint8_t irq);
+
+/*
+ * Writes one line of the dump: first "NEST <depth> <names of the interrupts, outermost first>", then for each
+ * interrupt "IRQ <name> n=<count> preempted=<count> dur=<min>/<mean>/<max> lat=<count> <min>/<mean>/<max>" and the
+ * histograms "IDUR <name> ..." and "ILAT <name> ..." (see profiling_formatHistogram()).
+ *
+ * @param index Line to write, from 0
+ * @param line Receives up to PROFILING_LINE_SIZE characters with the terminator
+ * @return Length of the line, 0 after the last one
+ */
+uint16_t profiling_irqFormatLine(uint16_t index, char* line);
+
+/*
+ * Writes one CAN payload of an interrupt: PROFILING_IRQ_CAN_FLAG | irq, frame, then 32 bit little endian the count
+ * (frame 0), mean and maximum duration (1 and 2), mean and maximum latency (3 and 4) or the preemptions (5), and two
+ * unused bytes.
+ *
+ * @param irq The interrupt
+ * @param frame 0 to PROFILING_IRQ_CAN_FRAMES - 1
+ * @param data Receives PROFILING_CAN_PAYLOAD_SIZE bytes
+ */
+void profiling_irqPackCan(uint8_t irq, uint8_t frame, uint8_t* data);
+
+// Writes the nesting payload: PROFILING_IRQ_CAN_NESTING, depth, the first 6 interrupts (0xFF if none)
+void profiling_irqPackNesting(uint8_t* data);
+
+#define PROFILING_IRQ_ENTER(name) profiling_irqEnter(PROFILING_IRQ_##name, profiling_now(), PROFILING_IRQ_NO_LATENCY)
+#define PROFILING_IRQ_EXIT(name) profiling_irqExit(PROFILING_IRQ_##name, profiling_now())
+
+// For the update interrupt of an up-counting timer (TIM_TypeDef*): the counter restarted from 0 at the event
+#define PROFILING_IRQ_ENTER_TIMER(name, tim) profiling_irqEnter(PROFILING_IRQ_##name, profiling_now(), \
+		((tim)->SR & TIM_SR_UIF) ? (tim)->CNT * ((tim)->PSC + 1) : PROFILING_IRQ_NO_LATENCY)
+
+#else
+
+#define PROFILING_IRQ_ENTER(name) do {} while (0)
+#define PROFILING_IRQ_EXIT(name) do {} while (0)
+#define PROFILING_IRQ_ENTER_TIMER(name, tim) do {} while (0)
+
+#endif /* PROFILING_ENABLE */
+
+#endif /* PROFILING_IRQ_H_ */
@@ -0,0 +1,23 @@
+/*
+ * profiling_irqs.h
+ *
+ * The interrupts timed by profiling_irq.h, one PROFILING_IRQ(name) line each. The name is the one given to
+ * PROFILING_IRQ_ENTER() and PROFILING_IRQ_EXIT() in the handler and printed in the dump. Add a line here and the two
+ * macros to the USER CODE sections of the handler in stm32u5xx_it.c to time another interrupt.
+ *
+ * This file is included several times on purpose, it has no include guard.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+PROFILING_IRQ(SYSTICK) // HAL tick and watchdog supervision
+PROFILING_IRQ(USART1) // debug UART
+PROFILING_IRQ(I2C1_EV) // VEML3328 readings
+PROFILING_IRQ(I2C1_ER)
+PROFILING_IRQ(GPDMA1_CH1)
+PROFILING_IRQ(GPDMA1_CH4)
+PROFILING_IRQ(ADC1)
+PROFILING_IRQ(LPTIM1) // wakeup from Stop2, idle.c
+PROFILING_IRQ(TIM6) // wingsail servo-solenoid sequence, SERVOSOLENOID.c (update interrupt, latency measured)
+PROFILING_IRQ(GPDMA1_CH0) // wingsail servo ramp frames, SERVOSOLENOID.c
@@ -0,0 +1,18 @@
+/*
+ * profiling_probes.h
+ *
+ * The probes of profiling.h, one PROFILING_PROBE(name) line each. The name is the one given to PROFILING_SCOPE(),
+ * PROFILING_ENTER() and PROFILING_EXIT() and printed in the dump. Add a line here to profile another function.
+ *
+ * This file is included several times on purpose, it has no include guard.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+PROFILING_PROBE(BRITER_HANDLE_DMA) // BRITER__handleDMA(), one encoder reply
+PROFILING_PROBE(IMU_HANDLE_RX_DMA) // IMU__handleRxDMA(), decoding of an Euler or offsets reading (IMU_ACQUISITION_EULER)
+PROFILING_PROBE(IMU_HANDLE_MEM_RX_DMA) // IMU__handleMemRxDMA(), decoding of a burst reading, the default acquisition
+PROFILING_PROBE(PI_MOTOR) // PI_Motor(), one step of the rudder controller
+PROFILING_PROBE(WIND_SENSOR_DATA) // processWindSensorData(), one byte of NMEA
+PROFILING_PROBE(VEML3328_POLL) // veml3328_poll() of the base library, a blocking I2C check after a failure included
@@ -0,0 +1,127 @@
+/*
+ * regmap.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "regmap.h"
+#include <string.h>
+
+// Division rounded towards minus infinity (C division truncates towards zero)
+static int64_t floorDivide(int64_t numerator, int64_t denominator){
+	int64_t quotient = numerator / denominator;
+	if((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0))){
+		quotient--;
+	}
+	return quotient;
+}
+
+// Closes the transaction being built and places it in the plan buffer
+static uint8_t addTransaction(REGMAP_PLAN* plan, uint8_t address, uint8_t length){
+	if(plan->transactionCount >= REGMAP_MAX_TRANSACTIONS || plan->length + length > REGMAP_MAX_BUFFER){
+		return 0;
+	}
+	REGMAP_TRANSACTION* transaction = &plan->transactions[plan->transactionCount++];
+	transaction->address = address;
+	transaction->length = length;
+	transaction->offset = plan->length;
+	plan->length += length;
+	return 1;
+}
+
+uint8_t regmap_plan(const REGMAP_DEVICE* device, const uint8_t* indices, uint8_t count, REGMAP_PLAN* plan){
+	uint8_t order[REGMAP_MAX_REGISTERS];
+	uint8_t ordered = 0;
+
+	memset(plan, 0, sizeof(*plan));
+	memset(plan->offsets, REGMAP_NOT_PLANNED, sizeof(plan->offsets));
+	if(device->count > REGMAP_MAX_REGISTERS){
+		return 0;
+	}
+
+	// Sort the requested registers by address, dropping duplicates
+	for(uint8_t i = 0; i < count; i++){
+		uint8_t index = indices[i];
+		if(index >= device->count){
+			return 0;
+		}
+		if(plan->offsets[index] != REGMAP_NOT_PLANNED){
+			continue;
+		}
+		plan->offsets[index] = 0;
+
+		uint8_t position = ordered++;
+		while(position > 0 && device->registers[order[position - 1]].address > device->registers[index].address){
+			order[position] = order[position - 1];
+			position--;
+		}
+		order[position] = index;
+	}
+	if(ordered == 0){
+		return 1;
+	}
+
+	// Merge neighbouring registers into block reads. The transaction being built goes at the end of the buffer.
+	const REGMAP_REGISTER* first = &device->registers[order[0]];
+	uint8_t start = first->address;
+	uint16_t end = first->address + first->width;
+	plan->offsets[order[0]] = 0;
+	for(uint8_t i = 1; i < ordered; i++){
+		const REGMAP_REGISTER* reg = &device->registers[order[i]];
+		uint16_t regEnd = reg->address + reg->width;
+		uint16_t mergedEnd = regEnd > end ? regEnd : end;
+		if(device->autoIncrement && reg->address <= end + device->maxGap && mergedEnd - start <= device->maxBlock){
+			end = mergedEnd;
+		}
+		else{
+			if(!addTransaction(plan, start, end - start)){
+				return 0;
+			}
+			start = reg->address;
+			end = regEnd;
+		}
+		plan->offsets[order[i]] = plan->length + reg->address - start;
+	}
+	if(!addTransaction(plan, start, end - start)){
+		return 0;
+	}
+	return 1;
+}
+
+int32_t regmap_raw(const REGMAP_REGISTER* reg, const uint8_t* bytes){
+	uint32_t value = 0;
+	for(uint8_t i = 0; i < reg->width; i++){
+		uint8_t byte = reg->endianness == REGMAP_BIG_ENDIAN ? bytes[i] : bytes[reg->width - 1 - i];
+		value = (value << 8) | byte;
+	}
+	if(reg->isSigned && reg->width < 4 && (value & (1UL << (8 * reg->width - 1)))){
+		value |= ~0UL << (8 * reg->width);
+	}
+	return (int32_t)value;
+}
+
+int32_t regmap_scale(const REGMAP_REGISTER* reg, int32_t raw){
+	if(reg->scaleNumerator == reg->scaleDenominator){
+		return raw;
+	}
+	int64_t denominator = 2 * (int64_t)reg->scaleDenominator;
+	return (int32_t)floorDivide(2 * (int64_t)raw * reg->scaleNumerator + reg->scaleDenominator, denominator);
+}
+
+int32_t regmap_value(const REGMAP_DEVICE* device, const REGMAP_PLAN* plan, const uint8_t* buffer, uint8_t index){
+	if(index >= device->count || plan->offsets[index] == REGMAP_NOT_PLANNED){
+		return 0;
+	}
+	const REGMAP_REGISTER* reg = &device->registers[index];
+	return regmap_scale(reg, regmap_raw(reg, &buffer[plan->offsets[index]]));
+}
+
+void regmap_encode(const REGMAP_REGISTER* reg, int32_t raw, uint8_t* bytes){
+	uint32_t value = (uint32_t)raw;
+	for(uint8_t i = 0; i < reg->width; i++){
+		uint8_t position = reg->endianness == REGMAP_BIG_ENDIAN ? reg->width - 1 - i : i;
+		bytes[position] = value & 0xFF;
+		value >>= 8;
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * regmap.h
+ *
+ * Declarative register maps for I2C devices. A device is described by a table of its registers (address, width,
+ * byte order, sign and scale) instead of hand written read sequences. A set of registers to read is planned into
+ * the fewest bus transactions: registers that are adjacent (or separated by a gap cheaper to read through than a
+ * new transaction) are merged into one block read when the device auto-increments its register pointer.
+ *
+ * This file does not depend on the HAL so the planner and decoding can be tested on a host machine. The bus side
+ * is in regmap_i2c.h.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef REGMAP_H_
+#define REGMAP_H_
+
+#include <stdint.h>
+
+// Largest number of registers in a device table
+#define REGMAP_MAX_REGISTERS 48
+
+// Largest number of transactions in a plan
+#define REGMAP_MAX_TRANSACTIONS 8
+
+// Largest number of bytes read by a plan
+#define REGMAP_MAX_BUFFER 64
+
+// Offset of a register that is not part of a plan
+#define REGMAP_NOT_PLANNED 0xFF
+
+typedef enum {
+	REGMAP_LITTLE_ENDIAN,
+	REGMAP_BIG_ENDIAN
+} REGMAP_ENDIANNESS;
+
+// One register. The decoded value is raw * scaleNumerator / scaleDenominator, rounded to nearest (halves up).
+typedef struct {
+	uint8_t address;
+	uint8_t width; // bytes, 1 to 4
+	REGMAP_ENDIANNESS endianness;
+	uint8_t isSigned;
+	int32_t scaleNumerator;
+	int32_t scaleDenominator;
+} REGMAP_REGISTER;
+
+// A device. With autoIncrement a block read starting at a register returns the registers at the following byte
+// addresses; without it every register is its own transaction (e.g. command code devices with 16 bit registers).
+typedef struct {
+	uint8_t address; // 7 bit I2C address
+	uint8_t autoIncrement;
+	uint8_t maxGap; // unused bytes a block read may read through to merge two registers
+	uint8_t maxBlock; // largest block read in bytes
+	const REGMAP_REGISTER* registers;
+	uint8_t count;
+} REGMAP_DEVICE;
+
+// One block read: length bytes from register address, stored at offset in the plan buffer
+typedef struct {
+	uint8_t address;
+	uint8_t length;
+	uint8_t offset;
+} REGMAP_TRANSACTION;
+
+typedef struct {
+	REGMAP_TRANSACTION transactions[REGMAP_MAX_TRANSACTIONS];
+	uint8_t transactionCount;
+	uint8_t length; // bytes used in the plan buffer
+	uint8_t offsets[REGMAP_MAX_REGISTERS]; // buffer offset of each register of the table, REGMAP_NOT_PLANNED if not read
+} REGMAP_PLAN;
+
+// Plans the reads of the registers at the given table indices. Duplicate indices are allowed.
+// Returns 1 on success, 0 if an index is out of range or the plan does not fit in the limits above.
+uint8_t regmap_plan(const REGMAP_DEVICE* device, const uint8_t* indices, uint8_t count, REGMAP_PLAN* plan);
+
+// Raw (sign extended) value of a register from its bytes
+int32_t regmap_raw(const REGMAP_REGISTER* reg, const uint8_t* bytes);
+
+// Scaled value of a raw register value
+int32_t regmap_scale(const REGMAP_REGISTER* reg, int32_t raw);
+
+// Scaled value of a planned register from the plan buffer, 0 if the register was not planned
+int32_t regmap_value(const REGMAP_DEVICE* device, const REGMAP_PLAN* plan, const uint8_t* buffer, uint8_t index);
+
+// Writes a raw value into the bytes of a register in the register's byte order
+void regmap_encode(const REGMAP_REGISTER* reg, int32_t raw, uint8_t* bytes);
+
+#endif /* REGMAP_H_ */
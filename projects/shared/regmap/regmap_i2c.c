@@ -0,0 +1,127 @@
+/*
+ * regmap_i2c.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "regmap_i2c.h"
+
+static HAL_StatusTypeDef startTransaction(REGMAP_I2C* self){
+	const REGMAP_TRANSACTION* transaction = &self->plan.transactions[self->transaction];
+	uint16_t address = self->device->address << 1;
+	self->transactions++;
+	if(self->i2c->hdmarx != NULL){
+		return HAL_I2C_Mem_Read_DMA(self->i2c, address, transaction->address, I2C_MEMADD_SIZE_8BIT, &self->buffer[transaction->offset], transaction->length);
+	}
+	return HAL_I2C_Mem_Read_IT(self->i2c, address, transaction->address, I2C_MEMADD_SIZE_8BIT, &self->buffer[transaction->offset], transaction->length);
+}
+
+//The device stays busy during the callback, so the plan and buffer it reads the results from cannot be replaced by
+//a transfer started meanwhile
+static void finish(REGMAP_I2C* self, HAL_StatusTypeDef status){
+	if(self->callback != NULL){
+		self->callback(self->context, status);
+	}
+	self->busy = 0;
+}
+
+void regmap_i2c_init(REGMAP_I2C* self, I2C_HandleTypeDef* i2c, const REGMAP_DEVICE* device){
+	self->i2c = i2c;
+	self->device = device;
+	self->plan.transactionCount = 0;
+	self->transaction = 0;
+	self->busy = 0;
+	self->callback = NULL;
+	self->context = NULL;
+	self->transactions = 0;
+}
+
+HAL_StatusTypeDef regmap_i2c_read(REGMAP_I2C* self, const uint8_t* indices, uint8_t count, REGMAP_CALLBACK callback, void* context){
+	if(self->busy){
+		return HAL_BUSY;
+	}
+	if(!regmap_plan(self->device, indices, count, &self->plan)){
+		return HAL_ERROR;
+	}
+	self->callback = callback;
+	self->context = context;
+	self->transaction = 0;
+	self->busy = 1;
+	if(self->plan.transactionCount == 0){
+		finish(self, HAL_OK);
+		return HAL_OK;
+	}
+
+	HAL_StatusTypeDef status = startTransaction(self);
+	if(status != HAL_OK){
+		self->busy = 0;
+	}
+	return status;
+}
+
+HAL_StatusTypeDef regmap_i2c_write(REGMAP_I2C* self, uint8_t index, int32_t raw, REGMAP_CALLBACK callback, void* context){
+	if(self->busy){
+		return HAL_BUSY;
+	}
+	if(index >= self->device->count){
+		return HAL_ERROR;
+	}
+	const REGMAP_REGISTER* reg = &self->device->registers[index];
+	regmap_encode(reg, raw, self->writeBuffer);
+	self->callback = callback;
+	self->context = context;
+
+	self->busy = 1;
+	self->transactions++;
+	HAL_StatusTypeDef status = HAL_I2C_Mem_Write_IT(self->i2c, self->device->address << 1, reg->address, I2C_MEMADD_SIZE_8BIT, self->writeBuffer, reg->width);
+	if(status != HAL_OK){
+		self->busy = 0;
+	}
+	return status;
+}
+
+uint8_t regmap_i2c_isBusy(const REGMAP_I2C* self){
+	return self->busy;
+}
+
+int32_t regmap_i2c_value(const REGMAP_I2C* self, uint8_t index){
+	return regmap_value(self->device, &self->plan, self->buffer, index);
+}
+
+int32_t regmap_i2c_raw(const REGMAP_I2C* self, uint8_t index){
+	if(index >= self->device->count || self->plan.offsets[index] == REGMAP_NOT_PLANNED){
+		return 0;
+	}
+	return regmap_raw(&self->device->registers[index], &self->buffer[self->plan.offsets[index]]);
+}
+
+uint8_t regmap_i2c_handleRxCplt(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c){
+	if(hi2c != self->i2c || !self->busy){
+		return 0;
+	}
+	if(++self->transaction < self->plan.transactionCount){
+		if(startTransaction(self) != HAL_OK){
+			finish(self, HAL_ERROR);
+		}
+		return 1;
+	}
+	finish(self, HAL_OK);
+	return 1;
+}
+
+uint8_t regmap_i2c_handleTxCplt(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c){
+	if(hi2c != self->i2c || !self->busy){
+		return 0;
+	}
+	finish(self, HAL_OK);
+	return 1;
+}
+
+uint8_t regmap_i2c_handleError(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c){
+	if(hi2c != self->i2c || !self->busy){
+		return 0;
+	}
+	finish(self, HAL_ERROR);
+	return 1;
+}
@@ -0,0 +1,66 @@
+/*
+ * regmap_i2c.h
+ *
+ * Asynchronous register map reads and writes over the HAL I2C driver. A read runs the transactions of its plan one
+ * after the other from the I2C interrupts (DMA when the handle has a receive DMA channel linked, interrupts
+ * otherwise) and calls the completion callback once every register is in the buffer.
+ *
+ * The HAL has a single set of I2C callbacks, so the application forwards them:
+ *
+ *		void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c){ regmap_i2c_handleRxCplt(&sensor, hi2c); }
+ *		void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c){ regmap_i2c_handleTxCplt(&sensor, hi2c); }
+ *		void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c){ regmap_i2c_handleError(&sensor, hi2c); }
+ *
+ * Each handler returns 1 if the event belonged to that device, so several devices can share a callback.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef REGMAP_I2C_H_
+#define REGMAP_I2C_H_
+
+#include "regmap.h"
+#include "stm32u5xx_hal.h"
+
+typedef void (*REGMAP_CALLBACK)(void* context, HAL_StatusTypeDef status);
+
+typedef struct {
+	I2C_HandleTypeDef* i2c;
+	const REGMAP_DEVICE* device;
+	REGMAP_PLAN plan;
+	uint8_t buffer[REGMAP_MAX_BUFFER];
+	uint8_t writeBuffer[4];
+	uint8_t transaction; // transaction of the plan in progress
+	volatile uint8_t busy;
+	REGMAP_CALLBACK callback;
+	void* context;
+	uint32_t transactions; // bus transactions started, for statistics
+} REGMAP_I2C;
+
+// Binds a device table to an I2C handle
+void regmap_i2c_init(REGMAP_I2C* self, I2C_HandleTypeDef* i2c, const REGMAP_DEVICE* device);
+
+// Starts reading the registers at the given table indices. The callback (may be NULL) runs from the I2C interrupt.
+// Returns HAL_BUSY if a transfer of this device is in progress and HAL_ERROR if the registers cannot be planned.
+// The device is still busy during the callback: it reads the results, the next transfer is started after it.
+HAL_StatusTypeDef regmap_i2c_read(REGMAP_I2C* self, const uint8_t* indices, uint8_t count, REGMAP_CALLBACK callback, void* context);
+
+// Starts writing a raw value to a register. The callback (may be NULL) runs from the I2C interrupt.
+HAL_StatusTypeDef regmap_i2c_write(REGMAP_I2C* self, uint8_t index, int32_t raw, REGMAP_CALLBACK callback, void* context);
+
+// Returns 1 while a read or write is in progress
+uint8_t regmap_i2c_isBusy(const REGMAP_I2C* self);
+
+// Scaled value of a register from the last completed read
+int32_t regmap_i2c_value(const REGMAP_I2C* self, uint8_t index);
+
+// Raw value of a register from the last completed read
+int32_t regmap_i2c_raw(const REGMAP_I2C* self, uint8_t index);
+
+// I2C callback handlers, return 1 if the event was for this device
+uint8_t regmap_i2c_handleRxCplt(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c);
+uint8_t regmap_i2c_handleTxCplt(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c);
+uint8_t regmap_i2c_handleError(REGMAP_I2C* self, I2C_HandleTypeDef* hi2c);
+
+#endif /* REGMAP_I2C_H_ */
@@ -0,0 +1,76 @@
+/*
+ * supervisor.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#include "supervisor.h"
+#include <stddef.h>
+
+static uint32_t checkOf(const SUPERVISOR_RECORD* record){
+	return ~(record->magic + record->watchdogResets + record->task + record->lateMs + record->uptimeMs);
+}
+
+static void writeRecord(SUPERVISOR_RECORD* record, uint8_t task, uint32_t lateMs, uint32_t uptimeMs){
+	record->task = task;
+	record->lateMs = lateMs;
+	record->uptimeMs = uptimeMs;
+	record->check = checkOf(record);
+}
+
+void supervisor_init(SUPERVISOR* self, SUPERVISOR_RECORD* record, uint8_t watchdogReset, SUPERVISOR_BOOT* boot){
+	self->count = 0;
+	self->latched = 0;
+	self->record = record;
+
+	uint8_t valid = record->magic == SUPERVISOR_RECORD_MAGIC && record->check == checkOf(record);
+	if(!valid){
+		record->magic = SUPERVISOR_RECORD_MAGIC;
+		record->watchdogResets = 0;
+	}
+	else if(watchdogReset){
+		record->watchdogResets++;
+	}
+
+	if(boot != NULL){
+		boot->watchdogReset = watchdogReset;
+		boot->task = valid && watchdogReset ? record->task : SUPERVISOR_NO_TASK;
+		boot->lateMs = valid && watchdogReset ? record->lateMs : 0;
+		boot->uptimeMs = valid && watchdogReset ? record->uptimeMs : 0;
+		boot->watchdogResets = record->watchdogResets;
+	}
+	writeRecord(record, SUPERVISOR_NO_TASK, 0, 0);
+}
+
+uint8_t supervisor_addTask(SUPERVISOR* self, uint32_t deadlineMs, uint32_t now){
+	if(self->count >= SUPERVISOR_MAX_TASKS){
+		return SUPERVISOR_NO_TASK;
+	}
+	SUPERVISOR_TASK* task = &self->tasks[self->count];
+	task->deadlineMs = deadlineMs;
+	task->lastCheckIn = now;
+	return self->count++;
+}
+
+void supervisor_checkIn(SUPERVISOR* self, uint8_t task, uint32_t now){
+	if(task < self->count){
+		self->tasks[task].lastCheckIn = now;
+	}
+}
+
+uint8_t supervisor_poll(SUPERVISOR* self, uint32_t now){
+	if(self->latched){
+		return 0;
+	}
+	for(uint8_t i = 0; i < self->count; i++){
+		// Signed so that a check-in from a higher priority interrupt after now was read is not late
+		int32_t elapsed = (int32_t)(now - self->tasks[i].lastCheckIn);
+		if(elapsed > (int32_t)self->tasks[i].deadlineMs){
+			self->latched = 1;
+			writeRecord(self->record, i, elapsed, now);
+			return 0;
+		}
+	}
+	return 1;
+}
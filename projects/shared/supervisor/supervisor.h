@@ -0,0 +1,97 @@
+/*
+ * supervisor.h
+ *
+ * Task supervision for the independent watchdog. Each task that must keep running (the control loop, a sensor
+ * acquisition, a message reception) is registered with a deadline and checks in whenever it makes progress.
+ * supervisor_poll(), called periodically from an interrupt so that it still runs when the main loop is stuck in a
+ * blocking call, tells whether the watchdog may be refreshed: only while every task checked in within its deadline.
+ *
+ * The first task that misses its deadline latches the supervisor: the watchdog is never refreshed again and resets
+ * the microcontroller. Before that the late task is written into a record kept in RAM that is not initialised at
+ * startup, so the next boot can report which task hung and for how long (supervisor_init()).
+ *
+ * This file does not depend on the HAL so it can be tested on a host machine, the watchdog itself is refreshed
+ * by the caller.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sailbot
+ */
+
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+#include <stdint.h>
+
+// Largest number of supervised tasks
+#define SUPERVISOR_MAX_TASKS 8
+
+// Returned by supervisor_addTask() when the table is full, and the task of a record without a late task
+#define SUPERVISOR_NO_TASK 0xFF
+
+// Marks a record written by the supervisor, anything else is the random content of RAM after power-on
+#define SUPERVISOR_RECORD_MAGIC 0x57444F47
+
+typedef struct {
+	uint32_t deadlineMs;
+	volatile uint32_t lastCheckIn;
+} SUPERVISOR_TASK;
+
+// Kept across resets, place it in a no-init section
+typedef struct {
+	uint32_t magic;
+	uint32_t watchdogResets; // since power-on
+	uint32_t task; // late task, SUPERVISOR_NO_TASK if none
+	uint32_t lateMs; // time since its last check-in
+	uint32_t uptimeMs; // time of the poll that found it late
+	uint32_t check; // complement of the sum of the fields above
+} SUPERVISOR_RECORD;
+
+// What the record said at boot
+typedef struct {
+	uint8_t watchdogReset; // the reset was caused by the watchdog
+	uint8_t task; // the task that missed its deadline, SUPERVISOR_NO_TASK if unknown (e.g. interrupts blocked)
+	uint32_t lateMs;
+	uint32_t uptimeMs;
+	uint32_t watchdogResets;
+} SUPERVISOR_BOOT;
+
+typedef struct {
+	SUPERVISOR_TASK tasks[SUPERVISOR_MAX_TASKS];
+	uint8_t count;
+	volatile uint8_t latched; // a task missed its deadline
+	SUPERVISOR_RECORD* record;
+} SUPERVISOR;
+
+/*
+ * Reads the record left by the previous run and clears it for this one.
+ *
+ * @param self The supervisor
+ * @param record The record in no-init RAM
+ * @param watchdogReset 1 if the reset cause is the watchdog
+ * @param boot Receives what the record said, may be NULL
+ */
+void supervisor_init(SUPERVISOR* self, SUPERVISOR_RECORD* record, uint8_t watchdogReset, SUPERVISOR_BOOT* boot);
+
+/*
+ * Registers a task, which counts as checked in now.
+ *
+ * @param self The supervisor
+ * @param deadlineMs Longest time allowed between two check-ins
+ * @param now Current time in ms
+ * @return The task number, SUPERVISOR_NO_TASK if the table is full
+ */
+uint8_t supervisor_addTask(SUPERVISOR* self, uint32_t deadlineMs, uint32_t now);
+
+// Records progress of a task, safe from interrupts
+void supervisor_checkIn(SUPERVISOR* self, uint8_t task, uint32_t now);
+
+/*
+ * Checks every deadline.
+ *
+ * @param self The supervisor
+ * @param now Current time in ms
+ * @return 1 if the watchdog may be refreshed, 0 once a task missed its deadline
+ */
+uint8_t supervisor_poll(SUPERVISOR* self, uint32_t now);
+
+#endif /* SUPERVISOR_H_ */
@@ -9,8 +9,9 @@
 #include <stdio.h>
 
 // -- Framework --
-void test_main(const t_test *test_runner, unsigned int size) {
+unsigned int test_main(const t_test *test_runner, unsigned int size) {
 	unsigned int pass_count = 0;
+	unsigned int run_count = 0;
 	unsigned int num_tests = size;
 
 	// Go through test runnner
@@ -19,6 +20,7 @@ void test_main(const t_test *test_runner, unsigned int size) {
 
 		if (TEST_GROUP_SEL == ALL || TEST_GROUP_SEL == test.group) {
 			printf("--- Running Test: %s --- \r\n", test.testname);
+			run_count++;
 			testresult result = test.func();
 
 			if (result.stat == TSUCCESS) {
@@ -33,6 +35,8 @@ void test_main(const t_test *test_runner, unsigned int size) {
 
 	printf("--- Test Results --- \r\n");
 
-	printf("Tests Passed: %d \n\rTests Failed: %d\n\r", pass_count, num_tests - pass_count);
+	printf("Tests Passed: %d \n\rTests Failed: %d\n\r", pass_count, run_count - pass_count);
+
+	return run_count - pass_count;
 }
 
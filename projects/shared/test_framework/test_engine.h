@@ -33,7 +33,10 @@ typedef struct {
 	testgroup group;
 }t_test;
 
+// Ends the running test as failed when cond is false, with the line of the check in error.seg[0]
+#define TEST_CHECK(cond) do { if (!(cond)) return (testresult){TERROR, {.seg = {(unsigned short)__LINE__, 0}}}; } while (0)
 
-void test_main(const t_test * test_runner, unsigned int size);
+// Runs the tests of the selected group and returns the number of failed tests
+unsigned int test_main(const t_test * test_runner, unsigned int size);
 
 #endif /* SRC_UNIT_TESTS_H_ */